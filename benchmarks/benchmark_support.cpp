@@ -0,0 +1,196 @@
+#include "benchmark_support.h"
+
+#include <dsl/escaping.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace dsl {
+namespace bench {
+namespace {
+
+constexpr std::size_t kFactsPerClass = 8;
+constexpr std::size_t kModuleCount = 50;
+
+std::string ModuleName(std::size_t type) {
+  return "bench::module" + std::to_string(type % kModuleCount);
+}
+
+std::string TypeName(std::size_t type) {
+  return ModuleName(type) + "::Entity" + std::to_string(type);
+}
+
+std::string Location(std::size_t type, std::size_t line) {
+  return "src/module" + std::to_string(type % kModuleCount) + "/entity" +
+         std::to_string(type) + ".h:" + std::to_string(line) + ":3-" +
+         std::to_string(line + 4) + ":4";
+}
+
+AstFact GenerateFact(std::size_t index, std::size_t type_count) {
+  const auto type = index / kFactsPerClass;
+  const auto related = (type * 7 + 1) % type_count;
+  const auto line = 10 + (index % kFactsPerClass) * 6;
+  const auto type_name = TypeName(type);
+
+  AstFact fact;
+  fact.source_location = Location(type, line);
+  fact.range = fact.source_location;
+  fact.scope_path = ModuleName(type);
+  fact.subject_in_project = true;
+  switch (index % kFactsPerClass) {
+  case 0:
+    fact.name = type_name;
+    fact.kind = "type";
+    fact.signature = "class Entity" + std::to_string(type);
+    fact.doc_comment = "/// Domain entity number " + std::to_string(type);
+    break;
+  case 1:
+    fact.name = type_name + "::GetValue";
+    fact.kind = "function";
+    fact.signature = "int GetValue() const";
+    fact.doc_comment = "/// Returns the current value";
+    fact.scope_path = type_name;
+    break;
+  case 2:
+    fact.name = type_name + "::SetValue";
+    fact.kind = "function";
+    fact.signature = "void SetValue(int value)";
+    fact.scope_path = type_name;
+    break;
+  case 3:
+    fact.name = type_name + "::SetValue";
+    fact.kind = "call";
+    fact.target = TypeName(related) + "::GetValue";
+    fact.signature = "int GetValue() const";
+    fact.target_scope = AstFact::TargetScope::kInProject;
+    fact.target_location = Location(related, 16);
+    break;
+  case 4:
+    fact.name = type_name + "::SetValue";
+    fact.kind = "type_usage";
+    fact.target = TypeName(related);
+    fact.descriptor = "uses Entity" + std::to_string(related);
+    fact.target_scope = AstFact::TargetScope::kInProject;
+    fact.target_location = Location(related, 10);
+    break;
+  case 5:
+    fact.name = type_name;
+    fact.kind = "owns";
+    fact.target = "std::string";
+    fact.descriptor = "label";
+    fact.target_scope = AstFact::TargetScope::kExternal;
+    fact.target_location =
+        "/usr/include/c++/13/bits/basic_string.h:87:5-87:9";
+    break;
+  case 6:
+    fact.name = type_name + "::GetValue";
+    fact.kind = "call";
+    fact.target = "std::max";
+    fact.signature = "const int &max(const int &, const int &)";
+    fact.target_scope = AstFact::TargetScope::kExternal;
+    fact.target_location =
+        "/usr/include/c++/13/bits/stl_algobase.h:254:5-254:8";
+    break;
+  default:
+    fact.name = ModuleName(type) + "::kLimit" + std::to_string(type);
+    fact.kind = "variable";
+    fact.descriptor = "const int";
+    fact.signature = "const int kLimit" + std::to_string(type);
+    break;
+  }
+  return fact;
+}
+
+std::unique_ptr<AstIndex> BuildIndex(std::size_t fact_count) {
+  auto index = std::make_unique<AstIndex>();
+  index->facts.reserve(fact_count);
+  const auto type_count = (fact_count + kFactsPerClass - 1) / kFactsPerClass;
+  for (std::size_t i = 0; i < fact_count; ++i) {
+    index->facts.push_back(GenerateFact(i, type_count));
+  }
+  return index;
+}
+
+std::unique_ptr<TextCorpus> BuildCorpus(const AstIndex &index) {
+  auto corpus = std::make_unique<TextCorpus>();
+  corpus->texts.reserve(index.facts.size());
+  corpus->escaped_rows.reserve(index.facts.size());
+  for (const auto &fact : index.facts) {
+    auto text = std::string(fact.doc_comment());
+    text.append("\n").append(fact.signature()).append("\t\"");
+    text.append(fact.descriptor()).append("\"");
+    auto row = Escape(std::string(fact.name()));
+    row.append("\t").append(Escape(std::string(fact.kind())));
+    row.append("\t").append(Escape(text));
+    corpus->text_bytes += text.size();
+    corpus->row_bytes += row.size();
+    corpus->texts.push_back(std::move(text));
+    corpus->escaped_rows.push_back(std::move(row));
+  }
+  return corpus;
+}
+
+template <typename T, typename Build>
+const T &Cached(std::map<std::size_t, std::unique_ptr<T>> &cache,
+                std::size_t size, const Build &build) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = cache[size];
+  if (!entry) {
+    entry = build();
+  }
+  return *entry;
+}
+
+} // namespace
+
+const AstIndex &GeneratedIndex(std::size_t fact_count) {
+  static std::map<std::size_t, std::unique_ptr<AstIndex>> indexes;
+  return Cached(indexes, fact_count, [&] { return BuildIndex(fact_count); });
+}
+
+const TextCorpus &GeneratedCorpus(std::size_t fact_count) {
+  static std::map<std::size_t, std::unique_ptr<TextCorpus>> corpora;
+  const auto &index = GeneratedIndex(fact_count);
+  return Cached(corpora, fact_count, [&] { return BuildCorpus(index); });
+}
+
+std::uint64_t FactBytes(const FactStore &facts) {
+  std::uint64_t bytes = 0;
+  for (const auto &fact : facts) {
+    bytes += fact.name().size() + fact.kind().size() +
+             fact.signature().size() + fact.descriptor().size() +
+             fact.target().size() + fact.doc_comment().size() +
+             fact.scope_path().size() + fact.source_location().size() +
+             fact.range().size() + fact.target_location().size();
+  }
+  return bytes;
+}
+
+AnalysisConfig BenchmarkConfig() {
+  AnalysisConfig config;
+  config.root_path = "bench";
+  config.formats = {"markdown", "json"};
+  config.scope_notes = "Generated benchmark fact set";
+  return config;
+}
+
+void FactSetSizes(benchmark::internal::Benchmark *benchmark) {
+  for (const auto size : {10'000, 100'000, 1'000'000, 5'000'000}) {
+    benchmark->Arg(size);
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+void SetFactThroughput(benchmark::State &state, std::size_t facts,
+                       std::uint64_t bytes) {
+  state.counters["facts/s"] =
+      benchmark::Counter(static_cast<double>(facts),
+                         benchmark::Counter::kIsIterationInvariantRate);
+  state.SetBytesProcessed(static_cast<std::int64_t>(bytes) *
+                          static_cast<std::int64_t>(state.iterations()));
+}
+
+} // namespace bench
+} // namespace dsl
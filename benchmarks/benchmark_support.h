@@ -0,0 +1,46 @@
+#ifndef DSL_BENCHMARKS_BENCHMARK_SUPPORT_H
+#define DSL_BENCHMARKS_BENCHMARK_SUPPORT_H
+
+#include <dsl/models.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dsl {
+namespace bench {
+
+// Deterministic fact set shaped like an indexer run over `fact_count` facts:
+// types with members and methods, in-project calls and type usages, and
+// references to external types. Built once per size and shared.
+const AstIndex &GeneratedIndex(std::size_t fact_count);
+
+// Field text of every generated fact, raw and in the escaped tab-separated
+// row format, for the text helper benchmarks.
+struct TextCorpus {
+  std::vector<std::string> texts;
+  std::vector<std::string> escaped_rows;
+  std::uint64_t text_bytes = 0;
+  std::uint64_t row_bytes = 0;
+};
+const TextCorpus &GeneratedCorpus(std::size_t fact_count);
+
+// Total size of the string fields of `facts`, as they would be printed.
+std::uint64_t FactBytes(const FactStore &facts);
+
+AnalysisConfig BenchmarkConfig();
+
+// Registers the fact-set sizes every stage benchmark runs over.
+void FactSetSizes(benchmark::internal::Benchmark *benchmark);
+
+// Reports facts/s and bytes/s for `facts` and `bytes` handled per iteration.
+void SetFactThroughput(benchmark::State &state, std::size_t facts,
+                       std::uint64_t bytes);
+
+} // namespace bench
+} // namespace dsl
+
+#endif // DSL_BENCHMARKS_BENCHMARK_SUPPORT_H
@@ -0,0 +1,71 @@
+#include "benchmark_support.h"
+
+#include <dsl/compile_commands_loader.h>
+
+#include <map>
+#include <string>
+
+namespace dsl {
+namespace bench {
+namespace {
+
+// A database shaped like CMake output: long include and define lists, with
+// every other entry in the `arguments` form.
+const std::string &GeneratedDatabase(std::size_t entries) {
+  static std::map<std::size_t, std::string> databases;
+  auto &json = databases[entries];
+  if (!json.empty()) {
+    return json;
+  }
+  std::string flags;
+  for (int i = 0; i < 24; ++i) {
+    flags += " -I/work/project/include/component" + std::to_string(i);
+  }
+  flags += " -DPROJECT_VERSION=\\\"1.2.3\\\" -std=c++17 -O2 -g";
+  json = "[\n";
+  for (std::size_t i = 0; i < entries; ++i) {
+    const auto file = "/work/project/src/unit" + std::to_string(i) + ".cpp";
+    const auto output = "CMakeFiles/app.dir/unit" + std::to_string(i) + ".o";
+    json += i == 0 ? "" : ",\n";
+    json += "{\n  \"directory\": \"/work/project/build\",\n";
+    if (i % 2 == 0) {
+      json += "  \"command\": \"/usr/bin/c++" + flags + " -o " + output +
+              " -c " + file + "\",\n";
+    } else {
+      json += "  \"arguments\": [\"/usr/bin/c++\"";
+      for (std::size_t at = 1, next; at < flags.size(); at = next + 1) {
+        next = flags.find(' ', at);
+        next = next == std::string::npos ? flags.size() : next;
+        json += ", \"" + flags.substr(at, next - at) + "\"";
+      }
+      json += ", \"-o\", \"" + output + "\", \"-c\", \"" + file + "\"],\n";
+    }
+    json += "  \"file\": \"" + file + "\",\n  \"output\": \"" + output +
+            "\"\n}";
+  }
+  json += "\n]\n";
+  return json;
+}
+
+void BM_ReadCompileCommands(benchmark::State &state) {
+  const auto entries = static_cast<std::size_t>(state.range(0));
+  const auto &json = GeneratedDatabase(entries);
+  for (auto _ : state) {
+    CompileCommandsReader reader(json);
+    CompileCommand command;
+    std::size_t read = 0;
+    while (reader.Next(command)) {
+      ++read;
+    }
+    benchmark::DoNotOptimize(read);
+  }
+  SetFactThroughput(state, entries, json.size());
+}
+BENCHMARK(BM_ReadCompileCommands)
+    ->Arg(10'000)
+    ->Arg(100'000)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace bench
+} // namespace dsl
@@ -0,0 +1,86 @@
+#include "benchmark_support.h"
+
+#include <dsl/analyzer_pipeline_builder.h>
+#include <dsl/component_registry.h>
+#include <dsl/default_analyzer_pipeline.h>
+#include <dsl/dsl_analyzer.h>
+#include <dsl/project_generator.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace dsl {
+namespace bench {
+namespace {
+
+// Units of the "50k-loc" shape; 80 units is that scenario and 800 units
+// its 500k-line counterpart.
+GeneratedProject WriteProject(std::size_t unit_count) {
+  auto shape = ProjectShapeForScenario("50k-loc");
+  shape.translation_units = static_cast<unsigned>(unit_count);
+  return GenerateProject(std::filesystem::temp_directory_path() /
+                             "dsl_benchmarks" /
+                             ("project_" + std::to_string(unit_count)),
+                         shape);
+}
+
+std::size_t CountFacts(const GeneratedProject &project) {
+  AnalysisConfig config;
+  config.root_path = project.root.string();
+  config.formats = {"markdown"};
+  auto pipeline = AnalyzerPipelineBuilder::WithDefaults()
+                      .WithLogger(std::make_shared<NullLogger>())
+                      .Build();
+  const auto result = pipeline.Run(config);
+  return result.extraction.facts ? result.extraction.facts->size() : 0;
+}
+
+void BM_AnalyzeProject(benchmark::State &state) {
+  const auto project = WriteProject(state.range(0));
+  const auto facts = CountFacts(project);
+  const std::vector<std::string> arguments{
+      "--root", project.root.string(), "--build",
+      (project.root / "build").string(), "--out",
+      (project.root / "out").string(), "--log-level", "error"};
+  for (auto _ : state) {
+    // The exit code reports coherence findings, not failures.
+    benchmark::DoNotOptimize(RunAnalyze(arguments));
+  }
+  SetFactThroughput(state, facts, project.bytes);
+  std::filesystem::remove_all(project.root);
+}
+BENCHMARK(BM_AnalyzeProject)
+    ->Arg(8)
+    ->Arg(80)
+    ->Arg(800)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Indexing alone with each registered engine: the cursor walker (0) and
+// clang_indexSourceFile (1), on one worker and without caches.
+void BM_IndexProject(benchmark::State &state) {
+  const auto project = WriteProject(state.range(0));
+  const std::string engine = state.range(1) == 0 ? "cursor" : "indexing-api";
+  state.SetLabel(engine);
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root.string();
+  sources.build_directory = (project.root / "build").string();
+  std::size_t facts = 0;
+  for (auto _ : state) {
+    auto indexer = GlobalComponentRegistry().CreateIndexer(
+        engine, std::make_shared<NullLogger>());
+    facts = indexer->BuildIndex(sources).facts.size();
+    benchmark::DoNotOptimize(facts);
+  }
+  SetFactThroughput(state, facts, project.bytes);
+  std::filesystem::remove_all(project.root);
+}
+BENCHMARK(BM_IndexProject)
+    ->ArgsProduct({{8, 80, 800}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
+} // namespace bench
+} // namespace dsl
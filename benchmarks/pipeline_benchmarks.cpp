@@ -0,0 +1,112 @@
+#include "benchmark_support.h"
+
+#include <dsl/ast_cache.h>
+#include <dsl/heuristic_dsl_extractor.h>
+#include <dsl/markdown_reporter.h>
+#include <dsl/rule_based_coherence_analyzer.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace dsl {
+namespace bench {
+namespace {
+
+const std::string kCacheKey = "benchmark";
+
+std::filesystem::path CacheDirectory(std::size_t fact_count) {
+  return std::filesystem::temp_directory_path() / "dsl_benchmarks" /
+         ("cache_" + std::to_string(fact_count));
+}
+
+AstCache MakeCache(std::size_t fact_count) {
+  AstCacheOptions options;
+  options.enabled = true;
+  options.directory = CacheDirectory(fact_count);
+  return AstCache(options, std::make_shared<NullLogger>());
+}
+
+const DslExtractionResult &CachedExtraction(std::size_t fact_count) {
+  static std::map<std::size_t, DslExtractionResult> extractions;
+  auto found = extractions.find(fact_count);
+  if (found == extractions.end()) {
+    HeuristicDslExtractor extractor;
+    found = extractions
+                .emplace(fact_count,
+                         extractor.Extract(GeneratedIndex(fact_count),
+                                           BenchmarkConfig()))
+                .first;
+  }
+  return found->second;
+}
+
+void BM_AstCacheStore(benchmark::State &state) {
+  const auto &index = GeneratedIndex(state.range(0));
+  const auto cache = MakeCache(index.facts.size());
+  for (auto _ : state) {
+    cache.Store(kCacheKey, index);
+  }
+  SetFactThroughput(state, index.facts.size(), FactBytes(index.facts));
+  std::filesystem::remove_all(cache.Directory());
+}
+BENCHMARK(BM_AstCacheStore)->Apply(FactSetSizes);
+
+void BM_AstCacheLoad(benchmark::State &state) {
+  const auto &index = GeneratedIndex(state.range(0));
+  const auto cache = MakeCache(index.facts.size());
+  cache.Store(kCacheKey, index);
+  for (auto _ : state) {
+    AstIndex loaded;
+    if (!cache.Load(kCacheKey, loaded)) {
+      state.SkipWithError("AST cache entry could not be loaded");
+      break;
+    }
+    benchmark::DoNotOptimize(loaded);
+  }
+  SetFactThroughput(state, index.facts.size(), FactBytes(index.facts));
+  std::filesystem::remove_all(cache.Directory());
+}
+BENCHMARK(BM_AstCacheLoad)->Apply(FactSetSizes);
+
+void BM_HeuristicExtract(benchmark::State &state) {
+  const auto &index = GeneratedIndex(state.range(0));
+  const auto config = BenchmarkConfig();
+  HeuristicDslExtractor extractor;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(extractor.Extract(index, config));
+  }
+  SetFactThroughput(state, index.facts.size(), FactBytes(index.facts));
+}
+BENCHMARK(BM_HeuristicExtract)->Apply(FactSetSizes);
+
+void BM_RuleBasedAnalyze(benchmark::State &state) {
+  const auto &extraction = CachedExtraction(state.range(0));
+  RuleBasedCoherenceAnalyzer analyzer;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(analyzer.Analyze(extraction));
+  }
+  SetFactThroughput(state, extraction.facts->size(),
+                    FactBytes(*extraction.facts));
+}
+BENCHMARK(BM_RuleBasedAnalyze)->Apply(FactSetSizes);
+
+void BM_MarkdownRender(benchmark::State &state) {
+  const auto &extraction = CachedExtraction(state.range(0));
+  const auto coherence = RuleBasedCoherenceAnalyzer().Analyze(extraction);
+  const auto config = BenchmarkConfig();
+  MarkdownReporter reporter;
+  std::uint64_t report_bytes = 0;
+  for (auto _ : state) {
+    const auto report = reporter.Render(extraction, coherence, config);
+    report_bytes = report.markdown.size() + report.json.size();
+    benchmark::DoNotOptimize(report);
+  }
+  SetFactThroughput(state, extraction.facts->size(), report_bytes);
+}
+BENCHMARK(BM_MarkdownRender)->Apply(FactSetSizes);
+
+} // namespace
+} // namespace bench
+} // namespace dsl
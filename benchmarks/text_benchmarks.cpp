@@ -0,0 +1,60 @@
+#include "benchmark_support.h"
+
+#include <dsl/escaping.h>
+#include <dsl/naming.h>
+
+namespace dsl {
+namespace bench {
+namespace {
+
+void BM_Escape(benchmark::State &state) {
+  const auto &corpus = GeneratedCorpus(state.range(0));
+  for (auto _ : state) {
+    for (const auto &text : corpus.texts) {
+      benchmark::DoNotOptimize(Escape(text));
+    }
+  }
+  SetFactThroughput(state, corpus.texts.size(), corpus.text_bytes);
+}
+BENCHMARK(BM_Escape)->Apply(FactSetSizes);
+
+void BM_SplitEscaped(benchmark::State &state) {
+  const auto &corpus = GeneratedCorpus(state.range(0));
+  for (auto _ : state) {
+    for (const auto &row : corpus.escaped_rows) {
+      benchmark::DoNotOptimize(SplitEscaped(row));
+    }
+  }
+  SetFactThroughput(state, corpus.escaped_rows.size(), corpus.row_bytes);
+}
+BENCHMARK(BM_SplitEscaped)->Apply(FactSetSizes);
+
+void BM_CanonicalizeName(benchmark::State &state) {
+  const auto &index = GeneratedIndex(state.range(0));
+  std::uint64_t bytes = 0;
+  for (const auto &fact : index.facts) {
+    bytes += fact.name().size();
+  }
+  for (auto _ : state) {
+    for (const auto &fact : index.facts) {
+      benchmark::DoNotOptimize(CanonicalizeName(fact.name()));
+    }
+  }
+  SetFactThroughput(state, index.facts.size(), bytes);
+}
+BENCHMARK(BM_CanonicalizeName)->Apply(FactSetSizes);
+
+void BM_EscapeJsonString(benchmark::State &state) {
+  const auto &corpus = GeneratedCorpus(state.range(0));
+  for (auto _ : state) {
+    for (const auto &text : corpus.texts) {
+      benchmark::DoNotOptimize(EscapeJsonString(text));
+    }
+  }
+  SetFactThroughput(state, corpus.texts.size(), corpus.text_bytes);
+}
+BENCHMARK(BM_EscapeJsonString)->Apply(FactSetSizes);
+
+} // namespace
+} // namespace bench
+} // namespace dsl
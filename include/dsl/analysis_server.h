@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+namespace dsl {
+
+// What a client prints and exits with for one request.
+struct ServerReply {
+  int exit_code = 0;
+  std::string body;
+};
+
+using RequestHandler = std::function<ServerReply(const std::string &request)>;
+
+// Answers requests on a Unix domain socket, one connection at a time, so the
+// handler may keep state between requests. A client writes one line naming
+// the request; the reply is the exit code on a line of its own followed by
+// the body, and the server closes the connection. A client that has not
+// sent its request line within `client_timeout`, or stops reading the reply
+// for that long, is dropped so it cannot hold up the clients behind it.
+class AnalysisServer {
+public:
+  AnalysisServer(std::filesystem::path socket_path, RequestHandler handler,
+                 std::chrono::milliseconds client_timeout =
+                     std::chrono::seconds(5));
+  ~AnalysisServer();
+  AnalysisServer(const AnalysisServer &) = delete;
+  AnalysisServer &operator=(const AnalysisServer &) = delete;
+
+  // Binds the socket, replacing a socket file no server answers on. Throws
+  // std::runtime_error when another server is listening on the path or the
+  // socket cannot be created.
+  void Listen();
+  // Answers connections until a "shutdown" request, which is acknowledged
+  // without reaching the handler. A handler exception becomes a reply with
+  // exit code 1 and the server keeps running.
+  void Serve();
+
+  const std::filesystem::path &socket_path() const { return socket_path_; }
+
+private:
+  std::filesystem::path socket_path_;
+  RequestHandler handler_;
+  std::chrono::milliseconds client_timeout_;
+  int descriptor_ = -1;
+};
+
+// Sends `request` to the server listening on `socket_path` and waits for its
+// reply; throws std::runtime_error when no server answers.
+ServerReply SendServerRequest(const std::filesystem::path &socket_path,
+                              const std::string &request);
+
+} // namespace dsl
@@ -39,6 +39,10 @@ public:
   AnalyzerPipelineBuilder &WithExtractorName(std::string name);
   AnalyzerPipelineBuilder &WithAnalyzerName(std::string name);
   AnalyzerPipelineBuilder &WithReporterName(std::string name);
+  AnalyzerPipelineBuilder &WithIndexerName(std::string name);
+  // Options handed to the registry's indexer factory; ignored when an
+  // indexer instance is given with WithIndexer.
+  AnalyzerPipelineBuilder &WithIndexerOptions(IndexerOptions options);
 
   DefaultAnalyzerPipeline Build();
 
@@ -50,7 +54,9 @@ private:
     std::string extractor;
     std::string analyzer;
     std::string reporter;
+    std::string indexer;
   } selections_;
+  IndexerOptions indexer_options_;
   PipelineComponents components_;
 };
 
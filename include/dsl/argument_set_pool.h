@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dsl {
+
+using ArgumentSetId = std::uint32_t;
+
+// Stores each distinct compiler argument list once. Translation units built
+// with the same flags share one id, one copy of the strings and one
+// `const char *` array for libclang. Interning is not thread-safe; lookups
+// on a pool that is no longer modified are.
+class ArgumentSetPool {
+public:
+  ArgumentSetId Intern(const std::vector<std::string> &arguments);
+
+  const std::vector<std::string> &Arguments(ArgumentSetId id) const {
+    return sets_[id].arguments;
+  }
+  // Points into Arguments(id); valid for the lifetime of the pool.
+  const std::vector<const char *> &Pointers(ArgumentSetId id) const {
+    return sets_[id].pointers;
+  }
+  std::size_t size() const { return sets_.size(); }
+
+private:
+  struct ArgumentSet {
+    std::vector<std::string> arguments;
+    std::vector<const char *> pointers;
+  };
+
+  std::vector<ArgumentSet> sets_;
+  std::unordered_multimap<std::uint64_t, ArgumentSetId> ids_by_hash_;
+};
+
+} // namespace dsl
@@ -3,9 +3,13 @@
 #include <dsl/interfaces.h>
 #include <dsl/logging.h>
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace dsl {
 
@@ -15,26 +19,102 @@ struct AstCacheOptions {
   std::filesystem::path directory;
 };
 
+struct FileDependency {
+  std::string path;
+  std::uint64_t content_hash = 0;
+};
+
+// Why no translation unit could be parsed: the libclang error code of the
+// last attempt, a short description of every attempt and the first few
+// error messages found, each as "file:line: message" when it has a location.
+struct ParseFailure {
+  int error_code = 0;
+  std::string summary;
+  std::vector<std::string> diagnostics;
+};
+
+// Facts harvested from one translation unit plus every file the parse read
+// (main file and headers), so the entry can be validated before it is reused.
+// A failed parse is recorded with its main file as the only dependency and
+// no facts.
+struct TranslationUnitCacheEntry {
+  std::vector<FileDependency> dependencies;
+  FactStore facts;
+  std::optional<ParseFailure> failure;
+  // The git commit every dependency held its recorded contents at, when
+  // known; such an entry can be validated against a change set from that
+  // commit without reading its files.
+  std::string revision;
+};
+
+// How long the last run that parsed a translation unit took to parse it and
+// how many facts it produced, so the next run can start long units first.
+struct ParseTiming {
+  std::string file;
+  std::uint64_t duration_us = 0;
+  std::uint64_t fact_count = 0;
+};
+
+struct FindingBaseline {
+  std::string revision;
+  std::vector<Finding> findings;
+};
+
 std::filesystem::path ResolveCacheDirectory(const AstCacheOptions &options);
 
+// Writes `contents` to a temporary file beside `path` and renames it over
+// `path`, so a reader sees the old file or the new one but never part of
+// it. Creates missing parent directories; returns false on failure.
+bool WriteFileAtomically(const std::filesystem::path &path,
+                         std::string_view contents);
+
 class AstCache {
 public:
   AstCache(AstCacheOptions options, std::shared_ptr<Logger> logger);
 
   bool Load(const std::string &key, AstIndex &index) const;
   void Store(const std::string &key, const AstIndex &index) const;
+  bool LoadTranslationUnit(const std::string &key,
+                           TranslationUnitCacheEntry &entry) const;
+  void StoreTranslationUnit(const std::string &key,
+                            const TranslationUnitCacheEntry &entry) const;
+  std::vector<ParseTiming> LoadParseTimings() const;
+  // Replaces the stored timings with `timings`.
+  void StoreParseTimings(const std::vector<ParseTiming> &timings) const;
+  // Findings of the last full analysis, which a changed-files run is
+  // compared with; nullopt when none are stored or the cache is disabled.
+  std::optional<FindingBaseline> LoadFindingBaseline() const;
+  // `revision` is the commit the analyzed files were at, or empty when they
+  // differed from every commit.
+  void StoreFindingBaseline(const std::vector<Finding> &findings,
+                            const std::string &revision) const;
   void Clean() const;
   const std::filesystem::path &Directory() const { return directory_; }
 
 private:
   std::filesystem::path CachePath(const std::string &key) const;
+  std::filesystem::path TranslationUnitPath(const std::string &key) const;
+  std::filesystem::path ParseTimingsPath() const;
+  std::filesystem::path FindingBaselinePath() const;
 
   AstCacheOptions options_;
   std::filesystem::path directory_;
   std::shared_ptr<Logger> logger_;
 };
 
+// The cache file encoding of `facts` alone, for fact shards written outside
+// the cache directory. DecodeFacts appends the facts to `facts` and returns
+// false when `data` is not such an encoding.
+std::string EncodeFacts(const FactStore &facts);
+bool DecodeFacts(std::string_view data, FactStore &facts);
+
 std::string ToolchainVersion();
 std::string BuildCacheKey(const SourceAcquisitionResult &sources,
                           const std::string &toolchain_version);
+std::string
+BuildTranslationUnitCacheKey(const std::string &toolchain_version,
+                             const std::string &indexer_settings,
+                             const std::filesystem::path &file,
+                             const std::filesystem::path &directory,
+                             const std::vector<std::string> &args);
 } // namespace dsl
@@ -3,6 +3,8 @@
 #include <dsl/ast_cache.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace dsl {
 
@@ -12,12 +14,21 @@ public:
                     std::shared_ptr<Logger> logger);
 
   AstIndex BuildIndex(const SourceAcquisitionResult &sources) override;
+  void StreamIndex(const SourceAcquisitionResult &sources,
+                   FactSink &sink) override;
+  std::vector<std::string> IndexingNotes() const override;
 
 private:
+  // Cleans the cache if requested and reports whether the inner indexer
+  // should run directly, i.e. without the whole-index cache.
+  bool DelegatesRun() const;
+  AstIndex BuildCachedIndex(const SourceAcquisitionResult &sources);
+
   std::unique_ptr<AstIndexer> inner_;
   AstCacheOptions options_;
-  AstCache cache_;
+  std::shared_ptr<AstCache> cache_;
   std::shared_ptr<Logger> logger_;
+  bool per_translation_unit_ = false;
 };
 
 } // namespace dsl
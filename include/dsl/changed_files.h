@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dsl {
+
+// A git work tree compared with one commit. Paths are canonical, absolute,
+// sorted and without duplicates.
+struct ChangeSet {
+  // The full hash of the commit.
+  std::string revision;
+  // Committed, staged and unstaged edits, deletions and untracked files that
+  // are not ignored.
+  std::vector<std::string> changed;
+  // Tracked files outside `changed`, which still hold their contents at
+  // `revision`. Ignored and untracked files are in neither list.
+  std::vector<std::string> unchanged;
+};
+
+// Compares the git work tree containing `root` with `revision`. Reads only
+// the local object store, so no fetch happens. Throws std::runtime_error
+// when git is missing, `root` is not in a work tree or the revision is
+// unknown.
+ChangeSet ChangedFilesSince(const std::filesystem::path &root,
+                            const std::string &revision);
+
+// Compares the work tree containing `root` with its checked-out commit;
+// nullopt when there is none, for example outside a git work tree.
+std::optional<ChangeSet> WorkTreeChanges(const std::filesystem::path &root);
+
+// Reads a list of changed files, one per line, for CI systems that already
+// know the change set. Relative paths are resolved against `root`; blank
+// lines and lines starting with '#' are skipped. Returns canonical absolute
+// paths sorted and without duplicates.
+std::vector<std::string>
+ReadChangedFilesList(const std::filesystem::path &list_file,
+                     const std::filesystem::path &root);
+
+} // namespace dsl
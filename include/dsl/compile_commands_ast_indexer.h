@@ -1,23 +1,88 @@
 #pragma once
 
+#include <dsl/changed_files.h>
+#include <dsl/fact_shard.h>
 #include <dsl/interfaces.h>
 #include <dsl/logging.h>
 
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace dsl {
 
+// How facts are harvested from a translation unit.
+enum class IndexerEngine {
+  // Visits every cursor of the parsed unit with clang_visitChildren.
+  kCursorWalk,
+  // Receives declarations and references from clang_indexSourceFile.
+  kIndexingApi,
+};
+
+struct IndexerOptions {
+  // Number of translation units parsed concurrently; 0 selects one worker per
+  // hardware thread.
+  unsigned jobs = 1;
+  // Skips the subtrees of declarations located outside the project root or in
+  // system headers instead of visiting every cursor of every included header.
+  bool prune_external = true;
+  // `kDeclarations` parses with skipped function bodies and harvests only
+  // function, type, variable and owns facts.
+  IndexDepth depth = IndexDepth::kFull;
+  // Precompiles the includes shared at the top of translation units with
+  // equal arguments once and parses those units with -include-pch. Headers
+  // are kept in the AST cache directory when caching, else in a temporary
+  // directory; facts are the same as without them.
+  bool precompile_headers = true;
+  // Parses translation units whose failure is recorded in the AST cache
+  // instead of skipping them while their main file and flags are unchanged.
+  bool retry_failed = false;
+  // The indexing API names a call at the callee's name rather than over the
+  // whole call expression and reads no precompiled headers; otherwise both
+  // engines report the same facts.
+  IndexerEngine engine = IndexerEngine::kCursorWalk;
+  // Keeps each parsed translation unit alive between runs of this indexer.
+  // A later run reuses the unit's facts while its main file and headers are
+  // unchanged and reparses it in place with its precompiled preamble
+  // otherwise. Applies to the cursor walk and replaces precompiled headers
+  // and the skipping of shared headers, whose facts a kept unit must hold.
+  bool keep_translation_units = false;
+  // The work tree compared with a git commit. A cached unit recorded at
+  // that commit is reused without reading its files when none of them
+  // changed since; any other cached unit is validated by hashing its files.
+  std::optional<ChangeSet> changes;
+  // Parses only the compile commands in this partition. Every other command
+  // is delivered as an empty batch, so a sink still sees one batch per
+  // compile command in order, as FactShardWriter expects.
+  std::optional<IndexShard> shard;
+};
+
+class ResidentTranslationUnits;
+
 class CompileCommandsAstIndexer : public AstIndexer {
 public:
   explicit CompileCommandsAstIndexer(
       std::filesystem::path compile_commands_path = {},
-      std::shared_ptr<Logger> logger = nullptr);
+      std::shared_ptr<Logger> logger = nullptr, IndexerOptions options = {});
+  ~CompileCommandsAstIndexer() override;
   AstIndex BuildIndex(const SourceAcquisitionResult &sources) override;
+  // Hands each translation unit's facts to `sink` in compile-command order
+  // as soon as every earlier unit is done, minus facts already delivered.
+  void StreamIndex(const SourceAcquisitionResult &sources,
+                   FactSink &sink) override;
+  bool UseTranslationUnitCache(std::shared_ptr<const AstCache> cache) override;
+  // Lists the translation units of the last run that produced no facts.
+  std::vector<std::string> IndexingNotes() const override;
 
 private:
   std::filesystem::path compile_commands_path_;
   std::shared_ptr<Logger> logger_;
+  IndexerOptions options_;
+  std::shared_ptr<const AstCache> cache_;
+  std::vector<std::string> notes_;
+  std::unique_ptr<ResidentTranslationUnits> resident_;
 };
 
 } // namespace dsl
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dsl {
+
+// One entry of a JSON compilation database. `arguments` comes from the
+// `arguments` array or, when that is absent, from splitting `command`.
+struct CompileCommand {
+  std::string directory;
+  std::string file;
+  std::vector<std::string> arguments;
+  std::string output;
+};
+
+// Pull parser for compile_commands.json that yields one entry at a time
+// without building a document tree. `json` must outlive the reader. Unknown
+// keys are skipped; malformed input throws std::runtime_error naming the
+// byte offset.
+class CompileCommandsReader {
+public:
+  explicit CompileCommandsReader(std::string_view json);
+
+  // Overwrites `command` with the next entry, reusing its buffers. Returns
+  // false once the closing bracket has been read.
+  bool Next(CompileCommand &command);
+
+private:
+  enum class State { kStart, kNextEntry, kDone };
+
+  bool Finish();
+  void ReadEntry(CompileCommand &command);
+  void ReadString(std::string &value);
+  void ReadStringArray(std::vector<std::string> &values);
+  void SkipValue(unsigned depth);
+  void SkipLiteral();
+  void SkipWhitespace();
+  void Expect(char expected);
+  char Peek();
+  [[noreturn]] void Fail(const std::string &message) const;
+
+  std::string_view json_;
+  std::size_t position_ = 0;
+  State state_ = State::kStart;
+  std::string key_;
+  std::string command_;
+};
+
+// Splits a `command` string the way clang tooling does: whitespace separates
+// arguments, single quotes are literal, and a backslash escapes the next
+// character outside single quotes.
+std::vector<std::string> SplitCommandLine(std::string_view command);
+
+} // namespace dsl
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <dsl/compile_commands_ast_indexer.h>
 #include <dsl/interfaces.h>
+#include <dsl/logging.h>
 
 #include <functional>
 #include <memory>
@@ -15,6 +17,8 @@ public:
   using ExtractorFactory = std::function<std::unique_ptr<DslExtractor>()>;
   using AnalyzerFactory = std::function<std::unique_ptr<CoherenceAnalyzer>()>;
   using ReporterFactory = std::function<std::unique_ptr<Reporter>()>;
+  using IndexerFactory = std::function<std::unique_ptr<AstIndexer>(
+      std::shared_ptr<Logger>, IndexerOptions)>;
 
   void RegisterExtractor(const std::string &name, ExtractorFactory factory,
                          bool set_as_default = false);
@@ -22,20 +26,28 @@ public:
                         bool set_as_default = false);
   void RegisterReporter(const std::string &name, ReporterFactory factory,
                         bool set_as_default = false);
+  void RegisterIndexer(const std::string &name, IndexerFactory factory,
+                       bool set_as_default = false);
 
   std::unique_ptr<DslExtractor>
   CreateExtractor(const std::string &name = "") const;
   std::unique_ptr<CoherenceAnalyzer>
   CreateAnalyzer(const std::string &name = "") const;
   std::unique_ptr<Reporter> CreateReporter(const std::string &name = "") const;
+  std::unique_ptr<AstIndexer>
+  CreateIndexer(const std::string &name = "",
+                std::shared_ptr<Logger> logger = nullptr,
+                IndexerOptions options = {}) const;
 
   std::vector<std::string> ExtractorNames() const;
   std::vector<std::string> AnalyzerNames() const;
   std::vector<std::string> ReporterNames() const;
+  std::vector<std::string> IndexerNames() const;
 
   const std::string &DefaultExtractorName() const;
   const std::string &DefaultAnalyzerName() const;
   const std::string &DefaultReporterName() const;
+  const std::string &DefaultIndexerName() const;
 
   template <typename Factory> struct ComponentSet {
     std::unordered_map<std::string, Factory> factories;
@@ -50,10 +62,11 @@ private:
   template <typename Factory>
   static std::string JoinNames(const ComponentSet<Factory> &set);
 
-  template <typename Interface, typename Factory>
+  template <typename Interface, typename Factory, typename... Args>
   std::unique_ptr<Interface> CreateComponent(const std::string &name,
                                              const ComponentSet<Factory> &set,
-                                             const std::string &kind) const;
+                                             const std::string &kind,
+                                             Args... args) const;
 
   template <typename Factory>
   void RegisterComponent(const std::string &name, Factory factory,
@@ -62,6 +75,7 @@ private:
   ComponentSet<ExtractorFactory> extractors_;
   ComponentSet<AnalyzerFactory> analyzers_;
   ComponentSet<ReporterFactory> reporters_;
+  ComponentSet<IndexerFactory> indexers_;
 };
 
 ComponentRegistry MakeComponentRegistryWithDefaults();
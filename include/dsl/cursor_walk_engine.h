@@ -0,0 +1,82 @@
+#pragma once
+
+#include <dsl/argument_set_pool.h>
+#include <dsl/compile_commands_ast_indexer.h>
+#include <dsl/fact_store.h>
+#include <dsl/file_hashes.h>
+
+#include <atomic>
+#include <clang-c/Index.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dsl {
+
+// What the translation units of one run have already emitted: headers whose
+// declarations a unit traversed in full, by path and content hash, and the
+// header definitions it emitted, by USR. Each is tagged with the earliest
+// unit that covered it, and a unit skips only what an earlier unit covered.
+// Coverage is kept per argument set, since other defines, include paths or
+// language standards can preprocess a header into other declarations, and
+// only for headers included where every unit sees them alike (see
+// CollectFacts).
+// Facts are delivered in compile-command order, so the skipped facts were
+// already on their way and the index is the same as without skipping.
+class HarvestedDeclarations {
+public:
+  // Header contents are hashed through the run's `hashes`.
+  explicit HarvestedDeclarations(FileHashes &hashes) : hashes_(&hashes) {}
+
+  // True when a unit before `position` with the same `arguments` traversed
+  // `path` and it still hashes to the contents recorded then.
+  bool HeaderHarvestedBefore(ArgumentSetId arguments, const std::string &path,
+                             std::size_t position);
+
+  bool DefinitionEmittedBefore(ArgumentSetId arguments, std::uint64_t key,
+                               std::size_t position);
+
+  void Record(ArgumentSetId arguments, std::size_t position,
+              const std::vector<std::string> &headers,
+              const std::vector<std::uint64_t> &definitions,
+              std::size_t skipped);
+
+  // Distinct headers harvested, counting a header once per argument set.
+  std::size_t headers();
+  std::size_t skipped() const { return skipped_.load(); }
+
+private:
+  struct Header {
+    std::optional<std::uint64_t> content_hash;
+    std::size_t position = 0;
+  };
+
+  struct Scope {
+    std::unordered_map<std::string, Header> headers;
+    std::unordered_map<std::uint64_t, std::size_t> definitions;
+  };
+
+  FileHashes *hashes_;
+  std::shared_mutex mutex_;
+  std::unordered_map<ArgumentSetId, Scope> scopes_;
+  std::atomic<std::size_t> skipped_{0};
+};
+
+// Walks the cursors of `translation_unit` and returns its facts.
+// `project_root` must already be canonical. With `harvested`, declarations
+// an earlier unit of the run parsed with the same `arguments` covered are
+// skipped and this unit's coverage is recorded at `position`. Both are
+// limited to the headers the main file includes at file scope before its
+// first #define or #undef, which preprocess alike in every such unit.
+FactStore CollectFacts(CXTranslationUnit translation_unit,
+                       const std::filesystem::path &project_root,
+                       const IndexerOptions &options,
+                       HarvestedDeclarations *harvested = nullptr,
+                       std::size_t position = 0, ArgumentSetId arguments = 0);
+
+} // namespace dsl
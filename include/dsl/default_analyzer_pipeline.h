@@ -3,9 +3,16 @@
 #include <dsl/analyzer_pipeline_builder.h>
 
 #include <memory>
+#include <vector>
 
 namespace dsl {
 
+// Marks each of `findings` new or unchanged by whether `baseline` has a
+// finding with the same term and conflict, and appends the baseline findings
+// that are gone, marked resolved.
+void MarkFindingChanges(const std::vector<Finding> &baseline,
+                        std::vector<Finding> &findings);
+
 class DefaultAnalyzerPipeline : public AnalyzerPipeline {
 public:
   explicit DefaultAnalyzerPipeline(PipelineComponents components);
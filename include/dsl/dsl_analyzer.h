@@ -1,6 +1,7 @@
 #pragma once
 
 #include <dsl/ast_cache.h>
+#include <dsl/fact_shard.h>
 
 #include <filesystem>
 #include <optional>
@@ -19,12 +20,28 @@ struct AnalyzeOptions {
   std::optional<std::string> extractor;
   std::optional<std::string> analyzer;
   std::optional<std::string> reporter;
+  std::optional<std::string> indexer;
   std::vector<std::string> formats;
   std::vector<std::string> ignored_namespaces;
   std::vector<std::string> ignored_source_directories;
   std::optional<dsl::LogLevel> log_level;
   std::optional<bool> enable_ast_cache;
   std::optional<bool> clean_cache;
+  std::optional<unsigned> jobs;
+  std::optional<bool> traverse_external;
+  std::optional<dsl::IndexDepth> index_depth;
+  std::optional<bool> precompiled_headers;
+  std::optional<bool> retry_failed;
+  // Command line only: keeps running and re-analyzes after each edit.
+  bool watch = false;
+  // Command line only: re-indexes just the units affected by the files
+  // changed since a git revision, or listed in a file, and marks findings
+  // against the last full cached analysis.
+  std::optional<std::string> since;
+  std::optional<std::filesystem::path> changed_files;
+  // Command line only: indexes one shard of the compile commands and writes
+  // its facts for `dsl-extract merge` instead of reports.
+  std::optional<dsl::IndexShard> shard;
   bool show_help = false;
 };
 
@@ -35,6 +52,28 @@ struct ReportOptions {
   bool show_help = false;
 };
 
+// `dsl-extract serve`: the analyze options the server runs every request
+// with, and where it listens.
+struct ServeOptions {
+  AnalyzeOptions analyze;
+  std::optional<std::filesystem::path> socket;
+};
+
+struct ClientOptions {
+  std::optional<std::filesystem::path> root;
+  std::optional<std::filesystem::path> cache_directory;
+  std::optional<std::filesystem::path> socket;
+  std::string request = "analyze";
+  bool show_help = false;
+};
+
+// `dsl-extract merge`: the fact shards to merge and the analyze options
+// for the stages after indexing.
+struct FactMergeOptions {
+  AnalyzeOptions analyze;
+  std::vector<std::filesystem::path> shards;
+};
+
 struct CacheCleanOptions {
   std::optional<std::filesystem::path> root;
   std::optional<std::filesystem::path> cache_directory;
@@ -53,6 +92,19 @@ AnalyzeOptions ResolveAnalyzeOptions(const AnalyzeOptions &cli_options);
 ReportOptions ParseReportArguments(const std::vector<std::string> &arguments);
 int RunReport(const std::vector<std::string> &arguments);
 
+ServeOptions ParseServeArguments(const std::vector<std::string> &arguments);
+ClientOptions ParseClientArguments(const std::vector<std::string> &arguments);
+// serve.sock in the cache directory, where serve listens and client connects
+// unless --socket names another path.
+std::filesystem::path
+DefaultServerSocket(const std::filesystem::path &cache_directory);
+int RunServe(const std::vector<std::string> &arguments);
+int RunClient(const std::vector<std::string> &arguments);
+
+FactMergeOptions
+ParseMergeArguments(const std::vector<std::string> &arguments);
+int RunMerge(const std::vector<std::string> &arguments);
+
 CacheCleanOptions
 ParseCacheCleanArguments(const std::vector<std::string> &arguments);
 std::filesystem::path ResolveCacheDirectory(const CacheCleanOptions &options,
@@ -8,5 +8,7 @@ namespace dsl {
 std::string Escape(const std::string &value);
 std::string Unescape(const std::string &value);
 std::vector<std::string> SplitEscaped(const std::string &line);
+// Escapes quotes, backslashes and control characters for a JSON string.
+std::string EscapeJsonString(const std::string &value);
 
 } // namespace dsl
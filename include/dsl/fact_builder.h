@@ -0,0 +1,104 @@
+#pragma once
+
+#include <dsl/fact_store.h>
+
+#include <clang-c/Index.h>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace dsl {
+
+// Takes ownership of `value`.
+std::string ToString(CXString value);
+
+// Both paths must already be canonical; only their components are compared,
+// so no filesystem access happens here.
+bool IsWithinCanonical(const std::filesystem::path &candidate,
+                       const std::filesystem::path &parent);
+
+// Functions, records and enums: the definitions facts inside them are about.
+bool IsEntityKind(CXCursorKind kind);
+
+// Qualified names of the cursors of one translation unit. A name is built
+// from its semantic parent's, so each parent is named once and a helper
+// called from thousands of sites costs a lookup per call instead of a walk
+// up its scopes.
+class CursorNames {
+public:
+  // The non-empty spellings from the outermost scope down to `cursor`.
+  const std::string &QualifiedName(CXCursor cursor);
+
+  // The qualified name of the scope enclosing `cursor`.
+  std::string ScopePath(CXCursor cursor);
+
+private:
+  struct CursorHash {
+    std::size_t operator()(const CXCursor &cursor) const {
+      return clang_hashCursor(cursor);
+    }
+  };
+
+  struct CursorEqual {
+    bool operator()(const CXCursor &left, const CXCursor &right) const {
+      return clang_equalCursors(left, right) != 0;
+    }
+  };
+
+  std::unordered_map<CXCursor, std::string, CursorHash, CursorEqual> names_;
+};
+
+// Turns cursors into facts. The cursor walker and the indexing-API callbacks
+// differ in how they find cursors and the names around them, not in the
+// facts they build from them.
+class FactBuilder {
+public:
+  // `project_root` must already be canonical.
+  explicit FactBuilder(std::filesystem::path project_root)
+      : project_root_(std::move(project_root)) {}
+
+  FactStore TakeFacts() { return std::move(facts_); }
+
+protected:
+  // A function or type definition that the facts inside it are about.
+  struct Entity {
+    std::string name;
+    std::string usr;
+  };
+
+  struct FileIdentity {
+    bool has_path = false;
+    bool in_project = false;
+  };
+
+  // Canonicalizing a path costs several syscalls, so each file is resolved
+  // once per translation unit instead of once per cursor.
+  const FileIdentity &IdentifyFile(CXSourceLocation location);
+
+  CursorNames &names() { return names_; }
+
+  // `cursor` must be a definition.
+  void AddSymbolFact(CXCursor cursor, const std::string &kind,
+                     std::string name, std::string scope_path);
+  void AddOwnershipFact(CXCursor cursor, const Entity &owner,
+                        std::string scope_path);
+  void AddCallFact(CXCursor cursor, CXCursor referenced, const Entity &caller,
+                   const std::string &target_name, std::string scope_path);
+  void AddTypeUsageFact(CXCursor cursor, const Entity &subject,
+                        std::string scope_path);
+
+private:
+  void AddFact(const AstFact &fact) { facts_.push_back(fact); }
+
+  // Fills in the target's USR, scope and location from its declaration.
+  void ResolveTarget(CXCursor declaration, AstFact &fact);
+  void ResolveTarget(CXType type, AstFact &fact);
+
+  std::filesystem::path project_root_;
+  std::unordered_map<CXFile, FileIdentity> files_;
+  CursorNames names_;
+  FactStore facts_;
+};
+
+} // namespace dsl
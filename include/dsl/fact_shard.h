@@ -0,0 +1,69 @@
+#pragma once
+
+#include <dsl/interfaces.h>
+#include <dsl/logging.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dsl {
+
+// Shard `index` of `count`, numbered from 1. A compile command belongs to
+// the shard its file's path relative to the project root hashes to, so
+// every machine computes the same partition of the same checkout.
+struct IndexShard {
+  unsigned index = 1;
+  unsigned count = 1;
+};
+
+bool InShard(const std::string &relative_file, const IndexShard &shard);
+// dsl_facts_<index>_of_<count>.shard
+std::string FactShardFileName(const IndexShard &shard);
+
+// Records the batches of a sharded indexer, one per compile command in
+// compile-command order, and writes those with facts to a shard file.
+class FactShardWriter : public FactSink {
+public:
+  explicit FactShardWriter(IndexShard shard) : shard_(shard) {}
+
+  void Consume(const FactStore &facts) override;
+
+  // Writes the recorded units and the indexer's notes to `path`; throws
+  // std::runtime_error when the file cannot be written.
+  void Write(const std::filesystem::path &path,
+             const std::vector<std::string> &notes) const;
+
+  std::uint64_t units() const { return units_; }
+
+private:
+  IndexShard shard_;
+  std::uint64_t positions_ = 0;
+  std::uint64_t units_ = 0;
+  std::string records_;
+};
+
+// The indexer of `dsl-extract merge`. Reads one shard file per partition
+// and replays their units in compile-command order through the same
+// deduplication as a single run, so extraction, coherence analysis and
+// reports match that run byte for byte. Throws std::runtime_error when a
+// shard is unreadable or the set is incomplete or inconsistent.
+class FactShardMerger : public AstIndexer {
+public:
+  explicit FactShardMerger(std::vector<std::filesystem::path> shards,
+                           std::shared_ptr<Logger> logger = nullptr);
+
+  AstIndex BuildIndex(const SourceAcquisitionResult &sources) override;
+  void StreamIndex(const SourceAcquisitionResult &sources,
+                   FactSink &sink) override;
+  std::vector<std::string> IndexingNotes() const override;
+
+private:
+  std::vector<std::filesystem::path> shards_;
+  std::shared_ptr<Logger> logger_;
+  std::vector<std::string> notes_;
+};
+
+} // namespace dsl
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dsl {
+
+struct AstFact {
+  std::string name;
+  std::string kind;
+  std::string source_location;
+  std::string signature;
+  std::string descriptor;
+  std::string target;
+  std::string range;
+  std::string doc_comment;
+  std::string scope_path;
+  bool subject_in_project = false;
+  enum class TargetScope {
+    kUnknown,
+    kInProject,
+    kExternal,
+  } target_scope = TargetScope::kUnknown;
+  std::string target_location;
+  // Clang USRs of the subject and the target, when the indexer knows them.
+  std::string usr;
+  std::string target_usr;
+};
+
+enum class FactKind : std::uint8_t {
+  kOther,
+  kFunction,
+  kType,
+  kVariable,
+  kOwns,
+  kCall,
+  kTypeUsage,
+};
+
+FactKind ClassifyFactKind(std::string_view kind);
+
+using StringId = std::uint32_t;
+
+// Identifies a symbol across translation units by the hash of its USR, so
+// overloads and same-named entities stay apart while every unit's view of one
+// entity merges. Id 0 means the USR is unknown.
+using SymbolId = std::uint64_t;
+
+SymbolId SymbolIdForUsr(std::string_view usr);
+
+// Deduplicating string storage. Id 0 is always the empty string and ids stay
+// valid for the lifetime of the pool.
+class StringPool {
+public:
+  StringPool();
+  StringPool(const StringPool &other);
+  StringPool &operator=(const StringPool &other);
+  StringPool(StringPool &&other);
+  StringPool &operator=(StringPool &&other);
+
+  StringId Intern(std::string_view value);
+  std::string_view Get(StringId id) const { return values_[id]; }
+  std::size_t size() const { return values_.size(); }
+
+private:
+  std::string_view Store(std::string_view value);
+  void Reset();
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::size_t block_capacity_ = 0;
+  std::size_t block_used_ = 0;
+  std::vector<std::string_view> values_;
+  std::unordered_map<std::string_view, StringId> ids_;
+};
+
+// A `file:line:column-line:column` range with the file interned. Text in any
+// other shape is kept verbatim in `file` with `structured` unset.
+struct SourceSpan {
+  StringId file = 0;
+  std::uint32_t begin_line = 0;
+  std::uint32_t begin_column = 0;
+  std::uint32_t end_line = 0;
+  std::uint32_t end_column = 0;
+  bool structured = false;
+};
+
+struct CompactFact {
+  StringId name = 0;
+  StringId kind_text = 0;
+  StringId signature = 0;
+  StringId descriptor = 0;
+  StringId target = 0;
+  StringId doc_comment = 0;
+  StringId scope_path = 0;
+  SourceSpan location;
+  SourceSpan range;
+  SourceSpan target_location;
+  SymbolId symbol = 0;
+  SymbolId target_symbol = 0;
+  FactKind kind = FactKind::kOther;
+  bool subject_in_project = false;
+  AstFact::TargetScope target_scope = AstFact::TargetScope::kUnknown;
+};
+
+class FactStore;
+
+// Read-only handle to one fact in a FactStore. Strings are views into the
+// store; locations are formatted on request.
+class FactView {
+public:
+  FactView(const FactStore &store, const CompactFact &fact)
+      : store_(&store), fact_(&fact) {}
+
+  std::string_view name() const;
+  std::string_view kind() const;
+  FactKind kind_id() const { return fact_->kind; }
+  std::string_view signature() const;
+  std::string_view descriptor() const;
+  std::string_view target() const;
+  std::string_view doc_comment() const;
+  std::string_view scope_path() const;
+  std::string source_location() const;
+  std::string range() const;
+  std::string target_location() const;
+  SymbolId symbol() const { return fact_->symbol; }
+  SymbolId target_symbol() const { return fact_->target_symbol; }
+  std::string_view usr() const;
+  std::string_view target_usr() const;
+  bool subject_in_project() const { return fact_->subject_in_project; }
+  AstFact::TargetScope target_scope() const { return fact_->target_scope; }
+  const CompactFact &compact() const { return *fact_; }
+
+  AstFact Materialize() const;
+  // Lets code and matchers written against AstFact read stored facts.
+  operator AstFact() const { return Materialize(); }
+
+private:
+  const FactStore *store_;
+  const CompactFact *fact_;
+};
+
+// Compact, interned storage for AST facts. Facts are added as AstFact values
+// and read back through FactView, which avoids a string per field.
+class FactStore {
+public:
+  using value_type = AstFact;
+  using size_type = std::size_t;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = FactView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = FactView;
+
+    const_iterator(const FactStore *store, std::size_t index)
+        : store_(store), index_(index) {}
+
+    FactView operator*() const { return (*store_)[index_]; }
+    const_iterator &operator++() {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      auto previous = *this;
+      ++index_;
+      return previous;
+    }
+    difference_type operator-(const const_iterator &other) const {
+      return static_cast<difference_type>(index_) -
+             static_cast<difference_type>(other.index_);
+    }
+    bool operator==(const const_iterator &other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return index_ != other.index_;
+    }
+
+  private:
+    const FactStore *store_;
+    std::size_t index_;
+  };
+  using iterator = const_iterator;
+
+  FactStore() = default;
+  FactStore(std::initializer_list<AstFact> facts);
+
+  void push_back(const AstFact &fact) { Add(Compact(fact)); }
+  void Add(const CompactFact &fact) { facts_.push_back(fact); }
+  void reserve(std::size_t count) { facts_.reserve(count); }
+  // Copies every fact of `other` into this store.
+  void Append(const FactStore &other);
+
+  // Interns the fields of `fact` without storing it.
+  CompactFact Compact(const AstFact &fact);
+  // Re-interns a fact owned by `source` into this store without storing it.
+  CompactFact Import(const FactStore &source, const CompactFact &fact);
+  StringId Intern(std::string_view value) { return strings_.Intern(value); }
+  SourceSpan InternLocation(std::string_view location);
+  // Records `usr` in the store's symbol table and returns its id.
+  SymbolId InternSymbol(std::string_view usr);
+
+  std::string_view Text(StringId id) const { return strings_.Get(id); }
+  std::string_view Usr(SymbolId id) const;
+  std::string Location(const SourceSpan &span) const;
+
+  const std::vector<CompactFact> &compact_facts() const { return facts_; }
+  FactView operator[](std::size_t index) const {
+    return {*this, facts_[index]};
+  }
+  std::size_t size() const { return facts_.size(); }
+  bool empty() const { return facts_.empty(); }
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, facts_.size()}; }
+
+private:
+  SourceSpan ImportLocation(const FactStore &source, const SourceSpan &span);
+
+  StringPool strings_;
+  std::unordered_map<SymbolId, StringId> symbols_;
+  std::vector<CompactFact> facts_;
+};
+
+} // namespace dsl
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <dsl/ast_cache.h>
+#include <dsl/changed_files.h>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dsl {
+
+// Content hashes of the files one run reads, memoized so headers shared by
+// many translation units are read once.
+class FileHashes {
+public:
+  // When given, the files `changes` lists as unchanged hold their contents
+  // at its revision, so dependencies recorded at that revision need not be
+  // read again.
+  explicit FileHashes(std::optional<ChangeSet> changes = std::nullopt);
+
+  std::optional<std::uint64_t> Hash(const std::string &path);
+
+  // Whether every dependency still hashes to its recorded contents. Those
+  // recorded at `revision` are trusted without being read when it is the
+  // change set's revision and none of them changed since.
+  bool IsCurrent(const std::vector<FileDependency> &dependencies,
+                 const std::string &revision = {});
+
+  // The change set's revision when none of `dependencies` changed since it,
+  // so their current contents are the ones at that revision; empty
+  // otherwise.
+  std::string RevisionOf(const std::vector<FileDependency> &dependencies);
+
+  // Records the current hash of each of `paths`; false when one is
+  // unreadable or there are none.
+  bool Record(const std::vector<std::string> &paths,
+              std::vector<FileDependency> &dependencies);
+
+private:
+  bool AllUnchanged(const std::vector<FileDependency> &dependencies);
+
+  // Recorded paths are lexically normal; the change set is canonical.
+  std::string Canonical(const std::string &path);
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::optional<std::uint64_t>> hashes_;
+  std::string revision_;
+  std::unordered_set<std::string> unchanged_;
+  std::unordered_map<std::string, std::string> canonical_;
+};
+
+} // namespace dsl
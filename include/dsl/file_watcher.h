@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace dsl {
+
+// Reports files created, written, moved or deleted in watched directories.
+// Uses inotify, so it is available on Linux only; elsewhere the constructor
+// throws std::runtime_error.
+class FileWatcher {
+public:
+  // Directories below a watched tree that are skipped, with everything in
+  // them, such as the build and cache directories.
+  explicit FileWatcher(std::vector<std::filesystem::path> excluded = {});
+  ~FileWatcher();
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  // Watches the files directly in `directory`.
+  void Watch(const std::filesystem::path &directory);
+  // Watches `root` and every directory below it that is not excluded or
+  // hidden, including directories created later.
+  void WatchTree(const std::filesystem::path &root);
+
+  // Blocks until a watched file changes, then until `quiet` passes without
+  // another change, so a burst of saves is reported once. Returns the
+  // changed paths sorted and without duplicates.
+  std::vector<std::filesystem::path>
+  WaitForChanges(std::chrono::milliseconds quiet);
+  // True when the kernel dropped events during the last wait, so any watched
+  // file may have changed without being reported.
+  bool lost_events() const { return lost_events_; }
+
+private:
+  struct WatchedDirectory {
+    std::filesystem::path path;
+    bool tree = false;
+  };
+
+  void Add(const std::filesystem::path &directory, bool tree);
+  void AddTree(const std::filesystem::path &canonical_root);
+  // Watches a directory that appeared below a watched tree, ignoring one
+  // that disappears again meanwhile.
+  void WatchNewTree(const std::filesystem::path &directory);
+  bool IsExcluded(const std::filesystem::path &directory) const;
+  // Appends the files named by the pending events to `changed`.
+  void Drain(std::vector<std::filesystem::path> &changed);
+
+  std::vector<std::filesystem::path> excluded_;
+  std::vector<std::filesystem::path> trees_;
+  int descriptor_ = -1;
+  bool lost_events_ = false;
+  std::unordered_map<int, WatchedDirectory> watches_;
+};
+
+} // namespace dsl
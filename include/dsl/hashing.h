@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dsl {
+
+inline constexpr std::uint64_t kFnv1a64Offset = 14695981039346656037ULL;
+
+// Stable 64-bit FNV-1a hash; unlike std::hash its values may be persisted.
+std::uint64_t Fnv1a64(std::string_view data,
+                      std::uint64_t seed = kFnv1a64Offset);
+std::string HashToHex(std::uint64_t hash);
+std::optional<std::uint64_t>
+HashFileContents(const std::filesystem::path &path);
+
+} // namespace dsl
@@ -2,12 +2,16 @@
 
 #include <dsl/interfaces.h>
 
+#include <memory>
+
 namespace dsl {
 
 class HeuristicDslExtractor : public DslExtractor {
 public:
   DslExtractionResult Extract(const AstIndex &index,
                               const AnalysisConfig &config) override;
+  std::unique_ptr<ExtractionSession>
+  StartExtraction(const AnalysisConfig &config) override;
 };
 
 } // namespace dsl
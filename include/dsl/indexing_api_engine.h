@@ -0,0 +1,24 @@
+#pragma once
+
+#include <dsl/compile_commands_ast_indexer.h>
+#include <dsl/fact_store.h>
+
+#include <clang-c/Index.h>
+#include <filesystem>
+#include <string>
+
+namespace dsl {
+
+// Parses `file` with clang_indexSourceFile under `action` and harvests the
+// facts the indexer callbacks report into `facts`. `index_options` and
+// `parse_options` are passed through. The translation unit is left for the
+// caller to dispose. `project_root` must already be canonical.
+CXErrorCode IndexSourceFile(CXIndexAction action, unsigned index_options,
+                            const std::string &file, const char *const *args,
+                            int arg_count, unsigned parse_options,
+                            const std::filesystem::path &project_root,
+                            const IndexerOptions &options,
+                            CXTranslationUnit &translation_unit,
+                            FactStore &facts);
+
+} // namespace dsl
@@ -2,18 +2,88 @@
 
 #include <dsl/models.h>
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 namespace dsl {
 
+class AstCache;
+
 class SourceAcquirer {
 public:
   virtual ~SourceAcquirer() = default;
   virtual SourceAcquisitionResult Acquire(const AnalysisConfig &config) = 0;
 };
 
+// Receives facts in batches, typically one per translation unit, in
+// compile-command order. Batches are delivered from one thread at a time.
+class FactSink {
+public:
+  virtual ~FactSink() = default;
+  virtual void Consume(const FactStore &facts) = 0;
+};
+
+// Collects streamed batches into a single store.
+class CollectingFactSink : public FactSink {
+public:
+  explicit CollectingFactSink(FactStore &facts) : facts_(&facts) {}
+
+  void Consume(const FactStore &facts) override { facts_->Append(facts); }
+
+private:
+  FactStore *facts_;
+};
+
+// Forwards each batch without the facts an earlier batch already produced,
+// such as declarations from shared headers. Facts are told apart by name,
+// kind, target and location.
+class DeduplicatingFactSink : public FactSink {
+public:
+  explicit DeduplicatingFactSink(FactSink &sink) : sink_(&sink) {}
+
+  void Consume(const FactStore &facts) override;
+
+private:
+  // A 64-bit hash of the fields facts are told apart by. Only the hash of
+  // each fact seen is kept; distinct facts sharing one are vanishingly rare.
+  static std::uint64_t KeyOf(const FactStore &facts, const CompactFact &fact);
+
+  FactSink *sink_;
+  std::unordered_set<std::uint64_t> seen_;
+};
+
 class AstIndexer {
 public:
   virtual ~AstIndexer() = default;
   virtual AstIndex BuildIndex(const SourceAcquisitionResult &sources) = 0;
+
+  // Delivers the facts BuildIndex would return to `sink` as they become
+  // available. The default hands over the finished index as one batch.
+  virtual void StreamIndex(const SourceAcquisitionResult &sources,
+                           FactSink &sink) {
+    sink.Consume(BuildIndex(sources).facts);
+  }
+
+  // Indexers that can reuse cached facts per translation unit keep `cache`
+  // and return true; the caller then skips whole-index caching.
+  virtual bool UseTranslationUnitCache(std::shared_ptr<const AstCache> cache) {
+    (void)cache;
+    return false;
+  }
+
+  // Notes about the last run for the report's extraction notes, such as
+  // translation units that produced no facts.
+  virtual std::vector<std::string> IndexingNotes() const { return {}; }
+};
+
+// One incremental extraction: facts are consumed batch by batch while the
+// indexer is still running, and Finish produces the result.
+class ExtractionSession : public FactSink {
+public:
+  virtual DslExtractionResult Finish() = 0;
 };
 
 class DslExtractor {
@@ -21,6 +91,10 @@ public:
   virtual ~DslExtractor() = default;
   virtual DslExtractionResult Extract(const AstIndex &index,
                                       const AnalysisConfig &config) = 0;
+
+  // The default session buffers every batch and runs Extract on Finish.
+  virtual std::unique_ptr<ExtractionSession>
+  StartExtraction(const AnalysisConfig &config);
 };
 
 class CoherenceAnalyzer {
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dsl {
+
+// The `#include` directives a source file opens with, spelled as written
+// (`<vector>` or `"pch.h"`). Scanning stops at the first line that is neither
+// an include, a comment nor blank, so a precompiled header of exactly these
+// includes parses the same as the start of the file.
+std::vector<std::string> LeadingIncludes(std::string_view source);
+
+// Longest run of includes that every list in `lists` starts with.
+std::vector<std::string>
+CommonIncludePrefix(const std::vector<std::vector<std::string>> &lists);
+
+// Offset of the first `#define` or `#undef` directive in `source`, or
+// std::string_view::npos when there is none. Directives inside comments or
+// skipped conditional blocks are found too, which errs towards an earlier
+// offset.
+std::size_t FirstMacroDirective(std::string_view source);
+
+} // namespace dsl
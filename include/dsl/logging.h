@@ -2,6 +2,7 @@
 
 #include <iosfwd>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -44,6 +45,8 @@ public:
 private:
   std::ostream *stream_;
   LoggingConfig config_;
+  // Indexer workers log concurrently; keep each record on its own line.
+  std::mutex mutex_;
 };
 
 std::shared_ptr<Logger> EnsureLogger(std::shared_ptr<Logger> logger);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dsl {
+
+// Read-only view of a whole file. POSIX builds map it with mmap; other
+// platforms read it into an owned buffer.
+class MappedFile {
+public:
+  static std::optional<MappedFile> Open(const std::filesystem::path &path);
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  ~MappedFile();
+
+  std::string_view contents() const { return {data_, size_}; }
+
+private:
+  MappedFile() = default;
+  void Release();
+
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+  bool mapped_ = false;
+  std::string buffer_;
+};
+
+} // namespace dsl
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <dsl/fact_store.h>
 #include <dsl/logging.h>
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -9,6 +11,12 @@
 
 namespace dsl {
 
+// How much of each translation unit is analyzed. `kDeclarations` skips
+// function bodies and emits no `call` or `type_usage` facts.
+enum class IndexDepth { kFull, kDeclarations };
+
+struct Finding;
+
 struct AnalysisConfig {
   std::string root_path;
   std::vector<std::string> formats;
@@ -23,6 +31,10 @@ struct AnalysisConfig {
   } cache;
   std::shared_ptr<Logger> logger;
   std::string config_file;
+  IndexDepth index_depth = IndexDepth::kFull;
+  // Findings of the run the current one is compared with; when set, every
+  // finding is marked new, unchanged or resolved relative to them.
+  std::shared_ptr<const std::vector<Finding>> baseline_findings;
 };
 
 struct SourceAcquisitionResult {
@@ -31,27 +43,8 @@ struct SourceAcquisitionResult {
   std::string build_directory;
 };
 
-struct AstFact {
-  std::string name;
-  std::string kind;
-  std::string source_location;
-  std::string signature;
-  std::string descriptor;
-  std::string target;
-  std::string range;
-  std::string doc_comment;
-  std::string scope_path;
-  bool subject_in_project = false;
-  enum class TargetScope {
-    kUnknown,
-    kInProject,
-    kExternal,
-  } target_scope = TargetScope::kUnknown;
-  std::string target_location;
-};
-
 struct AstIndex {
-  std::vector<AstFact> facts;
+  FactStore facts;
 };
 
 struct DslTerm {
@@ -61,6 +54,9 @@ struct DslTerm {
   std::vector<std::string> evidence;
   std::vector<std::string> aliases;
   int usage_count = 0;
+  // The symbol the term was extracted for, or 0 when unknown. Terms of one
+  // name and kind with distinct symbols are overloads, not duplicates.
+  std::uint64_t symbol = 0;
 };
 
 struct DslRelationship {
@@ -77,7 +73,10 @@ struct DslExtractionResult {
   std::vector<DslTerm> external_dependencies;
   std::vector<DslRelationship> relationships;
   std::vector<std::string> extraction_notes;
-  std::vector<AstFact> facts;
+  // The facts intent analysis reads: function declarations, mutations and
+  // calls, without doc comments, scopes or symbols. Shared and immutable, so
+  // copying a result never copies them.
+  std::shared_ptr<const FactStore> facts;
   struct Workflow {
     std::string name;
     std::vector<std::string> steps;
@@ -85,12 +84,16 @@ struct DslExtractionResult {
   std::vector<Workflow> workflows;
 };
 
+// How a finding compares with the baseline findings, if there are any.
+enum class FindingChange { kUnmarked, kNew, kUnchanged, kResolved };
+
 struct Finding {
   std::string term;
   std::string conflict;
   std::vector<std::string> examples;
   std::string suggested_canonical_form;
   std::string description;
+  FindingChange change = FindingChange::kUnmarked;
 };
 
 enum class CoherenceSeverity {
@@ -108,7 +111,14 @@ struct Report {
   std::string json;
 };
 
+// Move-only so large results are handed over rather than duplicated.
 struct PipelineResult {
+  PipelineResult() = default;
+  PipelineResult(const PipelineResult &) = delete;
+  PipelineResult &operator=(const PipelineResult &) = delete;
+  PipelineResult(PipelineResult &&) = default;
+  PipelineResult &operator=(PipelineResult &&) = default;
+
   Report report;
   CoherenceResult coherence;
   DslExtractionResult extraction;
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace dsl {
+
+// Lowercases `name` and replaces every ':' with '.', so names that differ
+// only in case compare equal (`Sample::Widget` becomes `sample..widget`).
+std::string CanonicalizeName(std::string_view name);
+
+// Whether facts of `kind` record a state change, which intent analysis
+// checks getters and predicates for.
+bool IsMutationKind(std::string_view kind);
+
+} // namespace dsl
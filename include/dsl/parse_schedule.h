@@ -0,0 +1,74 @@
+#pragma once
+
+#include <dsl/interfaces.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace dsl {
+
+// Estimated cost of each job in microseconds: its recorded duration when
+// there is one, else its size scaled by the average microseconds per byte of
+// the recorded jobs (one per byte when nothing is recorded).
+std::vector<std::uint64_t>
+EstimateParseCosts(const std::vector<std::optional<std::uint64_t>> &recorded,
+                   const std::vector<std::uint64_t> &sizes);
+
+// Job indices with the costliest first; equal costs keep their index order.
+// Started first, the few long jobs overlap the many short ones instead of
+// running alone at the end.
+std::vector<std::size_t>
+LongestFirstOrder(const std::vector<std::uint64_t> &costs);
+
+// When the last of `workers` workers finishes if each takes the next job of
+// `order` as soon as it is free.
+std::uint64_t PredictMakespan(const std::vector<std::uint64_t> &costs,
+                              const std::vector<std::size_t> &order,
+                              unsigned workers);
+
+// Hands the jobs of `order` to workers and streams their facts to a sink in
+// job index order, one batch per job; jobs left out of `order` are delivered
+// as empty batches. A job finished ahead of an earlier one waits in memory
+// until that one is delivered. At most `window` non-empty batches wait: then
+// a worker takes the earliest job not yet started instead of the next one of
+// `order`, or blocks until the earliest job in progress is delivered. This
+// bounds the waiting facts at the cost of idle workers while a long job
+// holds up delivery. The sink is called without holding the lock that
+// workers take and complete jobs under, one batch at a time.
+class OrderedDelivery {
+public:
+  OrderedDelivery(std::vector<std::size_t> order, std::size_t count,
+                  std::size_t window, FactSink &sink);
+
+  // The next job to run, or nullopt when none is left or Stop was called.
+  std::optional<std::size_t> Take();
+  void Complete(std::size_t job, FactStore facts);
+  // Wakes blocked workers and hands out no more jobs.
+  void Stop();
+
+  // The most non-empty batches that waited at once.
+  std::size_t peak_waiting() const;
+
+private:
+  std::size_t Start(std::size_t job);
+
+  mutable std::mutex mutex_;
+  std::condition_variable delivered_;
+  std::vector<std::size_t> order_;
+  std::vector<bool> started_;
+  std::vector<std::optional<FactStore>> pending_;
+  std::size_t window_;
+  FactSink *sink_;
+  std::size_t cursor_ = 0;
+  std::size_t next_ = 0;
+  std::size_t waiting_ = 0;
+  std::size_t peak_waiting_ = 0;
+  bool delivering_ = false;
+  bool stopped_ = false;
+};
+
+} // namespace dsl
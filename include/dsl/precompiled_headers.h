@@ -0,0 +1,91 @@
+#pragma once
+
+#include <dsl/translation_unit_parsing.h>
+
+#include <atomic>
+#include <chrono>
+#include <clang-c/Index.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dsl {
+
+// Opening includes shared by translation units with the same arguments.
+struct PrecompiledHeader {
+  ArgumentSetId arguments = 0;
+  std::vector<std::string> includes;
+  // Synthetic unsaved file holding the includes. It sits next to the units'
+  // sources so quoted includes resolve as they do there.
+  std::string source;
+  std::string key;
+  std::size_t translation_units = 0;
+  std::once_flag build;
+  bool usable = false;
+  std::string path;
+  std::vector<std::string> dependencies;
+};
+
+// Groups translation units that open with the same includes under the same
+// normalized arguments and, the first time a unit of a group has to be
+// parsed, saves a precompiled header of those includes. The rest of the
+// group is parsed with -include-pch, so the shared headers are parsed once
+// per run instead of once per unit. Headers that fail to build are skipped
+// and their units parse as before.
+class PrecompiledHeaderSession {
+public:
+  // An empty `directory` selects a temporary one that is removed again when
+  // the session ends.
+  PrecompiledHeaderSession(std::filesystem::path directory,
+                           std::string settings);
+  PrecompiledHeaderSession(const PrecompiledHeaderSession &) = delete;
+  PrecompiledHeaderSession &
+  operator=(const PrecompiledHeaderSession &) = delete;
+  ~PrecompiledHeaderSession();
+
+  // Assigns entries to headers. Only groups of two or more units with a
+  // non-empty common prefix get one. Must run before any unit is parsed.
+  void Plan(std::vector<CompileCommandEntry> &entries,
+            const ArgumentSetPool &argument_sets);
+
+  // Returns the header covering `entry`, building it on first use, or
+  // nullptr when the entry has none or it could not be built.
+  const PrecompiledHeader *Acquire(CXIndex index,
+                                   const CompileCommandEntry &entry,
+                                   const IndexingContext &context);
+
+  std::size_t planned() const { return headers_.size(); }
+  std::size_t built() const { return built_.load(); }
+  std::size_t failed() const { return failed_.load(); }
+  // Time spent building headers, successful or not. It is not part of the
+  // parse time recorded for the unit that triggered the build.
+  std::chrono::microseconds build_time() const {
+    return std::chrono::microseconds(build_us_.load());
+  }
+  const std::filesystem::path &directory() const { return directory_; }
+
+private:
+  std::string Key(const std::vector<std::string> &arguments,
+                  const std::filesystem::path &directory,
+                  const std::vector<std::string> &includes) const;
+  void Build(CXIndex index, PrecompiledHeader &header,
+             const IndexingContext &context);
+  // Writes the header under a unique name and renames it into place, so a
+  // concurrent run never reads a partial file. Returns the problem, if any.
+  std::string Save(CXTranslationUnit translation_unit,
+                   PrecompiledHeader &header);
+
+  std::filesystem::path directory_;
+  std::string settings_;
+  bool owns_directory_ = false;
+  std::vector<std::unique_ptr<PrecompiledHeader>> headers_;
+  std::atomic<std::size_t> built_{0};
+  std::atomic<std::size_t> failed_{0};
+  std::atomic<std::uint64_t> build_us_{0};
+};
+
+} // namespace dsl
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dsl {
+
+// Size and structure of a synthetic C++ project. Every translation unit owns
+// `headers_per_unit` headers, each declaring `classes_per_header` classes
+// with `methods_per_class` methods; every method body calls `call_fan_out`
+// methods of classes owned by other units.
+struct ProjectShape {
+  unsigned translation_units = 8;
+  unsigned headers_per_unit = 1;
+  unsigned classes_per_header = 2;
+  unsigned methods_per_class = 4;
+  unsigned call_fan_out = 2;
+  // Nesting of the namespaces that group headers, below the `gen` namespace.
+  unsigned namespace_depth = 2;
+  // Fraction of classes and methods that carry a `///` doc comment.
+  double doc_comment_density = 0.5;
+  // Drives the choice of call targets and documented declarations.
+  std::uint64_t seed = 1;
+};
+
+// Named shapes: "small", "50k-loc" (the arc42 performance scenario) and
+// "500k-loc". Throws std::invalid_argument for any other name.
+ProjectShape ProjectShapeForScenario(std::string_view scenario);
+
+struct GeneratedProject {
+  std::filesystem::path root;
+  std::filesystem::path compile_commands;
+  std::vector<std::filesystem::path> sources;
+  std::vector<std::filesystem::path> headers;
+  std::uint64_t lines = 0;
+  std::uint64_t bytes = 0;
+};
+
+// Writes a CMake project under `root` (created if missing) plus a
+// `build/compile_commands.json` compiling every source. The same shape always
+// produces byte-identical files.
+GeneratedProject GenerateProject(const std::filesystem::path &root,
+                                 const ProjectShape &shape);
+
+struct GenerateProjectOptions {
+  std::filesystem::path output_directory;
+  ProjectShape shape;
+  bool show_help = false;
+};
+
+GenerateProjectOptions
+ParseGenerateProjectArguments(const std::vector<std::string> &arguments);
+int RunGenerateProject(const std::vector<std::string> &arguments);
+
+} // namespace dsl
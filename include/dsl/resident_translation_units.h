@@ -0,0 +1,98 @@
+#pragma once
+
+#include <dsl/ast_cache.h>
+#include <dsl/fact_store.h>
+#include <dsl/file_hashes.h>
+#include <dsl/translation_unit_parsing.h>
+
+#include <atomic>
+#include <clang-c/Index.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dsl {
+
+// Translation units a resident indexer keeps parsed between runs, keyed like
+// AST cache entries. Each unit owns the index it was parsed in, so workers
+// can reparse different units at once and no index outlives its units.
+class ResidentTranslationUnits {
+public:
+  struct Unit {
+    // Held by the worker refreshing or replacing the unit.
+    std::mutex mutex;
+    CXIndex index = nullptr;
+    CXTranslationUnit translation_unit = nullptr;
+    std::vector<FileDependency> dependencies;
+    FactStore facts;
+
+    void Dispose();
+  };
+
+  ResidentTranslationUnits() = default;
+  ResidentTranslationUnits(const ResidentTranslationUnits &) = delete;
+  ResidentTranslationUnits &
+  operator=(const ResidentTranslationUnits &) = delete;
+  ~ResidentTranslationUnits();
+
+  // The unit stored under `key`, created empty on first use.
+  Unit &Slot(const std::string &key);
+
+  // Disposes the units whose key is not in `keys`; call between runs.
+  void Retain(const std::unordered_set<std::string> &keys);
+
+  // Units holding a parsed translation unit; call between runs.
+  std::size_t size() const;
+
+private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<Unit>> units_;
+};
+
+// Serves the units an earlier run of a resident indexer kept and keeps the
+// units this run parses. A kept unit is reused while the main file and every
+// header it read hash to the recorded contents and reparsed in place
+// otherwise. Units the run does not use are released when it finishes.
+class ResidentUnitSession {
+public:
+  ResidentUnitSession(ResidentTranslationUnits &units, FileHashes &hashes,
+                      std::string toolchain_version,
+                      std::string indexer_settings);
+
+  // The facts of the unit kept for `entry`, reparsed first when a file it
+  // read changed; nullopt when none is kept or the reparse failed.
+  std::optional<FactStore> Refresh(const CompileCommandEntry &entry,
+                                   const std::vector<std::string> &args,
+                                   const IndexingContext &context);
+
+  // Parses `entry` in an index of its own and keeps the unit when it parses.
+  ParsedTranslationUnit Parse(const CompileCommandEntry &entry,
+                              const std::vector<std::string> &args,
+                              const IndexingContext &context);
+
+  // Releases the units this run did not use.
+  void Finish() { units_->Retain(used_); }
+
+  std::size_t reused() const { return reused_.load(); }
+  std::size_t reparsed() const { return reparsed_.load(); }
+
+private:
+  ResidentTranslationUnits::Unit &Use(const CompileCommandEntry &entry,
+                                      const std::vector<std::string> &args);
+
+  ResidentTranslationUnits *units_;
+  FileHashes *hashes_;
+  std::string toolchain_version_;
+  std::string indexer_settings_;
+  std::mutex mutex_;
+  std::unordered_set<std::string> used_;
+  std::atomic<std::size_t> reused_{0};
+  std::atomic<std::size_t> reparsed_{0};
+};
+
+} // namespace dsl
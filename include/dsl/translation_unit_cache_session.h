@@ -0,0 +1,59 @@
+#pragma once
+
+#include <dsl/ast_cache.h>
+#include <dsl/file_hashes.h>
+#include <dsl/translation_unit_parsing.h>
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dsl {
+
+// Reuses the facts of a translation unit when its toolchain, file, directory
+// and normalized arguments select a stored entry and the main file and every
+// header it read still hash to the recorded contents. Each unit's entry is
+// stored as soon as it completes, so a run that is stopped and started again
+// parses only the units it had not finished.
+class TranslationUnitCacheSession {
+public:
+  TranslationUnitCacheSession(const AstCache &cache, FileHashes &hashes,
+                              std::string toolchain_version,
+                              std::string indexer_settings);
+
+  // Returns the stored facts or, for a unit that failed to parse with the
+  // same flags and main file, the recorded failure.
+  std::optional<TranslationUnitCacheEntry>
+  Lookup(const CompileCommandEntry &entry,
+         const std::vector<std::string> &args);
+
+  void Store(const CompileCommandEntry &entry,
+             const std::vector<std::string> &args,
+             const ParsedTranslationUnit &parsed);
+
+  // A failed parse yields no translation unit and so no list of headers;
+  // the record is keyed on the flags and validated against the main file.
+  void StoreFailure(const CompileCommandEntry &entry,
+                    const std::vector<std::string> &args,
+                    const ParseFailure &failure);
+
+  std::size_t hits() const { return hits_.load(); }
+  std::size_t misses() const { return misses_.load(); }
+  std::size_t known_failures() const { return known_failures_.load(); }
+
+private:
+  std::string Key(const CompileCommandEntry &entry,
+                  const std::vector<std::string> &args) const;
+
+  const AstCache *cache_;
+  FileHashes *hashes_;
+  std::string toolchain_version_;
+  std::string indexer_settings_;
+  std::atomic<std::size_t> hits_{0};
+  std::atomic<std::size_t> misses_{0};
+  std::atomic<std::size_t> known_failures_{0};
+};
+
+} // namespace dsl
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <dsl/argument_set_pool.h>
+#include <dsl/ast_cache.h>
+#include <dsl/compile_commands_ast_indexer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <clang-c/Index.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dsl {
+
+class HarvestedDeclarations;
+class PrecompiledHeaderSession;
+class ResidentUnitSession;
+class TranslationUnitCacheSession;
+
+constexpr std::size_t kNoPrecompiledHeader = static_cast<std::size_t>(-1);
+
+// Normalized arguments live in the run's ArgumentSetPool; entries compiled
+// with the same flags share one set.
+struct CompileCommandEntry {
+  std::filesystem::path file;
+  std::filesystem::path directory;
+  ArgumentSetId arguments = 0;
+  // Index of the run's precompiled header covering the includes this entry
+  // opens with, or kNoPrecompiledHeader.
+  std::size_t precompiled_header = kNoPrecompiledHeader;
+  // Position in the run's compile-command order.
+  std::size_t position = 0;
+};
+
+// Parse durations and fact counts of the units parsed in this run, by
+// position. Each slot is written only by the worker parsing that unit and
+// read once every worker has finished.
+class ParseTimings {
+public:
+  struct Measurement {
+    std::uint64_t duration_us = 0;
+    std::size_t fact_count = 0;
+  };
+
+  explicit ParseTimings(std::size_t count) : measured_(count) {}
+
+  void Record(std::size_t position, std::chrono::microseconds duration,
+              std::size_t fact_count) {
+    measured_[position] =
+        Measurement{static_cast<std::uint64_t>(duration.count()), fact_count};
+  }
+
+  const std::vector<std::optional<Measurement>> &measured() const {
+    return measured_;
+  }
+
+private:
+  std::vector<std::optional<Measurement>> measured_;
+};
+
+// Collects a report note for every translation unit that produced no facts.
+// Workers add notes concurrently; Notes() sorts them, and as each note names
+// its file, the notes of shards merged later sort the same way.
+class UnparsedTranslationUnits {
+public:
+  void Add(std::string note) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    notes_.push_back(std::move(note));
+  }
+
+  std::vector<std::string> Notes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::sort(notes_.begin(), notes_.end());
+    return std::move(notes_);
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::string> notes_;
+};
+
+// Settings shared by every translation unit of one BuildIndex run.
+struct IndexingContext {
+  std::filesystem::path project_root;
+  IndexerOptions options;
+  const ArgumentSetPool *argument_sets = nullptr;
+  TranslationUnitCacheSession *cache = nullptr;
+  ResidentUnitSession *resident = nullptr;
+  PrecompiledHeaderSession *precompiled_headers = nullptr;
+  UnparsedTranslationUnits *unparsed = nullptr;
+  HarvestedDeclarations *harvested = nullptr;
+  ParseTimings *timings = nullptr;
+  // Whether each worker takes its units in increasing position.
+  bool in_order = true;
+  Logger *logger = nullptr;
+};
+
+struct ParsedTranslationUnit {
+  bool parsed = false;
+  FactStore facts;
+  std::vector<std::string> dependencies;
+  std::optional<ParseFailure> failure;
+};
+
+// Declaration-only runs skip semantic analysis of function bodies and keep
+// going past errors, since missing bodies cannot affect the harvested facts.
+unsigned ParseOptions(const IndexerOptions &options);
+
+std::string DescribeParseError(CXErrorCode error);
+
+// Lists the main file and every header the parse read, as absolute paths.
+std::vector<std::string>
+CollectDependencies(CXTranslationUnit translation_unit,
+                    const std::filesystem::path &directory);
+
+bool HasErrors(CXTranslationUnit translation_unit);
+
+// Parses `entry` and harvests its facts. The translation unit is disposed
+// unless `kept` is given, in which case it is handed back through it.
+ParsedTranslationUnit
+ExtractFactsFromCommand(CXIndex index, CXIndexAction action,
+                        const CompileCommandEntry &entry,
+                        const IndexingContext &context,
+                        CXTranslationUnit *kept = nullptr);
+
+} // namespace dsl
@@ -0,0 +1,291 @@
+#include <dsl/analysis_server.h>
+
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace dsl {
+
+namespace {
+
+#ifndef _WIN32
+
+constexpr std::string_view kShutdownRequest = "shutdown";
+// Longest request line read; requests are single words.
+constexpr std::size_t kMaxRequestLength = 4096;
+
+std::string FormatReply(const ServerReply &reply) {
+  return std::to_string(reply.exit_code) + "\n" + reply.body;
+}
+
+ServerReply ParseReply(const std::string &raw,
+                       const std::filesystem::path &socket_path) {
+  const auto newline = raw.find('\n');
+  ServerReply reply;
+  const auto *first = raw.data();
+  const auto *last = first + (newline == std::string::npos ? 0 : newline);
+  const auto parsed = std::from_chars(first, last, reply.exit_code);
+  if (newline == std::string::npos || parsed.ec != std::errc() ||
+      parsed.ptr != last) {
+    throw std::runtime_error("Malformed reply from server at " +
+                             socket_path.string());
+  }
+  reply.body = raw.substr(newline + 1);
+  return reply;
+}
+
+std::runtime_error SocketError(const std::string &action,
+                               const std::filesystem::path &socket_path) {
+  return std::runtime_error(action + " " + socket_path.string() + ": " +
+                            std::strerror(errno));
+}
+
+class Descriptor {
+public:
+  explicit Descriptor(int value) : value_(value) {}
+  ~Descriptor() {
+    if (value_ >= 0) {
+      ::close(value_);
+    }
+  }
+  Descriptor(const Descriptor &) = delete;
+  Descriptor &operator=(const Descriptor &) = delete;
+
+  int get() const { return value_; }
+  int release() { return std::exchange(value_, -1); }
+
+private:
+  int value_;
+};
+
+sockaddr_un AddressOf(const std::filesystem::path &socket_path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const auto &native = socket_path.native();
+  if (native.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Socket path is too long: " +
+                             socket_path.string());
+  }
+  std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+  return address;
+}
+
+// Returns the connected descriptor, or -1 when nothing listens on the path.
+int Connect(const std::filesystem::path &socket_path) {
+  const auto address = AddressOf(socket_path);
+  Descriptor socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+  if (socket.get() < 0) {
+    throw SocketError("Cannot create socket for", socket_path);
+  }
+  if (::connect(socket.get(), reinterpret_cast<const sockaddr *>(&address),
+                sizeof(address)) != 0) {
+    return -1;
+  }
+  return socket.release();
+}
+
+// A client that hangs up early must not take the server down with SIGPIPE.
+bool WriteAll(int descriptor, std::string_view data) {
+#ifdef MSG_NOSIGNAL
+  constexpr int kFlags = MSG_NOSIGNAL;
+#else
+  constexpr int kFlags = 0;
+#endif
+  while (!data.empty()) {
+    const auto written = ::send(descriptor, data.data(), data.size(), kFlags);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data.remove_prefix(static_cast<std::size_t>(written));
+  }
+  return true;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Reads until end of stream or, when `line` is set, the first newline. With
+// a `deadline`, returns nullopt when the data has not arrived by then.
+std::optional<std::string>
+Read(int descriptor, bool line,
+     std::optional<Clock::time_point> deadline = std::nullopt) {
+  std::string data;
+  char buffer[4096];
+  while (!line || data.size() < kMaxRequestLength) {
+    if (deadline) {
+      const auto remaining =
+          std::chrono::duration_cast<std::chrono::milliseconds>(*deadline -
+                                                                Clock::now());
+      pollfd ready{descriptor, POLLIN, 0};
+      const auto polled =
+          remaining.count() > 0
+              ? ::poll(&ready, 1, static_cast<int>(remaining.count()))
+              : 0;
+      if (polled < 0 && errno == EINTR) {
+        continue;
+      }
+      if (polled == 0) {
+        return std::nullopt;
+      }
+    }
+    const auto count = ::read(descriptor, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      break;
+    }
+    data.append(buffer, static_cast<std::size_t>(count));
+    if (line && data.find('\n') != std::string::npos) {
+      break;
+    }
+  }
+  if (line) {
+    data = data.substr(0, data.find('\n'));
+    if (!data.empty() && data.back() == '\r') {
+      data.pop_back();
+    }
+  }
+  return data;
+}
+
+// Makes a send to `descriptor` fail once it has blocked for `timeout`.
+void LimitSendTime(int descriptor, std::chrono::milliseconds timeout) {
+  timeval limit{};
+  limit.tv_sec = static_cast<decltype(limit.tv_sec)>(timeout.count() / 1000);
+  limit.tv_usec =
+      static_cast<decltype(limit.tv_usec)>(timeout.count() % 1000 * 1000);
+  ::setsockopt(descriptor, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+}
+
+#endif
+
+} // namespace
+
+AnalysisServer::AnalysisServer(std::filesystem::path socket_path,
+                               RequestHandler handler,
+                               std::chrono::milliseconds client_timeout)
+    : socket_path_(std::move(socket_path)), handler_(std::move(handler)),
+      client_timeout_(client_timeout) {}
+
+#ifdef _WIN32
+
+AnalysisServer::~AnalysisServer() = default;
+
+void AnalysisServer::Listen() {
+  throw std::runtime_error("serve requires Unix domain sockets");
+}
+
+void AnalysisServer::Serve() {
+  throw std::runtime_error("serve requires Unix domain sockets");
+}
+
+ServerReply SendServerRequest(const std::filesystem::path &,
+                              const std::string &) {
+  throw std::runtime_error("client requires Unix domain sockets");
+}
+
+#else
+
+AnalysisServer::~AnalysisServer() {
+  if (descriptor_ >= 0) {
+    ::close(descriptor_);
+    std::error_code ignored;
+    std::filesystem::remove(socket_path_, ignored);
+  }
+}
+
+void AnalysisServer::Listen() {
+  const auto address = AddressOf(socket_path_);
+  if (std::filesystem::exists(socket_path_)) {
+    if (const auto existing = Connect(socket_path_); existing >= 0) {
+      ::close(existing);
+      throw std::runtime_error("A server is already listening on " +
+                               socket_path_.string());
+    }
+    std::filesystem::remove(socket_path_);
+  }
+  if (socket_path_.has_parent_path()) {
+    std::filesystem::create_directories(socket_path_.parent_path());
+  }
+
+  Descriptor socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+  if (socket.get() < 0) {
+    throw SocketError("Cannot create socket for", socket_path_);
+  }
+  if (::bind(socket.get(), reinterpret_cast<const sockaddr *>(&address),
+             sizeof(address)) != 0) {
+    throw SocketError("Cannot bind", socket_path_);
+  }
+  if (::listen(socket.get(), SOMAXCONN) != 0) {
+    const auto error = SocketError("Cannot listen on", socket_path_);
+    std::filesystem::remove(socket_path_);
+    throw error;
+  }
+  descriptor_ = socket.release();
+}
+
+void AnalysisServer::Serve() {
+  if (descriptor_ < 0) {
+    throw std::logic_error("AnalysisServer::Serve called before Listen");
+  }
+  for (;;) {
+    Descriptor client(::accept(descriptor_, nullptr, nullptr));
+    if (client.get() < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw SocketError("Cannot accept connections on", socket_path_);
+    }
+
+    const auto request =
+        Read(client.get(), true, Clock::now() + client_timeout_);
+    if (!request) {
+      continue;
+    }
+    LimitSendTime(client.get(), client_timeout_);
+    if (*request == kShutdownRequest) {
+      WriteAll(client.get(), FormatReply({0, "Server stopped\n"}));
+      return;
+    }
+    ServerReply reply;
+    try {
+      reply = handler_(*request);
+    } catch (const std::exception &ex) {
+      reply = {1, std::string("Error: ") + ex.what() + "\n"};
+    }
+    WriteAll(client.get(), FormatReply(reply));
+  }
+}
+
+ServerReply SendServerRequest(const std::filesystem::path &socket_path,
+                              const std::string &request) {
+  Descriptor server(Connect(socket_path));
+  if (server.get() < 0) {
+    throw SocketError("No server answers on", socket_path);
+  }
+  if (!WriteAll(server.get(), request + "\n")) {
+    throw SocketError("Cannot send request to", socket_path);
+  }
+  ::shutdown(server.get(), SHUT_WR);
+  return ParseReply(*Read(server.get(), false), socket_path);
+}
+
+#endif
+
+} // namespace dsl
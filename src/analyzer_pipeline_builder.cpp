@@ -29,6 +29,7 @@ AnalyzerPipelineBuilder::AnalyzerPipelineBuilder(
   selections_.extractor = registry_->DefaultExtractorName();
   selections_.analyzer = registry_->DefaultAnalyzerName();
   selections_.reporter = registry_->DefaultReporterName();
+  selections_.indexer = registry_->DefaultIndexerName();
 }
 
 AnalyzerPipelineBuilder AnalyzerPipelineBuilder::WithDefaults() {
@@ -101,6 +102,18 @@ AnalyzerPipelineBuilder::WithReporterName(std::string name) {
   return *this;
 }
 
+AnalyzerPipelineBuilder &
+AnalyzerPipelineBuilder::WithIndexerName(std::string name) {
+  selections_.indexer = std::move(name);
+  return *this;
+}
+
+AnalyzerPipelineBuilder &
+AnalyzerPipelineBuilder::WithIndexerOptions(IndexerOptions options) {
+  indexer_options_ = std::move(options);
+  return *this;
+}
+
 DefaultAnalyzerPipeline AnalyzerPipelineBuilder::Build() {
   components_.logger = EnsureLogger(std::move(components_.logger));
   components_.source_acquirer =
@@ -108,10 +121,11 @@ DefaultAnalyzerPipeline AnalyzerPipelineBuilder::Build() {
           ? std::move(components_.source_acquirer)
           : std::make_unique<CMakeSourceAcquirer>(
                 std::filesystem::path("build"), components_.logger);
-  components_.indexer = components_.indexer
-                            ? std::move(components_.indexer)
-                            : std::make_unique<CompileCommandsAstIndexer>(
-                                  std::filesystem::path{}, components_.logger);
+  components_.indexer =
+      components_.indexer
+          ? std::move(components_.indexer)
+          : registry_->CreateIndexer(selections_.indexer, components_.logger,
+                                     indexer_options_);
   components_.extractor =
       components_.extractor ? std::move(components_.extractor)
                             : registry_->CreateExtractor(selections_.extractor);
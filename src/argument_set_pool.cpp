@@ -0,0 +1,51 @@
+#include <dsl/argument_set_pool.h>
+
+#include <dsl/hashing.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+std::uint64_t HashArguments(const std::vector<std::string> &arguments) {
+  auto hash = dsl::kFnv1a64Offset;
+  for (const auto &argument : arguments) {
+    hash = dsl::Fnv1a64(argument, hash);
+    // Separates arguments so {"-I", "a"} and {"-Ia"} hash differently.
+    hash = dsl::Fnv1a64(std::string_view("\0", 1), hash);
+  }
+  return hash;
+}
+
+} // namespace
+
+namespace dsl {
+
+ArgumentSetId
+ArgumentSetPool::Intern(const std::vector<std::string> &arguments) {
+  const auto hash = HashArguments(arguments);
+  const auto [first, last] = ids_by_hash_.equal_range(hash);
+  for (auto candidate = first; candidate != last; ++candidate) {
+    if (sets_[candidate->second].arguments == arguments) {
+      return candidate->second;
+    }
+  }
+  if (sets_.size() >= std::numeric_limits<ArgumentSetId>::max()) {
+    throw std::length_error("Too many distinct argument sets");
+  }
+
+  const auto id = static_cast<ArgumentSetId>(sets_.size());
+  auto &set = sets_.emplace_back();
+  set.arguments = arguments;
+  set.pointers.reserve(set.arguments.size());
+  // Moving `sets_` later keeps each argument vector's buffer, so these
+  // pointers stay valid.
+  for (const auto &argument : set.arguments) {
+    set.pointers.push_back(argument.c_str());
+  }
+  ids_by_hash_.emplace(hash, id);
+  return id;
+}
+
+} // namespace dsl
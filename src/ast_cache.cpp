@@ -1,13 +1,118 @@
 #include <dsl/ast_cache.h>
 
 #include <dsl/escaping.h>
+#include <dsl/mapped_file.h>
 
+#include <atomic>
+#include <charconv>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 
 namespace {
 
+// Cache files are laid out as
+//   FileHeader | DependencyRecord[] | FactRecord[] |
+//   uint64 string offsets[string_count + 1] | string bytes
+// Records refer to strings by index, and equal strings are stored once. The
+// header records a failed parse with its error code and summary string, and
+// the git commit the dependencies were recorded at.
+// Locations are stored as spans with an interned file name and symbols as
+// their interned USR, mirroring dsl::CompactFact.
+// Files are written in host byte order; a reader on a host with a different
+// byte order, or any other format version, treats the file as a miss.
+constexpr char kMagic[8] = {'D', 'S', 'L', 'A', 'S', 'T', '\0', '\0'};
+constexpr std::uint32_t kFormatVersion = 6;
+constexpr std::uint32_t kByteOrderMark = 0x01020304U;
+constexpr std::uint32_t kParseFailedFlag = 1U;
+
+// Parse timings are a text file: a header line, then one
+// `duration_us<TAB>fact_count<TAB>file` line per translation unit.
+constexpr std::string_view kParseTimingsHeader = "dsl-parse-timings 1";
+// The findings baseline is a header line, a `revision<TAB>commit` line and
+// one line per finding.
+constexpr std::string_view kFindingBaselineHeader = "dsl-findings 2";
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint64_t dependency_count;
+  std::uint64_t fact_count;
+  std::uint64_t string_count;
+  std::uint64_t string_bytes;
+  std::uint32_t flags;
+  std::int32_t failure_code;
+  std::uint32_t failure_summary;
+  // The failure's diagnostics, one per line.
+  std::uint32_t failure_diagnostics;
+  std::uint32_t revision;
+  std::uint32_t reserved;
+};
+
+struct DependencyRecord {
+  std::uint64_t content_hash;
+  std::uint32_t path;
+  std::uint32_t reserved;
+};
+
+using FactString = dsl::StringId dsl::CompactFact::*;
+constexpr FactString kFactStrings[] = {
+    &dsl::CompactFact::name,       &dsl::CompactFact::kind_text,
+    &dsl::CompactFact::signature,  &dsl::CompactFact::descriptor,
+    &dsl::CompactFact::target,     &dsl::CompactFact::doc_comment,
+    &dsl::CompactFact::scope_path,
+};
+constexpr std::size_t kFactStringCount = std::size(kFactStrings);
+
+using FactSpan = dsl::SourceSpan dsl::CompactFact::*;
+constexpr FactSpan kFactSpans[] = {
+    &dsl::CompactFact::location,
+    &dsl::CompactFact::range,
+    &dsl::CompactFact::target_location,
+};
+constexpr std::size_t kFactSpanCount = std::size(kFactSpans);
+
+using FactSymbol = dsl::SymbolId dsl::CompactFact::*;
+constexpr FactSymbol kFactSymbols[] = {
+    &dsl::CompactFact::symbol,
+    &dsl::CompactFact::target_symbol,
+};
+constexpr std::size_t kFactSymbolCount = std::size(kFactSymbols);
+
+struct SpanRecord {
+  std::uint32_t file;
+  std::uint32_t begin_line;
+  std::uint32_t begin_column;
+  std::uint32_t end_line;
+  std::uint32_t end_column;
+  std::uint32_t structured;
+};
+
+struct FactRecord {
+  std::uint32_t strings[kFactStringCount];
+  SpanRecord spans[kFactSpanCount];
+  std::uint32_t symbols[kFactSymbolCount];
+  std::uint8_t kind;
+  std::uint8_t subject_in_project;
+  std::uint8_t target_scope;
+  std::uint8_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader> &&
+              std::is_trivially_copyable_v<DependencyRecord> &&
+              std::is_trivially_copyable_v<SpanRecord> &&
+              std::is_trivially_copyable_v<FactRecord>);
+
 std::shared_ptr<dsl::Logger> EnsureLogger(std::shared_ptr<dsl::Logger> logger) {
   if (!logger) {
     return std::make_shared<dsl::NullLogger>();
@@ -15,10 +120,395 @@ std::shared_ptr<dsl::Logger> EnsureLogger(std::shared_ptr<dsl::Logger> logger) {
   return logger;
 }
 
+std::vector<std::string> SplitLines(std::string_view text) {
+  std::vector<std::string> lines;
+  while (!text.empty()) {
+    const auto end = text.find('\n');
+    lines.emplace_back(text.substr(0, end));
+    if (end == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(end + 1);
+  }
+  return lines;
+}
+
+template <typename T> void Append(std::string &buffer, const T &value) {
+  buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+class StringTable {
+public:
+  std::uint32_t Intern(std::string_view value) {
+    const auto [entry, inserted] =
+        ids_.emplace(value, static_cast<std::uint32_t>(values_.size()));
+    if (inserted) {
+      values_.push_back(value);
+    }
+    return entry->second;
+  }
+
+  std::uint64_t ByteCount() const {
+    std::uint64_t bytes = 0;
+    for (const auto value : values_) {
+      bytes += value.size();
+    }
+    return bytes;
+  }
+
+  std::size_t size() const { return values_.size(); }
+
+  void AppendTo(std::string &buffer) const {
+    std::uint64_t offset = 0;
+    for (const auto value : values_) {
+      Append(buffer, offset);
+      offset += value.size();
+    }
+    Append(buffer, offset);
+    for (const auto value : values_) {
+      buffer.append(value);
+    }
+  }
+
+private:
+  std::unordered_map<std::string_view, std::uint32_t> ids_;
+  std::vector<std::string_view> values_;
+};
+
+std::string Serialize(const std::vector<dsl::FileDependency> &dependencies,
+                      const dsl::FactStore &facts,
+                      const std::optional<dsl::ParseFailure> &failure,
+                      const std::string &revision) {
+  StringTable strings;
+  std::vector<DependencyRecord> dependency_records;
+  dependency_records.reserve(dependencies.size());
+  for (const auto &dependency : dependencies) {
+    dependency_records.push_back(
+        {dependency.content_hash, strings.Intern(dependency.path), 0});
+  }
+  std::vector<FactRecord> fact_records;
+  fact_records.reserve(facts.size());
+  for (const auto &fact : facts.compact_facts()) {
+    FactRecord record{};
+    for (std::size_t field = 0; field < kFactStringCount; ++field) {
+      record.strings[field] =
+          strings.Intern(facts.Text(fact.*kFactStrings[field]));
+    }
+    for (std::size_t field = 0; field < kFactSpanCount; ++field) {
+      const auto &span = fact.*kFactSpans[field];
+      record.spans[field] = {strings.Intern(facts.Text(span.file)),
+                             span.begin_line,
+                             span.begin_column,
+                             span.end_line,
+                             span.end_column,
+                             span.structured ? 1U : 0U};
+    }
+    for (std::size_t field = 0; field < kFactSymbolCount; ++field) {
+      record.symbols[field] =
+          strings.Intern(facts.Usr(fact.*kFactSymbols[field]));
+    }
+    record.kind = static_cast<std::uint8_t>(fact.kind);
+    record.subject_in_project = fact.subject_in_project ? 1 : 0;
+    record.target_scope = static_cast<std::uint8_t>(fact.target_scope);
+    fact_records.push_back(record);
+  }
+
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.byte_order = kByteOrderMark;
+  header.dependency_count = dependency_records.size();
+  header.fact_count = fact_records.size();
+  if (failure.has_value()) {
+    header.flags = kParseFailedFlag;
+    header.failure_code = failure->error_code;
+    header.failure_summary = strings.Intern(failure->summary);
+    std::string diagnostics;
+    for (const auto &diagnostic : failure->diagnostics) {
+      diagnostics.append(diagnostics.empty() ? "" : "\n").append(diagnostic);
+    }
+    header.failure_diagnostics = strings.Intern(diagnostics);
+  }
+  header.revision = strings.Intern(revision);
+  header.string_count = strings.size();
+  header.string_bytes = strings.ByteCount();
+
+  std::string buffer;
+  buffer.reserve(sizeof(FileHeader) +
+                 dependency_records.size() * sizeof(DependencyRecord) +
+                 fact_records.size() * sizeof(FactRecord) +
+                 (strings.size() + 1) * sizeof(std::uint64_t) +
+                 header.string_bytes);
+  Append(buffer, header);
+  for (const auto &record : dependency_records) {
+    Append(buffer, record);
+  }
+  for (const auto &record : fact_records) {
+    Append(buffer, record);
+  }
+  strings.AppendTo(buffer);
+  return buffer;
+}
+
+// Bounds-checked reader over a mapped cache file. Every section size is
+// validated against the file length before any record is read.
+class CacheReader {
+public:
+  explicit CacheReader(std::string_view data) : data_(data) {}
+
+  bool Read(std::vector<dsl::FileDependency> &dependencies,
+            dsl::FactStore &facts, std::optional<dsl::ParseFailure> &failure,
+            std::string &revision) {
+    FileHeader header{};
+    if (!Take(header) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFormatVersion ||
+        header.byte_order != kByteOrderMark ||
+        (header.flags & ~kParseFailedFlag) != 0) {
+      return false;
+    }
+    const auto dependency_offset = offset_;
+    if (!Skip(header.dependency_count, sizeof(DependencyRecord))) {
+      return false;
+    }
+    const auto fact_offset = offset_;
+    if (!Skip(header.fact_count, sizeof(FactRecord)) ||
+        !ReadStrings(header.string_count, header.string_bytes)) {
+      return false;
+    }
+
+    if ((header.flags & kParseFailedFlag) != 0) {
+      if (header.failure_summary >= strings_.size() ||
+          header.failure_diagnostics >= strings_.size()) {
+        return false;
+      }
+      failure = dsl::ParseFailure{
+          header.failure_code, std::string(strings_[header.failure_summary]),
+          SplitLines(strings_[header.failure_diagnostics])};
+    }
+    if (header.revision >= strings_.size()) {
+      return false;
+    }
+    revision = strings_[header.revision];
+
+    dependencies.reserve(header.dependency_count);
+    for (std::uint64_t i = 0; i < header.dependency_count; ++i) {
+      DependencyRecord record{};
+      std::memcpy(&record,
+                  data_.data() + dependency_offset +
+                      i * sizeof(DependencyRecord),
+                  sizeof(record));
+      if (record.path >= strings_.size()) {
+        return false;
+      }
+      dependencies.push_back(
+          {std::string(strings_[record.path]), record.content_hash});
+    }
+
+    facts.reserve(static_cast<std::size_t>(header.fact_count));
+    for (std::uint64_t i = 0; i < header.fact_count; ++i) {
+      FactRecord record{};
+      std::memcpy(&record, data_.data() + fact_offset + i * sizeof(FactRecord),
+                  sizeof(record));
+      dsl::CompactFact fact;
+      if (!ReadFact(record, facts, fact)) {
+        return false;
+      }
+      facts.Add(fact);
+    }
+    return true;
+  }
+
+private:
+  bool ReadFact(const FactRecord &record, dsl::FactStore &facts,
+                dsl::CompactFact &fact) {
+    if (record.kind > static_cast<std::uint8_t>(dsl::FactKind::kTypeUsage) ||
+        record.target_scope >
+            static_cast<std::uint8_t>(dsl::AstFact::TargetScope::kExternal)) {
+      return false;
+    }
+    for (std::size_t field = 0; field < kFactStringCount; ++field) {
+      if (!Resolve(record.strings[field], facts, fact.*kFactStrings[field])) {
+        return false;
+      }
+    }
+    for (std::size_t field = 0; field < kFactSpanCount; ++field) {
+      const auto &stored = record.spans[field];
+      auto &span = fact.*kFactSpans[field];
+      if (!Resolve(stored.file, facts, span.file)) {
+        return false;
+      }
+      span.begin_line = stored.begin_line;
+      span.begin_column = stored.begin_column;
+      span.end_line = stored.end_line;
+      span.end_column = stored.end_column;
+      span.structured = stored.structured != 0;
+    }
+    for (std::size_t field = 0; field < kFactSymbolCount; ++field) {
+      const auto usr = record.symbols[field];
+      if (usr >= strings_.size()) {
+        return false;
+      }
+      fact.*kFactSymbols[field] = facts.InternSymbol(strings_[usr]);
+    }
+    fact.kind = static_cast<dsl::FactKind>(record.kind);
+    fact.subject_in_project = record.subject_in_project != 0;
+    fact.target_scope =
+        static_cast<dsl::AstFact::TargetScope>(record.target_scope);
+    return true;
+  }
+
+  // Maps a cache string index to a store id, interning each string once.
+  bool Resolve(std::uint32_t index, dsl::FactStore &facts, dsl::StringId &id) {
+    if (index >= strings_.size()) {
+      return false;
+    }
+    if (store_ids_.empty()) {
+      store_ids_.assign(strings_.size(), kUnresolved);
+    }
+    if (store_ids_[index] == kUnresolved) {
+      store_ids_[index] = facts.Intern(strings_[index]);
+    }
+    id = store_ids_[index];
+    return true;
+  }
+
+  template <typename T> bool Take(T &value) {
+    if (data_.size() - offset_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool Skip(std::uint64_t count, std::size_t record_size) {
+    const auto remaining = data_.size() - offset_;
+    if (count > remaining / record_size) {
+      return false;
+    }
+    offset_ += static_cast<std::size_t>(count) * record_size;
+    return true;
+  }
+
+  bool ReadStrings(std::uint64_t count, std::uint64_t bytes) {
+    if (count >= std::numeric_limits<std::uint32_t>::max()) {
+      return false;
+    }
+    const auto offsets_offset = offset_;
+    if (!Skip(count + 1, sizeof(std::uint64_t)) ||
+        data_.size() - offset_ != bytes) {
+      return false;
+    }
+    const auto *blob = data_.data() + offset_;
+    strings_.reserve(static_cast<std::size_t>(count));
+    std::uint64_t begin = 0;
+    for (std::uint64_t i = 0; i <= count; ++i) {
+      std::uint64_t end = 0;
+      std::memcpy(&end,
+                  data_.data() + offsets_offset + i * sizeof(std::uint64_t),
+                  sizeof(end));
+      if (i == 0) {
+        if (end != 0) {
+          return false;
+        }
+        continue;
+      }
+      if (end < begin || end > bytes) {
+        return false;
+      }
+      strings_.emplace_back(blob + begin,
+                            static_cast<std::size_t>(end - begin));
+      begin = end;
+    }
+    return begin == bytes;
+  }
+
+  static constexpr dsl::StringId kUnresolved =
+      std::numeric_limits<dsl::StringId>::max();
+
+  std::string_view data_;
+  std::size_t offset_ = 0;
+  std::vector<std::string_view> strings_;
+  std::vector<dsl::StringId> store_ids_;
+};
+
+bool ReadCacheFile(const std::filesystem::path &path,
+                   std::vector<dsl::FileDependency> &dependencies,
+                   dsl::FactStore &facts,
+                   std::optional<dsl::ParseFailure> &failure,
+                   std::string &revision) {
+  const auto file = dsl::MappedFile::Open(path);
+  if (!file.has_value()) {
+    return false;
+  }
+  return CacheReader(file->contents())
+      .Read(dependencies, facts, failure, revision);
+}
+
+bool WriteCacheFile(const std::filesystem::path &path,
+                    const std::vector<dsl::FileDependency> &dependencies,
+                    const dsl::FactStore &facts,
+                    const std::optional<dsl::ParseFailure> &failure = {},
+                    const std::string &revision = {}) {
+  return dsl::WriteFileAtomically(
+      path, Serialize(dependencies, facts, failure, revision));
+}
+
+// Distinguishes the temporary files of concurrent writers, in this process
+// or another one sharing the cache directory.
+std::string TemporarySuffix() {
+  static const auto process = std::random_device{}();
+  static std::atomic<std::uint64_t> counter{0};
+  return ".tmp." + std::to_string(process) + "." +
+         std::to_string(counter.fetch_add(1));
+}
+
 } // namespace
 
 namespace dsl {
 
+std::string EncodeFacts(const FactStore &facts) {
+  return Serialize({}, facts, std::nullopt, {});
+}
+
+bool DecodeFacts(std::string_view data, FactStore &facts) {
+  std::vector<FileDependency> dependencies;
+  std::optional<ParseFailure> failure;
+  std::string revision;
+  return CacheReader(data).Read(dependencies, facts, failure, revision) &&
+         dependencies.empty() && !failure.has_value();
+}
+
+bool WriteFileAtomically(const std::filesystem::path &path,
+                         std::string_view contents) {
+  std::error_code error;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) {
+      return false;
+    }
+  }
+  auto temporary = path;
+  temporary += TemporarySuffix();
+  {
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    stream.write(contents.data(),
+                 static_cast<std::streamsize>(contents.size()));
+    stream.close();
+    if (!stream) {
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
 std::filesystem::path ResolveCacheDirectory(const AstCacheOptions &options) {
   if (!options.directory.empty()) {
     return std::filesystem::weakly_canonical(options.directory);
@@ -40,29 +530,16 @@ bool AstCache::Load(const std::string &key, AstIndex &index) const {
     return false;
   }
 
-  std::ifstream stream(path);
-  if (!stream) {
-    logger_->Log(LogLevel::kWarn, "Failed to open AST cache",
+  std::vector<FileDependency> dependencies;
+  std::optional<ParseFailure> failure;
+  std::string revision;
+  AstIndex cached;
+  if (!ReadCacheFile(path, dependencies, cached.facts, failure, revision)) {
+    logger_->Log(LogLevel::kWarn, "Ignoring unreadable AST cache",
                  {{"path", path.string()}});
     return false;
   }
 
-  std::string line;
-  AstIndex cached;
-  while (std::getline(stream, line)) {
-    if (line.empty() || line[0] == '#') {
-      continue;
-    }
-    auto fields = SplitEscaped(line);
-    if (fields.size() != 7) {
-      logger_->Log(LogLevel::kWarn, "Ignoring malformed cache line",
-                   {{"path", path.string()}});
-      continue;
-    }
-    cached.facts.push_back({fields[0], fields[1], fields[2], fields[3],
-                            fields[4], fields[5], fields[6]});
-  }
-
   index = std::move(cached);
   logger_->Log(LogLevel::kInfo, "Loaded AST facts from cache",
                {{"path", path.string()},
@@ -75,26 +552,162 @@ void AstCache::Store(const std::string &key, const AstIndex &index) const {
     return;
   }
   const auto path = CachePath(key);
-  std::filesystem::create_directories(path.parent_path());
-  std::ofstream stream(path, std::ios::trunc);
-  if (!stream) {
+  if (!WriteCacheFile(path, {}, index.facts)) {
     logger_->Log(LogLevel::kWarn, "Failed to write AST cache",
                  {{"path", path.string()}});
     return;
   }
-
-  stream << "# toolchain cache entry\n";
-  for (const auto &fact : index.facts) {
-    stream << Escape(fact.name) << '\t' << Escape(fact.kind) << '\t'
-           << Escape(fact.source_location) << '\t' << Escape(fact.signature)
-           << '\t' << Escape(fact.descriptor) << '\t' << Escape(fact.target)
-           << '\t' << Escape(fact.range) << '\n';
-  }
   logger_->Log(LogLevel::kInfo, "Persisted AST cache",
                {{"path", path.string()},
                 {"fact_count", std::to_string(index.facts.size())}});
 }
 
+bool AstCache::LoadTranslationUnit(const std::string &key,
+                                   TranslationUnitCacheEntry &entry) const {
+  if (!options_.enabled) {
+    return false;
+  }
+  TranslationUnitCacheEntry cached;
+  if (!ReadCacheFile(TranslationUnitPath(key), cached.dependencies,
+                     cached.facts, cached.failure, cached.revision) ||
+      cached.dependencies.empty()) {
+    return false;
+  }
+  entry = std::move(cached);
+  return true;
+}
+
+void AstCache::StoreTranslationUnit(
+    const std::string &key, const TranslationUnitCacheEntry &entry) const {
+  if (!options_.enabled) {
+    return;
+  }
+  const auto path = TranslationUnitPath(key);
+  if (!WriteCacheFile(path, entry.dependencies, entry.facts, entry.failure,
+                      entry.revision)) {
+    logger_->Log(LogLevel::kWarn, "Failed to write AST cache",
+                 {{"path", path.string()}});
+  }
+}
+
+std::vector<ParseTiming> AstCache::LoadParseTimings() const {
+  if (!options_.enabled) {
+    return {};
+  }
+  std::ifstream stream(ParseTimingsPath());
+  std::string line;
+  if (!std::getline(stream, line) || line != kParseTimingsHeader) {
+    return {};
+  }
+  std::vector<ParseTiming> timings;
+  while (std::getline(stream, line)) {
+    const auto first_tab = line.find('\t');
+    const auto second_tab = line.find('\t', first_tab + 1);
+    if (first_tab == std::string::npos || second_tab == std::string::npos) {
+      continue;
+    }
+    ParseTiming timing;
+    const auto *begin = line.data();
+    const auto duration = std::from_chars(begin, begin + first_tab,
+                                          timing.duration_us);
+    const auto facts = std::from_chars(begin + first_tab + 1,
+                                       begin + second_tab, timing.fact_count);
+    if (duration.ec != std::errc() || duration.ptr != begin + first_tab ||
+        facts.ec != std::errc() || facts.ptr != begin + second_tab) {
+      continue;
+    }
+    timing.file = line.substr(second_tab + 1);
+    timings.push_back(std::move(timing));
+  }
+  return timings;
+}
+
+void AstCache::StoreParseTimings(
+    const std::vector<ParseTiming> &timings) const {
+  if (!options_.enabled) {
+    return;
+  }
+  std::string contents(kParseTimingsHeader);
+  contents += '\n';
+  for (const auto &timing : timings) {
+    if (timing.file.find('\n') != std::string::npos) {
+      continue;
+    }
+    contents.append(std::to_string(timing.duration_us))
+        .append("\t")
+        .append(std::to_string(timing.fact_count))
+        .append("\t")
+        .append(timing.file)
+        .append("\n");
+  }
+  if (!WriteFileAtomically(ParseTimingsPath(), contents)) {
+    logger_->Log(LogLevel::kWarn, "Failed to write parse timings",
+                 {{"path", ParseTimingsPath().string()}});
+  }
+}
+
+std::optional<FindingBaseline> AstCache::LoadFindingBaseline() const {
+  if (!options_.enabled) {
+    return std::nullopt;
+  }
+  std::ifstream stream(FindingBaselinePath());
+  std::string line;
+  constexpr std::string_view kRevision = "revision\t";
+  if (!std::getline(stream, line) || line != kFindingBaselineHeader ||
+      !std::getline(stream, line) || line.rfind(kRevision, 0) != 0) {
+    return std::nullopt;
+  }
+  FindingBaseline baseline;
+  baseline.revision = line.substr(kRevision.size());
+  // One finding per line: term, conflict, suggested canonical form,
+  // description and then the examples, escaped and tab-separated.
+  auto &findings = baseline.findings;
+  while (std::getline(stream, line)) {
+    auto fields = SplitEscaped(line);
+    if (fields.size() < 4) {
+      continue;
+    }
+    Finding finding;
+    finding.term = std::move(fields[0]);
+    finding.conflict = std::move(fields[1]);
+    finding.suggested_canonical_form = std::move(fields[2]);
+    finding.description = std::move(fields[3]);
+    finding.examples.assign(std::make_move_iterator(fields.begin() + 4),
+                            std::make_move_iterator(fields.end()));
+    findings.push_back(std::move(finding));
+  }
+  return baseline;
+}
+
+void AstCache::StoreFindingBaseline(const std::vector<Finding> &findings,
+                                    const std::string &revision) const {
+  if (!options_.enabled) {
+    return;
+  }
+  std::string contents(kFindingBaselineHeader);
+  contents.append("\nrevision\t").append(revision).append("\n");
+  for (const auto &finding : findings) {
+    if (finding.change == FindingChange::kResolved) {
+      continue;
+    }
+    contents.append(Escape(finding.term))
+        .append("\t")
+        .append(Escape(finding.conflict))
+        .append("\t")
+        .append(Escape(finding.suggested_canonical_form))
+        .append("\t")
+        .append(Escape(finding.description));
+    for (const auto &example : finding.examples) {
+      contents.append("\t").append(Escape(example));
+    }
+    contents += '\n';
+  }
+  if (!WriteFileAtomically(FindingBaselinePath(), contents)) {
+    logger_->Log(LogLevel::kWarn, "Failed to write finding baseline",
+                 {{"path", FindingBaselinePath().string()}});
+  }
+}
+
 void AstCache::Clean() const {
   if (std::filesystem::exists(directory_)) {
     std::filesystem::remove_all(directory_);
@@ -107,4 +720,17 @@ std::filesystem::path AstCache::CachePath(const std::string &key) const {
   return directory_ / ("ast_cache_" + key + ".dat");
 }
 
+std::filesystem::path
+AstCache::TranslationUnitPath(const std::string &key) const {
+  return directory_ / "translation_units" / (key + ".dat");
+}
+
+std::filesystem::path AstCache::ParseTimingsPath() const {
+  return directory_ / "parse_timings.tsv";
+}
+
+std::filesystem::path AstCache::FindingBaselinePath() const {
+  return directory_ / "findings.tsv";
+}
+
 } // namespace dsl
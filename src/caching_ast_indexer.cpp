@@ -1,12 +1,22 @@
 #include <dsl/caching_ast_indexer.h>
 
+#include <dsl/hashing.h>
 #include <dsl/logging.h>
 
 #include <clang-c/Index.h>
 
-#include <functional>
+#include <string_view>
 #include <utility>
 
+namespace {
+
+// Terminates every field so adjacent values cannot run together.
+std::uint64_t HashField(std::string_view value, std::uint64_t hash) {
+  return dsl::Fnv1a64(std::string_view("\0", 1), dsl::Fnv1a64(value, hash));
+}
+
+} // namespace
+
 namespace dsl {
 
 std::string ToolchainVersion() {
@@ -21,33 +31,84 @@ std::string ToolchainVersion() {
 
 std::string BuildCacheKey(const SourceAcquisitionResult &sources,
                           const std::string &toolchain_version) {
-  std::string accumulator = toolchain_version;
-  accumulator.append(sources.project_root);
-  accumulator.append(sources.build_directory);
+  auto hash = HashField(toolchain_version, kFnv1a64Offset);
+  hash = HashField(sources.project_root, hash);
+  hash = HashField(sources.build_directory, hash);
   for (const auto &file : sources.files) {
-    accumulator.append(file);
+    hash = HashField(file, hash);
+    const auto content_hash = HashFileContents(file);
+    hash = HashField(content_hash ? HashToHex(*content_hash) : "", hash);
+  }
+  return HashToHex(hash);
+}
+
+std::string
+BuildTranslationUnitCacheKey(const std::string &toolchain_version,
+                             const std::string &indexer_settings,
+                             const std::filesystem::path &file,
+                             const std::filesystem::path &directory,
+                             const std::vector<std::string> &args) {
+  auto hash = HashField(toolchain_version, kFnv1a64Offset);
+  hash = HashField(indexer_settings, hash);
+  hash = HashField(file.string(), hash);
+  hash = HashField(directory.string(), hash);
+  for (const auto &arg : args) {
+    hash = HashField(arg, hash);
   }
-  return std::to_string(std::hash<std::string>{}(accumulator));
+  return HashToHex(hash);
 }
 
 CachingAstIndexer::CachingAstIndexer(std::unique_ptr<AstIndexer> inner,
                                      AstCacheOptions options,
                                      std::shared_ptr<Logger> logger)
     : inner_(std::move(inner)), options_(std::move(options)),
-      cache_(options_, logger), logger_(EnsureLogger(std::move(logger))) {}
+      cache_(std::make_shared<AstCache>(options_, logger)),
+      logger_(EnsureLogger(std::move(logger))) {
+  per_translation_unit_ =
+      options_.enabled && inner_->UseTranslationUnitCache(cache_);
+}
 
 AstIndex CachingAstIndexer::BuildIndex(const SourceAcquisitionResult &sources) {
+  if (DelegatesRun()) {
+    return inner_->BuildIndex(sources);
+  }
+  return BuildCachedIndex(sources);
+}
+
+void CachingAstIndexer::StreamIndex(const SourceAcquisitionResult &sources,
+                                    FactSink &sink) {
+  if (DelegatesRun()) {
+    inner_->StreamIndex(sources, sink);
+    return;
+  }
+  sink.Consume(BuildCachedIndex(sources).facts);
+}
+
+std::vector<std::string> CachingAstIndexer::IndexingNotes() const {
+  return inner_->IndexingNotes();
+}
+
+bool CachingAstIndexer::DelegatesRun() const {
   if (options_.clean) {
-    cache_.Clean();
+    cache_->Clean();
   }
   if (!options_.enabled) {
-    return inner_->BuildIndex(sources);
+    return true;
   }
+  if (per_translation_unit_) {
+    logger_->Log(LogLevel::kInfo, "Using per-translation-unit AST cache",
+                 {{"directory", cache_->Directory().string()}});
+    return true;
+  }
+  return false;
+}
 
+AstIndex
+CachingAstIndexer::BuildCachedIndex(const SourceAcquisitionResult &sources) {
   const auto version = ToolchainVersion();
   const auto key = BuildCacheKey(sources, version);
   AstIndex index;
-  if (cache_.Load(key, index)) {
+  if (cache_->Load(key, index)) {
     logger_->Log(LogLevel::kInfo, "AST cache hit",
                  {{"key", key}, {"toolchain", version}});
     return index;
@@ -56,7 +117,7 @@ AstIndex CachingAstIndexer::BuildIndex(const SourceAcquisitionResult &sources) {
   logger_->Log(LogLevel::kInfo, "AST cache miss",
                {{"key", key}, {"toolchain", version}});
   index = inner_->BuildIndex(sources);
-  cache_.Store(key, index);
+  cache_->Store(key, index);
   return index;
 }
 
@@ -0,0 +1,194 @@
+#include <dsl/changed_files.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+namespace dsl {
+namespace {
+
+std::string CanonicalPath(const std::filesystem::path &path) {
+  return std::filesystem::weakly_canonical(path).string();
+}
+
+void SortUnique(std::vector<std::string> &paths) {
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+}
+
+#ifndef _WIN32
+
+std::string ShellQuote(const std::string &value) {
+  std::string quoted = "'";
+  for (const auto character : value) {
+    if (character == '\'') {
+      quoted += "'\\''";
+    } else {
+      quoted += character;
+    }
+  }
+  return quoted + "'";
+}
+
+struct CommandOutput {
+  bool succeeded = false;
+  std::string text;
+};
+
+CommandOutput RunGit(const std::filesystem::path &root,
+                     const std::string &arguments) {
+  const auto command =
+      "git -C " + ShellQuote(root.string()) + " " + arguments + " 2>/dev/null";
+  auto *pipe = ::popen(command.c_str(), "r");
+  if (pipe == nullptr) {
+    throw std::runtime_error("Cannot run git");
+  }
+  CommandOutput output;
+  char buffer[4096];
+  for (std::size_t read = 0;
+       (read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0;) {
+    output.text.append(buffer, read);
+  }
+  const auto status = ::pclose(pipe);
+  output.succeeded = status != -1 && WIFEXITED(status) &&
+                     WEXITSTATUS(status) == 0;
+  return output;
+}
+
+std::string RunGitOrThrow(const std::filesystem::path &root,
+                          const std::string &arguments,
+                          const std::string &failure) {
+  auto output = RunGit(root, arguments);
+  if (!output.succeeded) {
+    throw std::runtime_error(failure);
+  }
+  return std::move(output.text);
+}
+
+std::string TrimLine(std::string text) {
+  while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) {
+    text.pop_back();
+  }
+  return text;
+}
+
+// Appends the NUL-separated paths in `listing`, relative to `top_level`,
+// which must be canonical. Without `canonical` the paths are only joined,
+// which spares a walk per file; one that runs through a symbolic link then
+// matches no canonical path.
+void AppendListed(std::string_view listing,
+                  const std::filesystem::path &top_level,
+                  std::vector<std::string> &paths, bool canonical = true) {
+  while (!listing.empty()) {
+    const auto end = listing.find('\0');
+    const auto entry = listing.substr(0, end);
+    if (!entry.empty()) {
+      const auto path = top_level / std::string(entry);
+      paths.push_back(canonical ? CanonicalPath(path)
+                                : path.lexically_normal().string());
+    }
+    if (end == std::string_view::npos) {
+      break;
+    }
+    listing.remove_prefix(end + 1);
+  }
+}
+
+#endif
+
+} // namespace
+
+ChangeSet ChangedFilesSince(const std::filesystem::path &root,
+                            const std::string &revision) {
+#ifdef _WIN32
+  (void)root;
+  (void)revision;
+  throw std::runtime_error(
+      "--since is not supported on Windows; pass --changed-files instead");
+#else
+  if (revision.empty()) {
+    throw std::runtime_error("--since requires a git revision");
+  }
+  ChangeSet changes;
+  changes.revision = TrimLine(
+      RunGitOrThrow(root,
+                    "rev-parse --verify --quiet " +
+                        ShellQuote(revision + "^{commit}"),
+                    "Unknown git revision '" + revision + "' in " +
+                        root.string() + " (fetch it before analyzing)"));
+  const std::filesystem::path top_level = CanonicalPath(
+      TrimLine(RunGitOrThrow(root, "rev-parse --show-toplevel",
+                             "Not a git work tree: " + root.string())));
+
+  AppendListed(RunGitOrThrow(root,
+                             "diff --name-only --no-renames -z " +
+                                 changes.revision + " --",
+                             "Cannot diff against '" + revision + "'"),
+               top_level, changes.changed);
+  AppendListed(RunGitOrThrow(root,
+                             "ls-files --others --exclude-standard "
+                             "--full-name -z -- :/",
+                             "Cannot list untracked files"),
+               top_level, changes.changed);
+  SortUnique(changes.changed);
+
+  // A large tree tracks far more files than any run reads, so these paths
+  // are not resolved; a linked one is just hashed like an untracked file.
+  std::vector<std::string> tracked;
+  AppendListed(RunGitOrThrow(root, "ls-files --full-name -z -- :/",
+                             "Cannot list tracked files"),
+               top_level, tracked, false);
+  SortUnique(tracked);
+  std::set_difference(tracked.begin(), tracked.end(), changes.changed.begin(),
+                      changes.changed.end(),
+                      std::back_inserter(changes.unchanged));
+  return changes;
+#endif
+}
+
+std::optional<ChangeSet> WorkTreeChanges(const std::filesystem::path &root) {
+#ifdef _WIN32
+  (void)root;
+  return std::nullopt;
+#else
+  try {
+    return ChangedFilesSince(root, "HEAD");
+  } catch (const std::runtime_error &) {
+    return std::nullopt;
+  }
+#endif
+}
+
+std::vector<std::string>
+ReadChangedFilesList(const std::filesystem::path &list_file,
+                     const std::filesystem::path &root) {
+  std::ifstream stream(list_file);
+  if (!stream) {
+    throw std::runtime_error("Cannot read changed files list: " +
+                             list_file.string());
+  }
+  std::vector<std::string> paths;
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    const std::filesystem::path path(line);
+    paths.push_back(CanonicalPath(path.is_absolute() ? path : root / path));
+  }
+  SortUnique(paths);
+  return paths;
+}
+
+} // namespace dsl
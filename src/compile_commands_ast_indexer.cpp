@@ -1,65 +1,40 @@
 #include <dsl/compile_commands_ast_indexer.h>
 
+#include <dsl/argument_set_pool.h>
+#include <dsl/ast_cache.h>
+#include <dsl/compile_commands_loader.h>
+#include <dsl/cursor_walk_engine.h>
+#include <dsl/fact_builder.h>
+#include <dsl/fact_shard.h>
+#include <dsl/file_hashes.h>
+#include <dsl/mapped_file.h>
+#include <dsl/parse_schedule.h>
+#include <dsl/precompiled_headers.h>
+#include <dsl/resident_translation_units.h>
+#include <dsl/translation_unit_cache_session.h>
+#include <dsl/translation_unit_parsing.h>
+
 #include <algorithm>
-#include <clang-c/CXCompilationDatabase.h>
+#include <chrono>
 #include <clang-c/Index.h>
-#include <cstdlib>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
-#include <fstream>
+#include <memory>
+#include <numeric>
 #include <optional>
-#include <regex>
-#include <set>
-#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace dsl {
-namespace {
-struct CompileCommandEntry {
-  std::filesystem::path file;
-  std::filesystem::path directory;
-  std::vector<std::string> args;
-};
-
-std::string Join(const std::vector<std::string> &values,
-                 const std::string &separator) {
-  std::ostringstream stream;
-  for (std::size_t i = 0; i < values.size(); ++i) {
-    if (i > 0) {
-      stream << separator;
-    }
-    stream << values[i];
-  }
-  return stream.str();
-}
 
-std::string ToString(CXString value) {
-  std::string text;
-  if (const auto *cstr = clang_getCString(value); cstr != nullptr) {
-    text = cstr;
-  }
-  clang_disposeString(value);
-  return text;
-}
-
-bool IsWithin(const std::filesystem::path &candidate,
-              const std::filesystem::path &potential_parent) {
-  if (potential_parent.empty()) {
-    return false;
-  }
-
-  const auto parent = std::filesystem::weakly_canonical(potential_parent);
-  const auto normalized_candidate =
-      std::filesystem::weakly_canonical(candidate);
-
-  return std::distance(parent.begin(), parent.end()) <=
-             std::distance(normalized_candidate.begin(),
-                           normalized_candidate.end()) &&
-         std::equal(parent.begin(), parent.end(), normalized_candidate.begin());
-}
+namespace {
 
 std::filesystem::path CanonicalPathOrEmpty(const std::string &path) {
   if (path.empty()) {
@@ -85,398 +60,6 @@ ChooseCompileCommandsPath(const std::filesystem::path &explicit_path,
                                            "compile_commands.json");
 }
 
-std::optional<std::filesystem::path>
-PathFromLocation(CXSourceLocation location) {
-  CXFile file{};
-  unsigned line = 0;
-  unsigned column = 0;
-  unsigned offset = 0;
-  clang_getFileLocation(location, &file, &line, &column, &offset);
-  if (file == nullptr) {
-    return std::nullopt;
-  }
-  const auto path = ToString(clang_getFileName(file));
-  if (path.empty()) {
-    return std::nullopt;
-  }
-  return std::filesystem::weakly_canonical(path);
-}
-
-std::string FormatRange(CXSourceRange range) {
-  const auto start = clang_getRangeStart(range);
-  const auto end = clang_getRangeEnd(range);
-
-  CXFile file{};
-  unsigned start_line = 0;
-  unsigned start_column = 0;
-  clang_getSpellingLocation(start, &file, &start_line, &start_column, nullptr);
-
-  unsigned end_line = 0;
-  unsigned end_column = 0;
-  clang_getSpellingLocation(end, nullptr, &end_line, &end_column, nullptr);
-
-  const auto file_path = ToString(clang_getFileName(file));
-  if (file_path.empty()) {
-    return {};
-  }
-
-  return file_path + ":" + std::to_string(start_line) + ":" +
-         std::to_string(start_column) + "-" + std::to_string(end_line) + ":" +
-         std::to_string(end_column);
-}
-
-std::string GetTypeName(CXType type) {
-  return ToString(clang_getTypeSpelling(type));
-}
-
-std::string QualifiedName(CXCursor cursor) {
-  if (clang_Cursor_isNull(cursor)) {
-    return {};
-  }
-
-  const auto parent = clang_getCursorSemanticParent(cursor);
-  if (clang_Cursor_isNull(parent) ||
-      clang_getCursorKind(parent) == CXCursor_TranslationUnit) {
-    return ToString(clang_getCursorSpelling(cursor));
-  }
-
-  const auto parent_name = QualifiedName(parent);
-  if (parent_name.empty()) {
-    return ToString(clang_getCursorSpelling(cursor));
-  }
-
-  const auto name = ToString(clang_getCursorSpelling(cursor));
-  if (name.empty()) {
-    return parent_name;
-  }
-  return parent_name + "::" + name;
-}
-
-std::string SignatureForCursor(CXCursor cursor) {
-  const auto kind = clang_getCursorKind(cursor);
-  if (kind == CXCursor_FunctionDecl || kind == CXCursor_CXXMethod ||
-      kind == CXCursor_Constructor || kind == CXCursor_FunctionTemplate) {
-    const auto return_type = GetTypeName(clang_getCursorResultType(cursor));
-    const auto display = ToString(clang_getCursorDisplayName(cursor));
-    if (return_type.empty()) {
-      return display;
-    }
-    if (display.empty()) {
-      return return_type;
-    }
-    return return_type + " " + display;
-  }
-
-  if (kind == CXCursor_FieldDecl || kind == CXCursor_VarDecl) {
-    const auto name = ToString(clang_getCursorSpelling(cursor));
-    const auto type = GetTypeName(clang_getCursorType(cursor));
-    if (name.empty()) {
-      return type;
-    }
-    if (type.empty()) {
-      return name;
-    }
-    return name + ": " + type;
-  }
-
-  return ToString(clang_getCursorDisplayName(cursor));
-}
-
-std::string BuildScopePath(CXCursor cursor) {
-  std::vector<std::string> components;
-  auto parent = clang_getCursorSemanticParent(cursor);
-  while (!clang_Cursor_isNull(parent) &&
-         clang_getCursorKind(parent) != CXCursor_TranslationUnit) {
-    const auto name = ToString(clang_getCursorSpelling(parent));
-    if (!name.empty()) {
-      components.push_back(name);
-    }
-    parent = clang_getCursorSemanticParent(parent);
-  }
-  if (components.empty()) {
-    return {};
-  }
-  std::reverse(components.begin(), components.end());
-  return Join(components, "::");
-}
-
-std::string DocComment(CXCursor cursor) {
-  auto comment = ToString(clang_Cursor_getRawCommentText(cursor));
-  if (!comment.empty()) {
-    return comment;
-  }
-  return ToString(clang_Cursor_getBriefCommentText(cursor));
-}
-
-class FactCollector {
-public:
-  explicit FactCollector(const std::filesystem::path &project_root)
-      : project_root_(std::filesystem::weakly_canonical(project_root)) {}
-
-  std::vector<AstFact> Collect(CXCursor root) {
-    Traverse(root);
-    return facts_;
-  }
-
-private:
-  struct EntityScope {
-    explicit EntityScope(std::vector<std::string> &stack)
-        : stack_(&stack), active_(true) {}
-
-    EntityScope(const EntityScope &) = delete;
-    EntityScope &operator=(const EntityScope &) = delete;
-
-    EntityScope(EntityScope &&other) noexcept
-        : stack_(other.stack_), active_(other.active_) {
-      other.stack_ = nullptr;
-      other.active_ = false;
-    }
-
-    EntityScope &operator=(EntityScope &&other) noexcept {
-      if (this == &other) {
-        return *this;
-      }
-      Release();
-      stack_ = other.stack_;
-      active_ = other.active_;
-      other.stack_ = nullptr;
-      other.active_ = false;
-      return *this;
-    }
-
-    ~EntityScope() { Release(); }
-
-  private:
-    void Release() {
-      if (active_ && stack_ != nullptr) {
-        stack_->pop_back();
-        active_ = false;
-      }
-    }
-
-    std::vector<std::string> *stack_;
-    bool active_;
-  };
-
-  bool IsProjectCursor(CXCursor cursor) const {
-    const auto location = clang_getCursorLocation(cursor);
-    const auto path = PathFromLocation(location);
-    return path.has_value() && IsWithin(*path, project_root_);
-  }
-
-  std::optional<std::string> CurrentEntity() const {
-    if (entity_stack_.empty()) {
-      return std::nullopt;
-    }
-    return entity_stack_.back();
-  }
-
-  bool IsEntityDefinition(CXCursorKind kind) const {
-    return kind == CXCursor_FunctionDecl || kind == CXCursor_CXXMethod ||
-           kind == CXCursor_Constructor || kind == CXCursor_FunctionTemplate ||
-           kind == CXCursor_StructDecl || kind == CXCursor_ClassDecl ||
-           kind == CXCursor_EnumDecl;
-  }
-
-  std::optional<EntityScope> EnterEntity(CXCursor cursor, CXCursorKind kind) {
-    if (!IsEntityDefinition(kind)) {
-      return std::nullopt;
-    }
-    if (!clang_isCursorDefinition(cursor)) {
-      return std::nullopt;
-    }
-
-    const auto name = QualifiedName(cursor);
-    if (name.empty()) {
-      return std::nullopt;
-    }
-
-    entity_stack_.push_back(name);
-    return EntityScope(entity_stack_);
-  }
-
-  void AddFact(AstFact fact) { facts_.push_back(std::move(fact)); }
-
-  AstFact::TargetScope DetermineTargetScope(CXCursor cursor,
-                                            std::string &location) const {
-    const auto cursor_location = clang_getCursorLocation(cursor);
-    const auto path = PathFromLocation(cursor_location);
-    if (!path.has_value()) {
-      return AstFact::TargetScope::kUnknown;
-    }
-    location = FormatRange(clang_getCursorExtent(cursor));
-    if (IsWithin(*path, project_root_)) {
-      return AstFact::TargetScope::kInProject;
-    }
-    return AstFact::TargetScope::kExternal;
-  }
-
-  AstFact::TargetScope DetermineTargetScope(CXType type,
-                                            std::string &location) const {
-    const auto declaration = clang_getTypeDeclaration(type);
-    if (clang_Cursor_isNull(declaration)) {
-      return AstFact::TargetScope::kUnknown;
-    }
-    return DetermineTargetScope(declaration, location);
-  }
-
-  void AddSymbolFact(CXCursor cursor, const std::string &kind) {
-    if (!clang_isCursorDefinition(cursor)) {
-      return;
-    }
-
-    AstFact fact;
-    fact.name = QualifiedName(cursor);
-    fact.kind = kind;
-    fact.signature = SignatureForCursor(cursor);
-    fact.descriptor = fact.signature;
-    fact.source_location = FormatRange(clang_getCursorExtent(cursor));
-    fact.range = fact.source_location;
-    fact.doc_comment = DocComment(cursor);
-    fact.scope_path = BuildScopePath(cursor);
-    fact.subject_in_project = true;
-    AddFact(std::move(fact));
-  }
-
-  void AddOwnershipFact(CXCursor cursor) {
-    const auto owner = CurrentEntity();
-    if (!owner.has_value()) {
-      return;
-    }
-
-    AstFact fact;
-    fact.name = *owner;
-    fact.kind = "owns";
-    fact.target = GetTypeName(clang_getCursorType(cursor));
-    fact.descriptor = ToString(clang_getCursorSpelling(cursor));
-    fact.signature = fact.descriptor + ": " + fact.target;
-    fact.source_location = FormatRange(clang_getCursorExtent(cursor));
-    fact.range = fact.source_location;
-    fact.doc_comment = DocComment(cursor);
-    fact.scope_path = BuildScopePath(cursor);
-    fact.subject_in_project = true;
-    fact.target_scope =
-        DetermineTargetScope(clang_getCursorType(cursor), fact.target_location);
-    AddFact(std::move(fact));
-  }
-
-  void AddCallFact(CXCursor cursor) {
-    const auto caller = CurrentEntity();
-    if (!caller.has_value()) {
-      return;
-    }
-
-    const auto referenced = clang_getCursorReferenced(cursor);
-    auto target_name = QualifiedName(referenced);
-    if (target_name.empty()) {
-      target_name = ToString(clang_getCursorDisplayName(cursor));
-    }
-    if (target_name.empty()) {
-      return;
-    }
-
-    AstFact fact;
-    fact.name = *caller;
-    fact.kind = "call";
-    fact.target = target_name;
-    fact.signature = SignatureForCursor(referenced);
-    fact.descriptor = "calls " + target_name;
-    fact.source_location = FormatRange(clang_getCursorExtent(cursor));
-    fact.range = fact.source_location;
-    fact.doc_comment = DocComment(cursor);
-    fact.scope_path = BuildScopePath(cursor);
-    fact.subject_in_project = true;
-    fact.target_scope = DetermineTargetScope(referenced, fact.target_location);
-    AddFact(std::move(fact));
-  }
-
-  void AddTypeUsageFact(CXCursor cursor) {
-    const auto subject = CurrentEntity();
-    if (!subject.has_value()) {
-      return;
-    }
-
-    const auto type_name = GetTypeName(clang_getCursorType(cursor));
-    if (type_name.empty()) {
-      return;
-    }
-
-    AstFact fact;
-    fact.name = *subject;
-    fact.kind = "type_usage";
-    fact.target = type_name;
-    fact.descriptor = "uses " + type_name;
-    fact.signature = fact.descriptor;
-    fact.source_location = FormatRange(clang_getCursorExtent(cursor));
-    fact.range = fact.source_location;
-    fact.doc_comment = DocComment(cursor);
-    fact.scope_path = BuildScopePath(cursor);
-    fact.subject_in_project = true;
-    fact.target_scope =
-        DetermineTargetScope(clang_getCursorType(cursor), fact.target_location);
-    AddFact(std::move(fact));
-  }
-
-  void Traverse(CXCursor cursor) {
-    const auto kind = clang_getCursorKind(cursor);
-    const bool in_project = IsProjectCursor(cursor);
-    std::optional<EntityScope> scope;
-    if (in_project) {
-      scope = EnterEntity(cursor, kind);
-      switch (kind) {
-      case CXCursor_FunctionDecl:
-      case CXCursor_CXXMethod:
-      case CXCursor_Constructor:
-      case CXCursor_FunctionTemplate:
-        AddSymbolFact(cursor, "function");
-        break;
-      case CXCursor_StructDecl:
-      case CXCursor_ClassDecl:
-      case CXCursor_EnumDecl:
-        AddSymbolFact(cursor, "type");
-        break;
-      case CXCursor_VarDecl:
-        AddSymbolFact(cursor, "variable");
-        break;
-      case CXCursor_FieldDecl:
-        AddOwnershipFact(cursor);
-        break;
-      case CXCursor_CallExpr:
-        AddCallFact(cursor);
-        break;
-      case CXCursor_TypeRef:
-        AddTypeUsageFact(cursor);
-        break;
-      default:
-        break;
-      }
-    }
-
-    clang_visitChildren(
-        cursor,
-        [](CXCursor child, CXCursor, CXClientData data) {
-          auto *collector = static_cast<FactCollector *>(data);
-          collector->Traverse(child);
-          return CXChildVisit_Continue;
-        },
-        this);
-  }
-
-  std::filesystem::path project_root_;
-  std::vector<AstFact> facts_;
-  std::vector<std::string> entity_stack_;
-};
-
-std::vector<std::string> ExtractArgs(CXCompileCommand command) {
-  std::vector<std::string> args;
-  const unsigned count = clang_CompileCommand_getNumArgs(command);
-  args.reserve(count);
-  for (unsigned index = 0; index < count; ++index) {
-    args.push_back(ToString(clang_CompileCommand_getArg(command, index)));
-  }
-  return args;
-}
-
 bool ContainsArg(const std::vector<std::string> &args,
                  const std::string &needle) {
   return std::find(args.begin(), args.end(), needle) != args.end();
@@ -493,91 +76,132 @@ bool LooksLikeCompiler(const std::string &arg) {
          arg.find("clang") != std::string::npos;
 }
 
-std::vector<std::string> TokenizeCommand(const std::string &command) {
-  std::istringstream stream(command);
-  std::vector<std::string> tokens;
-  std::string token;
-  while (stream >> token) {
-    tokens.push_back(token);
+// Matches the translation unit when the command names it relative to the
+// entry's directory, as generated databases often do.
+bool IsSourceArgument(const CompileCommandEntry &entry,
+                      const std::string &arg) {
+  if (arg.empty() || arg.front() == '-' || entry.directory.empty()) {
+    return false;
   }
-  return tokens;
+  const std::filesystem::path path(arg);
+  return path.is_relative() &&
+         (entry.directory / path).lexically_normal() == entry.file;
 }
 
-std::vector<std::string> NormalizeArgs(const CompileCommandEntry &entry) {
-  std::vector<std::string> args;
-  args.reserve(entry.args.size() + 2);
-  for (std::size_t i = 0; i < entry.args.size(); ++i) {
-    const auto &arg = entry.args[i];
+// Drops the compiler, source file and output from `raw` and writes the rest
+// to `args`, reusing its strings so normalizing many entries in a row
+// allocates little.
+void NormalizeArgs(const CompileCommandEntry &entry,
+                   const std::vector<std::string> &raw,
+                   const std::string &output, std::vector<std::string> &args) {
+  const auto file = entry.file.string();
+  std::size_t count = 0;
+  const auto keep = [&](const std::string &arg) {
+    if (count == args.size()) {
+      args.emplace_back();
+    }
+    args[count++] = arg;
+  };
+  for (std::size_t i = 0; i < raw.size(); ++i) {
+    const auto &arg = raw[i];
     if (i == 0 && LooksLikeCompiler(arg)) {
       continue;
     }
-    if (arg == entry.file.string()) {
+    if (arg == file || IsSourceArgument(entry, arg)) {
       continue;
     }
     if (arg == "-c") {
       continue;
     }
-    if (arg == "-o" && i + 1 < entry.args.size()) {
+    if (arg == "-o" && i + 1 < raw.size()) {
       ++i;
       continue;
     }
-    args.push_back(arg);
+    if (!output.empty() && arg.size() == output.size() + 2 &&
+        arg.compare(0, 2, "-o") == 0 && arg.compare(2, arg.npos, output) == 0) {
+      continue;
+    }
+    keep(arg);
   }
+  args.resize(count);
 
   if (!ContainsStandardFlag(args)) {
     args.push_back("-std=c++17");
   }
+}
 
-  return args;
+// Identifies the indexer settings that change the harvested facts, so cached
+// entries produced under different settings are never reused.
+std::string IndexerSettings(const IndexerOptions &options) {
+  std::string settings =
+      options.prune_external ? "prune-external" : "full-traversal";
+  if (options.depth == IndexDepth::kDeclarations) {
+    settings += ";declarations";
+  }
+  if (options.engine == IndexerEngine::kIndexingApi) {
+    settings += ";indexing-api";
+  }
+  return settings;
 }
 
-std::vector<AstFact> CollectFacts(CXTranslationUnit translation_unit,
-                                  const std::filesystem::path &project_root) {
-  FactCollector collector(project_root);
-  const auto root = clang_getTranslationUnitCursor(translation_unit);
-  return collector.Collect(root);
+// The failure's summary followed by the errors recorded with it.
+std::string DescribeFailure(const ParseFailure &failure) {
+  auto description = failure.summary;
+  for (const auto &diagnostic : failure.diagnostics) {
+    description += "; " + diagnostic;
+  }
+  return description;
 }
 
-std::vector<AstFact>
-ExtractFactsFromCommand(CXIndex index, const CompileCommandEntry &entry,
-                        const std::filesystem::path &project_root,
-                        Logger &logger) {
-  const auto args = NormalizeArgs(entry);
-  std::vector<const char *> arg_pointers;
-  arg_pointers.reserve(args.size());
-  for (const auto &arg : args) {
-    arg_pointers.push_back(arg.c_str());
-  }
-
-  CXTranslationUnit translation_unit = nullptr;
-  const auto error = clang_parseTranslationUnit2(
-      index, entry.file.string().c_str(), arg_pointers.data(),
-      static_cast<int>(arg_pointers.size()), nullptr, 0, CXTranslationUnit_None,
-      &translation_unit);
-  logger.Log(LogLevel::kDebug, "Parsing translation unit",
-             {{"file", entry.file.string()},
-              {"arg_count", std::to_string(args.size())},
-              {"result", std::to_string(error)}});
-
-  if (error != CXError_Success || translation_unit == nullptr) {
-    const char *fallback_args[] = {"-std=c++17", entry.file.string().c_str()};
-    const auto fallback_error = clang_parseTranslationUnit2(
-        index, entry.file.string().c_str(), fallback_args, 2, nullptr, 0,
-        CXTranslationUnit_None, &translation_unit);
-    logger.Log(LogLevel::kWarn, "Fallback parse invoked",
-               {{"file", entry.file.string()},
-                {"result", std::to_string(fallback_error)}});
-    if (fallback_error != CXError_Success || translation_unit == nullptr) {
-      return {};
+FactStore IndexTranslationUnit(CXIndex index, CXIndexAction action,
+                               const CompileCommandEntry &entry,
+                               const IndexingContext &context) {
+  const auto &args = context.argument_sets->Arguments(entry.arguments);
+  auto *resident = context.resident;
+  if (resident != nullptr) {
+    if (auto facts = resident->Refresh(entry, args, context)) {
+      return std::move(*facts);
+    }
+  }
+  auto *cache = context.cache;
+  if (cache != nullptr) {
+    if (auto cached = cache->Lookup(entry, args)) {
+      if (!cached->failure) {
+        context.logger->Log(LogLevel::kDebug, "Reused cached translation unit",
+                            {{"file", entry.file.string()}});
+        return std::move(cached->facts);
+      }
+      if (!context.options.retry_failed) {
+        context.logger->Log(LogLevel::kInfo,
+                            "Skipped translation unit that failed before",
+                            {{"file", entry.file.string()},
+                             {"failure", DescribeFailure(*cached->failure)}});
+        context.unparsed->Add("Skipped " + entry.file.string() +
+                              ": it failed to parse in an earlier run and is "
+                              "unchanged (" +
+                              DescribeFailure(*cached->failure) +
+                              "); use --retry-failed to parse it again.");
+        return {};
+      }
     }
   }
 
-  auto facts = CollectFacts(translation_unit, project_root);
-  logger.Log(
-      LogLevel::kInfo, "Collected facts",
-      {{"count", std::to_string(facts.size())}, {"file", entry.file.string()}});
-  clang_disposeTranslationUnit(translation_unit);
-  return facts;
+  auto parsed = resident != nullptr
+                    ? resident->Parse(entry, args, context)
+                    : ExtractFactsFromCommand(index, action, entry, context);
+  if (parsed.failure) {
+    context.unparsed->Add("Could not parse " + entry.file.string() + " (" +
+                          DescribeFailure(*parsed.failure) +
+                          "); it contributed no facts.");
+  }
+  if (cache != nullptr) {
+    if (parsed.parsed) {
+      cache->Store(entry, args, parsed);
+    } else if (parsed.failure) {
+      cache->StoreFailure(entry, args, *parsed.failure);
+    }
+  }
+  return std::move(parsed.facts);
 }
 
 std::filesystem::path
@@ -595,121 +219,63 @@ CanonicalTranslationUnitPath(const std::string &file,
   return std::filesystem::weakly_canonical(path);
 }
 
+// Streams the database entry by entry and keeps the first entry of every
+// existing translation unit inside the project. A malformed file keeps the
+// entries read before the error.
 std::vector<CompileCommandEntry>
-LoadCompileCommandsFromJson(const std::filesystem::path &compile_commands_path,
-                            const std::filesystem::path &project_root) {
-  std::ifstream stream(compile_commands_path);
-  if (!stream.is_open()) {
+LoadCompileCommands(const std::filesystem::path &compile_commands_path,
+                    const std::filesystem::path &project_root,
+                    ArgumentSetPool &argument_sets, Logger &logger) {
+  const auto mapped = MappedFile::Open(compile_commands_path);
+  if (!mapped) {
     return {};
   }
-  const std::string content((std::istreambuf_iterator<char>(stream)),
-                            std::istreambuf_iterator<char>());
-
-  const std::regex object_regex("\\{[^\\}]*\\}");
-  const std::regex file_regex("\\\"file\\\"\\s*:\\s*\\\"([^\\\"]+)\\\"");
-  const std::regex directory_regex(
-      "\\\"directory\\\"\\s*:\\s*\\\"([^\\\"]+)\\\"");
-  const std::regex command_regex("\\\"command\\\"\\s*:\\s*\\\"([^\\\"]+)\\\"");
 
   std::unordered_set<std::string> seen_paths;
+  std::unordered_map<std::string, std::filesystem::path> directories;
   std::vector<CompileCommandEntry> entries;
+  CompileCommandsReader reader(mapped->contents());
+  CompileCommand command;
+  std::vector<std::string> normalized;
+  try {
+    while (reader.Next(command)) {
+      if (command.file.empty()) {
+        continue;
+      }
+      auto path = CanonicalTranslationUnitPath(command.file, command.directory,
+                                               project_root);
+      if (path.empty() || seen_paths.count(path.string()) > 0 ||
+          !std::filesystem::is_regular_file(path) ||
+          !IsWithinCanonical(path, project_root)) {
+        continue;
+      }
 
-  for (std::sregex_iterator
-           object(content.begin(), content.end(), object_regex),
-       end;
-       object != end; ++object) {
-    const auto object_text = object->str();
-    std::smatch file_match;
-    if (!std::regex_search(object_text, file_match, file_regex)) {
-      continue;
-    }
-
-    std::smatch directory_match;
-    const auto directory =
-        std::regex_search(object_text, directory_match, directory_regex)
-            ? directory_match[1].str()
-            : std::string{};
-    const auto path =
-        CanonicalTranslationUnitPath(file_match[1], directory, project_root);
-
-    if (path.empty() || seen_paths.count(path.string()) > 0 ||
-        !std::filesystem::exists(path) ||
-        !std::filesystem::is_regular_file(path) ||
-        !IsWithin(path, project_root)) {
-      continue;
-    }
-
-    std::smatch command_match;
-    const auto args =
-        std::regex_search(object_text, command_match, command_regex)
-            ? TokenizeCommand(command_match[1])
-            : std::vector<std::string>{path.string()};
-
-    CompileCommandEntry entry;
-    entry.file = path;
-    if (!directory.empty()) {
-      entry.directory = std::filesystem::weakly_canonical(directory);
-    }
-    entry.args = args;
-
-    seen_paths.insert(path.string());
-    entries.push_back(std::move(entry));
-  }
-
-  return entries;
-}
-
-std::vector<CompileCommandEntry>
-LoadCompileCommands(const std::filesystem::path &compile_commands_path,
-                    const std::filesystem::path &project_root) {
-  CXCompilationDatabase_Error error = CXCompilationDatabase_NoError;
-  const auto parent = compile_commands_path.parent_path();
-  CXCompilationDatabase database =
-      clang_CompilationDatabase_fromDirectory(parent.string().c_str(), &error);
-
-  if (error != CXCompilationDatabase_NoError || database == nullptr) {
-    return LoadCompileCommandsFromJson(compile_commands_path, project_root);
-  }
-
-  CXCompileCommands commands =
-      clang_CompilationDatabase_getAllCompileCommands(database);
-  const unsigned size = clang_CompileCommands_getSize(commands);
-
-  std::unordered_set<std::string> seen_paths;
-  std::vector<CompileCommandEntry> entries;
-  entries.reserve(size);
-
-  for (unsigned index = 0; index < size; ++index) {
-    CXCompileCommand command =
-        clang_CompileCommands_getCommand(commands, index);
-    const auto file = ToString(clang_CompileCommand_getFilename(command));
-    const auto directory = ToString(clang_CompileCommand_getDirectory(command));
-    auto translation_unit_path =
-        CanonicalTranslationUnitPath(file, directory, project_root);
-
-    if (translation_unit_path.empty() ||
-        seen_paths.count(translation_unit_path.string()) > 0) {
-      continue;
-    }
-    if (!std::filesystem::exists(translation_unit_path) ||
-        !std::filesystem::is_regular_file(translation_unit_path)) {
-      continue;
-    }
-    if (!IsWithin(translation_unit_path, project_root)) {
-      continue;
+      CompileCommandEntry entry;
+      if (!command.directory.empty()) {
+        auto directory = directories.find(command.directory);
+        if (directory == directories.end()) {
+          directory =
+              directories
+                  .emplace(command.directory,
+                           std::filesystem::weakly_canonical(command.directory))
+                  .first;
+        }
+        entry.directory = directory->second;
+      }
+      entry.file = std::move(path);
+      if (command.arguments.empty()) {
+        command.arguments.push_back(entry.file.string());
+      }
+      NormalizeArgs(entry, command.arguments, command.output, normalized);
+      entry.arguments = argument_sets.Intern(normalized);
+      seen_paths.insert(entry.file.string());
+      entries.push_back(std::move(entry));
     }
-
-    seen_paths.insert(translation_unit_path.string());
-    entries.push_back({translation_unit_path,
-                       std::filesystem::weakly_canonical(directory),
-                       ExtractArgs(command)});
-  }
-
-  clang_CompileCommands_dispose(commands);
-  clang_CompilationDatabase_dispose(database);
-
-  if (entries.empty()) {
-    return LoadCompileCommandsFromJson(compile_commands_path, project_root);
+  } catch (const std::runtime_error &error) {
+    logger.Log(LogLevel::kWarn, "Stopped reading malformed compile commands",
+               {{"path", compile_commands_path.string()},
+                {"error", error.what()},
+                {"entries", std::to_string(entries.size())}});
   }
   return entries;
 }
@@ -717,8 +283,10 @@ LoadCompileCommands(const std::filesystem::path &compile_commands_path,
 std::vector<CompileCommandEntry>
 BuildFallbackCommands(const SourceAcquisitionResult &sources,
                       const std::filesystem::path &project_root,
-                      const std::filesystem::path &build_directory) {
+                      const std::filesystem::path &build_directory,
+                      ArgumentSetPool &argument_sets) {
   std::vector<CompileCommandEntry> entries;
+  std::vector<std::string> normalized;
   for (const auto &file : sources.files) {
     std::filesystem::path path(file);
     if (path.is_relative()) {
@@ -727,33 +295,227 @@ BuildFallbackCommands(const SourceAcquisitionResult &sources,
     path = std::filesystem::weakly_canonical(path);
     if (!std::filesystem::exists(path) ||
         !std::filesystem::is_regular_file(path) ||
-        !IsWithin(path, project_root) ||
-        (!build_directory.empty() && IsWithin(path, build_directory))) {
+        !IsWithinCanonical(path, project_root) ||
+        IsWithinCanonical(path, build_directory)) {
       continue;
     }
 
     CompileCommandEntry entry;
     entry.file = path;
     entry.directory = path.parent_path();
-    entry.args = {path.string()};
+    NormalizeArgs(entry, {path.string()}, {}, normalized);
+    entry.arguments = argument_sets.Intern(normalized);
     entries.push_back(std::move(entry));
   }
   return entries;
 }
 
+unsigned ResolveWorkerCount(unsigned requested_jobs, std::size_t work_items) {
+  unsigned workers = requested_jobs;
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return static_cast<unsigned>(
+      std::min<std::size_t>(workers, std::max<std::size_t>(work_items, 1)));
+}
+
+// The order workers take entries in and the estimated parse cost of each,
+// in microseconds.
+struct ParsePlan {
+  std::vector<std::size_t> order;
+  std::vector<std::uint64_t> costs;
+  bool has_history = false;
+};
+
+// Starts the units that took longest in earlier runs first, estimating units
+// without a recorded duration from the size of their main file, so a few
+// huge units do not finish alone while the other workers idle. A single
+// worker gains nothing from reordering and keeps compile-command order.
+ParsePlan PlanParses(const std::vector<CompileCommandEntry> &entries,
+                     const std::vector<ParseTiming> &history,
+                     unsigned worker_count) {
+  std::unordered_map<std::string, std::uint64_t> durations;
+  for (const auto &timing : history) {
+    durations.emplace(timing.file, timing.duration_us);
+  }
+  ParsePlan plan;
+  std::vector<std::optional<std::uint64_t>> recorded(entries.size());
+  std::vector<std::uint64_t> sizes(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const auto found = durations.find(entries[i].file.string());
+    if (found != durations.end()) {
+      recorded[i] = found->second;
+      plan.has_history = true;
+    }
+    std::error_code error;
+    const auto size = std::filesystem::file_size(entries[i].file, error);
+    sizes[i] = error ? 0 : static_cast<std::uint64_t>(size);
+  }
+  plan.costs = EstimateParseCosts(recorded, sizes);
+  if (worker_count > 1) {
+    plan.order = LongestFirstOrder(plan.costs);
+  } else {
+    plan.order.resize(entries.size());
+    std::iota(plan.order.begin(), plan.order.end(), std::size_t{0});
+  }
+  return plan;
+}
+
+// This run's measurements, plus the earlier ones of units that were not
+// parsed this time, such as cache hits. Units no longer compiled are dropped.
+std::vector<ParseTiming>
+UpdateParseTimings(const std::vector<CompileCommandEntry> &entries,
+                   const std::vector<ParseTiming> &history,
+                   const ParseTimings &timings) {
+  std::unordered_map<std::string, const ParseTiming *> previous;
+  for (const auto &timing : history) {
+    previous.emplace(timing.file, &timing);
+  }
+  std::vector<ParseTiming> updated;
+  updated.reserve(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    auto file = entries[i].file.string();
+    if (const auto &measured = timings.measured()[i]) {
+      updated.push_back(
+          {std::move(file), measured->duration_us, measured->fact_count});
+    } else if (const auto found = previous.find(file);
+               found != previous.end()) {
+      updated.push_back(*found->second);
+    }
+  }
+  return updated;
+}
+
+void LogSlowestTranslationUnits(const std::vector<CompileCommandEntry> &entries,
+                                const ParseTimings &timings, Logger &logger) {
+  constexpr std::size_t kSlowestReported = 10;
+  std::vector<std::size_t> parsed;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (timings.measured()[i].has_value()) {
+      parsed.push_back(i);
+    }
+  }
+  const auto reported = std::min(parsed.size(), kSlowestReported);
+  std::partial_sort(parsed.begin(), parsed.begin() + reported, parsed.end(),
+                    [&timings](std::size_t left, std::size_t right) {
+                      return timings.measured()[left]->duration_us >
+                             timings.measured()[right]->duration_us;
+                    });
+  for (std::size_t rank = 0; rank < reported; ++rank) {
+    const auto &measured = *timings.measured()[parsed[rank]];
+    logger.Log(LogLevel::kInfo, "Slow translation unit",
+               {{"rank", std::to_string(rank + 1)},
+                {"file", entries[parsed[rank]].file.string()},
+                {"duration_ms", std::to_string(measured.duration_us / 1000)},
+                {"facts", std::to_string(measured.fact_count)}});
+  }
+}
+
+// Batches a longest-first schedule may hold back per worker while an earlier
+// unit is still parsing, which bounds the facts held in memory at once.
+constexpr std::size_t kWaitingBatchesPerWorker = 8;
+
+// Parses every entry of `order` on a pool of workers, each owning its own
+// CXIndex and taking the next entry when it is free, and streams the results
+// to `sink` in compile-command order regardless of completion order. Entries
+// left out of `order` are delivered as empty batches, so the sink still sees
+// one batch per entry. Returns the most batches that waited for an earlier
+// entry at once.
+std::size_t
+ParseTranslationUnits(const std::vector<CompileCommandEntry> &entries,
+                      const std::vector<std::size_t> &order,
+                      unsigned worker_count, const IndexingContext &context,
+                      FactSink &sink) {
+  OrderedDelivery delivery(order, entries.size(),
+                           kWaitingBatchesPerWorker * worker_count, sink);
+  std::vector<std::exception_ptr> errors(worker_count);
+
+  const auto run_worker = [&](unsigned worker) {
+    CXIndex clang_index = clang_createIndex(0, 1);
+    // One action per worker, so the indexing session spans its entries.
+    CXIndexAction action =
+        context.options.engine == IndexerEngine::kIndexingApi
+            ? clang_IndexAction_create(clang_index)
+            : nullptr;
+    try {
+      while (const auto entry = delivery.Take()) {
+        delivery.Complete(*entry, IndexTranslationUnit(clang_index, action,
+                                                       entries[*entry],
+                                                       context));
+      }
+    } catch (...) {
+      errors[worker] = std::current_exception();
+      delivery.Stop();
+    }
+    if (action != nullptr) {
+      clang_IndexAction_dispose(action);
+    }
+    clang_disposeIndex(clang_index);
+  };
+
+  if (worker_count <= 1) {
+    run_worker(0);
+  } else {
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (unsigned worker = 0; worker < worker_count; ++worker) {
+      workers.emplace_back(run_worker, worker);
+    }
+    for (auto &thread : workers) {
+      thread.join();
+    }
+  }
+
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return delivery.peak_waiting();
+}
+
 } // namespace
 
 CompileCommandsAstIndexer::CompileCommandsAstIndexer(
-    std::filesystem::path compile_commands_path, std::shared_ptr<Logger> logger)
+    std::filesystem::path compile_commands_path, std::shared_ptr<Logger> logger,
+    IndexerOptions options)
     : compile_commands_path_(std::move(compile_commands_path)),
-      logger_(std::move(logger)) {
+      logger_(std::move(logger)), options_(options) {
   if (!logger_) {
     logger_ = std::make_shared<NullLogger>();
   }
+  // The indexing API parses inside clang_indexSourceFile, which leaves no
+  // unit to reparse.
+  if (options_.engine != IndexerEngine::kCursorWalk) {
+    options_.keep_translation_units = false;
+  }
+  if (options_.keep_translation_units) {
+    resident_ = std::make_unique<ResidentTranslationUnits>();
+  }
+}
+
+CompileCommandsAstIndexer::~CompileCommandsAstIndexer() = default;
+
+bool CompileCommandsAstIndexer::UseTranslationUnitCache(
+    std::shared_ptr<const AstCache> cache) {
+  cache_ = std::move(cache);
+  return cache_ != nullptr;
+}
+
+std::vector<std::string> CompileCommandsAstIndexer::IndexingNotes() const {
+  return notes_;
 }
 
 AstIndex
 CompileCommandsAstIndexer::BuildIndex(const SourceAcquisitionResult &sources) {
+  AstIndex index;
+  CollectingFactSink sink(index.facts);
+  StreamIndex(sources, sink);
+  return index;
+}
+
+void CompileCommandsAstIndexer::StreamIndex(
+    const SourceAcquisitionResult &sources, FactSink &sink) {
   if (sources.project_root.empty()) {
     throw std::invalid_argument(
         "SourceAcquisitionResult.project_root is empty");
@@ -769,37 +531,159 @@ CompileCommandsAstIndexer::BuildIndex(const SourceAcquisitionResult &sources) {
                              compile_commands_path.string());
   }
 
-  auto compile_commands =
-      LoadCompileCommands(compile_commands_path, project_root);
+  ArgumentSetPool argument_sets;
+  auto compile_commands = LoadCompileCommands(
+      compile_commands_path, project_root, argument_sets, *logger_);
   if (compile_commands.empty()) {
-    compile_commands =
-        BuildFallbackCommands(sources, project_root, build_directory);
+    compile_commands = BuildFallbackCommands(sources, project_root,
+                                             build_directory, argument_sets);
   }
   logger_->Log(LogLevel::kInfo, "Loaded compile commands",
                {{"entries", std::to_string(compile_commands.size())},
+                {"argument_sets", std::to_string(argument_sets.size())},
                 {"path", compile_commands_path.string()}});
 
-  AstIndex index;
-  std::unordered_set<std::string> seen_facts;
-  CXIndex clang_index = clang_createIndex(0, 1);
-
-  for (const auto &entry : compile_commands) {
-    if (!build_directory.empty() && IsWithin(entry.file, build_directory)) {
-      continue;
-    }
-
-    for (auto &fact :
-         ExtractFactsFromCommand(clang_index, entry, project_root, *logger_)) {
-      const auto fingerprint = fact.name + "|" + fact.kind + "|" + fact.target +
-                               "|" + fact.source_location;
-      if (seen_facts.insert(fingerprint).second) {
-        index.facts.push_back(std::move(fact));
-      }
-    }
+  if (!build_directory.empty()) {
+    compile_commands.erase(
+        std::remove_if(compile_commands.begin(), compile_commands.end(),
+                       [&](const CompileCommandEntry &entry) {
+                         return IsWithinCanonical(entry.file,
+                                                  build_directory);
+                       }),
+        compile_commands.end());
+  }
+
+  const auto worker_count =
+      ResolveWorkerCount(options_.jobs, compile_commands.size());
+  logger_->Log(LogLevel::kInfo, "Parsing translation units",
+               {{"entries", std::to_string(compile_commands.size())},
+                {"jobs", std::to_string(worker_count)}});
+  if (options_.changes && cache_) {
+    logger_->Log(LogLevel::kInfo, "Trusting cached units recorded at revision",
+                 {{"revision", options_.changes->revision},
+                  {"changed_files",
+                   std::to_string(options_.changes->changed.size())}});
+  }
+  FileHashes file_hashes(options_.changes);
+  std::optional<TranslationUnitCacheSession> cache;
+  if (cache_) {
+    cache.emplace(*cache_, file_hashes, ToolchainVersion(),
+                  IndexerSettings(options_));
+  }
+  std::optional<ResidentUnitSession> resident;
+  if (resident_) {
+    resident.emplace(*resident_, file_hashes, ToolchainVersion(),
+                     IndexerSettings(options_));
+  }
+  std::optional<PrecompiledHeaderSession> precompiled_headers;
+  // The indexing API reports nothing for declarations read from an AST file,
+  // so its units are always parsed from source. Kept units are reparsed
+  // with their own preamble, and a header in a temporary directory would
+  // not outlive the run.
+  if (options_.precompile_headers &&
+      options_.engine == IndexerEngine::kCursorWalk && !resident) {
+    precompiled_headers.emplace(
+        cache_ ? cache_->Directory() / "pch" : std::filesystem::path{},
+        ToolchainVersion() + ";" + IndexerSettings(options_));
+    precompiled_headers->Plan(compile_commands, argument_sets);
+  }
+  UnparsedTranslationUnits unparsed;
+  // Cached and kept units must hold all of their own facts, so they cannot
+  // leave shared headers to an earlier unit.
+  std::optional<HarvestedDeclarations> harvested;
+  if (!cache && !resident && options_.engine == IndexerEngine::kCursorWalk) {
+    harvested.emplace(file_hashes);
+  }
+  for (std::size_t i = 0; i < compile_commands.size(); ++i) {
+    compile_commands[i].position = i;
+  }
+  const auto history =
+      cache_ ? cache_->LoadParseTimings() : std::vector<ParseTiming>{};
+  auto plan = PlanParses(compile_commands, history, worker_count);
+  if (options_.shard) {
+    plan.order.erase(std::remove_if(plan.order.begin(), plan.order.end(),
+                                    [&](std::size_t entry) {
+                                      return !InShard(
+                                          compile_commands[entry].file
+                                              .lexically_relative(project_root)
+                                              .generic_string(),
+                                          *options_.shard);
+                                    }),
+                     plan.order.end());
+    logger_->Log(LogLevel::kInfo, "Indexing shard",
+                 {{"shard", std::to_string(options_.shard->index) + "/" +
+                                std::to_string(options_.shard->count)},
+                  {"entries", std::to_string(plan.order.size())}});
+  }
+  ParseTimings timings(compile_commands.size());
+  IndexingContext context{project_root,
+                          options_,
+                          &argument_sets,
+                          cache ? &*cache : nullptr,
+                          resident ? &*resident : nullptr,
+                          precompiled_headers ? &*precompiled_headers
+                                              : nullptr,
+                          &unparsed,
+                          harvested ? &*harvested : nullptr,
+                          &timings,
+                          std::is_sorted(plan.order.begin(), plan.order.end()),
+                          logger_.get()};
+  DeduplicatingFactSink unique_facts(sink);
+  notes_.clear();
+  const auto started = std::chrono::steady_clock::now();
+  const auto peak_waiting = ParseTranslationUnits(
+      compile_commands, plan.order, worker_count, context, unique_facts);
+  const auto makespan = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - started);
+  notes_ = unparsed.Notes();
+  logger_->Log(
+      LogLevel::kInfo, "Parse schedule",
+      {{"order", context.in_order ? "compile-commands" : "longest-first"},
+       {"predicted_makespan_ms",
+        plan.has_history
+            ? std::to_string(
+                  PredictMakespan(plan.costs, plan.order, worker_count) / 1000)
+            : "unknown"},
+       {"actual_makespan_ms", std::to_string(makespan.count())},
+       {"peak_waiting_batches", std::to_string(peak_waiting)}});
+  LogSlowestTranslationUnits(compile_commands, timings, *logger_);
+  if (cache_) {
+    cache_->StoreParseTimings(
+        UpdateParseTimings(compile_commands, history, timings));
+  }
+  if (resident) {
+    resident->Finish();
+    logger_->Log(LogLevel::kInfo, "Resident translation units",
+                 {{"kept", std::to_string(resident_->size())},
+                  {"reused", std::to_string(resident->reused())},
+                  {"reparsed", std::to_string(resident->reparsed())}});
+  }
+  if (harvested) {
+    logger_->Log(LogLevel::kInfo, "Shared headers",
+                 {{"harvested", std::to_string(harvested->headers())},
+                  {"skipped_declarations",
+                   std::to_string(harvested->skipped())}});
+  }
+  if (precompiled_headers) {
+    logger_->Log(
+        LogLevel::kInfo, "Precompiled headers",
+        {{"planned", std::to_string(precompiled_headers->planned())},
+         {"built", std::to_string(precompiled_headers->built())},
+         {"skipped", std::to_string(precompiled_headers->failed())},
+         {"build_ms",
+          std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+                             precompiled_headers->build_time())
+                             .count())},
+         {"directory", precompiled_headers->directory().string()}});
+  }
+  if (cache) {
+    logger_->Log(LogLevel::kInfo, "Translation unit cache",
+                 {{"hits", std::to_string(cache->hits())},
+                  {"misses", std::to_string(cache->misses())},
+                  {"known_failures", std::to_string(cache->known_failures())},
+                  {"retry_failed", options_.retry_failed ? "true" : "false"}});
   }
-
-  clang_disposeIndex(clang_index);
-  return index;
 }
 
 } // namespace dsl
+
@@ -0,0 +1,398 @@
+#include <dsl/compile_commands_loader.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Nesting allowed inside values of unknown keys before input is rejected, so
+// hostile files cannot exhaust the stack.
+constexpr unsigned kMaxSkippedDepth = 64;
+
+bool IsWhitespace(char character) {
+  return character == ' ' || character == '\n' || character == '\r' ||
+         character == '\t';
+}
+
+int HexDigit(char character) {
+  if (character >= '0' && character <= '9') {
+    return character - '0';
+  }
+  if (character >= 'a' && character <= 'f') {
+    return character - 'a' + 10;
+  }
+  if (character >= 'A' && character <= 'F') {
+    return character - 'A' + 10;
+  }
+  return -1;
+}
+
+void AppendUtf8(std::uint32_t code_point, std::string &value) {
+  if (code_point < 0x80) {
+    value.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    value.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+    value.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else if (code_point < 0x10000) {
+    value.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+    value.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    value.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else {
+    value.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+    value.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+    value.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    value.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+}
+
+// Splits into `arguments`, reusing its strings like ReadStringArray does.
+void SplitCommandLineInto(std::string_view command,
+                          std::vector<std::string> &arguments) {
+  std::size_t count = 0;
+  std::size_t i = 0;
+  while (true) {
+    while (i < command.size() && IsWhitespace(command[i])) {
+      ++i;
+    }
+    if (i >= command.size()) {
+      break;
+    }
+    if (count == arguments.size()) {
+      arguments.emplace_back();
+    }
+    auto &current = arguments[count++];
+    current.clear();
+    while (i < command.size() && !IsWhitespace(command[i])) {
+      const auto character = command[i];
+      if (character == '\\' && i + 1 < command.size()) {
+        current.push_back(command[i + 1]);
+        i += 2;
+      } else if (character == '\'') {
+        const auto end = command.find('\'', i + 1);
+        const auto stop = end == std::string_view::npos ? command.size() : end;
+        current.append(command.substr(i + 1, stop - i - 1));
+        i = stop + 1;
+      } else if (character == '"') {
+        for (++i; i < command.size() && command[i] != '"'; ++i) {
+          if (command[i] == '\\' && i + 1 < command.size()) {
+            ++i;
+          }
+          current.push_back(command[i]);
+        }
+        ++i;
+      } else {
+        // Copy plain runs in one go; most arguments contain no quoting. A
+        // trailing lone backslash is kept as is.
+        const auto end = command.find_first_of(" \t\r\n\\'\"", i + 1);
+        const auto stop = end == std::string_view::npos ? command.size() : end;
+        current.append(command.substr(i, stop - i));
+        i = stop;
+      }
+    }
+  }
+  arguments.resize(count);
+}
+
+} // namespace
+
+namespace dsl {
+
+CompileCommandsReader::CompileCommandsReader(std::string_view json)
+    : json_(json) {}
+
+bool CompileCommandsReader::Next(CompileCommand &command) {
+  if (state_ == State::kDone) {
+    return false;
+  }
+  if (state_ == State::kStart) {
+    Expect('[');
+    if (Peek() == ']') {
+      return Finish();
+    }
+  } else {
+    const auto separator = Peek();
+    if (separator == ']') {
+      return Finish();
+    }
+    if (separator != ',') {
+      Fail("expected ',' or ']' after entry");
+    }
+    ++position_;
+  }
+  ReadEntry(command);
+  state_ = State::kNextEntry;
+  return true;
+}
+
+bool CompileCommandsReader::Finish() {
+  ++position_;
+  if (Peek() != '\0') {
+    Fail("unexpected data after the closing bracket");
+  }
+  state_ = State::kDone;
+  return false;
+}
+
+void CompileCommandsReader::ReadEntry(CompileCommand &command) {
+  command.directory.clear();
+  command.file.clear();
+  command.output.clear();
+  command_.clear();
+  bool has_arguments = false;
+  bool has_command = false;
+
+  Expect('{');
+  if (Peek() == '}') {
+    ++position_;
+    command.arguments.clear();
+    return;
+  }
+  while (true) {
+    SkipWhitespace();
+    ReadString(key_);
+    Expect(':');
+    SkipWhitespace();
+    if (key_ == "directory") {
+      ReadString(command.directory);
+    } else if (key_ == "file") {
+      ReadString(command.file);
+    } else if (key_ == "output") {
+      ReadString(command.output);
+    } else if (key_ == "arguments") {
+      ReadStringArray(command.arguments);
+      has_arguments = true;
+    } else if (key_ == "command") {
+      ReadString(command_);
+      has_command = true;
+    } else {
+      SkipValue(0);
+    }
+    const auto separator = Peek();
+    ++position_;
+    if (separator == '}') {
+      break;
+    }
+    if (separator != ',') {
+      --position_;
+      Fail("expected ',' or '}' in entry");
+    }
+  }
+  if (!has_arguments) {
+    SplitCommandLineInto(has_command ? command_ : std::string_view{},
+                         command.arguments);
+  }
+}
+
+void CompileCommandsReader::ReadString(std::string &value) {
+  value.clear();
+  if (position_ >= json_.size() || json_[position_] != '"') {
+    Fail("expected string");
+  }
+  ++position_;
+  while (true) {
+    // Copy the run up to the next quote or escape in one go.
+    const auto *begin = json_.data() + position_;
+    const auto remaining = json_.size() - position_;
+    std::size_t run = 0;
+    while (run < remaining && begin[run] != '"' && begin[run] != '\\') {
+      if (static_cast<unsigned char>(begin[run]) < 0x20) {
+        position_ += run;
+        Fail("control character in string");
+      }
+      ++run;
+    }
+    value.append(begin, run);
+    position_ += run;
+    if (position_ >= json_.size()) {
+      Fail("unterminated string");
+    }
+    if (json_[position_++] == '"') {
+      return;
+    }
+    if (position_ >= json_.size()) {
+      Fail("unterminated escape");
+    }
+    const auto escape = json_[position_++];
+    switch (escape) {
+    case '"':
+    case '\\':
+    case '/':
+      value.push_back(escape);
+      break;
+    case 'b':
+      value.push_back('\b');
+      break;
+    case 'f':
+      value.push_back('\f');
+      break;
+    case 'n':
+      value.push_back('\n');
+      break;
+    case 'r':
+      value.push_back('\r');
+      break;
+    case 't':
+      value.push_back('\t');
+      break;
+    case 'u': {
+      auto read_unit = [this]() {
+        if (json_.size() - position_ < 4) {
+          Fail("truncated \\u escape");
+        }
+        std::uint32_t unit = 0;
+        for (int i = 0; i < 4; ++i) {
+          const auto digit = HexDigit(json_[position_++]);
+          if (digit < 0) {
+            Fail("invalid \\u escape");
+          }
+          unit = (unit << 4) | static_cast<std::uint32_t>(digit);
+        }
+        return unit;
+      };
+      auto code_point = read_unit();
+      if (code_point >= 0xd800 && code_point < 0xdc00) {
+        if (json_.substr(position_, 2) != "\\u") {
+          Fail("unpaired surrogate");
+        }
+        position_ += 2;
+        const auto low = read_unit();
+        if (low < 0xdc00 || low >= 0xe000) {
+          Fail("unpaired surrogate");
+        }
+        code_point =
+            0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+      } else if (code_point >= 0xdc00 && code_point < 0xe000) {
+        Fail("unpaired surrogate");
+      }
+      AppendUtf8(code_point, value);
+      break;
+    }
+    default:
+      --position_;
+      Fail("invalid escape");
+    }
+  }
+}
+
+// Reuses the strings already in `values`, so reading entry after entry into
+// the same command stops allocating once the longest argument list is seen.
+void CompileCommandsReader::ReadStringArray(std::vector<std::string> &values) {
+  std::size_t count = 0;
+  Expect('[');
+  if (Peek() == ']') {
+    ++position_;
+    values.clear();
+    return;
+  }
+  while (true) {
+    SkipWhitespace();
+    if (count == values.size()) {
+      values.emplace_back();
+    }
+    ReadString(values[count++]);
+    const auto separator = Peek();
+    ++position_;
+    if (separator == ']') {
+      values.resize(count);
+      return;
+    }
+    if (separator != ',') {
+      --position_;
+      Fail("expected ',' or ']' in arguments");
+    }
+  }
+}
+
+void CompileCommandsReader::SkipValue(unsigned depth) {
+  if (depth > kMaxSkippedDepth) {
+    Fail("value nested too deeply");
+  }
+  const auto first = Peek();
+  if (first == '"') {
+    ReadString(key_);
+    return;
+  }
+  if (first != '{' && first != '[') {
+    SkipLiteral();
+    return;
+  }
+  const char close = first == '{' ? '}' : ']';
+  ++position_;
+  if (Peek() == close) {
+    ++position_;
+    return;
+  }
+  while (true) {
+    if (close == '}') {
+      SkipWhitespace();
+      ReadString(key_);
+      Expect(':');
+    }
+    SkipWhitespace();
+    SkipValue(depth + 1);
+    const auto separator = Peek();
+    ++position_;
+    if (separator == close) {
+      return;
+    }
+    if (separator != ',') {
+      --position_;
+      Fail("expected ',' in nested value");
+    }
+  }
+}
+
+// Numbers, true, false and null; only their extent matters here.
+void CompileCommandsReader::SkipLiteral() {
+  const auto begin = position_;
+  while (position_ < json_.size()) {
+    const auto character = json_[position_];
+    if (IsWhitespace(character) || character == ',' || character == '}' ||
+        character == ']') {
+      break;
+    }
+    if (std::strchr("+-.0123456789Eaeflnrstu", character) == nullptr) {
+      Fail("unexpected character");
+    }
+    ++position_;
+  }
+  if (position_ == begin) {
+    Fail("expected value");
+  }
+}
+
+void CompileCommandsReader::SkipWhitespace() {
+  while (position_ < json_.size() && IsWhitespace(json_[position_])) {
+    ++position_;
+  }
+}
+
+void CompileCommandsReader::Expect(char expected) {
+  if (Peek() != expected) {
+    Fail(std::string("expected '") + expected + "'");
+  }
+  ++position_;
+}
+
+// Skips whitespace and returns the next character, or '\0' at the end.
+char CompileCommandsReader::Peek() {
+  SkipWhitespace();
+  return position_ < json_.size() ? json_[position_] : '\0';
+}
+
+void CompileCommandsReader::Fail(const std::string &message) const {
+  throw std::runtime_error("Malformed compile_commands.json at offset " +
+                           std::to_string(position_) + ": " + message);
+}
+
+std::vector<std::string> SplitCommandLine(std::string_view command) {
+  std::vector<std::string> arguments;
+  SplitCommandLineInto(command, arguments);
+  return arguments;
+}
+
+} // namespace dsl
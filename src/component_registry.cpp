@@ -5,6 +5,7 @@
 #include <dsl/rule_based_coherence_analyzer.h>
 
 #include <algorithm>
+#include <filesystem>
 #include <stdexcept>
 #include <utility>
 
@@ -13,6 +14,8 @@ namespace {
 constexpr const char kDefaultExtractor[] = "heuristic";
 constexpr const char kDefaultAnalyzer[] = "rule-based";
 constexpr const char kDefaultReporter[] = "markdown";
+constexpr const char kDefaultIndexer[] = "cursor";
+constexpr const char kIndexingApiIndexer[] = "indexing-api";
 
 } // namespace
 
@@ -43,11 +46,12 @@ std::string ComponentRegistry::JoinNames(const ComponentSet<Factory> &set) {
   return message;
 }
 
-template <typename Interface, typename Factory>
+template <typename Interface, typename Factory, typename... Args>
 std::unique_ptr<Interface>
 ComponentRegistry::CreateComponent(const std::string &name,
                                    const ComponentSet<Factory> &set,
-                                   const std::string &kind) const {
+                                   const std::string &kind,
+                                   Args... args) const {
   const auto target_name = name.empty() ? set.default_name : name;
   if (target_name.empty()) {
     throw std::invalid_argument("No default " + kind + " registered");
@@ -57,7 +61,7 @@ ComponentRegistry::CreateComponent(const std::string &name,
     throw std::invalid_argument("Unknown " + kind + " '" + target_name +
                                 "'. Registered: " + JoinNames(set));
   }
-  auto instance = found->second();
+  auto instance = found->second(std::move(args)...);
   if (!instance) {
     throw std::runtime_error("Factory for " + kind + " '" + target_name +
                              "' returned null");
@@ -103,6 +107,12 @@ void ComponentRegistry::RegisterReporter(const std::string &name,
   RegisterComponent(name, std::move(factory), set_as_default, reporters_);
 }
 
+void ComponentRegistry::RegisterIndexer(const std::string &name,
+                                        IndexerFactory factory,
+                                        bool set_as_default) {
+  RegisterComponent(name, std::move(factory), set_as_default, indexers_);
+}
+
 std::unique_ptr<DslExtractor>
 ComponentRegistry::CreateExtractor(const std::string &name) const {
   return CreateComponent<DslExtractor>(name, extractors_, "extractor");
@@ -118,6 +128,14 @@ ComponentRegistry::CreateReporter(const std::string &name) const {
   return CreateComponent<Reporter>(name, reporters_, "reporter");
 }
 
+std::unique_ptr<AstIndexer>
+ComponentRegistry::CreateIndexer(const std::string &name,
+                                 std::shared_ptr<Logger> logger,
+                                 IndexerOptions options) const {
+  return CreateComponent<AstIndexer>(name, indexers_, "indexer",
+                                     std::move(logger), std::move(options));
+}
+
 std::vector<std::string> ComponentRegistry::ExtractorNames() const {
   return RegisteredNames(extractors_);
 }
@@ -130,6 +148,10 @@ std::vector<std::string> ComponentRegistry::ReporterNames() const {
   return RegisteredNames(reporters_);
 }
 
+std::vector<std::string> ComponentRegistry::IndexerNames() const {
+  return RegisteredNames(indexers_);
+}
+
 const std::string &ComponentRegistry::DefaultExtractorName() const {
   return extractors_.default_name;
 }
@@ -142,6 +164,10 @@ const std::string &ComponentRegistry::DefaultReporterName() const {
   return reporters_.default_name;
 }
 
+const std::string &ComponentRegistry::DefaultIndexerName() const {
+  return indexers_.default_name;
+}
+
 ComponentRegistry MakeComponentRegistryWithDefaults() {
   ComponentRegistry registry;
   registry.RegisterExtractor(
@@ -153,6 +179,21 @@ ComponentRegistry MakeComponentRegistryWithDefaults() {
   registry.RegisterReporter(
       kDefaultReporter, []() { return std::make_unique<MarkdownReporter>(); },
       true);
+  registry.RegisterIndexer(
+      kDefaultIndexer,
+      [](std::shared_ptr<Logger> logger, IndexerOptions options) {
+        options.engine = IndexerEngine::kCursorWalk;
+        return std::make_unique<CompileCommandsAstIndexer>(
+            std::filesystem::path{}, std::move(logger), options);
+      },
+      true);
+  registry.RegisterIndexer(
+      kIndexingApiIndexer,
+      [](std::shared_ptr<Logger> logger, IndexerOptions options) {
+        options.engine = IndexerEngine::kIndexingApi;
+        return std::make_unique<CompileCommandsAstIndexer>(
+            std::filesystem::path{}, std::move(logger), options);
+      });
   return registry;
 }
 
@@ -182,6 +223,14 @@ ComponentRegistry::CreateComponent<Reporter,
     const ComponentSet<ComponentRegistry::ReporterFactory> &,
     const std::string &) const;
 
+template std::unique_ptr<AstIndexer>
+ComponentRegistry::CreateComponent<AstIndexer,
+                                   ComponentRegistry::IndexerFactory,
+                                   std::shared_ptr<Logger>, IndexerOptions>(
+    const std::string &,
+    const ComponentSet<ComponentRegistry::IndexerFactory> &,
+    const std::string &, std::shared_ptr<Logger>, IndexerOptions) const;
+
 template void
 ComponentRegistry::RegisterComponent<ComponentRegistry::ExtractorFactory>(
     const std::string &, ComponentRegistry::ExtractorFactory, bool,
@@ -197,4 +246,9 @@ ComponentRegistry::RegisterComponent<ComponentRegistry::ReporterFactory>(
     const std::string &, ComponentRegistry::ReporterFactory, bool,
     ComponentSet<ComponentRegistry::ReporterFactory> &);
 
+template void
+ComponentRegistry::RegisterComponent<ComponentRegistry::IndexerFactory>(
+    const std::string &, ComponentRegistry::IndexerFactory, bool,
+    ComponentSet<ComponentRegistry::IndexerFactory> &);
+
 } // namespace dsl
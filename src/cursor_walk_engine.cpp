@@ -0,0 +1,455 @@
+#include <dsl/cursor_walk_engine.h>
+
+#include <dsl/fact_builder.h>
+#include <dsl/hashing.h>
+#include <dsl/leading_includes.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+namespace dsl {
+
+namespace {
+
+class FactCollector : public FactBuilder {
+public:
+  // `project_root` must already be canonical. With `harvested`, declarations
+  // an earlier unit of the run parsed with the same `arguments` covered are
+  // skipped and this unit's coverage is recorded at `position`.
+  FactCollector(std::filesystem::path project_root,
+                const IndexerOptions &options,
+                HarvestedDeclarations *harvested = nullptr,
+                std::size_t position = 0, ArgumentSetId arguments = 0)
+      : FactBuilder(std::move(project_root)),
+        prune_external_(options.prune_external),
+        declarations_only_(options.depth == IndexDepth::kDeclarations),
+        harvested_(harvested), position_(position), arguments_(arguments) {}
+
+  FactStore Collect(CXTranslationUnit translation_unit) {
+    translation_unit_ = translation_unit;
+    if (harvested_ != nullptr) {
+      FindSharedContextHeaders();
+    }
+    Traverse(clang_getTranslationUnitCursor(translation_unit));
+    if (harvested_ != nullptr) {
+      std::vector<std::string> headers;
+      for (const auto &[file, header] : headers_) {
+        if (header.shared_context && header.guarded &&
+            !header.harvested_before) {
+          headers.push_back(header.path);
+        }
+      }
+      harvested_->Record(arguments_, position_, headers, emitted_, skipped_);
+    }
+    return TakeFacts();
+  }
+
+private:
+  struct EntityScope {
+    explicit EntityScope(std::vector<Entity> &stack)
+        : stack_(&stack), active_(true) {}
+
+    EntityScope(const EntityScope &) = delete;
+    EntityScope &operator=(const EntityScope &) = delete;
+
+    EntityScope(EntityScope &&other) noexcept
+        : stack_(other.stack_), active_(other.active_) {
+      other.stack_ = nullptr;
+      other.active_ = false;
+    }
+
+    EntityScope &operator=(EntityScope &&other) noexcept {
+      if (this == &other) {
+        return *this;
+      }
+      Release();
+      stack_ = other.stack_;
+      active_ = other.active_;
+      other.stack_ = nullptr;
+      other.active_ = false;
+      return *this;
+    }
+
+    ~EntityScope() { Release(); }
+
+  private:
+    void Release() {
+      if (active_ && stack_ != nullptr) {
+        stack_->pop_back();
+        active_ = false;
+      }
+    }
+
+    std::vector<Entity> *stack_;
+    bool active_;
+  };
+
+  struct HeaderFile {
+    bool is_header = false;
+    bool shared_context = false;
+    bool guarded = false;
+    bool harvested_before = false;
+    std::string path;
+    std::uint64_t path_hash = 0;
+  };
+
+  const HeaderFile &Header(CXFile file, CXSourceLocation location) {
+    const auto [entry, inserted] = headers_.try_emplace(file);
+    auto &header = entry->second;
+    if (inserted && !clang_Location_isFromMainFile(location)) {
+      header.is_header = true;
+      header.path = ToString(clang_getFileName(file));
+      header.path_hash = Fnv1a64(header.path);
+      header.shared_context = shared_context_.count(file) != 0;
+      // Unguarded files may be included for their context, like X-macro
+      // lists, and must be traversed in every unit.
+      header.guarded =
+          clang_isFileMultipleIncludeGuarded(translation_unit_, file) != 0;
+      header.harvested_before =
+          header.shared_context && header.guarded &&
+          harvested_->HeaderHarvestedBefore(arguments_, header.path,
+                                            position_);
+    }
+    return header;
+  }
+
+  // Collects the headers the main file includes itself, at file scope and
+  // before it defines or undefines a macro. Those preprocess the same in
+  // every unit with the same arguments that includes them this way, so
+  // only their declarations are shared between units. A header included
+  // inside a namespace or after a #define, or only by another header, is
+  // always traversed. Macros set by headers included earlier are not told
+  // apart.
+  void FindSharedContextHeaders() {
+    struct Inclusions {
+      CXFile main_file = nullptr;
+      std::vector<std::pair<CXFile, unsigned>> direct;
+    } inclusions;
+    clang_getInclusions(
+        translation_unit_,
+        [](CXFile file, CXSourceLocation *stack, unsigned depth,
+           CXClientData data) {
+          auto *found = static_cast<Inclusions *>(data);
+          if (depth == 0) {
+            found->main_file = file;
+          } else if (depth == 1) {
+            unsigned offset = 0;
+            clang_getFileLocation(stack[0], nullptr, nullptr, nullptr,
+                                  &offset);
+            found->direct.emplace_back(file, offset);
+          }
+        },
+        &inclusions);
+    if (inclusions.main_file == nullptr || inclusions.direct.empty()) {
+      return;
+    }
+
+    std::size_t size = 0;
+    const auto *contents =
+        clang_getFileContents(translation_unit_, inclusions.main_file, &size);
+    const auto first_macro =
+        contents != nullptr
+            ? FirstMacroDirective(std::string_view(contents, size))
+            : std::size_t{0};
+    std::vector<std::pair<unsigned, unsigned>> scopes;
+    clang_visitChildren(
+        clang_getTranslationUnitCursor(translation_unit_),
+        [](CXCursor child, CXCursor, CXClientData data) {
+          const auto extent = clang_getCursorExtent(child);
+          const auto start = clang_getRangeStart(extent);
+          if (clang_Location_isFromMainFile(start)) {
+            unsigned begin = 0;
+            unsigned end = 0;
+            clang_getFileLocation(start, nullptr, nullptr, nullptr, &begin);
+            clang_getFileLocation(clang_getRangeEnd(extent), nullptr, nullptr,
+                                  nullptr, &end);
+            static_cast<std::vector<std::pair<unsigned, unsigned>> *>(data)
+                ->emplace_back(begin, end);
+          }
+          return CXChildVisit_Continue;
+        },
+        &scopes);
+
+    for (const auto &[file, offset] : inclusions.direct) {
+      const auto in_scope = std::any_of(
+          scopes.begin(), scopes.end(), [offset = offset](const auto &scope) {
+            return scope.first <= offset && offset < scope.second;
+          });
+      if (offset < first_macro && !in_scope) {
+        shared_context_.insert(file);
+      }
+    }
+  }
+
+  // Whether an earlier unit of the run emitted everything under `cursor`: it
+  // lies in a header that unit traversed, or it is an entity definition in a
+  // header that unit emitted. Definitions in the main file, or in a header
+  // included in another context, are never shared.
+  bool CoveredEarlier(CXCursor cursor, CXCursorKind kind,
+                      CXSourceLocation location) {
+    CXFile file{};
+    clang_getFileLocation(location, &file, nullptr, nullptr, nullptr);
+    if (file == nullptr) {
+      return false;
+    }
+    const auto &header = Header(file, location);
+    if (!header.is_header || !header.shared_context) {
+      return false;
+    }
+    if (header.harvested_before) {
+      ++skipped_;
+      return true;
+    }
+    if (!IsEntityKind(kind) || !clang_isCursorDefinition(cursor)) {
+      return false;
+    }
+    const auto usr = ToString(clang_getCursorUSR(cursor));
+    if (usr.empty()) {
+      return false;
+    }
+    const auto key = Fnv1a64(usr, header.path_hash);
+    if (harvested_->DefinitionEmittedBefore(arguments_, key, position_)) {
+      ++skipped_;
+      return true;
+    }
+    emitted_.push_back(key);
+    return false;
+  }
+
+  const Entity *CurrentEntity() const {
+    if (entity_stack_.empty()) {
+      return nullptr;
+    }
+    return &entity_stack_.back();
+  }
+
+  std::optional<EntityScope> EnterEntity(CXCursor cursor, CXCursorKind kind) {
+    if (!IsEntityKind(kind)) {
+      return std::nullopt;
+    }
+    if (!clang_isCursorDefinition(cursor)) {
+      return std::nullopt;
+    }
+
+    auto name = names().QualifiedName(cursor);
+    if (name.empty()) {
+      return std::nullopt;
+    }
+
+    entity_stack_.push_back(
+        {std::move(name), ToString(clang_getCursorUSR(cursor))});
+    return EntityScope(entity_stack_);
+  }
+
+  void AddSymbol(CXCursor cursor, const std::string &kind) {
+    if (!clang_isCursorDefinition(cursor)) {
+      return;
+    }
+    AddSymbolFact(cursor, kind, names().QualifiedName(cursor),
+                  names().ScopePath(cursor));
+  }
+
+  void AddOwnership(CXCursor cursor) {
+    if (const auto *owner = CurrentEntity()) {
+      AddOwnershipFact(cursor, *owner, names().ScopePath(cursor));
+    }
+  }
+
+  void AddCall(CXCursor cursor) {
+    const auto *caller = CurrentEntity();
+    if (caller == nullptr) {
+      return;
+    }
+
+    const auto referenced = clang_getCursorReferenced(cursor);
+    auto target_name = names().QualifiedName(referenced);
+    if (target_name.empty()) {
+      target_name = ToString(clang_getCursorDisplayName(cursor));
+    }
+    AddCallFact(cursor, referenced, *caller, target_name,
+                names().ScopePath(cursor));
+  }
+
+  void AddTypeUsage(CXCursor cursor) {
+    if (const auto *subject = CurrentEntity()) {
+      AddTypeUsageFact(cursor, *subject, names().ScopePath(cursor));
+    }
+  }
+
+  void Traverse(CXCursor cursor) {
+    const auto kind = clang_getCursorKind(cursor);
+    const auto location = clang_getCursorLocation(cursor);
+    const bool in_project = IdentifyFile(location).in_project;
+    // Declarations outside the project cannot contain project entities, so
+    // their subtrees (most of the standard library, for example) are skipped.
+    if (prune_external_ && clang_isDeclaration(kind) &&
+        (!in_project || clang_Location_isInSystemHeader(location))) {
+      return;
+    }
+    if (harvested_ != nullptr && clang_isDeclaration(kind) &&
+        CoveredEarlier(cursor, kind, location)) {
+      return;
+    }
+    std::optional<EntityScope> scope;
+    if (in_project) {
+      scope = EnterEntity(cursor, kind);
+      switch (kind) {
+      case CXCursor_FunctionDecl:
+      case CXCursor_CXXMethod:
+      case CXCursor_Constructor:
+      case CXCursor_FunctionTemplate:
+        AddSymbol(cursor, "function");
+        // Without bodies, a function's children only hold parameters and
+        // type references, which yield nothing at this depth.
+        if (declarations_only_) {
+          return;
+        }
+        break;
+      case CXCursor_StructDecl:
+      case CXCursor_ClassDecl:
+      case CXCursor_EnumDecl:
+        AddSymbol(cursor, "type");
+        break;
+      case CXCursor_VarDecl:
+        AddSymbol(cursor, "variable");
+        break;
+      case CXCursor_FieldDecl:
+        AddOwnership(cursor);
+        break;
+      case CXCursor_CallExpr:
+        if (!declarations_only_) {
+          AddCall(cursor);
+        }
+        break;
+      case CXCursor_TypeRef:
+        if (!declarations_only_) {
+          AddTypeUsage(cursor);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+
+    clang_visitChildren(
+        cursor,
+        [](CXCursor child, CXCursor, CXClientData data) {
+          auto *collector = static_cast<FactCollector *>(data);
+          collector->Traverse(child);
+          return CXChildVisit_Continue;
+        },
+        this);
+  }
+
+  bool prune_external_;
+  bool declarations_only_;
+  HarvestedDeclarations *harvested_;
+  std::size_t position_;
+  ArgumentSetId arguments_;
+  CXTranslationUnit translation_unit_ = nullptr;
+  std::unordered_set<CXFile> shared_context_;
+  std::unordered_map<CXFile, HeaderFile> headers_;
+  std::vector<std::uint64_t> emitted_;
+  std::size_t skipped_ = 0;
+  std::vector<Entity> entity_stack_;
+};
+
+} // namespace
+
+bool HarvestedDeclarations::HeaderHarvestedBefore(ArgumentSetId arguments,
+                                                  const std::string &path,
+                                                  std::size_t position) {
+  std::optional<std::uint64_t> content_hash;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto scope = scopes_.find(arguments);
+    if (scope == scopes_.end()) {
+      return false;
+    }
+    const auto found = scope->second.headers.find(path);
+    if (found == scope->second.headers.end() ||
+        found->second.position >= position) {
+      return false;
+    }
+    content_hash = found->second.content_hash;
+  }
+  return content_hash.has_value() && hashes_->Hash(path) == content_hash;
+}
+
+bool HarvestedDeclarations::DefinitionEmittedBefore(ArgumentSetId arguments,
+                                                    std::uint64_t key,
+                                                    std::size_t position) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  const auto scope = scopes_.find(arguments);
+  if (scope == scopes_.end()) {
+    return false;
+  }
+  const auto found = scope->second.definitions.find(key);
+  return found != scope->second.definitions.end() && found->second < position;
+}
+
+void HarvestedDeclarations::Record(
+    ArgumentSetId arguments, std::size_t position,
+    const std::vector<std::string> &headers,
+    const std::vector<std::uint64_t> &definitions, std::size_t skipped) {
+  skipped_.fetch_add(skipped);
+  std::vector<std::pair<std::string, std::optional<std::uint64_t>>> hashed;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto scope = scopes_.find(arguments);
+    for (const auto &path : headers) {
+      if (scope == scopes_.end()) {
+        hashed.emplace_back(path, std::nullopt);
+        continue;
+      }
+      const auto found = scope->second.headers.find(path);
+      if (found == scope->second.headers.end() ||
+          found->second.position > position) {
+        hashed.emplace_back(path, std::nullopt);
+      }
+    }
+  }
+  for (auto &[path, content_hash] : hashed) {
+    content_hash = hashes_->Hash(path);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto &scope = scopes_[arguments];
+  for (auto &[path, content_hash] : hashed) {
+    const auto [found, inserted] = scope.headers.try_emplace(
+        std::move(path), Header{content_hash, position});
+    if (!inserted && found->second.position > position) {
+      found->second = Header{content_hash, position};
+    }
+  }
+  for (const auto key : definitions) {
+    const auto [found, inserted] = scope.definitions.try_emplace(key, position);
+    if (!inserted && found->second > position) {
+      found->second = position;
+    }
+  }
+}
+
+std::size_t HarvestedDeclarations::headers() {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::size_t count = 0;
+  for (const auto &[arguments, scope] : scopes_) {
+    count += scope.headers.size();
+  }
+  return count;
+}
+
+FactStore CollectFacts(CXTranslationUnit translation_unit,
+                       const std::filesystem::path &project_root,
+                       const IndexerOptions &options,
+                       HarvestedDeclarations *harvested,
+                       std::size_t position, ArgumentSetId arguments) {
+  FactCollector collector(project_root, options, harvested, position,
+                          arguments);
+  return collector.Collect(translation_unit);
+}
+
+} // namespace dsl
@@ -1,10 +1,65 @@
 #include <dsl/default_analyzer_pipeline.h>
 
 #include <chrono>
+#include <cstddef>
+#include <string>
+#include <unordered_set>
 #include <utility>
 
+namespace {
+
+// Forwards batches to the extraction session while counting facts for the
+// stage log.
+class CountingFactSink : public dsl::FactSink {
+public:
+  explicit CountingFactSink(dsl::FactSink &sink) : sink_(&sink) {}
+
+  void Consume(const dsl::FactStore &facts) override {
+    count_ += facts.size();
+    sink_->Consume(facts);
+  }
+
+  std::size_t count() const { return count_; }
+
+private:
+  dsl::FactSink *sink_;
+  std::size_t count_ = 0;
+};
+
+std::string FindingKey(const dsl::Finding &finding) {
+  return finding.term + '\0' + finding.conflict;
+}
+
+} // namespace
+
 namespace dsl {
 
+void MarkFindingChanges(const std::vector<Finding> &baseline,
+                        std::vector<Finding> &findings) {
+  std::unordered_set<std::string> baseline_keys;
+  for (const auto &finding : baseline) {
+    if (finding.change != FindingChange::kResolved) {
+      baseline_keys.insert(FindingKey(finding));
+    }
+  }
+  std::unordered_set<std::string> current_keys;
+  for (auto &finding : findings) {
+    auto key = FindingKey(finding);
+    finding.change = baseline_keys.count(key) != 0 ? FindingChange::kUnchanged
+                                                   : FindingChange::kNew;
+    current_keys.insert(std::move(key));
+  }
+  for (const auto &finding : baseline) {
+    if (finding.change == FindingChange::kResolved ||
+        current_keys.count(FindingKey(finding)) != 0) {
+      continue;
+    }
+    auto resolved = finding;
+    resolved.change = FindingChange::kResolved;
+    findings.push_back(std::move(resolved));
+  }
+}
+
 DefaultAnalyzerPipeline::DefaultAnalyzerPipeline(PipelineComponents components)
     : source_acquirer_(std::move(components.source_acquirer)),
       indexer_(std::move(components.indexer)),
@@ -25,24 +80,36 @@ PipelineResult DefaultAnalyzerPipeline::Run(const AnalysisConfig &config) {
                {{"stage", "source"},
                 {"file_count", std::to_string(sources.files.size())}});
 
-  const auto index = indexer_->BuildIndex(sources);
-  logger_->Log(
-      LogLevel::kDebug, "pipeline.stage.complete",
-      {{"stage", "index"}, {"facts", std::to_string(index.facts.size())}});
+  // Extraction consumes each translation unit's facts while the indexer is
+  // still parsing the rest.
+  auto extraction_session = extractor_->StartExtraction(config);
+  CountingFactSink sink(*extraction_session);
+  indexer_->StreamIndex(sources, sink);
+  logger_->Log(LogLevel::kDebug, "pipeline.stage.complete",
+               {{"stage", "index"}, {"facts", std::to_string(sink.count())}});
 
-  const auto extraction = extractor_->Extract(index, config);
+  PipelineResult result;
+  auto &extraction = result.extraction;
+  extraction = extraction_session->Finish();
+  for (auto &note : indexer_->IndexingNotes()) {
+    extraction.extraction_notes.push_back(std::move(note));
+  }
   logger_->Log(
       LogLevel::kDebug, "pipeline.stage.complete",
       {{"stage", "extract"},
        {"terms", std::to_string(extraction.terms.size())},
        {"relationships", std::to_string(extraction.relationships.size())}});
 
-  const auto coherence = analyzer_->Analyze(extraction);
+  auto &coherence = result.coherence;
+  coherence = analyzer_->Analyze(extraction);
   logger_->Log(LogLevel::kDebug, "pipeline.stage.complete",
                {{"stage", "analyze"},
                 {"findings", std::to_string(coherence.findings.size())}});
+  if (config.baseline_findings) {
+    MarkFindingChanges(*config.baseline_findings, coherence.findings);
+  }
 
-  const auto report = reporter_->Render(extraction, coherence, config);
+  result.report = reporter_->Render(extraction, coherence, config);
 
   const auto duration_ms =
       std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -52,7 +119,7 @@ PipelineResult DefaultAnalyzerPipeline::Run(const AnalysisConfig &config) {
                {{"duration_ms", std::to_string(duration_ms)},
                 {"findings", std::to_string(coherence.findings.size())}});
 
-  return PipelineResult{report, coherence, extraction};
+  return result;
 }
 
 } // namespace dsl
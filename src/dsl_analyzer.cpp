@@ -1,9 +1,13 @@
+#include <dsl/analysis_server.h>
 #include <dsl/analyzer_pipeline_builder.h>
+#include <dsl/changed_files.h>
 #include <dsl/cli_exit_codes.h>
 #include <dsl/cmake_source_acquirer.h>
 #include <dsl/compile_commands_ast_indexer.h>
 #include <dsl/default_analyzer_pipeline.h>
 #include <dsl/dsl_analyzer.h>
+#include <dsl/fact_shard.h>
+#include <dsl/file_watcher.h>
 #include <dsl/heuristic_dsl_extractor.h>
 #include <dsl/markdown_reporter.h>
 #include <dsl/models.h>
@@ -11,10 +15,14 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -54,9 +62,33 @@ void PrintAnalyzeUsage() {
       << "  --extractor <name>    DSL extractor plug-in to use\n"
       << "  --analyzer <name>     Coherence analyzer plug-in to use\n"
       << "  --reporter <name>     Reporter plug-in to render outputs\n"
+      << "  --indexer <name>      Indexing engine: cursor (default) or\n"
+      << "                        indexing-api\n"
+      << "  --jobs <count>        Translation units parsed in parallel\n"
+      << "                        (default: 1, 0 = one per hardware thread)\n"
+      << "  --traverse-external   Visit declarations outside the project and\n"
+      << "                        in system headers instead of pruning them\n"
+      << "  --index-depth <depth> full (default) or declarations; the latter\n"
+      << "                        skips function bodies, so reports have no\n"
+      << "                        call or type usage relationships\n"
+      << "  --no-pch              Parse every translation unit from scratch\n"
+      << "                        instead of precompiling shared includes\n"
       << "  --cache-ast           Enable AST caching\n"
       << "  --cache-dir <path>    Override AST cache directory\n"
+      << "  --retry-failed        Parse units the cache records as failed\n"
+      << "                        instead of skipping them\n"
       << "  --clean-cache         Remove AST cache before running\n"
+      << "  --watch               Keep running and re-analyze after each\n"
+      << "                        burst of edits under the root (Linux only)\n"
+      << "  --since <rev>         Re-index only the units affected by files\n"
+      << "                        changed since a git revision and mark\n"
+      << "                        findings as new, unchanged or resolved\n"
+      << "                        (implies --cache-ast)\n"
+      << "  --changed-files <file>  Like --since, with the changed paths read\n"
+      << "                        from a file, one per line\n"
+      << "  --shard <i>/<n>       Index only shard i of n of the compile\n"
+      << "                        commands and write its facts to\n"
+      << "                        dsl_facts_<i>_of_<n>.shard for 'merge'\n"
       << "  --help                Show this message\n";
 }
 
@@ -71,6 +103,44 @@ void PrintReportUsage() {
             << "  --help          Show this message\n";
 }
 
+void PrintServeUsage() {
+  std::cout
+      << "Usage: dsl-extract serve --root <path> [--socket <path>] "
+         "[analyze options]\n"
+      << "Keeps translation units parsed between runs and answers requests\n"
+      << "from 'dsl-extract client' on a Unix domain socket.\n"
+      << "Options:\n"
+      << "  --socket <path>       Socket to listen on (default: serve.sock in\n"
+      << "                        the cache directory)\n"
+      << "  Every 'dsl-extract analyze' option applies to each run.\n";
+}
+
+void PrintMergeUsage() {
+  std::cout
+      << "Usage: dsl-extract merge --root <path> [analyze options] "
+         "<shard>...\n"
+      << "Merges the fact shards written by 'analyze --shard i/n' and writes\n"
+      << "the reports a single 'analyze' run would. Pass every shard of one\n"
+      << "partition and the root, format, scope and extraction options the\n"
+      << "shards were indexed with; the checkout itself is not read.\n";
+}
+
+void PrintClientUsage() {
+  std::cout
+      << "Usage: dsl-extract client (--root <path> | --socket <path>) "
+         "[request]\n"
+      << "Requests:\n"
+      << "  analyze   Run the analysis, write reports and print the report\n"
+      << "            (default)\n"
+      << "  report    Print the report of the last analysis\n"
+      << "  shutdown  Stop the server\n"
+      << "Options:\n"
+      << "  --root <path>       Root the server was started with\n"
+      << "  --cache-dir <path>  Cache directory the server was started with\n"
+      << "  --socket <path>     Socket the server listens on\n"
+      << "  --help              Show this message\n";
+}
+
 std::string Trim(std::string value) {
   const auto is_space = [](unsigned char ch) { return std::isspace(ch) != 0; };
   value.erase(value.begin(),
@@ -113,6 +183,59 @@ dsl::LogLevel ParseLogLevel(const std::string &value) {
   throw std::invalid_argument("Unknown log level: " + value);
 }
 
+dsl::IndexDepth ParseIndexDepth(const std::string &value) {
+  const auto normalized = ToLower(Trim(value));
+  if (normalized == "full") {
+    return dsl::IndexDepth::kFull;
+  }
+  if (normalized == "declarations") {
+    return dsl::IndexDepth::kDeclarations;
+  }
+  throw std::invalid_argument("Unknown index depth: " + value);
+}
+
+dsl::IndexShard ParseShard(const std::string &value) {
+  const auto separator = value.find('/');
+  const auto is_number = [](const std::string &text) {
+    return !text.empty() && text.size() <= 9 &&
+           std::all_of(text.begin(), text.end(), [](unsigned char ch) {
+             return std::isdigit(ch) != 0;
+           });
+  };
+  if (separator != std::string::npos) {
+    const auto index = value.substr(0, separator);
+    const auto count = value.substr(separator + 1);
+    if (is_number(index) && is_number(count)) {
+      const dsl::IndexShard shard{static_cast<unsigned>(std::stoul(index)),
+                                  static_cast<unsigned>(std::stoul(count))};
+      if (shard.index >= 1 && shard.index <= shard.count) {
+        return shard;
+      }
+    }
+  }
+  throw std::invalid_argument("Invalid shard (expected i/n, 1 <= i <= n): " +
+                              value);
+}
+
+unsigned ParseJobCount(const std::string &value) {
+  const auto trimmed = Trim(value);
+  if (trimmed.empty() ||
+      !std::all_of(trimmed.begin(), trimmed.end(), [](unsigned char ch) {
+        return std::isdigit(ch) != 0;
+      })) {
+    throw std::invalid_argument("Invalid job count: " + value);
+  }
+  try {
+    const auto parsed = std::stoul(trimmed);
+    if (parsed > std::numeric_limits<unsigned>::max()) {
+      throw std::out_of_range(trimmed);
+    }
+    return static_cast<unsigned>(parsed);
+  } catch (const std::out_of_range &) {
+    throw std::invalid_argument("Invalid job count: " + value);
+  }
+}
+
 std::vector<std::string> SplitFormats(const std::string &raw_formats) {
   std::vector<std::string> values;
   std::string current;
@@ -256,6 +379,10 @@ void HandlePluginSelection(const std::vector<std::string> &arguments,
     options.reporter = RequireValue(arguments, index, argument);
     return;
   }
+  if (argument == "--indexer") {
+    options.indexer = RequireValue(arguments, index, argument);
+    return;
+  }
 }
 
 bool DispatchAnalyzeOption(const std::vector<std::string> &arguments,
@@ -285,6 +412,48 @@ bool DispatchAnalyzeOption(const std::vector<std::string> &arguments,
     options.config_file = RequireValue(arguments, index, "--config");
     return true;
   }
+  if (argument == "--jobs") {
+    options.jobs = ParseJobCount(RequireValue(arguments, index, argument));
+    return true;
+  }
+  if (argument == "--traverse-external") {
+    options.traverse_external = true;
+    return true;
+  }
+  if (argument == "--retry-failed") {
+    options.retry_failed = true;
+    return true;
+  }
+  if (argument == "--no-pch") {
+    options.precompiled_headers = false;
+    return true;
+  }
+  if (argument == "--watch") {
+    options.watch = true;
+    return true;
+  }
+  if (argument == "--since") {
+    options.since = RequireValue(arguments, index, argument);
+    return true;
+  }
+  if (argument == "--changed-files") {
+    options.changed_files = RequireValue(arguments, index, argument);
+    return true;
+  }
+  if (argument == "--shard") {
+    options.shard = ParseShard(RequireValue(arguments, index, argument));
+    return true;
+  }
+  if (argument == "--index-depth") {
+    options.index_depth =
+        ParseIndexDepth(RequireValue(arguments, index, argument));
+    return true;
+  }
+  if (argument.rfind("--index-depth=", 0) == 0) {
+    options.index_depth =
+        ParseIndexDepth(argument.substr(std::string("--index-depth=").size()));
+    return true;
+  }
 
   HandleFormatOption(arguments, index, options);
   if (argument == "--format") {
@@ -316,7 +485,7 @@ bool DispatchAnalyzeOption(const std::vector<std::string> &arguments,
 
   HandlePluginSelection(arguments, index, options);
   if (argument == "--extractor" || argument == "--analyzer" ||
-      argument == "--reporter") {
+      argument == "--reporter" || argument == "--indexer") {
     return true;
   }
 
@@ -327,6 +496,25 @@ void ValidateAnalyzeOptions(const AnalyzeOptions &options) {
   if (!options.root) {
     throw std::invalid_argument("--root is required (or set in config file)");
   }
+  if (options.since && options.changed_files) {
+    throw std::invalid_argument(
+        "--since and --changed-files cannot be combined");
+  }
+  if (options.since || options.changed_files) {
+    // The change set is fixed when the run starts, and the cached units
+    // and findings are what the unchanged files are compared against.
+    if (options.watch) {
+      throw std::invalid_argument(
+          "--watch cannot be combined with --since or --changed-files");
+    }
+    if (options.clean_cache.value_or(false)) {
+      throw std::invalid_argument(
+          "--clean-cache cannot be combined with --since or --changed-files");
+    }
+  }
+  if (options.shard && options.watch) {
+    throw std::invalid_argument("--watch cannot be combined with --shard");
+  }
 }
 
 void WriteFileIfContent(const std::filesystem::path &path,
@@ -369,6 +557,19 @@ DetectAvailableReportFormats(const std::filesystem::path &root) {
   return formats;
 }
 
+// --shard, --watch, --since and --changed-files shape a single analyze run;
+// `command` runs analyses of its own and rejects them.
+void RejectSingleRunOptions(const AnalyzeOptions &options,
+                            const std::string &command,
+                            const std::string &reason) {
+  if (options.shard || options.watch || options.since ||
+      options.changed_files) {
+    throw std::invalid_argument(command + " " + reason +
+                                "; --shard, --watch, --since and "
+                                "--changed-files do not apply");
+  }
+}
+
 } // namespace
 
 namespace dsl {
@@ -430,8 +631,14 @@ const std::vector<std::string> &SupportedConfigKeys() {
                                                 "extractor",
                                                 "analyzer",
                                                 "reporter",
+                                                "indexer",
                                                 "ignored_namespaces",
-                                                "ignored_source_directories"};
+                                                "ignored_source_directories",
+                                                "jobs",
+                                                "traverse_external",
+                                                "index_depth",
+                                                "precompiled_headers",
+                                                "retry_failed"};
   return keys;
 }
 
@@ -560,12 +767,15 @@ ConfigValue ToConfigValue(const std::string &key, const YAML::Node &node) {
   if (key == "ignored_source_directories") {
     return ExtractIgnoredSourceDirectories(node, key);
   }
-  if (key == "cache_ast" || key == "clean_cache") {
+  if (key == "cache_ast" || key == "clean_cache" ||
+      key == "traverse_external" || key == "precompiled_headers" ||
+      key == "retry_failed") {
     return ConfigValue{ExtractBool(node, key)};
   }
   if (key == "build" || key == "out" || key == "root" || key == "cache_dir" ||
       key == "scope_notes" || key == "log_level" || key == "extractor" ||
-      key == "analyzer" || key == "reporter") {
+      key == "analyzer" || key == "reporter" || key == "indexer" ||
+      key == "jobs" || key == "index_depth") {
     if (key == "build" || key == "out" || key == "root" || key == "cache_dir") {
       return ConfigValue{ExtractPathLike(node, key)};
     }
@@ -636,6 +846,10 @@ void ApplyConfig(const RawConfig &config, AnalyzeOptions &options) {
       options.reporter = std::get<std::string>(value);
       continue;
     }
+    if (key == "indexer") {
+      options.indexer = std::get<std::string>(value);
+      continue;
+    }
     if (key == "cache_ast") {
       options.enable_ast_cache = std::get<bool>(value);
       continue;
@@ -648,6 +862,26 @@ void ApplyConfig(const RawConfig &config, AnalyzeOptions &options) {
       options.cache_directory = std::get<std::string>(value);
       continue;
     }
+    if (key == "jobs") {
+      options.jobs = ParseJobCount(std::get<std::string>(value));
+      continue;
+    }
+    if (key == "traverse_external") {
+      options.traverse_external = std::get<bool>(value);
+      continue;
+    }
+    if (key == "retry_failed") {
+      options.retry_failed = std::get<bool>(value);
+      continue;
+    }
+    if (key == "precompiled_headers") {
+      options.precompiled_headers = std::get<bool>(value);
+      continue;
+    }
+    if (key == "index_depth") {
+      options.index_depth = ParseIndexDepth(std::get<std::string>(value));
+      continue;
+    }
     ThrowUnknownKey(key);
   }
 }
@@ -687,6 +921,7 @@ AnalyzeOptions MergeOptions(const AnalyzeOptions &config_options,
   override_path(merged.extractor, cli_options.extractor);
   override_path(merged.analyzer, cli_options.analyzer);
   override_path(merged.reporter, cli_options.reporter);
+  override_path(merged.indexer, cli_options.indexer);
 
   if (!cli_options.formats.empty()) {
     merged.formats = cli_options.formats;
@@ -706,6 +941,25 @@ AnalyzeOptions MergeOptions(const AnalyzeOptions &config_options,
   if (cli_options.clean_cache) {
     merged.clean_cache = cli_options.clean_cache;
   }
+  if (cli_options.jobs) {
+    merged.jobs = cli_options.jobs;
+  }
+  if (cli_options.traverse_external) {
+    merged.traverse_external = cli_options.traverse_external;
+  }
+  if (cli_options.retry_failed) {
+    merged.retry_failed = cli_options.retry_failed;
+  }
+  if (cli_options.precompiled_headers) {
+    merged.precompiled_headers = cli_options.precompiled_headers;
+  }
+  if (cli_options.index_depth) {
+    merged.index_depth = cli_options.index_depth;
+  }
+  merged.watch = cli_options.watch;
+  merged.since = cli_options.since;
+  merged.changed_files = cli_options.changed_files;
+  merged.shard = cli_options.shard;
   return merged;
 }
 
@@ -832,19 +1086,12 @@ dsl::AnalysisConfig BuildAnalysisConfig(const AnalyzeOptions &options,
   config.cache.directory = cache_dir.string();
   config.logger = std::move(logger);
   config.config_file = options.config_file ? options.config_file->string() : "";
+  config.index_depth = options.index_depth.value_or(dsl::IndexDepth::kFull);
   return config;
 }
 
-dsl::DefaultAnalyzerPipeline
-BuildAnalyzePipeline(const AnalyzeOptions &options,
-                     const std::filesystem::path &root,
-                     const std::shared_ptr<dsl::Logger> &logger) {
-  dsl::AnalyzerPipelineBuilder builder;
-  builder.WithLogger(logger);
-  builder.WithSourceAcquirer(std::make_unique<dsl::CMakeSourceAcquirer>(
-      ResolveBuildDirectory(options, root), logger));
-  builder.WithIndexer(std::make_unique<dsl::CompileCommandsAstIndexer>(
-      std::filesystem::path{}, logger));
+void SelectReportingComponents(const AnalyzeOptions &options,
+                               dsl::AnalyzerPipelineBuilder &builder) {
   if (options.extractor) {
     builder.WithExtractorName(*options.extractor);
   }
@@ -854,10 +1101,90 @@ BuildAnalyzePipeline(const AnalyzeOptions &options,
   if (options.reporter) {
     builder.WithReporterName(*options.reporter);
   }
+}
+
+dsl::IndexerOptions BuildIndexerOptions(const AnalyzeOptions &options) {
+  dsl::IndexerOptions indexer_options;
+  indexer_options.jobs = options.jobs.value_or(1);
+  indexer_options.prune_external = !options.traverse_external.value_or(false);
+  indexer_options.depth = options.index_depth.value_or(dsl::IndexDepth::kFull);
+  indexer_options.precompile_headers =
+      options.precompiled_headers.value_or(true);
+  indexer_options.retry_failed = options.retry_failed.value_or(false);
+  return indexer_options;
+}
+
+dsl::DefaultAnalyzerPipeline
+BuildAnalyzePipeline(const AnalyzeOptions &options,
+                     const std::filesystem::path &root,
+                     const std::shared_ptr<dsl::Logger> &logger,
+                     const dsl::IndexerOptions &indexer_options) {
+  dsl::AnalyzerPipelineBuilder builder;
+  builder.WithLogger(logger);
+  builder.WithSourceAcquirer(std::make_unique<dsl::CMakeSourceAcquirer>(
+      ResolveBuildDirectory(options, root), logger));
+  builder.WithIndexerOptions(indexer_options);
+  if (options.indexer) {
+    builder.WithIndexerName(*options.indexer);
+  }
+  SelectReportingComponents(options, builder);
   builder.WithAstCacheOptions(BuildCacheOptions(options, root));
   return builder.Build();
 }
 
+// `merge` feeds the stages after indexing from fact shards, so it needs the
+// root the shards were indexed under but not the checkout itself.
+class ProjectRootAcquirer : public dsl::SourceAcquirer {
+public:
+  dsl::SourceAcquisitionResult
+  Acquire(const dsl::AnalysisConfig &config) override {
+    dsl::SourceAcquisitionResult sources;
+    sources.project_root = config.root_path;
+    return sources;
+  }
+};
+
+dsl::DefaultAnalyzerPipeline
+BuildMergePipeline(const AnalyzeOptions &options,
+                   const std::vector<std::filesystem::path> &shards,
+                   const std::shared_ptr<dsl::Logger> &logger) {
+  dsl::AnalyzerPipelineBuilder builder;
+  builder.WithLogger(logger);
+  builder.WithSourceAcquirer(std::make_unique<ProjectRootAcquirer>());
+  builder.WithIndexer(std::make_unique<dsl::FactShardMerger>(shards, logger));
+  SelectReportingComponents(options, builder);
+  return builder.Build();
+}
+
+// Indexes this machine's shard of the compile commands and writes its facts
+// next to where the reports would go.
+void WriteFactShard(const AnalyzeOptions &options,
+                    const std::filesystem::path &root,
+                    const dsl::IndexerOptions &indexer_options,
+                    const dsl::AnalysisConfig &config,
+                    const std::shared_ptr<dsl::Logger> &logger) {
+  const auto &registry = dsl::GlobalComponentRegistry();
+  auto indexer = registry.CreateIndexer(
+      options.indexer.value_or(registry.DefaultIndexerName()), logger,
+      indexer_options);
+  if (options.enable_ast_cache.value_or(false)) {
+    indexer->UseTranslationUnitCache(
+        std::make_shared<dsl::AstCache>(BuildCacheOptions(options, root),
+                                        logger));
+  }
+  const auto sources =
+      dsl::CMakeSourceAcquirer(ResolveBuildDirectory(options, root), logger)
+          .Acquire(config);
+  dsl::FactShardWriter writer(*indexer_options.shard);
+  indexer->StreamIndex(sources, writer);
+  const auto path = options.output_directory.value_or(root) /
+                    dsl::FactShardFileName(*indexer_options.shard);
+  writer.Write(path, indexer->IndexingNotes());
+  logger->Log(dsl::LogLevel::kInfo, "Wrote fact shard",
+              {{"path", path.string()},
+               {"translation_units", std::to_string(writer.units())}});
+}
+
 void WriteAnalyzeReports(const AnalyzeOptions &options,
                          const std::filesystem::path &root,
                          const dsl::Report &report) {
@@ -865,6 +1192,81 @@ void WriteAnalyzeReports(const AnalyzeOptions &options,
   WriteReports(output_root, report);
 }
 
+// The text a client prints for an analysis: the markdown report when one
+// was rendered, else the JSON report.
+std::string ReportText(const dsl::Report &report) {
+  return report.markdown.empty() ? report.json : report.markdown;
+}
+
+// A pipeline that runs many times cleans the cache once up front rather
+// than before every run.
+void CleanCacheOnce(AnalyzeOptions &options,
+                    const std::filesystem::path &cache_directory) {
+  if (options.clean_cache.value_or(false)) {
+    RemoveCacheDirectory(cache_directory);
+    options.clean_cache = false;
+  }
+}
+
+// Sources, headers and build files; edits to anything else under the root,
+// such as the reports written there, do not trigger a new analysis.
+bool IsAnalysisInput(const std::filesystem::path &path) {
+  static const std::set<std::string> kExtensions{
+      ".c", ".cc", ".cpp", ".cxx", ".c++", ".h",
+      ".hh", ".hpp", ".hxx", ".inc", ".inl", ".ipp"};
+  const auto name = path.filename().string();
+  return name == "CMakeLists.txt" || name == "compile_commands.json" ||
+         kExtensions.count(path.extension().string()) != 0;
+}
+
+// Re-runs the analysis after each burst of edits until the process is
+// stopped. The pipeline keeps its translation units, so only the units whose
+// main file or headers changed are parsed again.
+void WatchAndReanalyze(const AnalyzeOptions &options,
+                       const std::filesystem::path &root,
+                       const std::filesystem::path &cache_directory,
+                       dsl::DefaultAnalyzerPipeline &pipeline,
+                       const dsl::AnalysisConfig &config) {
+  constexpr std::chrono::milliseconds kDebounce{300};
+  const auto build_directory = std::filesystem::weakly_canonical(
+      ResolveBuildDirectory(options, root));
+  // Builds write into the build directory constantly; only its
+  // compile_commands.json matters.
+  FileWatcher watcher({build_directory, cache_directory});
+  watcher.WatchTree(root);
+  if (std::filesystem::is_directory(build_directory)) {
+    watcher.Watch(build_directory);
+  }
+  std::cout << "Watching " << root.string() << " for changes" << std::endl;
+
+  for (;;) {
+    try {
+      auto changed = watcher.WaitForChanges(kDebounce);
+      changed.erase(std::remove_if(changed.begin(), changed.end(),
+                                   [](const std::filesystem::path &path) {
+                                     return !IsAnalysisInput(path);
+                                   }),
+                    changed.end());
+      // Dropped events may have hidden any edit, so the analysis reruns.
+      if (changed.empty() && !watcher.lost_events()) {
+        continue;
+      }
+      const auto result = pipeline.Run(config);
+      WriteAnalyzeReports(options, root, result.report);
+      if (watcher.lost_events()) {
+        std::cout << "Re-analyzed after lost file events";
+      } else {
+        std::cout << "Re-analyzed after " << changed.size()
+                  << " changed file(s)";
+      }
+      std::cout << "; exit code " << dsl::CoherenceExitCode(result.coherence)
+                << std::endl;
+    } catch (const std::exception &ex) {
+      std::cerr << "Error: " << ex.what() << "\n";
+    }
+  }
+}
+
 int RunAnalyze(const std::vector<std::string> &arguments) {
   const auto cli_options = ParseAnalyzeArguments(arguments);
   if (cli_options.show_help) {
@@ -872,17 +1274,93 @@ int RunAnalyze(const std::vector<std::string> &arguments) {
     return 0;
   }
 
-  const auto merged = ResolveAnalyzeOptions(cli_options);
+  auto merged = ResolveAnalyzeOptions(cli_options);
   const auto root = std::filesystem::weakly_canonical(*merged.root);
   const auto cache_directory =
       merged.cache_directory.value_or(root / ".dsl_cache");
+  if (merged.watch) {
+    CleanCacheOnce(merged, cache_directory);
+  }
   auto logger = dsl::MakeLogger(BuildLoggingConfig(merged), std::clog);
 
-  auto pipeline = BuildAnalyzePipeline(merged, root, logger);
+  auto indexer_options = BuildIndexerOptions(merged);
+  indexer_options.keep_translation_units = merged.watch;
+  indexer_options.shard = merged.shard;
+  const auto incremental = merged.since || merged.changed_files;
+  if (incremental) {
+    merged.enable_ast_cache = true;
+  }
+  // A full cached run records its units and findings at the checked-out
+  // commit, which a later --since run against that commit can trust.
+  const auto work_tree = !incremental && merged.enable_ast_cache.value_or(false)
+                             ? dsl::WorkTreeChanges(root)
+                             : std::nullopt;
+  if (merged.since) {
+    indexer_options.changes = dsl::ChangedFilesSince(root, *merged.since);
+  } else if (merged.changed_files) {
+    const auto listed = dsl::ReadChangedFilesList(*merged.changed_files, root);
+    logger->Log(dsl::LogLevel::kInfo,
+                "The changed files list names no revision; cached units are "
+                "validated by hashing their files",
+                {{"changed_files", std::to_string(listed.size())}});
+  } else if (!merged.watch) {
+    // Watching outlives the comparison, which is made once.
+    indexer_options.changes = work_tree;
+  }
+  if (merged.shard) {
+    CleanCacheOnce(merged, cache_directory);
+    WriteFactShard(merged, root, indexer_options,
+                   BuildAnalysisConfig(merged, root, cache_directory, logger),
+                   logger);
+    return 0;
+  }
+  auto pipeline = BuildAnalyzePipeline(merged, root, logger, indexer_options);
   auto config = BuildAnalysisConfig(merged, root, cache_directory, logger);
+  const dsl::AstCache findings_cache(BuildCacheOptions(merged, root), logger);
+  if (incremental) {
+    auto baseline = findings_cache.LoadFindingBaseline();
+    if (!baseline) {
+      logger->Log(dsl::LogLevel::kWarn,
+                  "No findings baseline in the AST cache; run a full cached "
+                  "analysis at the base revision first",
+                  {{"cache_directory", cache_directory.string()}});
+    } else if (merged.since &&
+               baseline->revision != indexer_options.changes->revision) {
+      // Marked against another commit, the base branch's own findings would
+      // show up as new or resolved.
+      logger->Log(dsl::LogLevel::kWarn,
+                  "Findings baseline was recorded at another revision; "
+                  "findings are not marked",
+                  {{"baseline_revision", baseline->revision.empty()
+                                             ? "unknown"
+                                             : baseline->revision},
+                   {"revision", indexer_options.changes->revision}});
+    } else {
+      if (!merged.since) {
+        logger->Log(dsl::LogLevel::kWarn,
+                    "Cannot check the findings baseline against a changed "
+                    "files list; marking findings against it",
+                    {{"baseline_revision", baseline->revision.empty()
+                                               ? "unknown"
+                                               : baseline->revision}});
+      }
+      config.baseline_findings =
+          std::make_shared<const std::vector<dsl::Finding>>(
+              std::move(baseline->findings));
+    }
+  }
 
   const auto result = pipeline.Run(config);
   WriteAnalyzeReports(merged, root, result.report);
+  if (!incremental) {
+    // Findings from a work tree with edits belong to no commit.
+    findings_cache.StoreFindingBaseline(
+        result.coherence.findings,
+        work_tree && work_tree->changed.empty() ? work_tree->revision : "");
+  }
+  if (merged.watch) {
+    WatchAndReanalyze(merged, root, cache_directory, pipeline, config);
+  }
   return dsl::CoherenceExitCode(result.coherence);
 }
 
@@ -904,6 +1382,172 @@ int RunReport(const std::vector<std::string> &arguments) {
   return 0;
 }
 
+ServeOptions ParseServeArguments(const std::vector<std::string> &arguments) {
+  ServeOptions options;
+  std::vector<std::string> analyze_arguments;
+  for (std::size_t i = 0; i < arguments.size(); ++i) {
+    if (arguments[i] == "--socket") {
+      options.socket = RequireValue(arguments, i, "--socket");
+      continue;
+    }
+    analyze_arguments.push_back(arguments[i]);
+  }
+  options.analyze = ParseAnalyzeArguments(analyze_arguments);
+  if (!options.analyze.show_help) {
+    RejectSingleRunOptions(options.analyze, "serve",
+                           "analyzes the whole project on every request");
+  }
+  return options;
+}
+
+FactMergeOptions
+ParseMergeArguments(const std::vector<std::string> &arguments) {
+  FactMergeOptions options;
+  for (std::size_t i = 0; i < arguments.size(); ++i) {
+    if (arguments[i].rfind('-', 0) != 0) {
+      options.shards.emplace_back(arguments[i]);
+      continue;
+    }
+    if (!DispatchAnalyzeOption(arguments, i, options.analyze)) {
+      throw std::invalid_argument("Unknown argument: " + arguments[i]);
+    }
+    if (options.analyze.show_help) {
+      break;
+    }
+  }
+  return options;
+}
+
+int RunMerge(const std::vector<std::string> &arguments) {
+  const auto options = ParseMergeArguments(arguments);
+  if (options.analyze.show_help) {
+    PrintMergeUsage();
+    return 0;
+  }
+  if (options.shards.empty()) {
+    throw std::invalid_argument("merge requires at least one fact shard");
+  }
+  RejectSingleRunOptions(options.analyze, "merge",
+                         "reads facts from shards only");
+
+  const auto merged = ResolveAnalyzeOptions(options.analyze);
+  const auto root = std::filesystem::weakly_canonical(*merged.root);
+  auto logger = dsl::MakeLogger(BuildLoggingConfig(merged), std::clog);
+  auto pipeline = BuildMergePipeline(merged, options.shards, logger);
+  const auto config = BuildAnalysisConfig(
+      merged, root, merged.cache_directory.value_or(root / ".dsl_cache"),
+      logger);
+
+  const auto result = pipeline.Run(config);
+  WriteAnalyzeReports(merged, root, result.report);
+  return dsl::CoherenceExitCode(result.coherence);
+}
+
+ClientOptions ParseClientArguments(const std::vector<std::string> &arguments) {
+  ClientOptions options;
+  bool has_request = false;
+  for (std::size_t i = 0; i < arguments.size(); ++i) {
+    const auto &arg = arguments[i];
+    if (arg == "--root") {
+      options.root = RequireValue(arguments, i, "--root");
+      continue;
+    }
+    if (arg == "--cache-dir") {
+      options.cache_directory = RequireValue(arguments, i, "--cache-dir");
+      continue;
+    }
+    if (arg == "--socket") {
+      options.socket = RequireValue(arguments, i, "--socket");
+      continue;
+    }
+    if (arg == "--help" || arg == "-h") {
+      options.show_help = true;
+      return options;
+    }
+    if (arg.rfind('-', 0) == 0 || has_request) {
+      throw std::invalid_argument("Unknown client argument: " + arg);
+    }
+    options.request = arg;
+    has_request = true;
+  }
+  return options;
+}
+
+std::filesystem::path
+DefaultServerSocket(const std::filesystem::path &cache_directory) {
+  return cache_directory / "serve.sock";
+}
+
+int RunServe(const std::vector<std::string> &arguments) {
+  const auto options = ParseServeArguments(arguments);
+  if (options.analyze.show_help) {
+    PrintServeUsage();
+    return 0;
+  }
+
+  auto merged = ResolveAnalyzeOptions(options.analyze);
+  const auto root = std::filesystem::weakly_canonical(*merged.root);
+  const auto cache_directory =
+      merged.cache_directory.value_or(root / ".dsl_cache");
+  CleanCacheOnce(merged, cache_directory);
+  auto logger = dsl::MakeLogger(BuildLoggingConfig(merged), std::clog);
+  auto indexer_options = BuildIndexerOptions(merged);
+  indexer_options.keep_translation_units = true;
+  auto pipeline = BuildAnalyzePipeline(merged, root, logger, indexer_options);
+  const auto config =
+      BuildAnalysisConfig(merged, root, cache_directory, logger);
+
+  std::optional<ServerReply> last_analysis;
+  AnalysisServer server(
+      options.socket.value_or(DefaultServerSocket(cache_directory)),
+      [&](const std::string &request) {
+        if (request == "analyze") {
+          const auto result = pipeline.Run(config);
+          WriteAnalyzeReports(merged, root, result.report);
+          last_analysis = ServerReply{dsl::CoherenceExitCode(result.coherence),
+                                      ReportText(result.report)};
+          return *last_analysis;
+        }
+        if (request == "report") {
+          if (!last_analysis) {
+            throw std::runtime_error(
+                "No analysis has run yet; request analyze first");
+          }
+          return *last_analysis;
+        }
+        throw std::invalid_argument("Unknown request: " + request);
+      });
+  server.Listen();
+  std::cout << "Serving " << root.string() << " on "
+            << server.socket_path().string() << std::endl;
+  server.Serve();
+  return 0;
+}
+
+int RunClient(const std::vector<std::string> &arguments) {
+  const auto options = ParseClientArguments(arguments);
+  if (options.show_help) {
+    PrintClientUsage();
+    return 0;
+  }
+
+  std::filesystem::path socket_path;
+  if (options.socket) {
+    socket_path = *options.socket;
+  } else if (options.root) {
+    CacheCleanOptions cache_options;
+    cache_options.cache_directory = options.cache_directory;
+    socket_path = DefaultServerSocket(ResolveCacheDirectory(
+        cache_options, std::filesystem::weakly_canonical(*options.root)));
+  } else {
+    throw std::invalid_argument("--root or --socket is required for client");
+  }
+
+  const auto reply = SendServerRequest(socket_path, options.request);
+  std::cout << reply.body;
+  return reply.exit_code;
+}
+
 CacheCleanOptions
 ParseCacheCleanArguments(const std::vector<std::string> &arguments) {
   CacheCleanOptions options;
@@ -12,7 +12,10 @@ void PrintGlobalUsage() {
       << "Commands:\n"
       << "  analyze   Run DSL analysis (default if no command is given).\n"
       << "  report    Re-render reports from cached analysis artifacts.\n"
-      << "  cache     Manage caches (subcommands: clean).\n\n"
+      << "  cache     Manage caches (subcommands: clean).\n"
+      << "  serve     Keep an analysis resident and answer client requests.\n"
+      << "  client    Send a request to a running 'serve'.\n"
+      << "  merge     Report on fact shards from 'analyze --shard'.\n\n"
       << "Run 'dsl-extract analyze --help' for analysis options.\n";
 }
 } // namespace
@@ -55,6 +58,27 @@ int main(int argc, char **argv) {
       return dsl::RunCacheCommand(cache_arguments);
     }
 
+    if (command == "serve") {
+      const std::vector<std::string> serve_arguments(
+          arguments.begin() + static_cast<std::ptrdiff_t>(first_argument_index),
+          arguments.end());
+      return dsl::RunServe(serve_arguments);
+    }
+
+    if (command == "client") {
+      const std::vector<std::string> client_arguments(
+          arguments.begin() + static_cast<std::ptrdiff_t>(first_argument_index),
+          arguments.end());
+      return dsl::RunClient(client_arguments);
+    }
+
+    if (command == "merge") {
+      const std::vector<std::string> merge_arguments(
+          arguments.begin() + static_cast<std::ptrdiff_t>(first_argument_index),
+          arguments.end());
+      return dsl::RunMerge(merge_arguments);
+    }
+
     throw std::invalid_argument("Unknown command: " + command);
   } catch (const std::exception &ex) {
     std::cerr << "Error: " << ex.what() << "\n";
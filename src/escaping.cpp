@@ -1,5 +1,7 @@
 #include <dsl/escaping.h>
 
+#include <unordered_map>
+
 namespace dsl {
 
 std::string Escape(const std::string &value) {
@@ -62,4 +64,25 @@ std::vector<std::string> SplitEscaped(const std::string &line) {
   return fields;
 }
 
+std::string EscapeJsonString(const std::string &value) {
+  static const std::unordered_map<char, std::string> replacements{
+      {'"', "\\\""},
+      {'\\', "\\\\"},
+      {'\n', "\\n"},
+      {'\r', "\\r"},
+      {'\t', "\\t"}};
+
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const auto character : value) {
+    const auto replacement = replacements.find(character);
+    if (replacement != replacements.end()) {
+      escaped.append(replacement->second);
+    } else {
+      escaped.push_back(character);
+    }
+  }
+  return escaped;
+}
+
 } // namespace dsl
@@ -0,0 +1,258 @@
+#include <dsl/fact_builder.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace dsl {
+
+namespace {
+
+std::string FormatRange(CXSourceRange range) {
+  const auto start = clang_getRangeStart(range);
+  const auto end = clang_getRangeEnd(range);
+
+  CXFile file{};
+  unsigned start_line = 0;
+  unsigned start_column = 0;
+  clang_getSpellingLocation(start, &file, &start_line, &start_column, nullptr);
+
+  unsigned end_line = 0;
+  unsigned end_column = 0;
+  clang_getSpellingLocation(end, nullptr, &end_line, &end_column, nullptr);
+
+  const auto file_path = ToString(clang_getFileName(file));
+  if (file_path.empty()) {
+    return {};
+  }
+
+  return file_path + ":" + std::to_string(start_line) + ":" +
+         std::to_string(start_column) + "-" + std::to_string(end_line) + ":" +
+         std::to_string(end_column);
+}
+
+std::string GetTypeName(CXType type) {
+  return ToString(clang_getTypeSpelling(type));
+}
+
+bool IsOutermost(CXCursor parent) {
+  return clang_Cursor_isNull(parent) ||
+         clang_getCursorKind(parent) == CXCursor_TranslationUnit;
+}
+
+std::string SignatureForCursor(CXCursor cursor) {
+  const auto kind = clang_getCursorKind(cursor);
+  if (kind == CXCursor_FunctionDecl || kind == CXCursor_CXXMethod ||
+      kind == CXCursor_Constructor || kind == CXCursor_FunctionTemplate) {
+    const auto return_type = GetTypeName(clang_getCursorResultType(cursor));
+    const auto display = ToString(clang_getCursorDisplayName(cursor));
+    if (return_type.empty()) {
+      return display;
+    }
+    if (display.empty()) {
+      return return_type;
+    }
+    return return_type + " " + display;
+  }
+
+  if (kind == CXCursor_FieldDecl || kind == CXCursor_VarDecl) {
+    const auto name = ToString(clang_getCursorSpelling(cursor));
+    const auto type = GetTypeName(clang_getCursorType(cursor));
+    if (name.empty()) {
+      return type;
+    }
+    if (type.empty()) {
+      return name;
+    }
+    return name + ": " + type;
+  }
+
+  return ToString(clang_getCursorDisplayName(cursor));
+}
+
+std::string DocComment(CXCursor cursor) {
+  auto comment = ToString(clang_Cursor_getRawCommentText(cursor));
+  if (!comment.empty()) {
+    return comment;
+  }
+  return ToString(clang_Cursor_getBriefCommentText(cursor));
+}
+
+} // namespace
+
+std::string ToString(CXString value) {
+  std::string text;
+  if (const auto *cstr = clang_getCString(value); cstr != nullptr) {
+    text = cstr;
+  }
+  clang_disposeString(value);
+  return text;
+}
+
+bool IsWithinCanonical(const std::filesystem::path &candidate,
+                       const std::filesystem::path &parent) {
+  if (parent.empty()) {
+    return false;
+  }
+  return std::distance(parent.begin(), parent.end()) <=
+             std::distance(candidate.begin(), candidate.end()) &&
+         std::equal(parent.begin(), parent.end(), candidate.begin());
+}
+
+bool IsEntityKind(CXCursorKind kind) {
+  return kind == CXCursor_FunctionDecl || kind == CXCursor_CXXMethod ||
+         kind == CXCursor_Constructor || kind == CXCursor_FunctionTemplate ||
+         kind == CXCursor_StructDecl || kind == CXCursor_ClassDecl ||
+         kind == CXCursor_EnumDecl;
+}
+
+const std::string &CursorNames::QualifiedName(CXCursor cursor) {
+  static const std::string kNoName;
+  if (clang_Cursor_isNull(cursor)) {
+    return kNoName;
+  }
+  if (const auto found = names_.find(cursor); found != names_.end()) {
+    return found->second;
+  }
+
+  auto name = ToString(clang_getCursorSpelling(cursor));
+  const auto parent = clang_getCursorSemanticParent(cursor);
+  if (!IsOutermost(parent)) {
+    const auto &parent_name = QualifiedName(parent);
+    if (name.empty()) {
+      name = parent_name;
+    } else if (!parent_name.empty()) {
+      name = parent_name + "::" + name;
+    }
+  }
+  return names_.emplace(cursor, std::move(name)).first->second;
+}
+
+std::string CursorNames::ScopePath(CXCursor cursor) {
+  const auto parent = clang_getCursorSemanticParent(cursor);
+  if (IsOutermost(parent)) {
+    return {};
+  }
+  return QualifiedName(parent);
+}
+
+const FactBuilder::FileIdentity &
+FactBuilder::IdentifyFile(CXSourceLocation location) {
+  static const FileIdentity kNoFile{};
+  CXFile file{};
+  clang_getFileLocation(location, &file, nullptr, nullptr, nullptr);
+  if (file == nullptr) {
+    return kNoFile;
+  }
+  const auto [entry, inserted] = files_.try_emplace(file);
+  if (inserted) {
+    const auto path = ToString(clang_getFileName(file));
+    entry->second.has_path = !path.empty();
+    entry->second.in_project =
+        entry->second.has_path &&
+        IsWithinCanonical(std::filesystem::weakly_canonical(path),
+                          project_root_);
+  }
+  return entry->second;
+}
+
+void FactBuilder::AddSymbolFact(CXCursor cursor, const std::string &kind,
+                                std::string name, std::string scope_path) {
+  AstFact fact;
+  fact.name = std::move(name);
+  fact.kind = kind;
+  fact.signature = SignatureForCursor(cursor);
+  fact.descriptor = fact.signature;
+  fact.source_location = FormatRange(clang_getCursorExtent(cursor));
+  fact.range = fact.source_location;
+  fact.doc_comment = DocComment(cursor);
+  fact.scope_path = std::move(scope_path);
+  fact.subject_in_project = true;
+  fact.usr = ToString(clang_getCursorUSR(cursor));
+  AddFact(fact);
+}
+
+void FactBuilder::AddOwnershipFact(CXCursor cursor, const Entity &owner,
+                                   std::string scope_path) {
+  AstFact fact;
+  fact.name = owner.name;
+  fact.usr = owner.usr;
+  fact.kind = "owns";
+  fact.target = GetTypeName(clang_getCursorType(cursor));
+  fact.descriptor = ToString(clang_getCursorSpelling(cursor));
+  fact.signature = fact.descriptor + ": " + fact.target;
+  fact.source_location = FormatRange(clang_getCursorExtent(cursor));
+  fact.range = fact.source_location;
+  fact.doc_comment = DocComment(cursor);
+  fact.scope_path = std::move(scope_path);
+  fact.subject_in_project = true;
+  ResolveTarget(clang_getCursorType(cursor), fact);
+  AddFact(fact);
+}
+
+void FactBuilder::AddCallFact(CXCursor cursor, CXCursor referenced,
+                              const Entity &caller,
+                              const std::string &target_name,
+                              std::string scope_path) {
+  if (target_name.empty()) {
+    return;
+  }
+
+  AstFact fact;
+  fact.name = caller.name;
+  fact.usr = caller.usr;
+  fact.kind = "call";
+  fact.target = target_name;
+  fact.signature = SignatureForCursor(referenced);
+  fact.descriptor = "calls " + target_name;
+  fact.source_location = FormatRange(clang_getCursorExtent(cursor));
+  fact.range = fact.source_location;
+  fact.doc_comment = DocComment(cursor);
+  fact.scope_path = std::move(scope_path);
+  fact.subject_in_project = true;
+  ResolveTarget(referenced, fact);
+  AddFact(fact);
+}
+
+void FactBuilder::AddTypeUsageFact(CXCursor cursor, const Entity &subject,
+                                   std::string scope_path) {
+  const auto type_name = GetTypeName(clang_getCursorType(cursor));
+  if (type_name.empty()) {
+    return;
+  }
+
+  AstFact fact;
+  fact.name = subject.name;
+  fact.usr = subject.usr;
+  fact.kind = "type_usage";
+  fact.target = type_name;
+  fact.descriptor = "uses " + type_name;
+  fact.signature = fact.descriptor;
+  fact.source_location = FormatRange(clang_getCursorExtent(cursor));
+  fact.range = fact.source_location;
+  fact.doc_comment = DocComment(cursor);
+  fact.scope_path = std::move(scope_path);
+  fact.subject_in_project = true;
+  ResolveTarget(clang_getCursorType(cursor), fact);
+  AddFact(fact);
+}
+
+void FactBuilder::ResolveTarget(CXCursor declaration, AstFact &fact) {
+  fact.target_usr = ToString(clang_getCursorUSR(declaration));
+  const auto &file = IdentifyFile(clang_getCursorLocation(declaration));
+  if (!file.has_path) {
+    return;
+  }
+  fact.target_location = FormatRange(clang_getCursorExtent(declaration));
+  fact.target_scope = file.in_project ? AstFact::TargetScope::kInProject
+                                      : AstFact::TargetScope::kExternal;
+}
+
+void FactBuilder::ResolveTarget(CXType type, AstFact &fact) {
+  const auto declaration = clang_getTypeDeclaration(type);
+  if (!clang_Cursor_isNull(declaration)) {
+    ResolveTarget(declaration, fact);
+  }
+}
+
+} // namespace dsl
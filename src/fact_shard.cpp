@@ -0,0 +1,315 @@
+#include <dsl/fact_shard.h>
+
+#include <dsl/ast_cache.h>
+#include <dsl/hashing.h>
+#include <dsl/mapped_file.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+// Shard files are laid out as
+//   ShardHeader | unit records | note records
+// A unit record is its uint64 position and byte count followed by the
+// AST cache encoding of its facts; a note record is a byte count and the
+// note. Units are stored in increasing position and only when they have
+// facts. Like cache files they are written in host byte order.
+constexpr char kShardMagic[8] = {'D', 'S', 'L', 'S', 'H', 'R', 'D', '\0'};
+constexpr std::uint32_t kShardFormatVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304U;
+
+struct ShardHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t index;
+  std::uint32_t count;
+  // Compile commands in the whole project, which every shard shares.
+  std::uint64_t positions;
+  std::uint64_t unit_count;
+  std::uint64_t note_count;
+};
+
+static_assert(std::is_trivially_copyable_v<ShardHeader>);
+
+template <typename T> void Append(std::string &buffer, const T &value) {
+  buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void AppendSized(std::string &buffer, std::string_view bytes) {
+  Append(buffer, static_cast<std::uint64_t>(bytes.size()));
+  buffer.append(bytes);
+}
+
+std::string ShardName(std::uint32_t index, std::uint32_t count) {
+  return std::to_string(index) + "/" + std::to_string(count);
+}
+
+// Bounds-checked cursor over one mapped shard file.
+class ShardReader {
+public:
+  explicit ShardReader(const std::filesystem::path &path)
+      : path_(path), file_(dsl::MappedFile::Open(path)) {
+    if (!file_.has_value()) {
+      throw std::runtime_error("Cannot read fact shard: " + path.string());
+    }
+    data_ = file_->contents();
+    if (!Take(header_) ||
+        std::memcmp(header_.magic, kShardMagic, sizeof(kShardMagic)) != 0 ||
+        header_.version != kShardFormatVersion ||
+        header_.byte_order != kByteOrderMark || header_.count == 0 ||
+        header_.index == 0 || header_.index > header_.count) {
+      throw Malformed();
+    }
+    units_left_ = header_.unit_count;
+    Advance();
+  }
+
+  const ShardHeader &header() const { return header_; }
+  const std::filesystem::path &path() const { return path_; }
+
+  // Position of the next unit, or nullopt once every unit was taken.
+  std::optional<std::uint64_t> next() const { return next_; }
+
+  // Decodes the next unit's facts and moves to the following unit.
+  dsl::FactStore TakeUnit() {
+    dsl::FactStore facts;
+    if (!dsl::DecodeFacts(next_bytes_, facts)) {
+      throw Malformed();
+    }
+    Advance();
+    return facts;
+  }
+
+  // The notes after the last unit; call once every unit was taken.
+  std::vector<std::string> Notes() {
+    std::vector<std::string> notes;
+    for (std::uint64_t i = 0; i < header_.note_count; ++i) {
+      notes.emplace_back(TakeSized());
+    }
+    if (offset_ != data_.size()) {
+      throw Malformed();
+    }
+    return notes;
+  }
+
+private:
+  void Advance() {
+    const auto previous = next_;
+    next_.reset();
+    if (units_left_ == 0) {
+      return;
+    }
+    --units_left_;
+    std::uint64_t position = 0;
+    if (!Take(position) || position >= header_.positions ||
+        (previous && position <= *previous)) {
+      throw Malformed();
+    }
+    next_bytes_ = TakeSized();
+    next_ = position;
+  }
+
+  std::string_view TakeSized() {
+    std::uint64_t size = 0;
+    if (!Take(size) || data_.size() - offset_ < size) {
+      throw Malformed();
+    }
+    const auto bytes = data_.substr(offset_, static_cast<std::size_t>(size));
+    offset_ += static_cast<std::size_t>(size);
+    return bytes;
+  }
+
+  template <typename T> bool Take(T &value) {
+    if (data_.size() - offset_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  std::runtime_error Malformed() const {
+    return std::runtime_error("Malformed fact shard: " + path_.string());
+  }
+
+  std::filesystem::path path_;
+  std::optional<dsl::MappedFile> file_;
+  std::string_view data_;
+  std::size_t offset_ = 0;
+  ShardHeader header_{};
+  std::uint64_t units_left_ = 0;
+  std::optional<std::uint64_t> next_;
+  std::string_view next_bytes_;
+};
+
+// Every shard must come from the same partition of the same project, and
+// each partition must be present exactly once.
+void CheckShardSet(const std::vector<std::unique_ptr<ShardReader>> &readers) {
+  if (readers.empty()) {
+    throw std::invalid_argument("merge requires at least one fact shard");
+  }
+  const auto &first = readers.front()->header();
+  std::vector<bool> present(first.count, false);
+  for (const auto &reader : readers) {
+    const auto &header = reader->header();
+    if (header.count != first.count || header.positions != first.positions) {
+      throw std::runtime_error(
+          "Fact shard " + reader->path().string() + " (" +
+          ShardName(header.index, header.count) + ", " +
+          std::to_string(header.positions) +
+          " compile commands) does not belong with " +
+          readers.front()->path().string() + " (" +
+          ShardName(first.index, first.count) + ", " +
+          std::to_string(first.positions) + " compile commands)");
+    }
+    if (present[header.index - 1]) {
+      throw std::runtime_error("Fact shard " +
+                               ShardName(header.index, header.count) +
+                               " is given twice");
+    }
+    present[header.index - 1] = true;
+  }
+  for (std::uint32_t index = 1; index <= first.count; ++index) {
+    if (!present[index - 1]) {
+      throw std::runtime_error("Fact shard " +
+                               ShardName(index, first.count) + " is missing");
+    }
+  }
+}
+
+} // namespace
+
+namespace dsl {
+
+bool InShard(const std::string &relative_file, const IndexShard &shard) {
+  return Fnv1a64(relative_file) % shard.count == shard.index - 1;
+}
+
+std::string FactShardFileName(const IndexShard &shard) {
+  return "dsl_facts_" + std::to_string(shard.index) + "_of_" +
+         std::to_string(shard.count) + ".shard";
+}
+
+void FactShardWriter::Consume(const FactStore &facts) {
+  const auto position = positions_++;
+  if (facts.size() == 0) {
+    return;
+  }
+  Append(records_, position);
+  AppendSized(records_, EncodeFacts(facts));
+  ++units_;
+}
+
+void FactShardWriter::Write(const std::filesystem::path &path,
+                            const std::vector<std::string> &notes) const {
+  ShardHeader header{};
+  std::memcpy(header.magic, kShardMagic, sizeof(kShardMagic));
+  header.version = kShardFormatVersion;
+  header.byte_order = kByteOrderMark;
+  header.index = shard_.index;
+  header.count = shard_.count;
+  header.positions = positions_;
+  header.unit_count = units_;
+  header.note_count = notes.size();
+  std::string buffer;
+  Append(buffer, header);
+  std::string note_records;
+  for (const auto &note : notes) {
+    AppendSized(note_records, note);
+  }
+
+  std::error_code error;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  stream.write(records_.data(), static_cast<std::streamsize>(records_.size()));
+  stream.write(note_records.data(),
+               static_cast<std::streamsize>(note_records.size()));
+  if (error || !stream) {
+    throw std::runtime_error("Cannot write fact shard: " + path.string());
+  }
+}
+
+FactShardMerger::FactShardMerger(std::vector<std::filesystem::path> shards,
+                                 std::shared_ptr<Logger> logger)
+    : shards_(std::move(shards)), logger_(EnsureLogger(std::move(logger))) {}
+
+AstIndex FactShardMerger::BuildIndex(const SourceAcquisitionResult &sources) {
+  AstIndex index;
+  CollectingFactSink sink(index.facts);
+  StreamIndex(sources, sink);
+  return index;
+}
+
+void FactShardMerger::StreamIndex(const SourceAcquisitionResult &,
+                                  FactSink &sink) {
+  std::vector<std::unique_ptr<ShardReader>> readers;
+  readers.reserve(shards_.size());
+  for (const auto &path : shards_) {
+    readers.push_back(std::make_unique<ShardReader>(path));
+  }
+  CheckShardSet(readers);
+
+  // Each shard holds its units in increasing position, so a k-way merge on
+  // the next position restores compile-command order. Positions without a
+  // unit become empty batches, as in the run that would have parsed them.
+  using Next = std::pair<std::uint64_t, std::size_t>;
+  std::priority_queue<Next, std::vector<Next>, std::greater<Next>> heads;
+  for (std::size_t i = 0; i < readers.size(); ++i) {
+    if (const auto next = readers[i]->next()) {
+      heads.emplace(*next, i);
+    }
+  }
+  DeduplicatingFactSink unique_facts(sink);
+  const FactStore no_facts;
+  std::uint64_t position = 0;
+  std::uint64_t units = 0;
+  while (!heads.empty()) {
+    const auto [next, reader] = heads.top();
+    heads.pop();
+    for (; position < next; ++position) {
+      unique_facts.Consume(no_facts);
+    }
+    unique_facts.Consume(readers[reader]->TakeUnit());
+    ++position;
+    ++units;
+    if (const auto following = readers[reader]->next()) {
+      heads.emplace(*following, reader);
+    }
+  }
+  const auto positions = readers.front()->header().positions;
+  for (; position < positions; ++position) {
+    unique_facts.Consume(no_facts);
+  }
+
+  notes_.clear();
+  for (const auto &reader : readers) {
+    auto notes = reader->Notes();
+    notes_.insert(notes_.end(), std::make_move_iterator(notes.begin()),
+                  std::make_move_iterator(notes.end()));
+  }
+  std::sort(notes_.begin(), notes_.end());
+  logger_->Log(LogLevel::kInfo, "Merged fact shards",
+               {{"shards", std::to_string(readers.size())},
+                {"translation_units", std::to_string(units)},
+                {"compile_commands", std::to_string(positions)}});
+}
+
+std::vector<std::string> FactShardMerger::IndexingNotes() const {
+  return notes_;
+}
+
+} // namespace dsl
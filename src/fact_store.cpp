@@ -0,0 +1,348 @@
+#include <dsl/fact_store.h>
+
+#include <dsl/hashing.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t kStringBlockSize = 64 * 1024;
+
+bool ParseNumber(std::string_view text, std::uint32_t &value) {
+  if (text.empty()) {
+    return false;
+  }
+  const auto *end = text.data() + text.size();
+  const auto [position, error] = std::from_chars(text.data(), end, value);
+  return error == std::errc() && position == end;
+}
+
+bool ParseLineColumn(std::string_view text, std::uint32_t &line,
+                     std::uint32_t &column) {
+  const auto separator = text.find(':');
+  return separator != std::string_view::npos &&
+         ParseNumber(text.substr(0, separator), line) &&
+         ParseNumber(text.substr(separator + 1), column);
+}
+
+std::string FormatSpan(std::string_view file, const dsl::SourceSpan &span) {
+  std::string text(file);
+  text.append(":")
+      .append(std::to_string(span.begin_line))
+      .append(":")
+      .append(std::to_string(span.begin_column))
+      .append("-")
+      .append(std::to_string(span.end_line))
+      .append(":")
+      .append(std::to_string(span.end_column));
+  return text;
+}
+
+// Splits the indexer's `file:line:column-line:column` format. Anything that
+// would not format back to the exact same text is rejected.
+std::optional<std::pair<std::string_view, dsl::SourceSpan>>
+ParseSpan(std::string_view text) {
+  const auto dash = text.rfind('-');
+  if (dash == std::string_view::npos) {
+    return std::nullopt;
+  }
+  const auto head = text.substr(0, dash);
+  const auto column_separator = head.rfind(':');
+  if (column_separator == std::string_view::npos || column_separator == 0) {
+    return std::nullopt;
+  }
+  const auto line_separator = head.rfind(':', column_separator - 1);
+  if (line_separator == std::string_view::npos || line_separator == 0) {
+    return std::nullopt;
+  }
+
+  dsl::SourceSpan span;
+  if (!ParseLineColumn(head.substr(line_separator + 1), span.begin_line,
+                       span.begin_column) ||
+      !ParseLineColumn(text.substr(dash + 1), span.end_line,
+                       span.end_column)) {
+    return std::nullopt;
+  }
+  const auto file = head.substr(0, line_separator);
+  if (FormatSpan(file, span) != text) {
+    return std::nullopt;
+  }
+  span.structured = true;
+  return std::make_pair(file, span);
+}
+
+} // namespace
+
+namespace dsl {
+
+FactKind ClassifyFactKind(std::string_view kind) {
+  if (kind == "function") {
+    return FactKind::kFunction;
+  }
+  if (kind == "type") {
+    return FactKind::kType;
+  }
+  if (kind == "variable") {
+    return FactKind::kVariable;
+  }
+  if (kind == "owns") {
+    return FactKind::kOwns;
+  }
+  if (kind == "call") {
+    return FactKind::kCall;
+  }
+  if (kind == "type_usage") {
+    return FactKind::kTypeUsage;
+  }
+  return FactKind::kOther;
+}
+
+SymbolId SymbolIdForUsr(std::string_view usr) {
+  if (usr.empty()) {
+    return 0;
+  }
+  const auto id = Fnv1a64(usr);
+  return id == 0 ? 1 : id;
+}
+
+StringPool::StringPool() { Intern({}); }
+
+StringPool::StringPool(const StringPool &other) : StringPool() {
+  *this = other;
+}
+
+StringPool &StringPool::operator=(const StringPool &other) {
+  if (this == &other) {
+    return *this;
+  }
+  StringPool copy;
+  copy.values_.reserve(other.values_.size());
+  copy.ids_.reserve(other.values_.size());
+  for (std::size_t id = 1; id < other.values_.size(); ++id) {
+    copy.Intern(other.values_[id]);
+  }
+  *this = std::move(copy);
+  return *this;
+}
+
+StringPool::StringPool(StringPool &&other)
+    : blocks_(std::move(other.blocks_)),
+      block_capacity_(other.block_capacity_), block_used_(other.block_used_),
+      values_(std::move(other.values_)), ids_(std::move(other.ids_)) {
+  other.Reset();
+}
+
+StringPool &StringPool::operator=(StringPool &&other) {
+  if (this == &other) {
+    return *this;
+  }
+  blocks_ = std::move(other.blocks_);
+  block_capacity_ = other.block_capacity_;
+  block_used_ = other.block_used_;
+  values_ = std::move(other.values_);
+  ids_ = std::move(other.ids_);
+  other.Reset();
+  return *this;
+}
+
+// Leaves a moved-from pool usable: empty apart from the id 0 entry.
+void StringPool::Reset() {
+  blocks_.clear();
+  block_capacity_ = 0;
+  block_used_ = 0;
+  values_.clear();
+  ids_.clear();
+  Intern({});
+}
+
+StringId StringPool::Intern(std::string_view value) {
+  if (const auto found = ids_.find(value); found != ids_.end()) {
+    return found->second;
+  }
+  const auto stored = Store(value);
+  const auto id = static_cast<StringId>(values_.size());
+  values_.push_back(stored);
+  ids_.emplace(stored, id);
+  return id;
+}
+
+std::string_view StringPool::Store(std::string_view value) {
+  if (value.empty()) {
+    return {};
+  }
+  if (blocks_.empty() || block_capacity_ - block_used_ < value.size()) {
+    block_capacity_ = std::max(kStringBlockSize, value.size());
+    blocks_.push_back(std::make_unique<char[]>(block_capacity_));
+    block_used_ = 0;
+  }
+  auto *destination = blocks_.back().get() + block_used_;
+  std::memcpy(destination, value.data(), value.size());
+  block_used_ += value.size();
+  return {destination, value.size()};
+}
+
+std::string_view FactView::name() const { return store_->Text(fact_->name); }
+
+std::string_view FactView::kind() const {
+  return store_->Text(fact_->kind_text);
+}
+
+std::string_view FactView::signature() const {
+  return store_->Text(fact_->signature);
+}
+
+std::string_view FactView::descriptor() const {
+  return store_->Text(fact_->descriptor);
+}
+
+std::string_view FactView::target() const {
+  return store_->Text(fact_->target);
+}
+
+std::string_view FactView::doc_comment() const {
+  return store_->Text(fact_->doc_comment);
+}
+
+std::string_view FactView::scope_path() const {
+  return store_->Text(fact_->scope_path);
+}
+
+std::string FactView::source_location() const {
+  return store_->Location(fact_->location);
+}
+
+std::string FactView::range() const { return store_->Location(fact_->range); }
+
+std::string FactView::target_location() const {
+  return store_->Location(fact_->target_location);
+}
+
+std::string_view FactView::usr() const { return store_->Usr(fact_->symbol); }
+
+std::string_view FactView::target_usr() const {
+  return store_->Usr(fact_->target_symbol);
+}
+
+AstFact FactView::Materialize() const {
+  AstFact fact;
+  fact.name = name();
+  fact.kind = kind();
+  fact.source_location = source_location();
+  fact.signature = signature();
+  fact.descriptor = descriptor();
+  fact.target = target();
+  fact.range = range();
+  fact.doc_comment = doc_comment();
+  fact.scope_path = scope_path();
+  fact.subject_in_project = subject_in_project();
+  fact.target_scope = target_scope();
+  fact.target_location = target_location();
+  fact.usr = usr();
+  fact.target_usr = target_usr();
+  return fact;
+}
+
+FactStore::FactStore(std::initializer_list<AstFact> facts) {
+  facts_.reserve(facts.size());
+  for (const auto &fact : facts) {
+    push_back(fact);
+  }
+}
+
+void FactStore::Append(const FactStore &other) {
+  if (&other == this) {
+    const auto copy = facts_;
+    facts_.insert(facts_.end(), copy.begin(), copy.end());
+    return;
+  }
+  facts_.reserve(facts_.size() + other.size());
+  for (const auto &fact : other.compact_facts()) {
+    Add(Import(other, fact));
+  }
+}
+
+CompactFact FactStore::Compact(const AstFact &fact) {
+  CompactFact compact;
+  compact.name = Intern(fact.name);
+  compact.kind_text = Intern(fact.kind);
+  compact.signature = Intern(fact.signature);
+  compact.descriptor = Intern(fact.descriptor);
+  compact.target = Intern(fact.target);
+  compact.doc_comment = Intern(fact.doc_comment);
+  compact.scope_path = Intern(fact.scope_path);
+  compact.location = InternLocation(fact.source_location);
+  compact.range = fact.range == fact.source_location
+                      ? compact.location
+                      : InternLocation(fact.range);
+  compact.target_location = InternLocation(fact.target_location);
+  compact.symbol = InternSymbol(fact.usr);
+  compact.target_symbol = InternSymbol(fact.target_usr);
+  compact.kind = ClassifyFactKind(fact.kind);
+  compact.subject_in_project = fact.subject_in_project;
+  compact.target_scope = fact.target_scope;
+  return compact;
+}
+
+CompactFact FactStore::Import(const FactStore &source,
+                              const CompactFact &fact) {
+  if (&source == this) {
+    return fact;
+  }
+  CompactFact imported = fact;
+  imported.name = Intern(source.Text(fact.name));
+  imported.kind_text = Intern(source.Text(fact.kind_text));
+  imported.signature = Intern(source.Text(fact.signature));
+  imported.descriptor = Intern(source.Text(fact.descriptor));
+  imported.target = Intern(source.Text(fact.target));
+  imported.doc_comment = Intern(source.Text(fact.doc_comment));
+  imported.scope_path = Intern(source.Text(fact.scope_path));
+  imported.location = ImportLocation(source, fact.location);
+  imported.range = ImportLocation(source, fact.range);
+  imported.target_location = ImportLocation(source, fact.target_location);
+  imported.symbol = InternSymbol(source.Usr(fact.symbol));
+  imported.target_symbol = InternSymbol(source.Usr(fact.target_symbol));
+  return imported;
+}
+
+SourceSpan FactStore::InternLocation(std::string_view location) {
+  if (auto parsed = ParseSpan(location)) {
+    parsed->second.file = Intern(parsed->first);
+    return parsed->second;
+  }
+  SourceSpan span;
+  span.file = Intern(location);
+  return span;
+}
+
+SourceSpan FactStore::ImportLocation(const FactStore &source,
+                                     const SourceSpan &span) {
+  SourceSpan imported = span;
+  imported.file = Intern(source.Text(span.file));
+  return imported;
+}
+
+SymbolId FactStore::InternSymbol(std::string_view usr) {
+  const auto id = SymbolIdForUsr(usr);
+  if (id != 0) {
+    symbols_.try_emplace(id, Intern(usr));
+  }
+  return id;
+}
+
+std::string_view FactStore::Usr(SymbolId id) const {
+  const auto found = symbols_.find(id);
+  return found == symbols_.end() ? std::string_view{} : Text(found->second);
+}
+
+std::string FactStore::Location(const SourceSpan &span) const {
+  if (!span.structured) {
+    return std::string(Text(span.file));
+  }
+  return FormatSpan(Text(span.file), span);
+}
+
+} // namespace dsl
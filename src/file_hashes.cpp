@@ -0,0 +1,93 @@
+#include <dsl/file_hashes.h>
+
+#include <dsl/hashing.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+namespace dsl {
+
+FileHashes::FileHashes(std::optional<ChangeSet> changes) {
+  if (changes) {
+    revision_ = std::move(changes->revision);
+    unchanged_.insert(std::make_move_iterator(changes->unchanged.begin()),
+                      std::make_move_iterator(changes->unchanged.end()));
+  }
+}
+
+std::optional<std::uint64_t> FileHashes::Hash(const std::string &path) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const auto found = hashes_.find(path); found != hashes_.end()) {
+      return found->second;
+    }
+  }
+  const auto hash = HashFileContents(path);
+  std::lock_guard<std::mutex> lock(mutex_);
+  hashes_.emplace(path, hash);
+  return hash;
+}
+
+bool FileHashes::IsCurrent(const std::vector<FileDependency> &dependencies,
+                           const std::string &revision) {
+  if (!revision.empty() && revision == revision_ &&
+      AllUnchanged(dependencies)) {
+    return true;
+  }
+  return std::all_of(dependencies.begin(), dependencies.end(),
+                     [this](const FileDependency &dependency) {
+                       return Hash(dependency.path) == dependency.content_hash;
+                     });
+}
+
+bool FileHashes::Record(const std::vector<std::string> &paths,
+                        std::vector<FileDependency> &dependencies) {
+  dependencies.clear();
+  dependencies.reserve(paths.size());
+  for (const auto &path : paths) {
+    const auto hash = Hash(path);
+    if (!hash.has_value()) {
+      return false;
+    }
+    dependencies.push_back({path, *hash});
+  }
+  return !dependencies.empty();
+}
+
+std::string
+FileHashes::RevisionOf(const std::vector<FileDependency> &dependencies) {
+  if (revision_.empty() || !AllUnchanged(dependencies)) {
+    return {};
+  }
+  return revision_;
+}
+
+bool FileHashes::AllUnchanged(
+    const std::vector<FileDependency> &dependencies) {
+  return std::all_of(dependencies.begin(), dependencies.end(),
+                     [this](const FileDependency &dependency) {
+                       return unchanged_.count(Canonical(dependency.path)) !=
+                              0;
+                     });
+}
+
+std::string FileHashes::Canonical(const std::string &path) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const auto found = canonical_.find(path); found != canonical_.end()) {
+      return found->second;
+    }
+  }
+  std::error_code error;
+  auto canonical = std::filesystem::weakly_canonical(path, error).string();
+  if (error) {
+    canonical = path;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return canonical_.emplace(path, std::move(canonical)).first->second;
+}
+
+} // namespace dsl
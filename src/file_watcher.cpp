@@ -0,0 +1,214 @@
+#include <dsl/file_watcher.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace dsl {
+
+namespace {
+
+bool IsHidden(const std::filesystem::path &directory) {
+  const auto name = directory.filename().string();
+  return !name.empty() && name.front() == '.' && name != "." && name != "..";
+}
+
+} // namespace
+
+#ifdef __linux__
+
+namespace {
+
+constexpr std::uint32_t kWatchedEvents = IN_CLOSE_WRITE | IN_MOVED_TO |
+                                         IN_MOVED_FROM | IN_CREATE |
+                                         IN_DELETE;
+
+std::runtime_error WatchError(const std::string &action,
+                              const std::filesystem::path &path) {
+  return std::runtime_error(action + " " + path.string() + ": " +
+                            std::strerror(errno));
+}
+
+// A directory removed, or replaced by a file, before it could be watched.
+class VanishedDirectory : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+} // namespace
+
+FileWatcher::FileWatcher(std::vector<std::filesystem::path> excluded)
+    : descriptor_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+  if (descriptor_ < 0) {
+    throw WatchError("Cannot watch", "files");
+  }
+  for (auto &directory : excluded) {
+    excluded_.push_back(std::filesystem::weakly_canonical(directory));
+  }
+}
+
+FileWatcher::~FileWatcher() { ::close(descriptor_); }
+
+void FileWatcher::Add(const std::filesystem::path &directory, bool tree) {
+  const auto watch = ::inotify_add_watch(descriptor_, directory.c_str(),
+                                         kWatchedEvents | IN_ONLYDIR);
+  if (watch < 0) {
+    if (errno == ENOENT || errno == ENOTDIR) {
+      throw VanishedDirectory(directory.string());
+    }
+    throw WatchError("Cannot watch", directory);
+  }
+  watches_[watch] = WatchedDirectory{directory, tree};
+}
+
+std::vector<std::filesystem::path>
+FileWatcher::WaitForChanges(std::chrono::milliseconds quiet) {
+  std::vector<std::filesystem::path> changed;
+  lost_events_ = false;
+  pollfd pending{descriptor_, POLLIN, 0};
+  const auto quiet_ms = static_cast<int>(quiet.count());
+  for (;;) {
+    const auto idle = changed.empty() && !lost_events_;
+    const auto ready = ::poll(&pending, 1, idle ? -1 : quiet_ms);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw WatchError("Cannot wait for changes in", "watched directories");
+    }
+    if (ready == 0) {
+      break;
+    }
+    Drain(changed);
+  }
+  if (lost_events_) {
+    // Directories created while events were dropped are not watched yet.
+    for (const auto &root : trees_) {
+      WatchNewTree(root);
+    }
+  }
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  return changed;
+}
+
+void FileWatcher::Drain(std::vector<std::filesystem::path> &changed) {
+  alignas(inotify_event) char buffer[16 * 1024];
+  for (;;) {
+    const auto length = ::read(descriptor_, buffer, sizeof(buffer));
+    if (length <= 0) {
+      break;
+    }
+    for (auto offset = 0L; offset < length;) {
+      const auto *event = reinterpret_cast<const inotify_event *>(
+          buffer + offset);
+      offset += static_cast<long>(sizeof(inotify_event) + event->len);
+      if ((event->mask & IN_Q_OVERFLOW) != 0) {
+        lost_events_ = true;
+        continue;
+      }
+      if ((event->mask & IN_IGNORED) != 0) {
+        watches_.erase(event->wd);
+        continue;
+      }
+      const auto watched = watches_.find(event->wd);
+      if (watched == watches_.end() || event->len == 0) {
+        continue;
+      }
+      const auto path = watched->second.path / event->name;
+      if ((event->mask & IN_ISDIR) != 0) {
+        // A directory created or moved into a tree is watched from now on,
+        // unless it is hidden, as in the initial walk; files already
+        // written into it are missed.
+        if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0 &&
+            watched->second.tree && !IsHidden(path)) {
+          WatchNewTree(path);
+        }
+        continue;
+      }
+      changed.push_back(path);
+    }
+  }
+}
+
+void FileWatcher::WatchNewTree(const std::filesystem::path &directory) {
+  // Build tools and editors create and delete temporary directories all the
+  // time; one that is gone before it is watched has nothing to report.
+  try {
+    AddTree(directory);
+  } catch (const VanishedDirectory &) {
+  } catch (const std::filesystem::filesystem_error &) {
+  }
+}
+
+#else
+
+FileWatcher::FileWatcher(std::vector<std::filesystem::path> excluded)
+    : excluded_(std::move(excluded)) {
+  throw std::runtime_error("Watching files requires inotify (Linux only)");
+}
+
+FileWatcher::~FileWatcher() = default;
+
+void FileWatcher::Add(const std::filesystem::path &, bool) {}
+
+std::vector<std::filesystem::path>
+FileWatcher::WaitForChanges(std::chrono::milliseconds) {
+  return {};
+}
+
+void FileWatcher::Drain(std::vector<std::filesystem::path> &) {}
+
+void FileWatcher::WatchNewTree(const std::filesystem::path &) {}
+
+#endif
+
+void FileWatcher::Watch(const std::filesystem::path &directory) {
+  Add(std::filesystem::weakly_canonical(directory), false);
+}
+
+void FileWatcher::WatchTree(const std::filesystem::path &root) {
+  const auto canonical_root = std::filesystem::weakly_canonical(root);
+  if (std::find(trees_.begin(), trees_.end(), canonical_root) ==
+      trees_.end()) {
+    trees_.push_back(canonical_root);
+  }
+  AddTree(canonical_root);
+}
+
+void FileWatcher::AddTree(const std::filesystem::path &canonical_root) {
+  if (IsExcluded(canonical_root)) {
+    return;
+  }
+  Add(canonical_root, true);
+  for (auto entry =
+           std::filesystem::recursive_directory_iterator(canonical_root);
+       entry != std::filesystem::recursive_directory_iterator(); ++entry) {
+    if (!entry->is_directory() || entry->is_symlink()) {
+      continue;
+    }
+    if (IsHidden(entry->path()) || IsExcluded(entry->path())) {
+      entry.disable_recursion_pending();
+      continue;
+    }
+    Add(entry->path(), true);
+  }
+}
+
+bool FileWatcher::IsExcluded(const std::filesystem::path &directory) const {
+  return std::find(excluded_.begin(), excluded_.end(), directory) !=
+         excluded_.end();
+}
+
+} // namespace dsl
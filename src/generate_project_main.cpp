@@ -0,0 +1,17 @@
+#include <dsl/project_generator.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+  try {
+    return dsl::RunGenerateProject(
+        std::vector<std::string>(argv + 1, argv + argc));
+  } catch (const std::exception &ex) {
+    std::cerr << "Error: " << ex.what() << "\n"
+              << "Run 'dsl-generate-project --help' for options.\n";
+    return 1;
+  }
+}
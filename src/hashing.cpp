@@ -0,0 +1,44 @@
+#include <dsl/hashing.h>
+
+#include <array>
+#include <fstream>
+
+namespace dsl {
+
+std::uint64_t Fnv1a64(std::string_view data, std::uint64_t seed) {
+  constexpr std::uint64_t kPrime = 1099511628211ULL;
+  std::uint64_t hash = seed;
+  for (const auto character : data) {
+    hash ^= static_cast<unsigned char>(character);
+    hash *= kPrime;
+  }
+  return hash;
+}
+
+std::string HashToHex(std::uint64_t hash) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  std::string hex(16, '0');
+  for (auto position = hex.rbegin(); position != hex.rend(); ++position) {
+    *position = kDigits[hash & 0xFU];
+    hash >>= 4U;
+  }
+  return hex;
+}
+
+std::optional<std::uint64_t>
+HashFileContents(const std::filesystem::path &path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return std::nullopt;
+  }
+  std::array<char, 64 * 1024> buffer{};
+  std::uint64_t hash = kFnv1a64Offset;
+  while (stream) {
+    stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    const auto count = static_cast<std::size_t>(stream.gcount());
+    hash = Fnv1a64(std::string_view(buffer.data(), count), hash);
+  }
+  return hash;
+}
+
+} // namespace dsl
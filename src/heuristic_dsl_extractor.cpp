@@ -1,11 +1,17 @@
 #include <dsl/heuristic_dsl_extractor.h>
 
+#include <dsl/hashing.h>
+#include <dsl/naming.h>
+
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -13,47 +19,164 @@
 
 namespace {
 
+using dsl::CanonicalizeName;
+using dsl::SymbolId;
+
 struct ParsedKind {
   std::string base_kind;
   std::optional<std::string> relationship_target;
   std::optional<std::string> descriptor;
 };
 
+// The symbols a contribution depends on whose project membership was not
+// known yet when its fact was folded. It counts only if every one of them
+// turns out to be a project symbol.
+struct Pending {
+  SymbolId first = 0;
+  SymbolId second = 0;
+
+  void Require(SymbolId symbol) {
+    if (symbol == first || symbol == second) {
+      return;
+    }
+    if (first == 0) {
+      first = symbol;
+      return;
+    }
+    second = symbol;
+    if (second < first) {
+      std::swap(first, second);
+    }
+  }
+
+  bool operator==(const Pending &other) const {
+    return first == other.first && second == other.second;
+  }
+};
+
 struct RelationshipKey {
-  std::string subject;
+  SymbolId subject;
   std::string verb;
-  std::string object;
+  SymbolId object;
+  Pending pending;
 
   bool operator==(const RelationshipKey &other) const {
     return subject == other.subject && verb == other.verb &&
-           object == other.object;
+           object == other.object && pending == other.pending;
   }
 };
 
 struct RelationshipKeyHash {
   std::size_t operator()(const RelationshipKey &key) const {
-    return std::hash<std::string>{}(key.subject) ^
+    return std::hash<SymbolId>{}(key.subject) ^
            (std::hash<std::string>{}(key.verb) << 1) ^
-           (std::hash<std::string>{}(key.object) << 2);
+           (std::hash<SymbolId>{}(key.object) << 2) ^
+           (std::hash<SymbolId>{}(key.pending.first) << 3) ^
+           (std::hash<SymbolId>{}(key.pending.second) << 4);
+  }
+};
+
+struct TermKey {
+  SymbolId symbol;
+  Pending pending;
+
+  bool operator==(const TermKey &other) const {
+    return symbol == other.symbol && pending == other.pending;
+  }
+};
+
+struct TermKeyHash {
+  std::size_t operator()(const TermKey &key) const {
+    return std::hash<SymbolId>{}(key.symbol) ^
+           (std::hash<SymbolId>{}(key.pending.first) << 1) ^
+           (std::hash<SymbolId>{}(key.pending.second) << 2);
   }
 };
 
+// What the facts folded so far contribute to one term under one condition.
+// `order` is the fact that started the draft; drafts of one term are merged
+// in that order.
+struct TermDraft {
+  dsl::DslTerm term;
+  std::unordered_set<std::string> aliases;
+  std::string fallback_definition;
+  std::uint64_t order = 0;
+};
+
+struct RelationshipDraft {
+  dsl::DslRelationship relationship;
+  std::uint64_t order = 0;
+};
+
+using TermDraftMap = std::unordered_map<TermKey, TermDraft, TermKeyHash>;
+using RelationshipDraftMap =
+    std::unordered_map<RelationshipKey, RelationshipDraft,
+                       RelationshipKeyHash>;
 using RelationshipMap =
     std::unordered_map<RelationshipKey, dsl::DslRelationship,
                        RelationshipKeyHash>;
-using TermMap = std::unordered_map<std::string, dsl::DslTerm>;
-using AliasMap =
-    std::unordered_map<std::string, std::unordered_set<std::string>>;
-using FallbackDefinitionMap = std::unordered_map<std::string, std::string>;
+using TermMap = std::unordered_map<SymbolId, dsl::DslTerm>;
+using FallbackDefinitionMap = std::unordered_map<SymbolId, std::string>;
+
+// Facts without a USR are identified by their canonical name, hashed apart
+// from USR-based ids.
+constexpr std::uint64_t kNameSymbolSeed = 0x6e616d6573796d62ULL;
+
+// Resolves the subjects and targets of facts to symbol ids. Facts with a USR
+// use its id, so the same entity merges across translation units and
+// overloads stay apart; anything else is identified by its canonical name, as
+// before USRs were recorded. Names are canonicalized once per distinct
+// spelling and display names only when a term or relationship is built.
+class SymbolTable {
+public:
+  SymbolId Subject(const dsl::FactView &fact) {
+    return Resolve(fact.symbol(), fact.name());
+  }
 
-std::string CanonicalizeName(std::string name) {
-  std::replace(name.begin(), name.end(), ':', '.');
-  std::transform(name.begin(), name.end(), name.begin(),
-                 [](unsigned char character) {
-                   return static_cast<char>(std::tolower(character));
-                 });
-  return name;
-}
+  SymbolId Target(const dsl::FactView &fact, const ParsedKind &parsed) {
+    if (!fact.target().empty()) {
+      return Resolve(fact.target_symbol(), fact.target());
+    }
+    // Targets spelled in the kind string are not interned in the store.
+    auto canonical = CanonicalizeName(*parsed.relationship_target);
+    const auto id = dsl::Fnv1a64(canonical, kNameSymbolSeed);
+    display_names_.try_emplace(id, std::move(canonical));
+    return id;
+  }
+
+  SymbolId Target(const dsl::FactView &fact) {
+    return Resolve(fact.target_symbol(), fact.target());
+  }
+
+  const std::string &DisplayName(SymbolId id) const {
+    const auto [found, inserted] = display_names_.try_emplace(id);
+    if (inserted) {
+      found->second = CanonicalizeName(spellings_.at(id));
+    }
+    return found->second;
+  }
+
+private:
+  // Spellings are copied, since the batches they come from are not kept.
+  SymbolId Resolve(SymbolId symbol, std::string_view spelling) {
+    if (symbol != 0) {
+      spellings_.try_emplace(symbol, spelling);
+      return symbol;
+    }
+    const auto [found, inserted] = named_.try_emplace(dsl::Fnv1a64(spelling));
+    if (inserted) {
+      auto canonical = CanonicalizeName(spelling);
+      found->second = dsl::Fnv1a64(canonical, kNameSymbolSeed);
+      display_names_.try_emplace(found->second, std::move(canonical));
+    }
+    return found->second;
+  }
+
+  // Keyed by the hash of the spelling; string ids only hold within a batch.
+  std::unordered_map<std::uint64_t, SymbolId> named_;
+  std::unordered_map<SymbolId, std::string> spellings_;
+  mutable std::unordered_map<SymbolId, std::string> display_names_;
+};
 
 std::vector<std::string>
 CanonicalizeNamespaces(const std::vector<std::string> &namespaces) {
@@ -65,50 +188,69 @@ CanonicalizeNamespaces(const std::vector<std::string> &namespaces) {
   return canonicalized;
 }
 
+// Decides which facts describe project symbols. Symbols are learned as facts
+// are observed, so a fact whose symbols are not known yet is only in scope
+// if they are by the time every batch is in; those are added to `pending`.
 class ScopeFilter {
 public:
-  ScopeFilter(const dsl::AstIndex &index,
-              const std::vector<std::string> &ignored_namespaces)
-      : ignored_namespaces_(CanonicalizeNamespaces(ignored_namespaces)) {
-    for (const auto &fact : index.facts) {
-      if (!fact.subject_in_project) {
-        continue;
-      }
-      if (IsIgnored(fact.name)) {
-        continue;
-      }
-      if (fact.kind == "function" || fact.kind == "type" ||
-          fact.kind == "variable") {
-        in_project_symbols_.insert(CanonicalizeName(fact.name));
-      }
+  ScopeFilter(const std::vector<std::string> &ignored_namespaces,
+              const SymbolTable &symbols)
+      : ignored_namespaces_(CanonicalizeNamespaces(ignored_namespaces)),
+        symbols_(&symbols) {}
+
+  void Observe(const dsl::FactView &fact, SymbolId subject) {
+    if (!fact.subject_in_project()) {
+      return;
+    }
+    if (IsIgnored(subject)) {
+      return;
+    }
+    const auto kind = fact.kind_id();
+    if (kind == dsl::FactKind::kFunction || kind == dsl::FactKind::kType ||
+        kind == dsl::FactKind::kVariable) {
+      in_project_symbols_.insert(subject);
     }
   }
 
-  bool SubjectInScope(const dsl::AstFact &fact) const {
-    if (IsIgnored(fact.name)) {
+  bool SubjectInScope(const dsl::FactView &fact, SymbolId subject,
+                      Pending &pending) const {
+    if (IsIgnored(subject) || !fact.subject_in_project()) {
       return false;
     }
-    return fact.subject_in_project &&
-           in_project_symbols_.count(CanonicalizeName(fact.name)) > 0;
+    RequireProjectSymbol(subject, pending);
+    return true;
   }
 
-  bool TargetInScope(const dsl::AstFact &fact) const {
-    if (IsIgnored(fact.target)) {
+  bool TargetInScope(const dsl::FactView &fact, SymbolId target,
+                     Pending &pending) const {
+    if (!fact.target().empty() && IsIgnored(target)) {
       return false;
     }
-    if (fact.target_scope == dsl::AstFact::TargetScope::kExternal) {
+    if (fact.target_scope() == dsl::AstFact::TargetScope::kExternal) {
       return false;
     }
-    if (fact.target_scope == dsl::AstFact::TargetScope::kInProject) {
+    if (fact.target_scope() == dsl::AstFact::TargetScope::kInProject) {
       return true;
     }
-    if (fact.target.empty()) {
+    if (fact.target().empty()) {
       return true;
     }
-    return in_project_symbols_.count(CanonicalizeName(fact.target)) > 0;
+    RequireProjectSymbol(target, pending);
+    return true;
+  }
+
+  bool Satisfied(const Pending &pending) const {
+    return (pending.first == 0 || in_project_symbols_.count(pending.first)) &&
+           (pending.second == 0 || in_project_symbols_.count(pending.second));
   }
 
 private:
+  void RequireProjectSymbol(SymbolId symbol, Pending &pending) const {
+    if (in_project_symbols_.count(symbol) == 0) {
+      pending.Require(symbol);
+    }
+  }
+
   bool HasIgnoredPrefix(const std::string &canonicalized_name) const {
     for (const auto &ns : ignored_namespaces_) {
       if (canonicalized_name.compare(0, ns.size(), ns) == 0) {
@@ -121,31 +263,40 @@ private:
     return false;
   }
 
-  bool IsIgnored(const std::string &name) const {
-    if (name.empty()) {
+  bool IsIgnored(SymbolId symbol) const {
+    if (ignored_namespaces_.empty()) {
       return false;
     }
-    return HasIgnoredPrefix(CanonicalizeName(name));
+    const auto [found, inserted] = ignored_.try_emplace(symbol);
+    if (inserted) {
+      const auto &name = symbols_->DisplayName(symbol);
+      found->second = !name.empty() && HasIgnoredPrefix(name);
+    }
+    return found->second;
   }
 
-  std::unordered_set<std::string> in_project_symbols_;
+  std::unordered_set<SymbolId> in_project_symbols_;
   std::vector<std::string> ignored_namespaces_;
+  const SymbolTable *symbols_;
+  mutable std::unordered_map<SymbolId, bool> ignored_;
 };
 
-std::string EvidenceLocation(const dsl::AstFact &fact) {
-  std::string location = fact.source_location;
-  if (!fact.range.empty() && fact.range != fact.source_location) {
+std::string EvidenceLocation(const dsl::FactView &fact) {
+  std::string location = fact.source_location();
+  const auto range = fact.range();
+  if (!range.empty() && range != location) {
     if (location.empty()) {
-      location = fact.range;
+      location = range;
     } else {
-      location.append("@").append(fact.range);
+      location.append("@").append(range);
     }
   }
-  if (!fact.scope_path.empty()) {
+  const auto scope_path = fact.scope_path();
+  if (!scope_path.empty()) {
     if (location.empty()) {
-      return fact.scope_path;
+      return std::string(scope_path);
     }
-    return fact.scope_path + "@" + location;
+    return std::string(scope_path).append("@").append(location);
   }
   return location;
 }
@@ -176,15 +327,15 @@ void ExtractRelationshipTarget(ParsedKind &parsed) {
   parsed.base_kind = parsed.base_kind.substr(0, relationship_separator);
 }
 
-ParsedKind ParseKind(const dsl::AstFact &fact) {
-  ParsedKind parsed{fact.kind, std::nullopt, std::nullopt};
+ParsedKind ParseKind(const dsl::FactView &fact) {
+  ParsedKind parsed{std::string(fact.kind()), std::nullopt, std::nullopt};
   ExtractDescriptor(parsed);
   ExtractRelationshipTarget(parsed);
-  if (!fact.descriptor.empty()) {
-    parsed.descriptor = fact.descriptor;
+  if (!fact.descriptor().empty()) {
+    parsed.descriptor = std::string(fact.descriptor());
   }
-  if (!fact.target.empty()) {
-    parsed.relationship_target = fact.target;
+  if (!fact.target().empty()) {
+    parsed.relationship_target = std::string(fact.target());
   }
   return parsed;
 }
@@ -218,21 +369,25 @@ void AddEvidence(const std::string &evidence_location,
   }
 }
 
-void AppendDefinitionPart(const std::string &definition_part,
-                          dsl::DslTerm &term) {
-  if (definition_part.empty()) {
+void AppendPart(std::string_view part, std::string &joined) {
+  if (part.empty()) {
     return;
   }
-  if (term.definition.empty()) {
-    term.definition = definition_part;
+  if (joined.empty()) {
+    joined.assign(part);
     return;
   }
-  if (term.definition.find(definition_part) == std::string::npos) {
-    term.definition.append(" | ");
-    term.definition.append(definition_part);
+  if (joined.find(part) == std::string::npos) {
+    joined.append(" | ");
+    joined.append(part);
   }
 }
 
+void AppendDefinitionPart(std::string_view definition_part,
+                          dsl::DslTerm &term) {
+  AppendPart(definition_part, term.definition);
+}
+
 void EnsureKindInitialized(const ParsedKind &parsed, dsl::DslTerm &term) {
   if (!term.kind.empty()) {
     return;
@@ -240,139 +395,220 @@ void EnsureKindInitialized(const ParsedKind &parsed, dsl::DslTerm &term) {
   term.kind = DeriveTermKind(parsed.base_kind);
 }
 
-void AppendAlias(const std::string &canonical_name, const std::string &alias,
-                 AliasMap &aliases, dsl::DslTerm &term) {
-  if (canonical_name == alias) {
+void AppendAlias(std::string_view alias, TermDraft &draft) {
+  if (draft.term.name == alias) {
     return;
   }
-  if (aliases[canonical_name].insert(alias).second) {
-    term.aliases.push_back(alias);
+  if (draft.aliases.insert(std::string(alias)).second) {
+    draft.term.aliases.emplace_back(alias);
   }
 }
 
-RelationshipKey MakeRelationshipKey(const dsl::AstFact &fact,
-                                    const ParsedKind &parsed) {
-  return {CanonicalizeName(fact.name),
-          RelationshipVerbForKind(parsed.base_kind),
-          CanonicalizeName(*parsed.relationship_target)};
+TermDraft &DraftFor(SymbolId symbol, const Pending &pending,
+                    std::uint64_t order, TermDraftMap &terms,
+                    const SymbolTable &symbols) {
+  const auto [found, inserted] = terms.try_emplace(TermKey{symbol, pending});
+  auto &draft = found->second;
+  if (inserted) {
+    draft.term.name = symbols.DisplayName(symbol);
+    draft.term.symbol = symbol;
+    draft.order = order;
+  }
+  return draft;
 }
 
 void InitializeRelationshipParticipants(const RelationshipKey &key,
+                                        const SymbolTable &symbols,
                                         dsl::DslRelationship &relationship) {
-  relationship.subject = key.subject;
+  if (!relationship.verb.empty()) {
+    return;
+  }
+  relationship.subject = symbols.DisplayName(key.subject);
   relationship.verb = key.verb;
-  relationship.object = key.object;
+  relationship.object = symbols.DisplayName(key.object);
 }
 
 void UpdateRelationshipNotes(const ParsedKind &parsed,
                              dsl::DslRelationship &relationship) {
-  if (!parsed.descriptor.has_value() || parsed.descriptor->empty()) {
-    return;
-  }
-  if (relationship.notes.empty()) {
-    relationship.notes = *parsed.descriptor;
-    return;
-  }
-  if (relationship.notes.find(*parsed.descriptor) == std::string::npos) {
-    relationship.notes.append(" | ");
-    relationship.notes.append(*parsed.descriptor);
+  if (parsed.descriptor.has_value()) {
+    AppendPart(*parsed.descriptor, relationship.notes);
   }
 }
 
-void TrackRelationship(const dsl::AstFact &fact, const ParsedKind &parsed,
-                       RelationshipMap &relationships,
+void TrackRelationship(const dsl::FactView &fact, const ParsedKind &parsed,
+                       SymbolId subject, SymbolId target, Pending pending,
+                       std::uint64_t order,
+                       RelationshipDraftMap &relationships,
+                       const SymbolTable &symbols,
                        const ScopeFilter &scope_filter) {
-  if (!parsed.relationship_target.has_value() ||
-      !scope_filter.TargetInScope(fact)) {
+  if (!scope_filter.TargetInScope(fact, target, pending)) {
     return;
   }
-  const auto key = MakeRelationshipKey(fact, parsed);
-  auto &relationship = relationships[key];
-  InitializeRelationshipParticipants(key, relationship);
+  const RelationshipKey key{subject, RelationshipVerbForKind(parsed.base_kind),
+                            target, pending};
+  const auto [found, inserted] = relationships.try_emplace(key);
+  auto &draft = found->second;
+  if (inserted) {
+    draft.order = order;
+  }
+  auto &relationship = draft.relationship;
+  InitializeRelationshipParticipants(key, symbols, relationship);
   AddEvidence(EvidenceLocation(fact), relationship.evidence);
   UpdateRelationshipNotes(parsed, relationship);
   ++relationship.usage_count;
 }
 
-void TrackTargetReference(const dsl::AstFact &fact, const ParsedKind &parsed,
-                          TermMap &terms, AliasMap &aliases,
+void TrackTargetReference(const dsl::FactView &fact, const ParsedKind &parsed,
+                          SymbolId target_symbol, Pending pending,
+                          std::uint64_t order, TermDraftMap &terms,
+                          const SymbolTable &symbols,
                           const ScopeFilter &scope_filter) {
-  if (!parsed.relationship_target.has_value() ||
-      !scope_filter.TargetInScope(fact)) {
+  if (!scope_filter.TargetInScope(fact, target_symbol, pending)) {
     return;
   }
-  const auto target_name = CanonicalizeName(*parsed.relationship_target);
-  auto &target = terms[target_name];
-  if (target.name.empty()) {
-    target.name = target_name;
-  }
-  AddEvidence(EvidenceLocation(fact), target.evidence);
-  ++target.usage_count;
+  auto &target = DraftFor(target_symbol, pending, order, terms, symbols);
+  AddEvidence(EvidenceLocation(fact), target.term.evidence);
+  ++target.term.usage_count;
   if (IsSymbolReference(parsed)) {
-    AppendAlias(target_name, fact.name, aliases, target);
+    AppendAlias(fact.name(), target);
   }
 }
 
-void TrackExternalDependency(const dsl::AstFact &fact, TermMap &externals,
-                             FallbackDefinitionMap &fallback_definitions) {
-  if (fact.target_scope != dsl::AstFact::TargetScope::kExternal ||
-      fact.target.empty()) {
+void TrackExternalDependency(const dsl::FactView &fact, TermMap &externals,
+                             FallbackDefinitionMap &fallback_definitions,
+                             SymbolTable &symbols) {
+  if (fact.target_scope() != dsl::AstFact::TargetScope::kExternal ||
+      fact.target().empty()) {
     return;
   }
 
-  const auto canonical_name = CanonicalizeName(fact.target);
-  auto &dependency = externals[canonical_name];
-  dependency.name = canonical_name;
-  dependency.kind = "External";
-  fallback_definitions.try_emplace(canonical_name,
-                                   "External dependency reference");
-  AppendDefinitionPart(fact.descriptor, dependency);
-  AppendDefinitionPart(fact.signature, dependency);
-  AppendDefinitionPart(fact.doc_comment, dependency);
-  AppendDefinitionPart(fact.scope_path, dependency);
+  const auto symbol = symbols.Target(fact);
+  auto &dependency = externals[symbol];
+  if (dependency.name.empty()) {
+    dependency.name = symbols.DisplayName(symbol);
+    dependency.kind = "External";
+  }
+  fallback_definitions.try_emplace(symbol, "External dependency reference");
+  AppendDefinitionPart(fact.descriptor(), dependency);
+  AppendDefinitionPart(fact.signature(), dependency);
+  AppendDefinitionPart(fact.doc_comment(), dependency);
+  AppendDefinitionPart(fact.scope_path(), dependency);
   AddEvidence(EvidenceLocation(fact), dependency.evidence);
   ++dependency.usage_count;
 }
 
-void UpdateTermFromFact(const dsl::AstFact &fact, TermMap &terms,
-                        AliasMap &aliases, RelationshipMap &relationships,
-                        const ScopeFilter &scope_filter,
-                        TermMap &external_dependencies,
-                        FallbackDefinitionMap &term_fallback_definitions,
-                        FallbackDefinitionMap &external_fallbacks) {
-  TrackExternalDependency(fact, external_dependencies, external_fallbacks);
+// Adds what `fact` contributes to the drafts of its terms and relationships.
+// References count whether or not their subject is in scope.
+void FoldFact(const dsl::FactView &fact, SymbolId subject, std::uint64_t order,
+              TermDraftMap &terms, RelationshipDraftMap &relationships,
+              SymbolTable &symbols, const ScopeFilter &scope_filter) {
   const auto parsed = ParseKind(fact);
-  if (!scope_filter.SubjectInScope(fact) && !IsSymbolReference(parsed)) {
+  Pending pending;
+  if (!IsSymbolReference(parsed) &&
+      !scope_filter.SubjectInScope(fact, subject, pending)) {
     return;
   }
-  if (IsSymbolReference(parsed) && parsed.relationship_target.has_value()) {
-    TrackTargetReference(fact, parsed, terms, aliases, scope_filter);
+  std::optional<SymbolId> target;
+  if (parsed.relationship_target.has_value()) {
+    target = symbols.Target(fact, parsed);
+  }
+  if (IsSymbolReference(parsed) && target.has_value()) {
+    TrackTargetReference(fact, parsed, *target, pending, order, terms, symbols,
+                         scope_filter);
     return;
   }
-  const auto canonical_name = CanonicalizeName(fact.name);
-  auto &term = terms[canonical_name];
-  term.name = canonical_name;
+  auto &draft = DraftFor(subject, pending, order, terms, symbols);
+  auto &term = draft.term;
   EnsureKindInitialized(parsed, term);
-  AppendDefinitionPart(fact.doc_comment, term);
+  AppendDefinitionPart(fact.doc_comment(), term);
   AppendDefinitionPart(parsed.descriptor.value_or(""), term);
-  AppendDefinitionPart(fact.signature, term);
-  AppendDefinitionPart(fact.scope_path, term);
+  AppendDefinitionPart(fact.signature(), term);
+  AppendDefinitionPart(fact.scope_path(), term);
   AddEvidence(EvidenceLocation(fact), term.evidence);
   ++term.usage_count;
-  AppendAlias(canonical_name, fact.name, aliases, term);
-  TrackRelationship(fact, parsed, relationships, scope_filter);
-  TrackTargetReference(fact, parsed, terms, aliases, scope_filter);
-  term_fallback_definitions.try_emplace(canonical_name,
-                                        "Declared as " + parsed.base_kind);
+  AppendAlias(fact.name(), draft);
+  if (target.has_value()) {
+    TrackRelationship(fact, parsed, subject, *target, pending, order,
+                      relationships, symbols, scope_filter);
+    TrackTargetReference(fact, parsed, *target, pending, order, terms, symbols,
+                         scope_filter);
+  }
+  if (draft.fallback_definition.empty()) {
+    draft.fallback_definition = "Declared as " + parsed.base_kind;
+  }
 }
 
-std::vector<dsl::DslTerm> MoveTerms(TermMap &terms) {
-  std::vector<dsl::DslTerm> term_list;
-  term_list.reserve(terms.size());
-  for (auto &entry : terms) {
-    term_list.push_back(std::move(entry.second));
+// The drafts whose pending symbols all turned out to be project symbols, in
+// the order of the facts that started them.
+template <typename DraftMap>
+std::vector<typename DraftMap::value_type *>
+ReadyDrafts(DraftMap &drafts, const ScopeFilter &scope_filter) {
+  std::vector<typename DraftMap::value_type *> ready;
+  ready.reserve(drafts.size());
+  for (auto &entry : drafts) {
+    if (scope_filter.Satisfied(entry.first.pending)) {
+      ready.push_back(&entry);
+    }
   }
-  return term_list;
+  std::sort(ready.begin(), ready.end(), [](const auto *lhs, const auto *rhs) {
+    return lhs->second.order < rhs->second.order;
+  });
+  return ready;
+}
+
+void MergeTermDrafts(TermDraftMap &drafts, const ScopeFilter &scope_filter,
+                     TermMap &terms,
+                     FallbackDefinitionMap &fallback_definitions) {
+  for (auto *entry : ReadyDrafts(drafts, scope_filter)) {
+    const auto symbol = entry->first.symbol;
+    auto &draft = entry->second;
+    if (!draft.fallback_definition.empty()) {
+      fallback_definitions.try_emplace(symbol,
+                                       std::move(draft.fallback_definition));
+    }
+    const auto [found, inserted] = terms.try_emplace(symbol);
+    auto &term = found->second;
+    if (inserted) {
+      term = std::move(draft.term);
+      continue;
+    }
+    if (term.kind.empty()) {
+      term.kind = std::move(draft.term.kind);
+    }
+    AppendDefinitionPart(draft.term.definition, term);
+    for (const auto &evidence : draft.term.evidence) {
+      AddEvidence(evidence, term.evidence);
+    }
+    for (auto &alias : draft.term.aliases) {
+      if (std::find(term.aliases.begin(), term.aliases.end(), alias) ==
+          term.aliases.end()) {
+        term.aliases.push_back(std::move(alias));
+      }
+    }
+    term.usage_count += draft.term.usage_count;
+  }
+}
+
+RelationshipMap MergeRelationshipDrafts(RelationshipDraftMap &drafts,
+                                        const ScopeFilter &scope_filter) {
+  RelationshipMap relationships;
+  for (auto *entry : ReadyDrafts(drafts, scope_filter)) {
+    auto key = entry->first;
+    key.pending = {};
+    auto &draft = entry->second.relationship;
+    const auto [found, inserted] = relationships.try_emplace(std::move(key));
+    auto &relationship = found->second;
+    if (inserted) {
+      relationship = std::move(draft);
+      continue;
+    }
+    for (const auto &evidence : draft.evidence) {
+      AddEvidence(evidence, relationship.evidence);
+    }
+    AppendPart(draft.notes, relationship.notes);
+    relationship.usage_count += draft.usage_count;
+  }
+  return relationships;
 }
 
 bool ContainsHelperKeyword(const std::string &value) {
@@ -396,7 +632,7 @@ bool HasMeaningfulDefinition(const dsl::DslTerm &term) {
 enum class TermRelevance { kDrop, kLowPriority, kKeep };
 
 TermRelevance EvaluateRelevance(const dsl::DslTerm &term,
-                                const FallbackDefinitionMap &fallbacks) {
+                                const std::string *fallback) {
   const bool helper_like = ContainsHelperKeyword(term.name) ||
                            ContainsHelperKeyword(term.definition);
   const bool meaningful_definition = HasMeaningfulDefinition(term);
@@ -407,7 +643,7 @@ TermRelevance EvaluateRelevance(const dsl::DslTerm &term,
   if (helper_like) {
     score -= 2;
   }
-  if (!meaningful_definition && fallbacks.find(term.name) != fallbacks.end()) {
+  if (!meaningful_definition && fallback != nullptr) {
     --score;
   }
   if (score <= 0) {
@@ -419,28 +655,17 @@ TermRelevance EvaluateRelevance(const dsl::DslTerm &term,
   return TermRelevance::kKeep;
 }
 
-void ApplyFallbackDefinitions(const FallbackDefinitionMap &fallbacks,
-                              std::vector<dsl::DslTerm> &terms) {
-  for (auto &term : terms) {
-    if (!term.definition.empty()) {
-      continue;
-    }
-    const auto iterator = fallbacks.find(term.name);
-    if (iterator != fallbacks.end()) {
-      term.definition = iterator->second;
-    }
-  }
-}
-
 std::vector<dsl::DslTerm>
 FilterAndFinalizeTerms(TermMap &terms,
                        const FallbackDefinitionMap &fallback_definitions) {
-  auto candidates = MoveTerms(terms);
   std::vector<dsl::DslTerm> filtered_terms;
-  filtered_terms.reserve(candidates.size());
+  filtered_terms.reserve(terms.size());
 
-  for (auto &term : candidates) {
-    const auto relevance = EvaluateRelevance(term, fallback_definitions);
+  for (auto &[symbol, term] : terms) {
+    const auto found = fallback_definitions.find(symbol);
+    const auto *fallback =
+        found != fallback_definitions.end() ? &found->second : nullptr;
+    const auto relevance = EvaluateRelevance(term, fallback);
     if (relevance == TermRelevance::kDrop) {
       continue;
     }
@@ -448,33 +673,14 @@ FilterAndFinalizeTerms(TermMap &terms,
       AppendDefinitionPart(
           "Low relevance: helper/utility or lightly referenced symbol", term);
     }
+    if (term.definition.empty() && fallback != nullptr) {
+      term.definition = *fallback;
+    }
     filtered_terms.push_back(std::move(term));
   }
-
-  ApplyFallbackDefinitions(fallback_definitions, filtered_terms);
   return filtered_terms;
 }
 
-std::vector<dsl::DslTerm> BuildTerms(const dsl::AstIndex &index,
-                                     RelationshipMap &relationships,
-                                     std::vector<dsl::DslTerm> &externals,
-                                     const dsl::AnalysisConfig &config) {
-  TermMap terms;
-  AliasMap aliases;
-  TermMap external_dependencies;
-  FallbackDefinitionMap fallback_definitions;
-  FallbackDefinitionMap external_fallbacks;
-  const ScopeFilter scope_filter(index, config.ignored_namespaces);
-
-  for (const auto &fact : index.facts) {
-    UpdateTermFromFact(fact, terms, aliases, relationships, scope_filter,
-                       external_dependencies, fallback_definitions,
-                       external_fallbacks);
-  }
-  externals = FilterAndFinalizeTerms(external_dependencies, external_fallbacks);
-  return FilterAndFinalizeTerms(terms, fallback_definitions);
-}
-
 std::vector<dsl::DslRelationship>
 BuildRelationships(RelationshipMap relationships) {
   std::vector<dsl::DslRelationship> relationship_list;
@@ -572,6 +778,92 @@ void AppendExtractionNotes(dsl::DslExtractionResult &result) {
       "from AST facts.");
 }
 
+// Intent analysis reads function signatures, mutations and calls.
+bool FeedsIntentAnalysis(const dsl::FactView &fact) {
+  switch (fact.kind_id()) {
+  case dsl::FactKind::kFunction:
+    return true;
+  case dsl::FactKind::kCall:
+    return !fact.target().empty();
+  case dsl::FactKind::kOther:
+    return dsl::IsMutationKind(fact.kind());
+  default:
+    return false;
+  }
+}
+
+// Clears the fields intent analysis does not read, so they are not interned.
+dsl::CompactFact IntentFields(const dsl::CompactFact &fact) {
+  auto kept = fact;
+  kept.doc_comment = 0;
+  kept.scope_path = 0;
+  kept.range = {};
+  kept.target_location = {};
+  kept.symbol = 0;
+  kept.target_symbol = 0;
+  return kept;
+}
+
+// Each batch is folded into the symbol table and the term, relationship and
+// external dependency maps as it arrives; of the facts themselves, only what
+// intent analysis reads is kept. Contributions that wait on symbols no batch
+// has defined yet are kept apart until Finish knows every project symbol.
+class HeuristicExtraction : public dsl::ExtractionSession {
+public:
+  explicit HeuristicExtraction(const dsl::AnalysisConfig &config)
+      : scope_filter_(config.ignored_namespaces, symbols_) {}
+
+  void Consume(const dsl::FactStore &facts) override {
+    std::vector<SymbolId> subjects;
+    subjects.reserve(facts.size());
+    for (const auto &fact : facts) {
+      subjects.push_back(symbols_.Subject(fact));
+      scope_filter_.Observe(fact, subjects.back());
+    }
+    for (std::size_t index = 0; index < facts.size(); ++index) {
+      const auto fact = facts[index];
+      FoldFact(fact, subjects[index], folded_++, term_drafts_,
+               relationship_drafts_, symbols_, scope_filter_);
+      TrackExternalDependency(fact, external_dependencies_,
+                              external_fallbacks_, symbols_);
+      if (FeedsIntentAnalysis(fact)) {
+        intent_facts_.Add(
+            intent_facts_.Import(facts, IntentFields(fact.compact())));
+      }
+    }
+  }
+
+  dsl::DslExtractionResult Finish() override {
+    TermMap terms;
+    FallbackDefinitionMap fallback_definitions;
+    MergeTermDrafts(term_drafts_, scope_filter_, terms, fallback_definitions);
+    term_drafts_.clear();
+    auto relationships =
+        MergeRelationshipDrafts(relationship_drafts_, scope_filter_);
+    relationship_drafts_.clear();
+    result_.external_dependencies =
+        FilterAndFinalizeTerms(external_dependencies_, external_fallbacks_);
+    result_.terms = FilterAndFinalizeTerms(terms, fallback_definitions);
+    result_.relationships = BuildRelationships(std::move(relationships));
+    result_.workflows = BuildWorkflows(result_.relationships);
+    AppendExtractionNotes(result_);
+    result_.facts =
+        std::make_shared<const dsl::FactStore>(std::move(intent_facts_));
+    return std::move(result_);
+  }
+
+private:
+  SymbolTable symbols_;
+  ScopeFilter scope_filter_;
+  std::uint64_t folded_ = 0;
+  TermDraftMap term_drafts_;
+  RelationshipDraftMap relationship_drafts_;
+  TermMap external_dependencies_;
+  FallbackDefinitionMap external_fallbacks_;
+  dsl::FactStore intent_facts_;
+  dsl::DslExtractionResult result_;
+};
+
 } // namespace
 
 namespace dsl {
@@ -579,15 +871,14 @@ namespace dsl {
 DslExtractionResult
 HeuristicDslExtractor::Extract(const AstIndex &index,
                                const AnalysisConfig &config) {
-  DslExtractionResult result{};
-  RelationshipMap relationships;
-  result.terms =
-      BuildTerms(index, relationships, result.external_dependencies, config);
-  result.relationships = BuildRelationships(std::move(relationships));
-  result.workflows = BuildWorkflows(result.relationships);
-  result.facts = index.facts;
-  AppendExtractionNotes(result);
-  return result;
+  HeuristicExtraction extraction(config);
+  extraction.Consume(index.facts);
+  return extraction.Finish();
+}
+
+std::unique_ptr<ExtractionSession>
+HeuristicDslExtractor::StartExtraction(const AnalysisConfig &config) {
+  return std::make_unique<HeuristicExtraction>(config);
 }
 
 } // namespace dsl
@@ -0,0 +1,197 @@
+#include <dsl/indexing_api_engine.h>
+
+#include <dsl/fact_builder.h>
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+namespace dsl {
+
+namespace {
+
+std::string Qualify(const std::string &scope, const char *name) {
+  if (name == nullptr || *name == '\0') {
+    return scope;
+  }
+  if (scope.empty()) {
+    return name;
+  }
+  return scope + "::" + name;
+}
+
+// Harvests facts from the callbacks of clang_indexSourceFile. Every container
+// the indexer announces (namespace, record, function definition) is tagged
+// with its qualified name and innermost entity, so declarations are named
+// from their container instead of by walking semantic parents, and each
+// callee is named once per USR.
+class IndexedFactCollector : public FactBuilder {
+public:
+  // `project_root` must already be canonical.
+  IndexedFactCollector(std::filesystem::path project_root,
+                       const IndexerOptions &options)
+      : FactBuilder(std::move(project_root)),
+        declarations_only_(options.depth == IndexDepth::kDeclarations) {}
+
+  static IndexerCallbacks Callbacks() {
+    IndexerCallbacks callbacks{};
+    callbacks.startedTranslationUnit =
+        [](CXClientData data, void *) -> CXIdxClientContainer {
+      return &static_cast<IndexedFactCollector *>(data)->file_scope_;
+    };
+    callbacks.indexDeclaration = [](CXClientData data,
+                                    const CXIdxDeclInfo *info) {
+      static_cast<IndexedFactCollector *>(data)->OnDeclaration(*info);
+    };
+    callbacks.indexEntityReference = [](CXClientData data,
+                                        const CXIdxEntityRefInfo *info) {
+      static_cast<IndexedFactCollector *>(data)->OnReference(*info);
+    };
+    return callbacks;
+  }
+
+private:
+  struct Container {
+    // Qualified name; empty at file scope.
+    std::string name;
+    // Innermost enclosing function or type definition; unnamed if none.
+    Entity entity;
+  };
+
+  const Container &Remember(const CXIdxContainerInfo *info,
+                            Container container) {
+    auto &stored = containers_.emplace_back(std::move(container));
+    clang_index_setClientContainer(info, &stored);
+    return stored;
+  }
+
+  const Container &ContainerOf(const CXIdxContainerInfo *info) {
+    if (info == nullptr) {
+      return file_scope_;
+    }
+    if (const auto known = clang_index_getClientContainer(info)) {
+      return *static_cast<const Container *>(known);
+    }
+    // Not announced by a declaration callback; name it the slow way once.
+    const auto cursor = info->cursor;
+    auto name = names().QualifiedName(cursor);
+    Entity entity;
+    if (IsEntityKind(clang_getCursorKind(cursor)) &&
+        clang_isCursorDefinition(cursor)) {
+      entity = {name, ToString(clang_getCursorUSR(cursor))};
+    }
+    return Remember(info, Container{std::move(name), std::move(entity)});
+  }
+
+  std::string NameOf(const CXIdxEntityInfo &entity) {
+    if (entity.USR == nullptr || *entity.USR == '\0') {
+      return names().QualifiedName(entity.cursor);
+    }
+    const auto [found, inserted] = usr_names_.try_emplace(entity.USR);
+    if (inserted) {
+      found->second = names().QualifiedName(entity.cursor);
+    }
+    return found->second;
+  }
+
+  void OnDeclaration(const CXIdxDeclInfo &info) {
+    const auto &parent = ContainerOf(info.semanticContainer);
+    const auto kind = clang_getCursorKind(info.cursor);
+    const auto *entity = info.entityInfo;
+    auto name =
+        Qualify(parent.name, entity != nullptr ? entity->name : nullptr);
+    std::string usr;
+    if (entity != nullptr && entity->USR != nullptr) {
+      usr = entity->USR;
+    }
+    if (!usr.empty()) {
+      usr_names_.try_emplace(usr, name);
+    }
+    if (info.declAsContainer != nullptr) {
+      const bool defines_entity =
+          IsEntityKind(kind) && info.isDefinition && !name.empty();
+      Remember(info.declAsContainer,
+               Container{name, defines_entity ? Entity{name, std::move(usr)}
+                                              : parent.entity});
+    }
+    if (!IdentifyFile(clang_getCursorLocation(info.cursor)).in_project) {
+      return;
+    }
+
+    switch (kind) {
+    case CXCursor_FunctionDecl:
+    case CXCursor_CXXMethod:
+    case CXCursor_Constructor:
+    case CXCursor_FunctionTemplate:
+      if (info.isDefinition) {
+        AddSymbolFact(info.cursor, "function", std::move(name), parent.name);
+      }
+      break;
+    case CXCursor_StructDecl:
+    case CXCursor_ClassDecl:
+    case CXCursor_EnumDecl:
+      if (info.isDefinition) {
+        AddSymbolFact(info.cursor, "type", std::move(name), parent.name);
+      }
+      break;
+    case CXCursor_VarDecl:
+      if (info.isDefinition) {
+        AddSymbolFact(info.cursor, "variable", std::move(name), parent.name);
+      }
+      break;
+    case CXCursor_FieldDecl:
+      if (!parent.entity.name.empty()) {
+        AddOwnershipFact(info.cursor, parent.entity, parent.name);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  void OnReference(const CXIdxEntityRefInfo &info) {
+    if (declarations_only_ || info.referencedEntity == nullptr) {
+      return;
+    }
+    const auto &container = ContainerOf(info.container);
+    if (container.entity.name.empty() ||
+        !IdentifyFile(clang_getCursorLocation(info.cursor)).in_project) {
+      return;
+    }
+    // Type references carry no scope path, as with the cursor walker.
+    if (clang_getCursorKind(info.cursor) == CXCursor_TypeRef) {
+      AddTypeUsageFact(info.cursor, container.entity, {});
+    } else if ((info.role & CXSymbolRole_Call) != 0) {
+      AddCallFact(info.cursor, info.referencedEntity->cursor, container.entity,
+                  NameOf(*info.referencedEntity), container.name);
+    }
+  }
+
+  bool declarations_only_;
+  Container file_scope_;
+  std::deque<Container> containers_;
+  std::unordered_map<std::string, std::string> usr_names_;
+};
+
+} // namespace
+
+CXErrorCode IndexSourceFile(CXIndexAction action, unsigned index_options,
+                            const std::string &file, const char *const *args,
+                            int arg_count, unsigned parse_options,
+                            const std::filesystem::path &project_root,
+                            const IndexerOptions &options,
+                            CXTranslationUnit &translation_unit,
+                            FactStore &facts) {
+  IndexedFactCollector collector(project_root, options);
+  auto callbacks = IndexedFactCollector::Callbacks();
+  const auto result = clang_indexSourceFile(
+      action, &collector, &callbacks, sizeof(callbacks), index_options,
+      file.c_str(), args, arg_count, nullptr, 0, &translation_unit,
+      parse_options);
+  if (result == 0 && translation_unit != nullptr) {
+    facts = collector.TakeFacts();
+  }
+  return static_cast<CXErrorCode>(result);
+}
+
+} // namespace dsl
@@ -0,0 +1,86 @@
+#include <dsl/interfaces.h>
+
+#include <dsl/hashing.h>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+class BufferedExtraction : public dsl::ExtractionSession {
+public:
+  BufferedExtraction(dsl::DslExtractor &extractor, dsl::AnalysisConfig config)
+      : extractor_(&extractor), config_(std::move(config)) {}
+
+  void Consume(const dsl::FactStore &facts) override {
+    index_.facts.Append(facts);
+  }
+
+  dsl::DslExtractionResult Finish() override {
+    return extractor_->Extract(index_, config_);
+  }
+
+private:
+  dsl::DslExtractor *extractor_;
+  dsl::AnalysisConfig config_;
+  dsl::AstIndex index_;
+};
+
+} // namespace
+
+namespace dsl {
+
+void DeduplicatingFactSink::Consume(const FactStore &facts) {
+  std::vector<std::size_t> unique;
+  unique.reserve(facts.size());
+  const auto &compact = facts.compact_facts();
+  for (std::size_t i = 0; i < compact.size(); ++i) {
+    if (seen_.insert(KeyOf(facts, compact[i])).second) {
+      unique.push_back(i);
+    }
+  }
+  if (unique.size() == compact.size()) {
+    sink_->Consume(facts);
+    return;
+  }
+  FactStore filtered;
+  filtered.reserve(unique.size());
+  for (const auto i : unique) {
+    filtered.Add(filtered.Import(facts, compact[i]));
+  }
+  sink_->Consume(filtered);
+}
+
+std::uint64_t DeduplicatingFactSink::KeyOf(const FactStore &facts,
+                                           const CompactFact &fact) {
+  const auto &location = fact.location;
+  const std::string_view texts[] = {
+      facts.Text(fact.name), facts.Text(fact.kind_text),
+      facts.Text(fact.target), facts.Text(location.file)};
+  // The lengths keep texts that only differ in where one ends apart.
+  const std::array<std::uint32_t, 9> numbers = {
+      static_cast<std::uint32_t>(texts[0].size()),
+      static_cast<std::uint32_t>(texts[1].size()),
+      static_cast<std::uint32_t>(texts[2].size()),
+      static_cast<std::uint32_t>(texts[3].size()),
+      location.begin_line,
+      location.begin_column,
+      location.end_line,
+      location.end_column,
+      location.structured ? 1U : 0U};
+  auto key = Fnv1a64(std::string_view(
+      reinterpret_cast<const char *>(numbers.data()), sizeof(numbers)));
+  for (const auto text : texts) {
+    key = Fnv1a64(text, key);
+  }
+  return key;
+}
+
+std::unique_ptr<ExtractionSession>
+DslExtractor::StartExtraction(const AnalysisConfig &config) {
+  return std::make_unique<BufferedExtraction>(*this, config);
+}
+
+} // namespace dsl
@@ -0,0 +1,142 @@
+#include <dsl/leading_includes.h>
+
+#include <cctype>
+#include <cstddef>
+
+namespace {
+
+bool IsHorizontalSpace(char character) {
+  return character == ' ' || character == '\t' || character == '\f' ||
+         character == '\v';
+}
+
+bool IsIdentifierCharacter(char character) {
+  return std::isalnum(static_cast<unsigned char>(character)) != 0 ||
+         character == '_';
+}
+
+} // namespace
+
+namespace dsl {
+
+std::vector<std::string> LeadingIncludes(std::string_view source) {
+  std::vector<std::string> includes;
+  std::size_t position = 0;
+  if (source.substr(0, 3) == "\xEF\xBB\xBF") {
+    position = 3;
+  }
+  const auto skip_horizontal_space = [&]() {
+    while (position < source.size() && IsHorizontalSpace(source[position])) {
+      ++position;
+    }
+  };
+
+  while (true) {
+    while (position < source.size() &&
+           (IsHorizontalSpace(source[position]) || source[position] == '\n' ||
+            source[position] == '\r')) {
+      ++position;
+    }
+    if (source.compare(position, 2, "//") == 0) {
+      position = source.find('\n', position);
+      if (position == std::string_view::npos) {
+        break;
+      }
+      continue;
+    }
+    if (source.compare(position, 2, "/*") == 0) {
+      const auto end = source.find("*/", position + 2);
+      if (end == std::string_view::npos) {
+        break;
+      }
+      position = end + 2;
+      continue;
+    }
+    if (position >= source.size() || source[position] != '#') {
+      break;
+    }
+
+    ++position;
+    skip_horizontal_space();
+    constexpr std::string_view kInclude = "include";
+    if (source.compare(position, kInclude.size(), kInclude) != 0) {
+      break;
+    }
+    position += kInclude.size();
+    if (position < source.size() && IsIdentifierCharacter(source[position])) {
+      break;
+    }
+    skip_horizontal_space();
+    if (position >= source.size() ||
+        (source[position] != '<' && source[position] != '"')) {
+      break;
+    }
+    const auto close = source[position] == '<' ? '>' : '"';
+    const auto end = source.find_first_of(std::string{close, '\n'},
+                                          position + 1);
+    if (end == std::string_view::npos || source[end] != close) {
+      break;
+    }
+    includes.emplace_back(source.substr(position, end - position + 1));
+    position = end + 1;
+    skip_horizontal_space();
+    // Anything but a comment after the header name ends the scan as well.
+    if (position < source.size() && source[position] != '\n' &&
+        source[position] != '\r' && source.compare(position, 2, "//") != 0 &&
+        source.compare(position, 2, "/*") != 0) {
+      break;
+    }
+  }
+  return includes;
+}
+
+std::size_t FirstMacroDirective(std::string_view source) {
+  std::size_t line = 0;
+  while (line < source.size()) {
+    auto position = line;
+    while (position < source.size() && IsHorizontalSpace(source[position])) {
+      ++position;
+    }
+    if (position < source.size() && source[position] == '#') {
+      const auto directive = position;
+      ++position;
+      while (position < source.size() &&
+             IsHorizontalSpace(source[position])) {
+        ++position;
+      }
+      for (const std::string_view name : {"define", "undef"}) {
+        const auto end = position + name.size();
+        if (source.compare(position, name.size(), name) == 0 &&
+            (end >= source.size() || !IsIdentifierCharacter(source[end]))) {
+          return directive;
+        }
+      }
+    }
+    line = source.find('\n', line);
+    if (line == std::string_view::npos) {
+      break;
+    }
+    ++line;
+  }
+  return std::string_view::npos;
+}
+
+std::vector<std::string>
+CommonIncludePrefix(const std::vector<std::vector<std::string>> &lists) {
+  if (lists.empty()) {
+    return {};
+  }
+  const auto &first = lists.front();
+  auto length = first.size();
+  for (const auto &list : lists) {
+    std::size_t shared = 0;
+    while (shared < length && shared < list.size() &&
+           list[shared] == first[shared]) {
+      ++shared;
+    }
+    length = shared;
+  }
+  return {first.begin(), first.begin() + static_cast<std::ptrdiff_t>(length)};
+}
+
+} // namespace dsl
@@ -65,6 +65,7 @@ void StructuredLogger::Log(
     return;
   }
 
+  const std::lock_guard<std::mutex> lock(mutex_);
   (*stream_) << "[" << Timestamp() << "] level=" << LevelName(level)
              << " message=\"" << message << "\" fields=" << FormatFields(fields)
              << "\n";
@@ -0,0 +1,85 @@
+#include <dsl/mapped_file.h>
+
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dsl {
+
+std::optional<MappedFile> MappedFile::Open(const std::filesystem::path &path) {
+  MappedFile file;
+#ifdef _WIN32
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return std::nullopt;
+  }
+  file.buffer_.assign(std::istreambuf_iterator<char>(stream),
+                      std::istreambuf_iterator<char>());
+  file.data_ = file.buffer_.data();
+  file.size_ = file.buffer_.size();
+#else
+  const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor < 0) {
+    return std::nullopt;
+  }
+  struct stat status {};
+  if (::fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+    ::close(descriptor);
+    return std::nullopt;
+  }
+  file.size_ = static_cast<std::size_t>(status.st_size);
+  if (file.size_ > 0) {
+    void *address =
+        ::mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (address == MAP_FAILED) {
+      ::close(descriptor);
+      return std::nullopt;
+    }
+    file.data_ = static_cast<const char *>(address);
+    file.mapped_ = true;
+  }
+  ::close(descriptor);
+#endif
+  return file;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+  *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  Release();
+  mapped_ = std::exchange(other.mapped_, false);
+  size_ = std::exchange(other.size_, 0);
+  buffer_ = std::move(other.buffer_);
+  data_ = mapped_ ? other.data_ : buffer_.data();
+  other.data_ = nullptr;
+  return *this;
+}
+
+MappedFile::~MappedFile() { Release(); }
+
+void MappedFile::Release() {
+#ifndef _WIN32
+  if (mapped_) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+#endif
+  mapped_ = false;
+  data_ = nullptr;
+  size_ = 0;
+  buffer_.clear();
+}
+
+} // namespace dsl
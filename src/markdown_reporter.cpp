@@ -1,35 +1,15 @@
 #include <dsl/markdown_reporter.h>
 
+#include <dsl/escaping.h>
+
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
-#include <unordered_map>
 
 namespace dsl {
 namespace {
 
-std::string EscapeJsonString(const std::string &value) {
-  static const std::unordered_map<char, std::string> replacements{
-      {'"', "\\\""},
-      {'\\', "\\\\"},
-      {'\n', "\\n"},
-      {'\r', "\\r"},
-      {'\t', "\\t"}};
-
-  std::string escaped;
-  escaped.reserve(value.size());
-  for (const auto character : value) {
-    const auto replacement = replacements.find(character);
-    if (replacement != replacements.end()) {
-      escaped.append(replacement->second);
-    } else {
-      escaped.push_back(character);
-    }
-  }
-  return escaped;
-}
-
 template <typename Collection, typename Formatter>
 std::string Join(const Collection &items, const std::string &delimiter,
                  Formatter formatter) {
@@ -118,6 +98,19 @@ bool ShouldRenderFormat(const std::vector<std::string> &formats,
   return std::find(formats.begin(), formats.end(), format) != formats.end();
 }
 
+const char *IndexDepthName(IndexDepth depth) {
+  return depth == IndexDepth::kDeclarations ? "declarations" : "full";
+}
+
+// Declarations-only runs never see function bodies, so readers are told which
+// relationship kinds are missing rather than left to assume there were none.
+std::string IndexDepthDescription(IndexDepth depth) {
+  if (depth == IndexDepth::kDeclarations) {
+    return "declarations (no call or type_usage relationships)";
+  }
+  return IndexDepthName(depth);
+}
+
 std::string BuildAnalysisHeaderMarkdown(const AnalysisConfig &config,
                                         const std::string &timestamp) {
   std::ostringstream section;
@@ -130,7 +123,9 @@ std::string BuildAnalysisHeaderMarkdown(const AnalysisConfig &config,
   if (!config.scope_notes.empty()) {
     scope_notes = config.scope_notes;
   }
-  section << "| Scope Notes | " << scope_notes << " |\n\n";
+  section << "| Scope Notes | " << scope_notes << " |\n";
+  section << "| Index Depth | " << IndexDepthDescription(config.index_depth)
+          << " |\n\n";
   return section.str();
 }
 
@@ -216,12 +211,37 @@ std::string BuildWorkflowsMarkdown(const DslExtractionResult &extraction) {
   return section.str();
 }
 
+const char *ChangeText(FindingChange change) {
+  switch (change) {
+  case FindingChange::kNew:
+    return "new";
+  case FindingChange::kUnchanged:
+    return "unchanged";
+  case FindingChange::kResolved:
+    return "resolved";
+  case FindingChange::kUnmarked:
+    break;
+  }
+  return "";
+}
+
+// Findings are marked only when compared with a baseline, and then all are.
+bool HasChangeMarks(const CoherenceResult &coherence) {
+  return std::any_of(coherence.findings.begin(), coherence.findings.end(),
+                     [](const Finding &finding) {
+                       return finding.change != FindingChange::kUnmarked;
+                     });
+}
+
 std::string BuildIncoherenceMarkdown(const CoherenceResult &coherence) {
+  const bool marked = HasChangeMarks(coherence);
   std::ostringstream section;
   section << "## Incoherence Report\n\n";
   section << "| Term | Conflict | Examples | Suggested Canonical Form | "
-             "Details |\n";
-  section << "| --- | --- | --- | --- | --- |\n";
+             "Details |"
+          << (marked ? " Change |" : "") << "\n";
+  section << "| --- | --- | --- | --- | --- |" << (marked ? " --- |" : "")
+          << "\n";
 
   if (coherence.findings.empty()) {
     section << "| None | - | - | - | - |\n\n";
@@ -232,7 +252,11 @@ std::string BuildIncoherenceMarkdown(const CoherenceResult &coherence) {
     section << "| " << finding.term << " | " << ConflictText(finding) << " | "
             << JoinWithBreaks(finding.examples) << " | "
             << SuggestedCanonical(finding) << " | " << FindingDetails(finding)
-            << " |\n";
+            << " |";
+    if (marked) {
+      section << " " << ChangeText(finding.change) << " |";
+    }
+    section << "\n";
   }
   section << "\n";
   return section.str();
@@ -263,7 +287,8 @@ std::string BuildAnalysisHeaderJson(const AnalysisConfig &config,
   if (!config.scope_notes.empty()) {
     scope_notes = config.scope_notes;
   }
-  json << "\"scope_notes\": \"" << EscapeJsonString(scope_notes) << "\"}";
+  json << "\"scope_notes\": \"" << EscapeJsonString(scope_notes) << "\",";
+  json << "\"index_depth\": \"" << IndexDepthName(config.index_depth) << "\"}";
   return json.str();
 }
 
@@ -355,7 +380,11 @@ std::string BuildIncoherenceJson(const CoherenceResult &coherence) {
     json << "\"suggested_canonical_form\": \""
          << EscapeJsonString(finding.suggested_canonical_form) << "\",";
     json << "\"description\": \"" << EscapeJsonString(finding.description)
-         << "\"}";
+         << "\"";
+    if (finding.change != FindingChange::kUnmarked) {
+      json << ",\"change\": \"" << ChangeText(finding.change) << "\"";
+    }
+    json << "}";
   }
   json << "]";
   return json.str();
@@ -0,0 +1,24 @@
+#include <dsl/naming.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace dsl {
+
+std::string CanonicalizeName(std::string_view name) {
+  std::string canonical(name);
+  std::replace(canonical.begin(), canonical.end(), ':', '.');
+  std::transform(canonical.begin(), canonical.end(), canonical.begin(),
+                 [](unsigned char character) {
+                   return static_cast<char>(std::tolower(character));
+                 });
+  return canonical;
+}
+
+bool IsMutationKind(std::string_view kind) {
+  const auto normalized = CanonicalizeName(kind);
+  return normalized == "mutation" || normalized == "assignment" ||
+         normalized == "state_change";
+}
+
+} // namespace dsl
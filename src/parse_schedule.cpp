@@ -0,0 +1,167 @@
+#include <dsl/parse_schedule.h>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace dsl {
+
+std::vector<std::uint64_t>
+EstimateParseCosts(const std::vector<std::optional<std::uint64_t>> &recorded,
+                   const std::vector<std::uint64_t> &sizes) {
+  std::uint64_t recorded_cost = 0;
+  std::uint64_t recorded_bytes = 0;
+  for (std::size_t i = 0; i < recorded.size() && i < sizes.size(); ++i) {
+    if (recorded[i].has_value()) {
+      recorded_cost += *recorded[i];
+      recorded_bytes += sizes[i];
+    }
+  }
+  const double cost_per_byte =
+      recorded_bytes > 0 ? static_cast<double>(recorded_cost) /
+                               static_cast<double>(recorded_bytes)
+                         : 1.0;
+
+  std::vector<std::uint64_t> costs(sizes.size());
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    if (i < recorded.size() && recorded[i].has_value()) {
+      costs[i] = *recorded[i];
+    } else {
+      costs[i] = static_cast<std::uint64_t>(static_cast<double>(sizes[i]) *
+                                            cost_per_byte);
+    }
+  }
+  return costs;
+}
+
+std::vector<std::size_t>
+LongestFirstOrder(const std::vector<std::uint64_t> &costs) {
+  std::vector<std::size_t> order(costs.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::stable_sort(order.begin(), order.end(),
+                   [&costs](std::size_t left, std::size_t right) {
+                     return costs[left] > costs[right];
+                   });
+  return order;
+}
+
+std::uint64_t PredictMakespan(const std::vector<std::uint64_t> &costs,
+                              const std::vector<std::size_t> &order,
+                              unsigned workers) {
+  std::priority_queue<std::uint64_t, std::vector<std::uint64_t>,
+                      std::greater<>>
+      finish_times;
+  for (unsigned worker = 0; worker < std::max(workers, 1u); ++worker) {
+    finish_times.push(0);
+  }
+  std::uint64_t makespan = 0;
+  for (const auto job : order) {
+    const auto finish = finish_times.top() + costs[job];
+    finish_times.pop();
+    finish_times.push(finish);
+    makespan = std::max(makespan, finish);
+  }
+  return makespan;
+}
+
+OrderedDelivery::OrderedDelivery(std::vector<std::size_t> order,
+                                 std::size_t count, std::size_t window,
+                                 FactSink &sink)
+    : order_(std::move(order)), started_(count, true), pending_(count),
+      window_(std::max<std::size_t>(window, 1)), sink_(&sink) {
+  for (const auto job : order_) {
+    started_[job] = false;
+  }
+  for (std::size_t job = 0; job < count; ++job) {
+    if (started_[job]) {
+      Complete(job, {});
+    }
+  }
+}
+
+std::optional<std::size_t> OrderedDelivery::Take() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    if (stopped_) {
+      return std::nullopt;
+    }
+    if (waiting_ < window_) {
+      while (cursor_ < order_.size() && started_[order_[cursor_]]) {
+        ++cursor_;
+      }
+      if (cursor_ == order_.size()) {
+        return std::nullopt;
+      }
+      return Start(order_[cursor_++]);
+    }
+    // Batches wait for the earliest undelivered job; run it if no worker
+    // has, else wait for it.
+    if (next_ < pending_.size() && !started_[next_]) {
+      return Start(next_);
+    }
+    delivered_.wait(lock);
+  }
+}
+
+void OrderedDelivery::Complete(std::size_t job, FactStore facts) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (job != next_ || delivering_) {
+    if (facts.size() != 0) {
+      peak_waiting_ = std::max(peak_waiting_, ++waiting_);
+    }
+    pending_[job] = std::move(facts);
+    return;
+  }
+
+  // Batches are consumed outside the lock, so workers finishing meanwhile
+  // only queue theirs; the flag keeps a single worker delivering, in order,
+  // until no batch is ready.
+  delivering_ = true;
+  pending_[job] = std::move(facts);
+  std::vector<FactStore> ready;
+  for (;;) {
+    std::size_t waited = 0;
+    while (next_ < pending_.size() && pending_[next_].has_value()) {
+      if (next_ != job && pending_[next_]->size() != 0) {
+        ++waited;
+      }
+      ready.push_back(std::move(*pending_[next_]));
+      pending_[next_].reset();
+      ++next_;
+    }
+    if (ready.empty()) {
+      break;
+    }
+    lock.unlock();
+    for (const auto &batch : ready) {
+      sink_->Consume(batch);
+    }
+    ready.clear();
+    lock.lock();
+    waiting_ -= waited;
+    delivered_.notify_all();
+  }
+  delivering_ = false;
+}
+
+void OrderedDelivery::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  delivered_.notify_all();
+}
+
+std::size_t OrderedDelivery::peak_waiting() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return peak_waiting_;
+}
+
+std::size_t OrderedDelivery::Start(std::size_t job) {
+  started_[job] = true;
+  return job;
+}
+
+} // namespace dsl
@@ -0,0 +1,239 @@
+#include <dsl/precompiled_headers.h>
+
+#include <dsl/hashing.h>
+#include <dsl/leading_includes.h>
+#include <dsl/mapped_file.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace dsl {
+
+namespace {
+
+std::string UniqueSuffix() {
+  std::random_device device;
+  return HashToHex((static_cast<std::uint64_t>(device()) << 32) | device());
+}
+
+// A translation unit parsed against a precompiled header still reads its own
+// #include lines. They must be no-ops, so every header the synthetic unit
+// includes directly needs an include guard or #pragma once.
+bool DirectIncludesAreGuarded(CXTranslationUnit translation_unit) {
+  struct GuardCheck {
+    CXTranslationUnit translation_unit;
+    bool guarded = true;
+  } check{translation_unit};
+  clang_getInclusions(
+      translation_unit,
+      [](CXFile file, CXSourceLocation *, unsigned depth, CXClientData data) {
+        auto *state = static_cast<GuardCheck *>(data);
+        if (depth == 1 &&
+            clang_isFileMultipleIncludeGuarded(state->translation_unit,
+                                               file) == 0) {
+          state->guarded = false;
+        }
+      },
+      &check);
+  return check.guarded;
+}
+
+} // namespace
+
+PrecompiledHeaderSession::PrecompiledHeaderSession(
+    std::filesystem::path directory, std::string settings)
+    : directory_(std::move(directory)), settings_(std::move(settings)) {
+  if (directory_.empty()) {
+    directory_ = std::filesystem::temp_directory_path() /
+                 ("dsl-pch-" + UniqueSuffix());
+    owns_directory_ = true;
+  }
+}
+
+PrecompiledHeaderSession::~PrecompiledHeaderSession() {
+  if (owns_directory_) {
+    std::error_code error;
+    std::filesystem::remove_all(directory_, error);
+  }
+}
+
+void PrecompiledHeaderSession::Plan(
+    std::vector<CompileCommandEntry> &entries,
+    const ArgumentSetPool &argument_sets) {
+  std::vector<std::vector<std::string>> includes(entries.size());
+  std::map<std::pair<ArgumentSetId, std::string>, std::vector<std::size_t>>
+      groups;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const auto mapped = MappedFile::Open(entries[i].file);
+    if (!mapped) {
+      continue;
+    }
+    includes[i] = LeadingIncludes(mapped->contents());
+    if (includes[i].empty()) {
+      continue;
+    }
+    const auto quoted =
+        std::any_of(includes[i].begin(), includes[i].end(),
+                    [](const std::string &name) { return name[0] == '"'; });
+    const auto directory =
+        quoted ? entries[i].file.parent_path().string() : std::string{};
+    groups[{entries[i].arguments, directory}].push_back(i);
+  }
+
+  for (const auto &[group, members] : groups) {
+    if (members.size() < 2) {
+      continue;
+    }
+    std::vector<std::vector<std::string>> lists;
+    lists.reserve(members.size());
+    for (const auto member : members) {
+      lists.push_back(std::move(includes[member]));
+    }
+    auto prefix = CommonIncludePrefix(lists);
+    if (prefix.empty()) {
+      continue;
+    }
+
+    auto header = std::make_unique<PrecompiledHeader>();
+    header->arguments = group.first;
+    header->includes = std::move(prefix);
+    header->translation_units = members.size();
+    const auto &first = entries[members.front()].file;
+    header->key = Key(argument_sets.Arguments(group.first),
+                      first.parent_path(), header->includes);
+    const auto extension = first.extension() == ".c" ? ".h" : ".hpp";
+    header->source =
+        (first.parent_path() / (".dsl-precompiled-" + header->key +
+                                extension))
+            .string();
+    for (const auto member : members) {
+      entries[member].precompiled_header = headers_.size();
+    }
+    headers_.push_back(std::move(header));
+  }
+}
+
+const PrecompiledHeader *
+PrecompiledHeaderSession::Acquire(CXIndex index,
+                                  const CompileCommandEntry &entry,
+                                  const IndexingContext &context) {
+  if (entry.precompiled_header == kNoPrecompiledHeader) {
+    return nullptr;
+  }
+  auto &header = *headers_[entry.precompiled_header];
+  std::call_once(header.build, [&]() { Build(index, header, context); });
+  return header.usable ? &header : nullptr;
+}
+
+std::string PrecompiledHeaderSession::Key(
+    const std::vector<std::string> &arguments,
+    const std::filesystem::path &directory,
+    const std::vector<std::string> &includes) const {
+  // Every field is terminated so adjacent values cannot run together.
+  const auto field = [](std::string_view value, std::uint64_t hash) {
+    return Fnv1a64(std::string_view("\0", 1), Fnv1a64(value, hash));
+  };
+  auto hash = field(settings_, kFnv1a64Offset);
+  for (const auto &argument : arguments) {
+    hash = field(argument, hash);
+  }
+  hash = field(directory.string(), hash);
+  for (const auto &include : includes) {
+    hash = field(include, hash);
+  }
+  return HashToHex(hash);
+}
+
+void PrecompiledHeaderSession::Build(CXIndex index,
+                                     PrecompiledHeader &header,
+                                     const IndexingContext &context) {
+  const auto started = std::chrono::steady_clock::now();
+  auto &logger = *context.logger;
+  std::string contents;
+  for (const auto &include : header.includes) {
+    contents += "#include " + include + "\n";
+  }
+  CXUnsavedFile unsaved{header.source.c_str(), contents.c_str(),
+                        static_cast<unsigned long>(contents.size())};
+  const auto &arg_pointers =
+      context.argument_sets->Pointers(header.arguments);
+  CXTranslationUnit translation_unit = nullptr;
+  const auto error = clang_parseTranslationUnit2(
+      index, header.source.c_str(), arg_pointers.data(),
+      static_cast<int>(arg_pointers.size()), &unsaved, 1,
+      ParseOptions(context.options) | CXTranslationUnit_Incomplete |
+          CXTranslationUnit_ForSerialization,
+      &translation_unit);
+
+  std::string problem;
+  if (error != CXError_Success || translation_unit == nullptr) {
+    problem = "parse failed";
+  } else if (HasErrors(translation_unit)) {
+    problem = "includes do not compile on their own";
+  } else if (!DirectIncludesAreGuarded(translation_unit)) {
+    problem = "an included header has no include guard";
+  } else {
+    problem = Save(translation_unit, header);
+  }
+  if (translation_unit != nullptr) {
+    clang_disposeTranslationUnit(translation_unit);
+  }
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - started);
+  build_us_ += static_cast<std::uint64_t>(duration.count());
+  const auto duration_ms = std::to_string(duration.count() / 1000);
+
+  if (!problem.empty()) {
+    ++failed_;
+    logger.Log(LogLevel::kWarn, "Skipped precompiled header",
+               {{"source", header.source},
+                {"reason", problem},
+                {"duration_ms", duration_ms}});
+    return;
+  }
+  ++built_;
+  logger.Log(LogLevel::kInfo, "Built precompiled header",
+             {{"path", header.path},
+              {"includes", std::to_string(header.includes.size())},
+              {"translation_units", std::to_string(header.translation_units)},
+              {"duration_ms", duration_ms}});
+}
+
+std::string
+PrecompiledHeaderSession::Save(CXTranslationUnit translation_unit,
+                               PrecompiledHeader &header) {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  const auto path = directory_ / (header.key + ".pch");
+  auto temporary = path;
+  temporary += ".tmp-" + UniqueSuffix();
+  if (clang_saveTranslationUnit(
+          translation_unit, temporary.string().c_str(),
+          clang_defaultSaveOptions(translation_unit)) != CXSaveError_None) {
+    std::filesystem::remove(temporary, error);
+    return "saving failed";
+  }
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+    return "saving failed";
+  }
+
+  header.path = path.string();
+  for (auto &dependency : CollectDependencies(
+           translation_unit,
+           std::filesystem::path(header.source).parent_path())) {
+    if (dependency != header.source) {
+      header.dependencies.push_back(std::move(dependency));
+    }
+  }
+  header.usable = true;
+  return {};
+}
+
+} // namespace dsl
@@ -0,0 +1,477 @@
+#include <dsl/project_generator.h>
+
+#include <dsl/escaping.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+constexpr unsigned kNamespaceFanOut = 4;
+constexpr std::uint64_t kDocumentedPerMille = 1000;
+
+struct ClassId {
+  unsigned header = 0;
+  unsigned index = 0;
+};
+
+// SplitMix64 finalizer: a cheap, well-distributed and platform-independent
+// mix, so the generated project never depends on the standard library.
+std::uint64_t Mix(std::uint64_t value) {
+  value += 0x9e3779b97f4a7c15ULL;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+std::uint64_t Mix(std::uint64_t seed, std::uint64_t a, std::uint64_t b,
+                  std::uint64_t c = 0) {
+  return Mix(Mix(Mix(seed ^ a) ^ b) ^ c);
+}
+
+class ProjectLayout {
+public:
+  explicit ProjectLayout(const dsl::ProjectShape &shape) : shape_(shape) {}
+
+  unsigned HeaderCount() const {
+    return shape_.translation_units * shape_.headers_per_unit;
+  }
+
+  unsigned ClassCount() const {
+    return HeaderCount() * shape_.classes_per_header;
+  }
+
+  unsigned UnitOfHeader(unsigned header) const {
+    return header / shape_.headers_per_unit;
+  }
+
+  ClassId ClassAt(unsigned global_index) const {
+    return {global_index / shape_.classes_per_header, global_index};
+  }
+
+  std::vector<std::string> NamespacePath(unsigned header) const {
+    std::vector<std::string> path{"gen"};
+    auto remaining = header;
+    for (unsigned depth = 0; depth < shape_.namespace_depth; ++depth) {
+      path.push_back("area" + std::to_string(remaining % kNamespaceFanOut));
+      remaining /= kNamespaceFanOut;
+    }
+    return path;
+  }
+
+  std::string HeaderInclude(unsigned header) const {
+    std::string include;
+    for (const auto &segment : NamespacePath(header)) {
+      include.append(segment).append("/");
+    }
+    return include + "header" + std::to_string(header) + ".h";
+  }
+
+  std::string QualifiedClassName(const ClassId &id) const {
+    std::string name;
+    for (const auto &segment : NamespacePath(id.header)) {
+      name.append("::").append(segment);
+    }
+    return name + "::" + ClassName(id);
+  }
+
+  static std::string ClassName(const ClassId &id) {
+    return "Component" + std::to_string(id.index);
+  }
+
+  bool Documented(std::uint64_t kind, std::uint64_t a,
+                  std::uint64_t b = 0) const {
+    const auto threshold = static_cast<std::uint64_t>(
+        std::clamp(shape_.doc_comment_density, 0.0, 1.0) *
+        kDocumentedPerMille);
+    return Mix(shape_.seed, kind, a, b) % kDocumentedPerMille < threshold;
+  }
+
+  // Picks the class called by call `call` of method `method` of `caller`,
+  // preferring classes owned by other translation units.
+  ClassId CallTarget(const ClassId &caller, unsigned method,
+                     unsigned call) const {
+    const auto classes = ClassCount();
+    const auto own_unit = UnitOfHeader(caller.header);
+    auto candidate = static_cast<unsigned>(
+        Mix(shape_.seed, caller.index, method, call + 1) % classes);
+    for (unsigned attempt = 0; attempt < classes; ++attempt) {
+      const auto target = ClassAt((candidate + attempt) % classes);
+      if (shape_.translation_units == 1 ||
+          UnitOfHeader(target.header) != own_unit) {
+        return target;
+      }
+    }
+    return ClassAt(candidate);
+  }
+
+  const dsl::ProjectShape &shape() const { return shape_; }
+
+private:
+  dsl::ProjectShape shape_;
+};
+
+std::string OpenNamespaces(const std::vector<std::string> &path) {
+  std::string text;
+  for (const auto &segment : path) {
+    text.append("namespace ").append(segment).append(" {\n");
+  }
+  return text + "\n";
+}
+
+std::string CloseNamespaces(const std::vector<std::string> &path) {
+  std::string text = "\n";
+  for (auto segment = path.rbegin(); segment != path.rend(); ++segment) {
+    text.append("} // namespace ").append(*segment).append("\n");
+  }
+  return text;
+}
+
+std::string MethodName(unsigned method) {
+  return "Step" + std::to_string(method);
+}
+
+std::string RenderHeader(const ProjectLayout &layout, unsigned header) {
+  const auto &shape = layout.shape();
+  const auto path = layout.NamespacePath(header);
+  std::string text = "#pragma once\n\n" + OpenNamespaces(path);
+  for (unsigned k = 0; k < shape.classes_per_header; ++k) {
+    const ClassId id{header, header * shape.classes_per_header + k};
+    const auto name = ProjectLayout::ClassName(id);
+    if (k > 0) {
+      text.append("\n");
+    }
+    if (layout.Documented(0, id.index)) {
+      text.append("/// Generated component ")
+          .append(std::to_string(id.index))
+          .append(" of header ")
+          .append(std::to_string(header))
+          .append(".\n");
+    }
+    text.append("class ").append(name).append(" {\npublic:\n");
+    for (unsigned method = 0; method < shape.methods_per_class; ++method) {
+      if (layout.Documented(1, id.index, method)) {
+        text.append("  /// Advances ")
+            .append(name)
+            .append(" by one step.\n");
+      }
+      text.append("  int ")
+          .append(MethodName(method))
+          .append("(int value) const;\n");
+    }
+    text.append("\nprivate:\n  int state_ = ")
+        .append(std::to_string(id.index))
+        .append(";\n};\n");
+  }
+  return text + CloseNamespaces(path);
+}
+
+std::string RenderMethod(const ProjectLayout &layout, const ClassId &id,
+                         unsigned method) {
+  std::string text = "int " + ProjectLayout::ClassName(id) +
+                     "::" + MethodName(method) +
+                     "(int value) const {\n  int total = state_ + value;\n";
+  for (unsigned call = 0; call < layout.shape().call_fan_out; ++call) {
+    const auto target = layout.CallTarget(id, method, call);
+    const auto target_method =
+        (method + call) % layout.shape().methods_per_class;
+    text.append("  {\n    const ")
+        .append(layout.QualifiedClassName(target))
+        .append(" peer;\n    total += peer.")
+        .append(MethodName(target_method))
+        .append("(total);\n  }\n");
+  }
+  return text + "  return total;\n}\n";
+}
+
+std::string RenderSource(const ProjectLayout &layout, unsigned unit) {
+  const auto &shape = layout.shape();
+  const auto first_header = unit * shape.headers_per_unit;
+  std::set<std::string> includes;
+  for (auto header = first_header;
+       header < first_header + shape.headers_per_unit; ++header) {
+    includes.insert(layout.HeaderInclude(header));
+    for (unsigned k = 0; k < shape.classes_per_header; ++k) {
+      const ClassId id{header, header * shape.classes_per_header + k};
+      for (unsigned method = 0; method < shape.methods_per_class; ++method) {
+        for (unsigned call = 0; call < shape.call_fan_out; ++call) {
+          includes.insert(layout.HeaderInclude(
+              layout.CallTarget(id, method, call).header));
+        }
+      }
+    }
+  }
+
+  std::string text;
+  for (const auto &include : includes) {
+    text.append("#include \"").append(include).append("\"\n");
+  }
+  for (auto header = first_header;
+       header < first_header + shape.headers_per_unit; ++header) {
+    const auto path = layout.NamespacePath(header);
+    text.append("\n").append(OpenNamespaces(path));
+    for (unsigned k = 0; k < shape.classes_per_header; ++k) {
+      const ClassId id{header, header * shape.classes_per_header + k};
+      for (unsigned method = 0; method < shape.methods_per_class; ++method) {
+        if (k > 0 || method > 0) {
+          text.append("\n");
+        }
+        text.append(RenderMethod(layout, id, method));
+      }
+    }
+    text.append(CloseNamespaces(path));
+  }
+  return text;
+}
+
+std::string SourceName(unsigned unit) {
+  return "unit" + std::to_string(unit) + ".cpp";
+}
+
+std::string
+RenderCompileCommands(const std::filesystem::path &build_directory,
+                      unsigned units) {
+  const auto directory = dsl::EscapeJsonString(build_directory.string());
+  std::string text = "[\n";
+  for (unsigned unit = 0; unit < units; ++unit) {
+    const auto file = "../src/" + SourceName(unit);
+    text.append(unit == 0 ? "" : ",\n")
+        .append("  {\n    \"directory\": \"")
+        .append(directory)
+        .append("\",\n    \"file\": \"")
+        .append(file)
+        .append("\",\n    \"command\": \"clang++ -std=c++17 -I../include -c ")
+        .append(file)
+        .append("\"\n  }");
+  }
+  return text + "\n]\n";
+}
+
+void WriteFile(const std::filesystem::path &path, const std::string &content,
+               dsl::GeneratedProject &project) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  if (!stream.is_open() ||
+      !stream.write(content.data(),
+                    static_cast<std::streamsize>(content.size()))) {
+    throw std::runtime_error("Failed to write generated file: " +
+                             path.string());
+  }
+  project.bytes += content.size();
+  project.lines += static_cast<std::uint64_t>(
+      std::count(content.begin(), content.end(), '\n'));
+}
+
+void ValidateShape(const dsl::ProjectShape &shape) {
+  if (shape.translation_units == 0 || shape.headers_per_unit == 0 ||
+      shape.classes_per_header == 0 || shape.methods_per_class == 0) {
+    throw std::invalid_argument(
+        "Project shape needs at least one translation unit, header, class "
+        "and method.");
+  }
+  const auto classes = static_cast<std::uint64_t>(shape.translation_units) *
+                       shape.headers_per_unit * shape.classes_per_header;
+  if (classes > std::numeric_limits<unsigned>::max()) {
+    throw std::invalid_argument("Project shape has too many classes.");
+  }
+  if (!(shape.doc_comment_density >= 0.0 &&
+        shape.doc_comment_density <= 1.0)) {
+    throw std::invalid_argument(
+        "Doc comment density must be between 0 and 1.");
+  }
+}
+
+void PrintGenerateProjectUsage() {
+  std::cout
+      << "Usage: dsl-generate-project --out <path> [options]\n"
+      << "Options:\n"
+      << "  --out <path>              Directory to write the project into\n"
+      << "  --scenario <name>         Start from a named shape (small,\n"
+      << "                            50k-loc, 500k-loc; default: small)\n"
+      << "  --units <count>           Translation units\n"
+      << "  --headers-per-unit <count>  Headers owned by each unit\n"
+      << "  --classes <count>         Classes per header\n"
+      << "  --methods <count>         Methods per class\n"
+      << "  --fan-out <count>         Calls made by every method\n"
+      << "  --namespace-depth <count> Nested namespaces below 'gen'\n"
+      << "  --doc-density <ratio>     Fraction of documented declarations\n"
+      << "  --seed <number>           Seed for call targets and docs\n"
+      << "Options after --scenario override its values.\n";
+}
+
+std::string RequireValue(const std::vector<std::string> &arguments,
+                         std::size_t &index, const std::string &flag) {
+  if (++index >= arguments.size()) {
+    throw std::invalid_argument(flag + " requires a value");
+  }
+  return arguments[index];
+}
+
+std::uint64_t ParseNumber(const std::string &value, const std::string &flag,
+                          std::uint64_t max) {
+  if (value.empty() ||
+      !std::all_of(value.begin(), value.end(), [](unsigned char ch) {
+        return std::isdigit(ch) != 0;
+      })) {
+    throw std::invalid_argument("Invalid value for " + flag + ": " + value);
+  }
+  try {
+    const auto parsed = std::stoull(value);
+    if (parsed > max) {
+      throw std::out_of_range(value);
+    }
+    return parsed;
+  } catch (const std::out_of_range &) {
+    throw std::invalid_argument("Invalid value for " + flag + ": " + value);
+  }
+}
+
+unsigned ParseCount(const std::string &value, const std::string &flag) {
+  return static_cast<unsigned>(
+      ParseNumber(value, flag, std::numeric_limits<unsigned>::max()));
+}
+
+double ParseRatio(const std::string &value, const std::string &flag) {
+  std::size_t consumed = 0;
+  double ratio = -1.0;
+  try {
+    ratio = std::stod(value, &consumed);
+  } catch (const std::exception &) {
+    consumed = 0;
+  }
+  if (consumed != value.size() || !(ratio >= 0.0 && ratio <= 1.0)) {
+    throw std::invalid_argument("Invalid value for " + flag + ": " + value);
+  }
+  return ratio;
+}
+
+} // namespace
+
+namespace dsl {
+
+ProjectShape ProjectShapeForScenario(std::string_view scenario) {
+  ProjectShape shape;
+  if (scenario == "small") {
+    return shape;
+  }
+  shape.headers_per_unit = 2;
+  shape.classes_per_header = 3;
+  shape.methods_per_class = 6;
+  shape.namespace_depth = 3;
+  if (scenario == "50k-loc") {
+    shape.translation_units = 80;
+    return shape;
+  }
+  if (scenario == "500k-loc") {
+    shape.translation_units = 800;
+    return shape;
+  }
+  throw std::invalid_argument("Unknown project scenario: " +
+                              std::string(scenario));
+}
+
+GeneratedProject GenerateProject(const std::filesystem::path &root,
+                                 const ProjectShape &shape) {
+  ValidateShape(shape);
+  const ProjectLayout layout(shape);
+
+  GeneratedProject project;
+  std::filesystem::create_directories(root);
+  project.root = std::filesystem::weakly_canonical(root);
+  WriteFile(project.root / "CMakeLists.txt",
+            "cmake_minimum_required(VERSION 3.20)\n"
+            "project(generated_project LANGUAGES CXX)\n\n"
+            "file(GLOB_RECURSE GENERATED_SOURCES src/*.cpp)\n"
+            "add_library(generated ${GENERATED_SOURCES})\n"
+            "target_include_directories(generated PUBLIC include)\n",
+            project);
+
+  for (unsigned header = 0; header < layout.HeaderCount(); ++header) {
+    const auto path = project.root / "include" / layout.HeaderInclude(header);
+    WriteFile(path, RenderHeader(layout, header), project);
+    project.headers.push_back(path);
+  }
+  for (unsigned unit = 0; unit < shape.translation_units; ++unit) {
+    const auto path = project.root / "src" / SourceName(unit);
+    WriteFile(path, RenderSource(layout, unit), project);
+    project.sources.push_back(path);
+  }
+
+  const auto build_directory = project.root / "build";
+  project.compile_commands = build_directory / "compile_commands.json";
+  WriteFile(project.compile_commands,
+            RenderCompileCommands(build_directory, shape.translation_units),
+            project);
+  return project;
+}
+
+GenerateProjectOptions
+ParseGenerateProjectArguments(const std::vector<std::string> &arguments) {
+  GenerateProjectOptions options;
+  options.shape = ProjectShapeForScenario("small");
+  for (std::size_t index = 0; index < arguments.size(); ++index) {
+    const auto &argument = arguments[index];
+    if (argument == "--help" || argument == "-h") {
+      options.show_help = true;
+    } else if (argument == "--out") {
+      options.output_directory = RequireValue(arguments, index, argument);
+    } else if (argument == "--scenario") {
+      const auto seed = options.shape.seed;
+      options.shape =
+          ProjectShapeForScenario(RequireValue(arguments, index, argument));
+      options.shape.seed = seed;
+    } else if (argument == "--units") {
+      options.shape.translation_units =
+          ParseCount(RequireValue(arguments, index, argument), argument);
+    } else if (argument == "--headers-per-unit") {
+      options.shape.headers_per_unit =
+          ParseCount(RequireValue(arguments, index, argument), argument);
+    } else if (argument == "--classes") {
+      options.shape.classes_per_header =
+          ParseCount(RequireValue(arguments, index, argument), argument);
+    } else if (argument == "--methods") {
+      options.shape.methods_per_class =
+          ParseCount(RequireValue(arguments, index, argument), argument);
+    } else if (argument == "--fan-out") {
+      options.shape.call_fan_out =
+          ParseCount(RequireValue(arguments, index, argument), argument);
+    } else if (argument == "--namespace-depth") {
+      options.shape.namespace_depth =
+          ParseCount(RequireValue(arguments, index, argument), argument);
+    } else if (argument == "--doc-density") {
+      options.shape.doc_comment_density =
+          ParseRatio(RequireValue(arguments, index, argument), argument);
+    } else if (argument == "--seed") {
+      options.shape.seed =
+          ParseNumber(RequireValue(arguments, index, argument), argument,
+                      std::numeric_limits<std::uint64_t>::max());
+    } else {
+      throw std::invalid_argument("Unknown option: " + argument);
+    }
+  }
+  if (!options.show_help && options.output_directory.empty()) {
+    throw std::invalid_argument("--out is required");
+  }
+  return options;
+}
+
+int RunGenerateProject(const std::vector<std::string> &arguments) {
+  const auto options = ParseGenerateProjectArguments(arguments);
+  if (options.show_help) {
+    PrintGenerateProjectUsage();
+    return 0;
+  }
+  const auto project = GenerateProject(options.output_directory, options.shape);
+  std::cout << "Generated " << project.sources.size()
+            << " translation units and " << project.headers.size()
+            << " headers (" << project.lines << " lines) in "
+            << project.root.string() << "\n";
+  return 0;
+}
+
+} // namespace dsl
@@ -0,0 +1,148 @@
+#include <dsl/resident_translation_units.h>
+
+#include <dsl/cursor_walk_engine.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace dsl {
+
+void ResidentTranslationUnits::Unit::Dispose() {
+  if (translation_unit != nullptr) {
+    clang_disposeTranslationUnit(translation_unit);
+    translation_unit = nullptr;
+  }
+  if (index != nullptr) {
+    clang_disposeIndex(index);
+    index = nullptr;
+  }
+  dependencies.clear();
+  facts = FactStore{};
+}
+
+ResidentTranslationUnits::~ResidentTranslationUnits() {
+  for (auto &entry : units_) {
+    entry.second->Dispose();
+  }
+}
+
+ResidentTranslationUnits::Unit &
+ResidentTranslationUnits::Slot(const std::string &key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &unit = units_[key];
+  if (!unit) {
+    unit = std::make_unique<Unit>();
+  }
+  return *unit;
+}
+
+void ResidentTranslationUnits::Retain(
+    const std::unordered_set<std::string> &keys) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto entry = units_.begin(); entry != units_.end();) {
+    if (keys.count(entry->first) == 0) {
+      entry->second->Dispose();
+      entry = units_.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+std::size_t ResidentTranslationUnits::size() const {
+  return static_cast<std::size_t>(
+      std::count_if(units_.begin(), units_.end(), [](const auto &entry) {
+        return entry.second->translation_unit != nullptr;
+      }));
+}
+
+ResidentUnitSession::ResidentUnitSession(ResidentTranslationUnits &units,
+                                         FileHashes &hashes,
+                                         std::string toolchain_version,
+                                         std::string indexer_settings)
+    : units_(&units), hashes_(&hashes),
+      toolchain_version_(std::move(toolchain_version)),
+      indexer_settings_(std::move(indexer_settings)) {}
+
+std::optional<FactStore>
+ResidentUnitSession::Refresh(const CompileCommandEntry &entry,
+                             const std::vector<std::string> &args,
+                             const IndexingContext &context) {
+  auto &unit = Use(entry, args);
+  std::lock_guard<std::mutex> lock(unit.mutex);
+  if (unit.translation_unit == nullptr) {
+    return std::nullopt;
+  }
+  if (hashes_->IsCurrent(unit.dependencies)) {
+    ++reused_;
+    return unit.facts;
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  const auto error = clang_reparseTranslationUnit(
+      unit.translation_unit, 0, nullptr,
+      clang_defaultReparseOptions(unit.translation_unit));
+  if (error != 0) {
+    // A unit that failed to reparse can only be disposed.
+    context.logger->Log(LogLevel::kDebug, "Reparse failed",
+                        {{"file", entry.file.string()},
+                         {"result", std::to_string(error)}});
+    unit.Dispose();
+    return std::nullopt;
+  }
+  unit.facts = CollectFacts(unit.translation_unit, context.project_root,
+                            context.options, nullptr, entry.position,
+                            entry.arguments);
+  if (context.timings != nullptr) {
+    context.timings->Record(
+        entry.position,
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started),
+        unit.facts.size());
+  }
+  ++reparsed_;
+  context.logger->Log(LogLevel::kInfo, "Reparsed translation unit",
+                      {{"count", std::to_string(unit.facts.size())},
+                       {"file", entry.file.string()}});
+  auto facts = unit.facts;
+  if (!hashes_->Record(
+          CollectDependencies(unit.translation_unit, entry.directory),
+          unit.dependencies)) {
+    unit.Dispose();
+  }
+  return facts;
+}
+
+ParsedTranslationUnit
+ResidentUnitSession::Parse(const CompileCommandEntry &entry,
+                           const std::vector<std::string> &args,
+                           const IndexingContext &context) {
+  auto &unit = Use(entry, args);
+  std::lock_guard<std::mutex> lock(unit.mutex);
+  unit.Dispose();
+  unit.index = clang_createIndex(0, 1);
+  auto parsed = ExtractFactsFromCommand(unit.index, nullptr, entry, context,
+                                        &unit.translation_unit);
+  if (parsed.parsed &&
+      hashes_->Record(parsed.dependencies, unit.dependencies)) {
+    unit.facts = parsed.facts;
+  } else {
+    unit.Dispose();
+  }
+  return parsed;
+}
+
+ResidentTranslationUnits::Unit &
+ResidentUnitSession::Use(const CompileCommandEntry &entry,
+                         const std::vector<std::string> &args) {
+  auto key = BuildTranslationUnitCacheKey(toolchain_version_,
+                                          indexer_settings_, entry.file,
+                                          entry.directory, args);
+  auto &unit = units_->Slot(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  used_.insert(std::move(key));
+  return unit;
+}
+
+} // namespace dsl
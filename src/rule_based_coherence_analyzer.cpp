@@ -1,14 +1,21 @@
 #include <dsl/rule_based_coherence_analyzer.h>
 
+#include <dsl/naming.h>
+
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace {
 
+using dsl::CanonicalizeName;
+using dsl::IsMutationKind;
+
 void AddDuplicateFindings(const std::unordered_map<std::string, int> &counts,
                           dsl::CoherenceResult &result) {
   for (const auto &[name, count] : counts) {
@@ -41,24 +48,35 @@ void AddRelationshipMissingFinding(const dsl::DslExtractionResult &extraction,
   result.findings.push_back(finding);
 }
 
+// Counts the terms of each name. An overload set, terms of one kind that
+// were each extracted for a distinct symbol, counts once.
 std::unordered_map<std::string, int>
 CountTermOccurrences(const std::vector<dsl::DslTerm> &terms) {
-  std::unordered_map<std::string, int> occurrence_counts;
+  struct Occurrences {
+    int count = 0;
+    bool overloads = true;
+    const std::string *kind = nullptr;
+    std::unordered_set<std::uint64_t> symbols;
+  };
+  std::unordered_map<std::string, Occurrences> by_name;
   for (const auto &term : terms) {
-    ++occurrence_counts[term.name];
+    auto &occurrences = by_name[term.name];
+    ++occurrences.count;
+    if (occurrences.kind == nullptr) {
+      occurrences.kind = &term.kind;
+    }
+    occurrences.overloads = occurrences.overloads &&
+                            *occurrences.kind == term.kind &&
+                            term.symbol != 0 &&
+                            occurrences.symbols.insert(term.symbol).second;
+  }
+  std::unordered_map<std::string, int> occurrence_counts;
+  for (const auto &[name, occurrences] : by_name) {
+    occurrence_counts[name] = occurrences.overloads ? 1 : occurrences.count;
   }
   return occurrence_counts;
 }
 
-std::string CanonicalizeName(std::string name) {
-  std::replace(name.begin(), name.end(), ':', '.');
-  std::transform(name.begin(), name.end(), name.begin(),
-                 [](unsigned char character) {
-                   return static_cast<char>(std::tolower(character));
-                 });
-  return name;
-}
-
 void AddAmbiguousAliasFindings(const std::vector<dsl::DslTerm> &terms,
                                dsl::CoherenceResult &result) {
   std::unordered_map<std::string, std::unordered_set<std::string>>
@@ -250,20 +268,15 @@ bool IsVoidType(const std::string &type) {
   return normalized == "void";
 }
 
-bool IsMutationKind(const std::string &kind) {
-  const auto normalized = CanonicalizeName(kind);
-  return normalized == "mutation" || normalized == "assignment" ||
-         normalized == "state_change";
-}
-
-std::string FactEvidence(const dsl::AstFact &fact) {
-  if (!fact.source_location.empty()) {
-    return fact.source_location;
+std::string FactEvidence(const dsl::FactView &fact) {
+  auto location = fact.source_location();
+  if (!location.empty()) {
+    return location;
   }
-  if (!fact.descriptor.empty()) {
-    return fact.descriptor;
+  if (!fact.descriptor().empty()) {
+    return std::string(fact.descriptor());
   }
-  return fact.signature;
+  return std::string(fact.signature());
 }
 
 struct FunctionBehavior {
@@ -283,25 +296,25 @@ std::string CallKey(const std::string &caller, const std::string &target) {
   return caller + "->" + target;
 }
 
-void CollectIntentFacts(const std::vector<dsl::AstFact> &facts,
+void CollectIntentFacts(const dsl::FactStore &facts,
                         IntentAnalysisContext &context) {
   for (const auto &fact : facts) {
-    const auto canonical_name = CanonicalizeName(fact.name);
+    const auto canonical_name = CanonicalizeName(fact.name());
     auto &behavior = context.functions[canonical_name];
 
-    if (fact.kind == "function") {
-      behavior.return_type = ExtractReturnType(fact.signature);
+    if (fact.kind_id() == dsl::FactKind::kFunction) {
+      behavior.return_type = ExtractReturnType(std::string(fact.signature()));
       behavior.signature_evidence = FactEvidence(fact);
     }
-    if (IsMutationKind(fact.kind)) {
+    if (IsMutationKind(fact.kind())) {
       behavior.has_mutation = true;
       behavior.mutation_evidence.push_back(FactEvidence(fact));
     }
-    if (fact.kind == "call") {
-      if (fact.target.empty()) {
+    if (fact.kind_id() == dsl::FactKind::kCall) {
+      if (fact.target().empty()) {
         continue;
       }
-      const auto target = CanonicalizeName(fact.target);
+      const auto target = CanonicalizeName(fact.target());
       context.call_targets[canonical_name].push_back(target);
       const auto key = CallKey(canonical_name, target);
       if (context.call_evidence.find(key) == context.call_evidence.end()) {
@@ -472,7 +485,9 @@ RuleBasedCoherenceAnalyzer::Analyze(const DslExtractionResult &extraction) {
   AddHighUsageMissingRelationshipFindings(extraction, result);
   AddCanonicalizationInconsistencyFindings(extraction, result);
   IntentAnalysisContext intent_context{};
-  CollectIntentFacts(extraction.facts, intent_context);
+  if (extraction.facts) {
+    CollectIntentFacts(*extraction.facts, intent_context);
+  }
   AddGetterFindings(intent_context, result);
   AddSetterFindings(intent_context, result);
   AddPredicateFindings(intent_context, result);
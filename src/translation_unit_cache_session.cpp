@@ -0,0 +1,61 @@
+#include <dsl/translation_unit_cache_session.h>
+
+#include <utility>
+
+namespace dsl {
+
+TranslationUnitCacheSession::TranslationUnitCacheSession(
+    const AstCache &cache, FileHashes &hashes, std::string toolchain_version,
+    std::string indexer_settings)
+    : cache_(&cache), hashes_(&hashes),
+      toolchain_version_(std::move(toolchain_version)),
+      indexer_settings_(std::move(indexer_settings)) {}
+
+std::optional<TranslationUnitCacheEntry>
+TranslationUnitCacheSession::Lookup(const CompileCommandEntry &entry,
+                                    const std::vector<std::string> &args) {
+  TranslationUnitCacheEntry cached;
+  if (!cache_->LoadTranslationUnit(Key(entry, args), cached) ||
+      !hashes_->IsCurrent(cached.dependencies, cached.revision)) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++(cached.failure ? known_failures_ : hits_);
+  return cached;
+}
+
+void TranslationUnitCacheSession::Store(const CompileCommandEntry &entry,
+                                        const std::vector<std::string> &args,
+                                        const ParsedTranslationUnit &parsed) {
+  TranslationUnitCacheEntry cached;
+  if (!hashes_->Record(parsed.dependencies, cached.dependencies)) {
+    return;
+  }
+  cached.facts = parsed.facts;
+  cached.revision = hashes_->RevisionOf(cached.dependencies);
+  cache_->StoreTranslationUnit(Key(entry, args), cached);
+}
+
+void TranslationUnitCacheSession::StoreFailure(
+    const CompileCommandEntry &entry, const std::vector<std::string> &args,
+    const ParseFailure &failure) {
+  const auto path = entry.file.string();
+  const auto hash = hashes_->Hash(path);
+  if (!hash.has_value()) {
+    return;
+  }
+  TranslationUnitCacheEntry cached;
+  cached.dependencies.push_back({path, *hash});
+  cached.failure = failure;
+  cached.revision = hashes_->RevisionOf(cached.dependencies);
+  cache_->StoreTranslationUnit(Key(entry, args), cached);
+}
+
+std::string
+TranslationUnitCacheSession::Key(const CompileCommandEntry &entry,
+                                 const std::vector<std::string> &args) const {
+  return BuildTranslationUnitCacheKey(toolchain_version_, indexer_settings_,
+                                      entry.file, entry.directory, args);
+}
+
+} // namespace dsl
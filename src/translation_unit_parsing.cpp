@@ -0,0 +1,301 @@
+#include <dsl/translation_unit_parsing.h>
+
+#include <dsl/cursor_walk_engine.h>
+#include <dsl/fact_builder.h>
+#include <dsl/indexing_api_engine.h>
+#include <dsl/precompiled_headers.h>
+
+#include <fstream>
+#include <set>
+#include <system_error>
+
+namespace dsl {
+
+namespace {
+
+// When each worker indexes its entries in compile-command order, a header
+// body its action has already indexed belongs to an earlier unit whose facts
+// were delivered first, and skipping it drops only duplicates. Units
+// scheduled longest first may come before the unit that indexed the body, and
+// cached units must hold all of their own facts, so nothing is skipped then.
+unsigned IndexOptions(const IndexingContext &context) {
+  unsigned options = CXIndexOpt_IndexFunctionLocalSymbols;
+  if (context.cache == nullptr && context.in_order) {
+    options |= CXIndexOpt_SkipParsedBodiesInSession;
+  }
+  return options;
+}
+
+// Parses `file` and harvests its facts with the configured engine. The
+// translation unit is left for the caller to dispose. `harvested` is null
+// when `args` are not the entry's own argument set, whose shared headers
+// the run tracks.
+CXErrorCode Harvest(CXIndex index, CXIndexAction action,
+                    const CompileCommandEntry &entry, const char *const *args,
+                    int arg_count, const IndexingContext &context,
+                    HarvestedDeclarations *harvested,
+                    CXTranslationUnit &translation_unit, FactStore &facts) {
+  const auto file = entry.file.string();
+  const auto parse_options = ParseOptions(context.options);
+  if (context.options.engine == IndexerEngine::kIndexingApi) {
+    return IndexSourceFile(action, IndexOptions(context), file, args,
+                           arg_count, parse_options, context.project_root,
+                           context.options, translation_unit, facts);
+  }
+
+  const auto error =
+      clang_parseTranslationUnit2(index, file.c_str(), args, arg_count, nullptr,
+                                  0, parse_options, &translation_unit);
+  if (error == CXError_Success && translation_unit != nullptr) {
+    facts = CollectFacts(translation_unit, context.project_root,
+                         context.options, harvested, entry.position,
+                         entry.arguments);
+  }
+  return error;
+}
+
+// A failed unit keeps only its first few errors; the rest usually follow
+// from them.
+constexpr std::size_t kMaxFailureDiagnostics = 3;
+
+// The first error messages of `translation_unit`, each as "file:line:
+// message" when it has a location.
+std::vector<std::string> ErrorDiagnostics(CXTranslationUnit translation_unit) {
+  std::vector<std::string> messages;
+  const auto count = clang_getNumDiagnostics(translation_unit);
+  for (unsigned i = 0; i < count && messages.size() < kMaxFailureDiagnostics;
+       ++i) {
+    const auto diagnostic = clang_getDiagnostic(translation_unit, i);
+    if (clang_getDiagnosticSeverity(diagnostic) >= CXDiagnostic_Error) {
+      CXFile file{};
+      unsigned line = 0;
+      clang_getSpellingLocation(clang_getDiagnosticLocation(diagnostic), &file,
+                                &line, nullptr, nullptr);
+      const auto path = ToString(clang_getFileName(file));
+      auto message = ToString(clang_getDiagnosticSpelling(diagnostic));
+      messages.push_back(path.empty() ? std::move(message)
+                                      : path + ":" + std::to_string(line) +
+                                            ": " + message);
+    }
+    clang_disposeDiagnostic(diagnostic);
+  }
+  return messages;
+}
+
+// libclang returns no translation unit, and so no diagnostics, when the
+// compiler could not be set up at all; the usual causes are checked instead.
+std::vector<std::string> DiagnoseInputs(const CompileCommandEntry &entry) {
+  std::vector<std::string> messages;
+  std::error_code error;
+  if (!entry.directory.empty() &&
+      !std::filesystem::is_directory(entry.directory, error)) {
+    messages.push_back(entry.directory.string() +
+                       ": working directory does not exist");
+  }
+  if (!std::ifstream(entry.file)) {
+    messages.push_back(entry.file.string() + ": cannot read the source file");
+  }
+  return messages;
+}
+
+} // namespace
+
+unsigned ParseOptions(const IndexerOptions &options) {
+  unsigned flags = CXTranslationUnit_None;
+  if (options.depth == IndexDepth::kDeclarations) {
+    flags |= CXTranslationUnit_SkipFunctionBodies |
+             CXTranslationUnit_Incomplete | CXTranslationUnit_KeepGoing;
+  }
+  // Kept units are reparsed, and a reparse reuses the precompiled preamble
+  // instead of parsing the includes at the top of the file again.
+  if (options.keep_translation_units) {
+    flags |= CXTranslationUnit_PrecompiledPreamble;
+  }
+  return flags;
+}
+
+std::string DescribeParseError(CXErrorCode error) {
+  switch (error) {
+  case CXError_Success:
+    return "success";
+  case CXError_Failure:
+    return "failure";
+  case CXError_Crashed:
+    return "crashed";
+  case CXError_InvalidArguments:
+    return "invalid arguments";
+  case CXError_ASTReadError:
+    return "AST read error";
+  }
+  return "error " + std::to_string(static_cast<int>(error));
+}
+
+std::vector<std::string>
+CollectDependencies(CXTranslationUnit translation_unit,
+                    const std::filesystem::path &directory) {
+  std::set<std::string> names;
+  clang_getInclusions(
+      translation_unit,
+      [](CXFile file, CXSourceLocation *, unsigned, CXClientData data) {
+        static_cast<std::set<std::string> *>(data)->insert(
+            ToString(clang_getFileName(file)));
+      },
+      &names);
+
+  std::vector<std::string> dependencies;
+  dependencies.reserve(names.size());
+  for (const auto &name : names) {
+    if (name.empty()) {
+      continue;
+    }
+    std::filesystem::path path(name);
+    if (path.is_relative()) {
+      path = directory / path;
+    }
+    dependencies.push_back(path.lexically_normal().string());
+  }
+  return dependencies;
+}
+
+bool HasErrors(CXTranslationUnit translation_unit) {
+  const auto count = clang_getNumDiagnostics(translation_unit);
+  for (unsigned i = 0; i < count; ++i) {
+    const auto diagnostic = clang_getDiagnostic(translation_unit, i);
+    const auto severity = clang_getDiagnosticSeverity(diagnostic);
+    clang_disposeDiagnostic(diagnostic);
+    if (severity >= CXDiagnostic_Error) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ParsedTranslationUnit
+ExtractFactsFromCommand(CXIndex index, CXIndexAction action,
+                        const CompileCommandEntry &entry,
+                        const IndexingContext &context,
+                        CXTranslationUnit *kept) {
+  // The first unit of a group builds the shared precompiled header, which
+  // the session times on its own; the unit's parse time starts after it.
+  const auto *header =
+      context.precompiled_headers != nullptr
+          ? context.precompiled_headers->Acquire(index, entry, context)
+          : nullptr;
+  const auto started = std::chrono::steady_clock::now();
+  const auto record_timing = [&](std::size_t fact_count) {
+    if (context.timings != nullptr) {
+      context.timings->Record(
+          entry.position,
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - started),
+          fact_count);
+    }
+  };
+  auto &logger = *context.logger;
+  const auto &arg_pointers = context.argument_sets->Pointers(entry.arguments);
+  const auto file = entry.file.string();
+
+  CXTranslationUnit translation_unit = nullptr;
+  FactStore facts;
+  auto error = CXError_Failure;
+  // A unit returned together with an error code is not used, but its
+  // diagnostics say why the parse failed.
+  const auto discard = [&translation_unit]() {
+    std::vector<std::string> diagnostics;
+    if (translation_unit != nullptr) {
+      diagnostics = ErrorDiagnostics(translation_unit);
+      clang_disposeTranslationUnit(translation_unit);
+      translation_unit = nullptr;
+    }
+    return diagnostics;
+  };
+  if (header != nullptr) {
+    auto with_header = arg_pointers;
+    with_header.push_back("-include-pch");
+    with_header.push_back(header->path.c_str());
+    error = Harvest(index, action, entry, with_header.data(),
+                    static_cast<int>(with_header.size()), context,
+                    context.harvested, translation_unit, facts);
+    if (error != CXError_Success || translation_unit == nullptr) {
+      logger.Log(LogLevel::kDebug, "Precompiled header rejected",
+                 {{"file", file}, {"header", header->path}});
+      discard();
+      header = nullptr;
+    }
+  }
+  if (header == nullptr) {
+    error = Harvest(index, action, entry, arg_pointers.data(),
+                    static_cast<int>(arg_pointers.size()), context,
+                    context.harvested, translation_unit, facts);
+  }
+  logger.Log(LogLevel::kDebug, "Parsing translation unit",
+             {{"file", file},
+              {"arg_count", std::to_string(arg_pointers.size())},
+              {"precompiled_header", header != nullptr ? header->path : ""},
+              {"result", std::to_string(error)}});
+
+  if (error != CXError_Success || translation_unit == nullptr) {
+    // The entry's own arguments give the errors that matter; the fallback's
+    // are only used when those gave none.
+    auto diagnostics = discard();
+    const char *fallback_args[] = {"-std=c++17", file.c_str()};
+    const auto fallback_error =
+        Harvest(index, action, entry, fallback_args, 2, context, nullptr,
+                translation_unit, facts);
+    logger.Log(LogLevel::kWarn, "Fallback parse invoked",
+               {{"file", entry.file.string()},
+                {"result", std::to_string(fallback_error)}});
+    if (fallback_error != CXError_Success || translation_unit == nullptr) {
+      auto fallback_diagnostics = discard();
+      if (diagnostics.empty()) {
+        diagnostics = std::move(fallback_diagnostics);
+      }
+      if (diagnostics.empty()) {
+        diagnostics = DiagnoseInputs(entry);
+      }
+      ParsedTranslationUnit failed;
+      failed.failure =
+          ParseFailure{static_cast<int>(fallback_error),
+                       "parse: " + DescribeParseError(error) +
+                           "; fallback parse: " +
+                           DescribeParseError(fallback_error),
+                       std::move(diagnostics)};
+      record_timing(0);
+      return failed;
+    }
+  }
+
+  ParsedTranslationUnit parsed;
+  parsed.parsed = true;
+  parsed.facts = std::move(facts);
+  if (context.cache != nullptr || kept != nullptr) {
+    parsed.dependencies = CollectDependencies(translation_unit,
+                                              entry.directory);
+    // Headers read from a precompiled header may not be reported as
+    // inclusions, and the header file itself is rebuilt every run.
+    if (header != nullptr) {
+      auto &dependencies = parsed.dependencies;
+      dependencies.erase(
+          std::remove(dependencies.begin(), dependencies.end(), header->path),
+          dependencies.end());
+      dependencies.insert(dependencies.end(), header->dependencies.begin(),
+                          header->dependencies.end());
+      std::sort(dependencies.begin(), dependencies.end());
+      dependencies.erase(
+          std::unique(dependencies.begin(), dependencies.end()),
+          dependencies.end());
+    }
+  }
+  logger.Log(LogLevel::kInfo, "Collected facts",
+             {{"count", std::to_string(parsed.facts.size())},
+              {"file", entry.file.string()}});
+  if (kept != nullptr) {
+    *kept = translation_unit;
+  } else {
+    clang_disposeTranslationUnit(translation_unit);
+  }
+  record_timing(parsed.facts.size());
+  return parsed;
+}
+
+} // namespace dsl
@@ -0,0 +1,124 @@
+#include <dsl/analysis_server.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace dsl {
+namespace {
+
+// Socket paths are limited to about a hundred bytes, so they stay short.
+std::filesystem::path SocketPath(const std::string &name) {
+  return std::filesystem::temp_directory_path() /
+         ("dsl_" + name + "_" + std::to_string(::getpid()) + ".sock");
+}
+
+// Connects like a client but sends nothing.
+int ConnectSilently(const std::filesystem::path &socket_path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(),
+               sizeof(address.sun_path) - 1);
+  const auto descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (::connect(descriptor, reinterpret_cast<const sockaddr *>(&address),
+                sizeof(address)) != 0) {
+    ::close(descriptor);
+    return -1;
+  }
+  return descriptor;
+}
+
+TEST(AnalysisServerTest, AnswersRequestsUntilShutdown) {
+  const auto socket_path = SocketPath("serve");
+  std::vector<std::string> requests;
+  AnalysisServer server(socket_path, [&](const std::string &request) {
+    requests.push_back(request);
+    if (request == "fail") {
+      throw std::runtime_error("no analysis yet");
+    }
+    return ServerReply{3, "run " + std::to_string(requests.size()) + "\n"};
+  });
+  server.Listen();
+  std::thread serving([&server] { server.Serve(); });
+
+  const auto first = SendServerRequest(socket_path, "analyze");
+  const auto second = SendServerRequest(socket_path, "analyze");
+  const auto failed = SendServerRequest(socket_path, "fail");
+  const auto stopped = SendServerRequest(socket_path, "shutdown");
+  serving.join();
+
+  EXPECT_EQ(3, first.exit_code);
+  EXPECT_EQ("run 1\n", first.body);
+  EXPECT_EQ("run 2\n", second.body);
+  EXPECT_EQ(1, failed.exit_code);
+  EXPECT_EQ("Error: no analysis yet\n", failed.body);
+  EXPECT_EQ(0, stopped.exit_code);
+  EXPECT_EQ((std::vector<std::string>{"analyze", "analyze", "fail"}),
+            requests);
+}
+
+TEST(AnalysisServerTest, DropsAClientThatSendsNoRequest) {
+  const auto socket_path = SocketPath("stall");
+  AnalysisServer server(
+      socket_path,
+      [](const std::string &request) {
+        return ServerReply{0, request + "\n"};
+      },
+      std::chrono::milliseconds(100));
+  server.Listen();
+  std::thread serving([&server] { server.Serve(); });
+
+  const auto stalled = ConnectSilently(socket_path);
+  ASSERT_GE(stalled, 0);
+  const auto reply = SendServerRequest(socket_path, "analyze");
+  char byte = 0;
+  const auto read = ::read(stalled, &byte, 1);
+  ::close(stalled);
+  SendServerRequest(socket_path, "shutdown");
+  serving.join();
+
+  EXPECT_EQ("analyze\n", reply.body);
+  EXPECT_EQ(0, read);
+}
+
+TEST(AnalysisServerTest, RefusesAPathAnotherServerListensOn) {
+  const auto socket_path = SocketPath("busy");
+  const auto reply = [](const std::string &) { return ServerReply{}; };
+  AnalysisServer first(socket_path, reply);
+  first.Listen();
+
+  AnalysisServer second(socket_path, reply);
+  EXPECT_THROW(second.Listen(), std::runtime_error);
+}
+
+TEST(AnalysisServerTest, ReplacesAStaleSocketFile) {
+  const auto socket_path = SocketPath("stale");
+  std::ofstream(socket_path) << "left behind";
+
+  AnalysisServer server(socket_path,
+                        [](const std::string &) { return ServerReply{}; });
+  server.Listen();
+  std::thread serving([&server] { server.Serve(); });
+  EXPECT_EQ(0, SendServerRequest(socket_path, "shutdown").exit_code);
+  serving.join();
+}
+
+TEST(AnalysisServerTest, ClientFailsWithoutAServer) {
+  const auto socket_path = SocketPath("absent");
+  std::filesystem::remove(socket_path);
+
+  EXPECT_THROW(SendServerRequest(socket_path, "analyze"), std::runtime_error);
+}
+
+} // namespace
+} // namespace dsl
@@ -0,0 +1,53 @@
+#include <dsl/argument_set_pool.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace dsl {
+namespace {
+
+TEST(ArgumentSetPoolTest, InternsEqualArgumentListsOnce) {
+  ArgumentSetPool pool;
+  const std::vector<std::string> flags{"-Iinclude", "-DNDEBUG", "-std=c++17"};
+
+  const auto first = pool.Intern(flags);
+  const auto second = pool.Intern(std::vector<std::string>(flags));
+  const auto other = pool.Intern({"-Iinclude", "-std=c++20"});
+
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+  EXPECT_EQ(2u, pool.size());
+  EXPECT_EQ(flags, pool.Arguments(first));
+}
+
+TEST(ArgumentSetPoolTest, KeepsArgumentBoundaries) {
+  ArgumentSetPool pool;
+
+  const auto split = pool.Intern({"-I", "include"});
+  const auto joined = pool.Intern({"-Iinclude"});
+  const auto empty = pool.Intern({});
+
+  EXPECT_NE(split, joined);
+  EXPECT_NE(joined, empty);
+  EXPECT_TRUE(pool.Arguments(empty).empty());
+}
+
+TEST(ArgumentSetPoolTest, PointersStayValidAsThePoolGrows) {
+  ArgumentSetPool pool;
+  const auto id = pool.Intern({"-DX", "-std=c++17"});
+  const auto *pointers = pool.Pointers(id).data();
+
+  for (int i = 0; i < 1000; ++i) {
+    pool.Intern({"-DUNIT=" + std::to_string(i)});
+  }
+
+  ASSERT_EQ(2u, pool.Pointers(id).size());
+  EXPECT_EQ(pointers, pool.Pointers(id).data());
+  EXPECT_STREQ("-DX", pool.Pointers(id)[0]);
+  EXPECT_STREQ("-std=c++17", pool.Pointers(id)[1]);
+}
+
+} // namespace
+} // namespace dsl
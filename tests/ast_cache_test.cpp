@@ -0,0 +1,339 @@
+#include <dsl/ast_cache.h>
+#include <dsl/caching_ast_indexer.h>
+#include <dsl/hashing.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "test_support/temporary_project.h"
+
+namespace dsl {
+namespace {
+
+AstCacheOptions EnabledCache(const std::filesystem::path &directory) {
+  AstCacheOptions options;
+  options.enabled = true;
+  options.directory = directory;
+  return options;
+}
+
+class CountingIndexer : public AstIndexer {
+public:
+  explicit CountingIndexer(bool per_translation_unit)
+      : per_translation_unit_(per_translation_unit) {}
+
+  AstIndex BuildIndex(const SourceAcquisitionResult &) override {
+    ++calls;
+    AstIndex index;
+    index.facts.push_back({"Widget", "type", "widget.h:1"});
+    return index;
+  }
+
+  bool UseTranslationUnitCache(std::shared_ptr<const AstCache> cache) override {
+    attached = cache != nullptr;
+    return per_translation_unit_;
+  }
+
+  int calls = 0;
+  bool attached = false;
+
+private:
+  bool per_translation_unit_;
+};
+
+TEST(HashingTest, ProducesStableFnv1aValues) {
+  EXPECT_EQ("cbf29ce484222325", HashToHex(Fnv1a64("")));
+  EXPECT_EQ("af63dc4c8601ec8c", HashToHex(Fnv1a64("a")));
+}
+
+TEST(HashingTest, HashesFileContents) {
+  test::TemporaryProject project;
+  const auto path = project.AddFile("widget.h", "a");
+
+  EXPECT_EQ(Fnv1a64("a"), HashFileContents(path));
+  EXPECT_FALSE(HashFileContents(project.root() / "missing.h").has_value());
+}
+
+TEST(AstCacheTest, RoundTripsTranslationUnitEntries) {
+  test::TemporaryProject project;
+  AstCache cache(EnabledCache(project.root() / "cache"), nullptr);
+
+  AstFact fact{"sample::Use", "call",        "use.cpp:3",      "int Add(int)",
+               "calls\tAdd", "sample::Add", "use.cpp:3:1-3:9"};
+  fact.doc_comment = "/// Uses\n/// things";
+  fact.scope_path = "sample";
+  fact.subject_in_project = true;
+  fact.target_scope = AstFact::TargetScope::kInProject;
+  fact.target_location = "add.h:1:1-1:20";
+  fact.usr = "c:@N@sample@F@Use#";
+  fact.target_usr = "c:@N@sample@F@Add#I#";
+  TranslationUnitCacheEntry entry;
+  entry.dependencies = {{"/project/use.cpp", 0x1234U},
+                        {"/project/add.h", 0xfedcba9876543210U}};
+  entry.facts = {fact};
+
+  cache.StoreTranslationUnit("key", entry);
+  TranslationUnitCacheEntry loaded;
+  ASSERT_TRUE(cache.LoadTranslationUnit("key", loaded));
+
+  ASSERT_EQ(2u, loaded.dependencies.size());
+  EXPECT_EQ("/project/add.h", loaded.dependencies[1].path);
+  EXPECT_EQ(0xfedcba9876543210U, loaded.dependencies[1].content_hash);
+  ASSERT_EQ(1u, loaded.facts.size());
+  EXPECT_EQ(fact.descriptor, loaded.facts[0].descriptor());
+  EXPECT_EQ(fact.doc_comment, loaded.facts[0].doc_comment());
+  EXPECT_EQ(fact.scope_path, loaded.facts[0].scope_path());
+  EXPECT_TRUE(loaded.facts[0].subject_in_project());
+  EXPECT_EQ(AstFact::TargetScope::kInProject, loaded.facts[0].target_scope());
+  EXPECT_EQ(fact.target_location, loaded.facts[0].target_location());
+  EXPECT_EQ(fact.usr, loaded.facts[0].usr());
+  EXPECT_EQ(SymbolIdForUsr(fact.target_usr),
+            loaded.facts[0].target_symbol());
+  EXPECT_FALSE(cache.LoadTranslationUnit("other", loaded));
+}
+
+TEST(AstCacheTest, RoundTripsParseTimings) {
+  test::TemporaryProject project;
+  AstCache cache(EnabledCache(project.root() / "cache"), nullptr);
+  AstCache disabled(AstCacheOptions{}, nullptr);
+
+  EXPECT_TRUE(cache.LoadParseTimings().empty());
+  cache.StoreParseTimings({{"/project/a b.cpp", 1500, 12},
+                           {"/project/bad\nname.cpp", 1, 1},
+                           {"/project/gen.pb.cc", 98000, 4000}});
+  const auto loaded = cache.LoadParseTimings();
+
+  ASSERT_EQ(2u, loaded.size());
+  EXPECT_EQ("/project/a b.cpp", loaded[0].file);
+  EXPECT_EQ(1500u, loaded[0].duration_us);
+  EXPECT_EQ(12u, loaded[0].fact_count);
+  EXPECT_EQ("/project/gen.pb.cc", loaded[1].file);
+  EXPECT_EQ(98000u, loaded[1].duration_us);
+  EXPECT_TRUE(disabled.LoadParseTimings().empty());
+}
+
+TEST(AstCacheTest, RoundTripsFindingBaseline) {
+  test::TemporaryProject project;
+  AstCache cache(EnabledCache(project.root() / "cache"), nullptr);
+  Finding finding;
+  finding.term = "Widget";
+  finding.conflict = "Duplicate\tterm";
+  finding.description = "line one\nline two";
+  finding.examples = {"a.cpp:1", "b.cpp:2"};
+  Finding resolved;
+  resolved.term = "Gone";
+  resolved.change = FindingChange::kResolved;
+
+  EXPECT_FALSE(cache.LoadFindingBaseline());
+  cache.StoreFindingBaseline({finding, resolved}, "0a1b2c");
+  const auto loaded = cache.LoadFindingBaseline();
+
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ("0a1b2c", loaded->revision);
+  const auto &findings = loaded->findings;
+  ASSERT_EQ(1u, findings.size());
+  EXPECT_EQ("Widget", findings[0].term);
+  EXPECT_EQ("Duplicate\tterm", findings[0].conflict);
+  EXPECT_EQ("", findings[0].suggested_canonical_form);
+  EXPECT_EQ("line one\nline two", findings[0].description);
+  EXPECT_EQ(finding.examples, findings[0].examples);
+  EXPECT_FALSE(AstCache(AstCacheOptions{}, nullptr).LoadFindingBaseline());
+}
+
+TEST(AstCacheTest, RoundTripsParseFailures) {
+  test::TemporaryProject project;
+  AstCache cache(EnabledCache(project.root() / "cache"), nullptr);
+  TranslationUnitCacheEntry entry;
+  entry.dependencies = {{"/project/broken.cpp", 0x42U}};
+  entry.failure =
+      ParseFailure{4,
+                   "parse: ast read error",
+                   {"/src/a.cpp:3: unknown type name 'Widget'",
+                    "/src/a.h:1: 'b.h' file not found"}};
+
+  cache.StoreTranslationUnit("key", entry);
+  TranslationUnitCacheEntry loaded;
+  ASSERT_TRUE(cache.LoadTranslationUnit("key", loaded));
+
+  ASSERT_TRUE(loaded.failure.has_value());
+  EXPECT_EQ(4, loaded.failure->error_code);
+  EXPECT_EQ("parse: ast read error", loaded.failure->summary);
+  EXPECT_EQ(entry.failure->diagnostics, loaded.failure->diagnostics);
+  EXPECT_EQ(0u, loaded.facts.size());
+  ASSERT_EQ(1u, loaded.dependencies.size());
+  EXPECT_EQ(0x42U, loaded.dependencies[0].content_hash);
+
+  EXPECT_EQ("", loaded.revision);
+
+  entry.failure.reset();
+  entry.revision = "0a1b2c";
+  cache.StoreTranslationUnit("key", entry);
+  ASSERT_TRUE(cache.LoadTranslationUnit("key", loaded));
+  EXPECT_FALSE(loaded.failure.has_value());
+  EXPECT_EQ("0a1b2c", loaded.revision);
+}
+
+TEST(AstCacheTest, RoundTripsWholeIndexWithAllFields) {
+  test::TemporaryProject project;
+  AstCache cache(EnabledCache(project.root() / "cache"), nullptr);
+  AstFact type{"Widget",        "type", "widget.h:1",      "struct Widget",
+               "struct Widget", "",     "widget.h:1:1-3:2"};
+  type.doc_comment = "/// Widget entity";
+  type.scope_path = "sample";
+  type.subject_in_project = true;
+  auto owns = type;
+  owns.kind = "owns";
+  owns.target = "std::string";
+  owns.target_scope = AstFact::TargetScope::kExternal;
+  owns.target_location = "string:10";
+  AstIndex index;
+  index.facts = {type, owns};
+
+  cache.Store("key", index);
+  AstIndex loaded;
+  ASSERT_TRUE(cache.Load("key", loaded));
+
+  ASSERT_EQ(2u, loaded.facts.size());
+  EXPECT_EQ("Widget", loaded.facts[1].name());
+  EXPECT_EQ("owns", loaded.facts[1].kind());
+  EXPECT_EQ(FactKind::kOwns, loaded.facts[1].kind_id());
+  EXPECT_EQ("widget.h:1:1-3:2", loaded.facts[1].range());
+  EXPECT_EQ("/// Widget entity", loaded.facts[1].doc_comment());
+  EXPECT_EQ("sample", loaded.facts[1].scope_path());
+  EXPECT_TRUE(loaded.facts[1].subject_in_project());
+  EXPECT_EQ(AstFact::TargetScope::kExternal, loaded.facts[1].target_scope());
+  EXPECT_EQ("string:10", loaded.facts[1].target_location());
+}
+
+TEST(AstCacheTest, TreatsTruncatedOrForeignFilesAsMisses) {
+  test::TemporaryProject project;
+  const auto directory = project.root() / "cache";
+  AstCache cache(EnabledCache(directory), nullptr);
+  AstIndex index;
+  index.facts.push_back({"Widget", "type", "widget.h:1"});
+  cache.Store("key", index);
+
+  const auto path = directory / "ast_cache_key.dat";
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+  AstIndex loaded;
+  EXPECT_FALSE(cache.Load("key", loaded));
+
+  {
+    std::ofstream stream(path, std::ios::trunc);
+    stream << "Widget\ttype\twidget.h:1\t\t\t\t\n";
+  }
+  EXPECT_FALSE(cache.Load("key", loaded));
+  EXPECT_TRUE(loaded.facts.empty());
+}
+
+TEST(AstCacheTest, WritesFilesAtomically) {
+  test::TemporaryProject project;
+  const auto path = project.root() / "cache" / "nested" / "entry.dat";
+
+  ASSERT_TRUE(WriteFileAtomically(path, "first"));
+  ASSERT_TRUE(WriteFileAtomically(path, "second"));
+
+  std::ifstream stream(path);
+  std::string contents((std::istreambuf_iterator<char>(stream)),
+                       std::istreambuf_iterator<char>());
+  EXPECT_EQ("second", contents);
+  std::vector<std::filesystem::path> files;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(path.parent_path())) {
+    files.push_back(entry.path());
+  }
+  EXPECT_EQ(std::vector<std::filesystem::path>{path}, files);
+}
+
+TEST(AstCacheTest, TranslationUnitKeyDependsOnFlagsToolchainAndSettings) {
+  const std::vector<std::string> args = {"-std=c++17", "-Iinclude"};
+  const auto key_for = [&](const std::string &toolchain,
+                           const std::string &settings,
+                           const std::string &file,
+                           const std::vector<std::string> &flags) {
+    return BuildTranslationUnitCacheKey(toolchain, settings, file, "/p/build",
+                                        flags);
+  };
+  const auto key = key_for("clang 18", "prune", "/p/a.cpp", args);
+
+  EXPECT_EQ(key, key_for("clang 18", "prune", "/p/a.cpp", args));
+  EXPECT_NE(key, key_for("clang 19", "prune", "/p/a.cpp", args));
+  EXPECT_NE(key, key_for("clang 18", "full", "/p/a.cpp", args));
+  EXPECT_NE(key, key_for("clang 18", "prune", "/p/a.cpp", {"-std=c++20"}));
+  EXPECT_NE(key, key_for("clang 18", "prune", "/p/b.cpp", args));
+}
+
+TEST(AstCacheTest, WholeIndexKeyTracksFileContents) {
+  test::TemporaryProject project;
+  const auto source = project.AddFile("src/widget.cpp", "int a;\n");
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.files = {source.string()};
+
+  const auto before = BuildCacheKey(sources, "clang 18");
+  project.AddFile("src/widget.cpp", "int b;\n");
+
+  EXPECT_NE(before, BuildCacheKey(sources, "clang 18"));
+}
+
+TEST(CachingAstIndexerTest, ReusesWholeIndexForIndexersWithoutUnitCache) {
+  test::TemporaryProject project;
+  auto inner = std::make_unique<CountingIndexer>(false);
+  auto *counting = inner.get();
+  CachingAstIndexer indexer(std::move(inner),
+                            EnabledCache(project.root() / "cache"), nullptr);
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+
+  (void)indexer.BuildIndex(sources);
+  const auto index = indexer.BuildIndex(sources);
+
+  EXPECT_TRUE(counting->attached);
+  EXPECT_EQ(1, counting->calls);
+  ASSERT_EQ(1u, index.facts.size());
+  EXPECT_EQ("Widget", index.facts[0].name());
+}
+
+TEST(CachingAstIndexerTest, StreamsCachedWholeIndexAsOneBatch) {
+  test::TemporaryProject project;
+  auto inner = std::make_unique<CountingIndexer>(false);
+  auto *counting = inner.get();
+  CachingAstIndexer indexer(std::move(inner),
+                            EnabledCache(project.root() / "cache"), nullptr);
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  (void)indexer.BuildIndex(sources);
+
+  FactStore streamed;
+  CollectingFactSink sink(streamed);
+  indexer.StreamIndex(sources, sink);
+
+  EXPECT_EQ(1, counting->calls);
+  ASSERT_EQ(1u, streamed.size());
+  EXPECT_EQ("Widget", streamed[0].name());
+}
+
+TEST(CachingAstIndexerTest, DelegatesToIndexersWithUnitCache) {
+  test::TemporaryProject project;
+  auto inner = std::make_unique<CountingIndexer>(true);
+  auto *counting = inner.get();
+  CachingAstIndexer indexer(std::move(inner),
+                            EnabledCache(project.root() / "cache"), nullptr);
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+
+  (void)indexer.BuildIndex(sources);
+  (void)indexer.BuildIndex(sources);
+
+  EXPECT_EQ(2, counting->calls);
+  EXPECT_FALSE(std::filesystem::exists(project.root() / "cache"));
+}
+
+} // namespace
+} // namespace dsl
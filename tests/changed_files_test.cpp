@@ -0,0 +1,84 @@
+#include <dsl/changed_files.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "test_support/temporary_project.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+namespace dsl {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::string Canonical(const std::filesystem::path &path) {
+  return std::filesystem::weakly_canonical(path).string();
+}
+
+TEST(ChangedFilesTest, ReadsListRelativeToRoot) {
+  test::TemporaryProject project;
+  const auto source = project.AddFile("src/a.cpp");
+  const auto header = project.AddFile("include/a.h");
+  const auto list = project.AddFile(
+      "changed.txt", "# from CI\nsrc/a.cpp\n\n" + header.string() +
+                         "\r\nsrc/../src/a.cpp\n");
+
+  EXPECT_THAT(ReadChangedFilesList(list, project.root()),
+              ElementsAre(Canonical(header), Canonical(source)));
+}
+
+TEST(ChangedFilesTest, RejectsMissingList) {
+  test::TemporaryProject project;
+
+  EXPECT_THROW(ReadChangedFilesList(project.root() / "missing.txt",
+                                    project.root()),
+               std::runtime_error);
+}
+
+#ifndef _WIN32
+
+TEST(ChangedFilesTest, ListsFilesChangedSinceRevision) {
+  test::TemporaryProject project;
+  const auto git = "git -C '" + project.root().string() + "' ";
+  const auto run = [&](const std::string &arguments) {
+    return std::system((git + arguments + " >/dev/null 2>&1").c_str()) == 0;
+  };
+  if (!run("init -q") || !run("config user.email dsl@example.com") ||
+      !run("config user.name dsl")) {
+    GTEST_SKIP() << "git is not available";
+  }
+  project.AddFile("kept.cpp", "int kept;\n");
+  const auto edited = project.AddFile("src/edited.cpp", "int a;\n");
+  const auto removed = project.AddFile("removed.h", "int r;\n");
+  ASSERT_TRUE(run("add -A") && run("commit -q -m base"));
+
+  project.AddFile("src/edited.cpp", "int a = 1;\n");
+  std::filesystem::remove(removed);
+  const auto added = project.AddFile("include/added.h", "int b;\n");
+  project.AddFile(".gitignore", "build/\n");
+  project.AddFile("build/ignored.cpp", "");
+
+  const auto changes = ChangedFilesSince(project.root() / "src", "HEAD");
+  EXPECT_THAT(changes.changed,
+              ElementsAre(Canonical(project.root() / ".gitignore"),
+                          Canonical(added), Canonical(removed),
+                          Canonical(edited)));
+  EXPECT_THAT(changes.unchanged,
+              ElementsAre(Canonical(project.root() / "kept.cpp")));
+  EXPECT_EQ(40u, changes.revision.size());
+  const auto work_tree = WorkTreeChanges(project.root());
+  ASSERT_TRUE(work_tree);
+  EXPECT_EQ(changes.revision, work_tree->revision);
+  EXPECT_THROW(ChangedFilesSince(project.root(), "no-such-branch"),
+               std::runtime_error);
+  EXPECT_FALSE(WorkTreeChanges(project.root().parent_path()));
+}
+
+#endif
+
+} // namespace
+} // namespace dsl
@@ -1,9 +1,17 @@
+#include <dsl/ast_cache.h>
 #include <dsl/compile_commands_ast_indexer.h>
+#include <dsl/fact_shard.h>
+#include <dsl/logging.h>
 #include <dsl/models.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -121,6 +129,11 @@ int Use(const Widget &widget) {
                              Field(&AstFact::scope_path, "sample"),
                              Field(&AstFact::source_location,
                                    HasSubstr("example.cpp:15")))));
+  EXPECT_THAT(index.facts,
+              Contains(AllOf(Field(&AstFact::name, "sample::Use"),
+                             Field(&AstFact::kind, "call"),
+                             Field(&AstFact::target,
+                                   "sample::Calculator::Add"))));
 }
 
 TEST(CompileCommandsAstIndexerTest,
@@ -161,13 +174,13 @@ TEST(CompileCommandsAstIndexerTest, EmitsRelationshipFactsAndMetadata) {
   const auto compile_commands_path = build_dir / "compile_commands.json";
   {
     std::ofstream stream(compile_commands_path);
-    stream << "[\\n";
-    stream << "  {\\n";
-    stream << "    \"directory\": \"" << build_dir.string() << "\",\\n";
-    stream << "    \"file\": \"" << source_path.string() << "\",\\n";
+    stream << "[\n";
+    stream << "  {\n";
+    stream << "    \"directory\": \"" << build_dir.string() << "\",\n";
+    stream << "    \"file\": \"" << source_path.string() << "\",\n";
     stream << "    \"command\": \"clang -std=c++17 -c " << source_path.string()
-           << "\"\\n";
-    stream << "  }\\n";
+           << "\"\n";
+    stream << "  }\n";
     stream << "]\n";
   }
 
@@ -184,6 +197,8 @@ TEST(CompileCommandsAstIndexerTest, EmitsRelationshipFactsAndMetadata) {
                              Field(&AstFact::name, HasSubstr("Use")),
                              Field(&AstFact::target, HasSubstr("Add")),
                              Field(&AstFact::signature, HasSubstr("int Add")),
+                             Field(&AstFact::usr, HasSubstr("@F@Use")),
+                             Field(&AstFact::target_usr, HasSubstr("@F@Add")),
                              Field(&AstFact::subject_in_project, true),
                              Field(&AstFact::target_scope,
                                    Eq(AstFact::TargetScope::kInProject)))));
@@ -193,6 +208,7 @@ TEST(CompileCommandsAstIndexerTest, EmitsRelationshipFactsAndMetadata) {
                      Field(&AstFact::name, HasSubstr("Use")),
                      Field(&AstFact::target, HasSubstr("Widget")),
                      Field(&AstFact::descriptor, HasSubstr("uses Widget")),
+                     Field(&AstFact::target_usr, "c:@S@Widget"),
                      Field(&AstFact::subject_in_project, true),
                      Field(&AstFact::target_scope,
                            Eq(AstFact::TargetScope::kInProject)))));
@@ -200,12 +216,688 @@ TEST(CompileCommandsAstIndexerTest, EmitsRelationshipFactsAndMetadata) {
       index.facts,
       Contains(AllOf(
           Field(&AstFact::kind, "owns"), Field(&AstFact::name, "Widget"),
-          Field(&AstFact::target, "int"),
+          Field(&AstFact::usr, "c:@S@Widget"), Field(&AstFact::target, "int"),
+          Field(&AstFact::target_usr, ""),
           Field(&AstFact::descriptor, HasSubstr("value")),
           Field(&AstFact::subject_in_project, true),
           Field(&AstFact::target_scope, Eq(AstFact::TargetScope::kUnknown)))));
 }
 
+TEST(CompileCommandsAstIndexerTest, ParallelIndexMatchesSerialIndex) {
+  test::TemporaryProject project;
+  std::vector<std::filesystem::path> source_paths;
+  for (int i = 0; i < 6; ++i) {
+    const auto suffix = std::to_string(i);
+    source_paths.push_back(project.AddFile(
+        "src/unit" + suffix + ".cpp",
+        "struct Shared { int value; };\nint Helper" + suffix +
+            "(Shared shared) { return shared.value; }\nint Use" + suffix +
+            "() { return Helper" + suffix + "(Shared{}); }\n"));
+  }
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[\n";
+    for (std::size_t i = 0; i < source_paths.size(); ++i) {
+      stream << "  {\"directory\": \"" << build_dir.string()
+             << "\", \"file\": \"" << source_paths[i].string()
+             << "\", \"command\": \"clang -std=c++17 -c "
+             << source_paths[i].string() << "\"}"
+             << (i + 1 < source_paths.size() ? ",\n" : "\n");
+    }
+    stream << "]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  CompileCommandsAstIndexer serial_indexer({}, nullptr, IndexerOptions{1});
+  CompileCommandsAstIndexer parallel_indexer({}, nullptr, IndexerOptions{4});
+  const auto serial = serial_indexer.BuildIndex(sources);
+  const auto parallel = parallel_indexer.BuildIndex(sources);
+
+  ASSERT_THAT(serial.facts, Not(IsEmpty()));
+  ASSERT_EQ(serial.facts.size(), parallel.facts.size());
+  for (std::size_t i = 0; i < serial.facts.size(); ++i) {
+    EXPECT_EQ(serial.facts[i].name(), parallel.facts[i].name());
+    EXPECT_EQ(serial.facts[i].kind(), parallel.facts[i].kind());
+    EXPECT_EQ(serial.facts[i].target(), parallel.facts[i].target());
+    EXPECT_EQ(serial.facts[i].source_location(),
+              parallel.facts[i].source_location());
+  }
+}
+
+TEST(CompileCommandsAstIndexerTest, PrecompiledHeaderKeepsFacts) {
+  test::TemporaryProject project;
+  project.AddFile("src/shared.h",
+                  "#pragma once\n"
+                  "struct Shared { int value; };\n"
+                  "inline int Twice(Shared s) { return s.value * 2; }\n");
+  std::vector<std::filesystem::path> source_paths;
+  for (int i = 0; i < 3; ++i) {
+    const auto suffix = std::to_string(i);
+    source_paths.push_back(project.AddFile(
+        "src/unit" + suffix + ".cpp",
+        "#include \"shared.h\"\n#include <vector>\nint Use" + suffix +
+            "(Shared s) { return Twice(s); }\n"));
+  }
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[\n";
+    for (std::size_t i = 0; i < source_paths.size(); ++i) {
+      stream << "  {\"directory\": \"" << build_dir.string()
+             << "\", \"file\": \"" << source_paths[i].string()
+             << "\", \"command\": \"clang++ -std=c++17 -c "
+             << source_paths[i].string() << "\"}"
+             << (i + 1 < source_paths.size() ? ",\n" : "\n");
+    }
+    stream << "]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  IndexerOptions plain_options;
+  plain_options.precompile_headers = false;
+  CompileCommandsAstIndexer precompiled_indexer;
+  CompileCommandsAstIndexer plain_indexer({}, nullptr, plain_options);
+  const auto precompiled = precompiled_indexer.BuildIndex(sources);
+  const auto plain = plain_indexer.BuildIndex(sources);
+
+  ASSERT_THAT(plain.facts, Contains(AllOf(Field(&AstFact::kind, "call"),
+                                          Field(&AstFact::name, "Use2"))));
+  ASSERT_EQ(plain.facts.size(), precompiled.facts.size());
+  for (std::size_t i = 0; i < plain.facts.size(); ++i) {
+    EXPECT_EQ(plain.facts[i].name(), precompiled.facts[i].name());
+    EXPECT_EQ(plain.facts[i].kind(), precompiled.facts[i].kind());
+    EXPECT_EQ(plain.facts[i].target(), precompiled.facts[i].target());
+    EXPECT_EQ(plain.facts[i].source_location(),
+              precompiled.facts[i].source_location());
+  }
+}
+
+TEST(CompileCommandsAstIndexerTest, SkipsHeadersHarvestedByEarlierUnits) {
+  test::TemporaryProject project;
+  project.AddFile("src/shared.h",
+                  "#pragma once\n"
+                  "struct Shared {\n"
+                  "  int value;\n"
+                  "  int Get() const { return value; }\n"
+                  "};\n");
+  std::vector<std::filesystem::path> source_paths;
+  for (int i = 0; i < 2; ++i) {
+    const auto suffix = std::to_string(i);
+    source_paths.push_back(project.AddFile(
+        "src/unit" + suffix + ".cpp",
+        "#include \"shared.h\"\nint Use" + suffix +
+            "(const Shared &shared) { return shared.Get(); }\n"));
+  }
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[\n";
+    for (std::size_t i = 0; i < source_paths.size(); ++i) {
+      stream << "  {\"directory\": \"" << build_dir.string()
+             << "\", \"file\": \"" << source_paths[i].string()
+             << "\", \"command\": \"clang++ -std=c++17 -c "
+             << source_paths[i].string() << "\"}"
+             << (i + 1 < source_paths.size() ? ",\n" : "\n");
+    }
+    stream << "]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  std::ostringstream log;
+  IndexerOptions options;
+  options.precompile_headers = false;
+  CompileCommandsAstIndexer indexer(
+      {}, MakeLogger(LoggingConfig{LogLevel::kInfo}, log), options);
+  const auto index = indexer.BuildIndex(sources);
+
+  EXPECT_THAT(log.str(), HasSubstr("\"harvested\": \"1\""));
+  EXPECT_THAT(log.str(), Not(HasSubstr("\"skipped_declarations\": \"0\"")));
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "type"),
+                                          Field(&AstFact::name, "Shared")))
+                              .Times(1));
+  for (const auto *user : {"Use0", "Use1"}) {
+    EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "call"),
+                                            Field(&AstFact::name, user),
+                                            Field(&AstFact::target,
+                                                  "Shared::Get"))));
+  }
+}
+
+TEST(CompileCommandsAstIndexerTest, HarvestsSharedHeadersPerArgumentSet) {
+  test::TemporaryProject project;
+  project.AddFile("src/shared.h",
+                  "#pragma once\n"
+                  "struct Shared { int value; };\n"
+                  "#ifdef WITH_EXTRA\n"
+                  "struct Extra { int Get() const { return 1; } };\n"
+                  "#endif\n");
+  const auto plain = project.AddFile("src/plain.cpp",
+                                     "#include \"shared.h\"\n"
+                                     "int Plain(const Shared &s) { return "
+                                     "s.value; }\n");
+  const auto extra = project.AddFile(
+      "src/extra.cpp",
+      "#include \"shared.h\"\nint Plain(const Shared &s);\n"
+      "#ifdef WITH_EXTRA\nint UseExtra(const Extra &e) { return e.Get(); }\n"
+      "#endif\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[\n  {\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << plain.string()
+           << "\", \"command\": \"clang++ -std=c++17 -c " << plain.string()
+           << "\"},\n  {\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << extra.string()
+           << "\", \"command\": \"clang++ -std=c++17 -DWITH_EXTRA -c "
+           << extra.string() << "\"}\n]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  IndexerOptions options;
+  options.precompile_headers = false;
+  CompileCommandsAstIndexer indexer({}, nullptr, options);
+  const auto index = indexer.BuildIndex(sources);
+
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "type"),
+                                          Field(&AstFact::name, "Shared")))
+                              .Times(1));
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "type"),
+                                          Field(&AstFact::name, "Extra"))));
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "call"),
+                                          Field(&AstFact::name, "UseExtra"),
+                                          Field(&AstFact::target,
+                                                "Extra::Get"))));
+}
+
+TEST(CompileCommandsAstIndexerTest, TraversesHeadersIncludedAfterADefine) {
+  test::TemporaryProject project;
+  project.AddFile("src/shared.h",
+                  "#pragma once\n"
+                  "struct Shared { int value; };\n"
+                  "#ifdef WITH_EXTRA\n"
+                  "struct Extra { int Get() const { return 1; } };\n"
+                  "#endif\n");
+  const auto plain = project.AddFile("src/plain.cpp",
+                                     "#include \"shared.h\"\n"
+                                     "int Plain(const Shared &s) { return "
+                                     "s.value; }\n");
+  const auto extra = project.AddFile(
+      "src/extra.cpp", "#define WITH_EXTRA\n#include \"shared.h\"\n"
+                       "int UseExtra(const Extra &e) { return e.Get(); }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[\n";
+    for (const auto &source : {plain, extra}) {
+      stream << "  {\"directory\": \"" << build_dir.string()
+             << "\", \"file\": \"" << source.string()
+             << "\", \"command\": \"clang++ -std=c++17 -c " << source.string()
+             << "\"}" << (source == plain ? ",\n" : "\n");
+    }
+    stream << "]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  IndexerOptions options;
+  options.precompile_headers = false;
+  options.jobs = 1;
+  CompileCommandsAstIndexer indexer({}, nullptr, options);
+  const auto index = indexer.BuildIndex(sources);
+
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "type"),
+                                          Field(&AstFact::name, "Extra"))));
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "call"),
+                                          Field(&AstFact::name, "UseExtra"),
+                                          Field(&AstFact::target,
+                                                "Extra::Get"))));
+}
+
+TEST(CompileCommandsAstIndexerTest, TraversesHeadersIncludedInANamespace) {
+  test::TemporaryProject project;
+  project.AddFile("src/shared.h",
+                  "#pragma once\n"
+                  "struct Shared { int Get() const { return 1; } };\n");
+  const auto plain = project.AddFile(
+      "src/plain.cpp", "#include \"shared.h\"\n"
+                       "int Plain(const Shared &s) { return s.Get(); }\n");
+  const auto wrapped = project.AddFile(
+      "src/wrapped.cpp",
+      "namespace wrapped {\n#include \"shared.h\"\n}\n"
+      "int Wrapped(const wrapped::Shared &s) { return s.Get(); }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[\n";
+    for (const auto &source : {plain, wrapped}) {
+      stream << "  {\"directory\": \"" << build_dir.string()
+             << "\", \"file\": \"" << source.string()
+             << "\", \"command\": \"clang++ -std=c++17 -c " << source.string()
+             << "\"}" << (source == plain ? ",\n" : "\n");
+    }
+    stream << "]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  IndexerOptions options;
+  options.precompile_headers = false;
+  options.jobs = 1;
+  CompileCommandsAstIndexer indexer({}, nullptr, options);
+  const auto index = indexer.BuildIndex(sources);
+
+  for (const auto *name : {"Shared", "wrapped::Shared"}) {
+    EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "type"),
+                                            Field(&AstFact::name, name))));
+  }
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "call"),
+                                          Field(&AstFact::name, "Wrapped"),
+                                          Field(&AstFact::target,
+                                                "wrapped::Shared::Get"))));
+}
+
+TEST(CompileCommandsAstIndexerTest, PrunedTraversalKeepsProjectFacts) {
+  test::TemporaryProject project;
+  const auto source_path = project.AddFile(
+      "src/use.cpp", "#include <vector>\n"
+                     "struct Widget { std::vector<int> values; };\n"
+                     "int First(const Widget &w) { return w.values[0]; }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[{\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << source_path.string()
+           << "\", \"command\": \"clang++ -std=c++17 -c "
+           << source_path.string() << "\"}]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  IndexerOptions full_options;
+  full_options.prune_external = false;
+  CompileCommandsAstIndexer pruned_indexer;
+  CompileCommandsAstIndexer full_indexer({}, nullptr, full_options);
+  const auto pruned = pruned_indexer.BuildIndex(sources);
+  const auto full = full_indexer.BuildIndex(sources);
+
+  ASSERT_THAT(pruned.facts, Contains(Field(&AstFact::name, "Widget")));
+  ASSERT_EQ(full.facts.size(), pruned.facts.size());
+  for (std::size_t i = 0; i < full.facts.size(); ++i) {
+    EXPECT_EQ(full.facts[i].name(), pruned.facts[i].name());
+    EXPECT_EQ(full.facts[i].kind(), pruned.facts[i].kind());
+    EXPECT_EQ(full.facts[i].target(), pruned.facts[i].target());
+    EXPECT_EQ(full.facts[i].target_scope(), pruned.facts[i].target_scope());
+  }
+}
+
+TEST(CompileCommandsAstIndexerTest, DeclarationDepthSkipsBodyFacts) {
+  test::TemporaryProject project;
+  const auto source_path = project.AddFile(
+      "src/use.cpp", "struct Widget { int value; };\n"
+                     "int Add(int a, int b) { return a + b; }\n"
+                     "int Use(Widget w) { return Add(w.value, 1); }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[{\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << source_path.string()
+           << "\", \"command\": \"clang++ -std=c++17 -c "
+           << source_path.string() << "\"}]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  IndexerOptions options;
+  options.depth = IndexDepth::kDeclarations;
+  CompileCommandsAstIndexer indexer({}, nullptr, options);
+  const auto index = indexer.BuildIndex(sources);
+
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "function"),
+                                          Field(&AstFact::name, "Use"))));
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "owns"),
+                                          Field(&AstFact::name, "Widget"))));
+  EXPECT_THAT(index.facts, Not(Contains(Field(&AstFact::kind, "call"))));
+  EXPECT_THAT(index.facts, Not(Contains(Field(&AstFact::kind, "type_usage"))));
+}
+
+TEST(CompileCommandsAstIndexerTest, IndexingApiEngineMatchesCursorWalk) {
+  test::TemporaryProject project;
+  project.AddFile("src/widget.h", "namespace shop {\n"
+                                  "struct Widget { int value; };\n"
+                                  "int Add(int a, int b);\n"
+                                  "}\n");
+  const auto source_path = project.AddFile(
+      "src/use.cpp", "#include \"widget.h\"\n"
+                     "namespace shop {\n"
+                     "int Add(int a, int b) { return a + b; }\n"
+                     "int Use(Widget w) { int total = Add(w.value, 1);\n"
+                     "                    return total; }\n"
+                     "}\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[{\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << source_path.string()
+           << "\", \"command\": \"clang++ -std=c++17 -c "
+           << source_path.string() << "\"}]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  const auto declarations = [&](IndexerEngine engine) {
+    IndexerOptions options;
+    options.engine = engine;
+    CompileCommandsAstIndexer indexer({}, nullptr, options);
+    std::vector<std::tuple<std::string, std::string, std::string>> facts;
+    for (const auto &fact : indexer.BuildIndex(sources).facts) {
+      if (fact.kind() != "call") {
+        facts.emplace_back(fact.kind(), fact.name(), fact.source_location());
+      }
+    }
+    std::sort(facts.begin(), facts.end());
+    return facts;
+  };
+  EXPECT_EQ(declarations(IndexerEngine::kIndexingApi),
+            declarations(IndexerEngine::kCursorWalk));
+
+  IndexerOptions options;
+  options.engine = IndexerEngine::kIndexingApi;
+  CompileCommandsAstIndexer indexer({}, nullptr, options);
+  const auto index = indexer.BuildIndex(sources);
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "call"),
+                                          Field(&AstFact::name, "shop::Use"),
+                                          Field(&AstFact::target, "shop::Add"),
+                                          Field(&AstFact::scope_path,
+                                                "shop::Use"))));
+  EXPECT_THAT(index.facts, Contains(AllOf(Field(&AstFact::kind, "variable"),
+                                          Field(&AstFact::name,
+                                                "shop::Use::total"))));
+}
+
+TEST(CompileCommandsAstIndexerTest, ReusesCachedUnitsUntilAHeaderChanges) {
+  test::TemporaryProject project;
+  const auto header_path =
+      project.AddFile("src/widget.h", "struct Widget { int value; };\n");
+  const auto source_path =
+      project.AddFile("src/use.cpp", "#include \"widget.h\"\n"
+                                     "int Use(Widget w) { return w.value; }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[{\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << source_path.string()
+           << "\", \"command\": \"clang -std=c++17 -c "
+           << source_path.string() << "\"}]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  AstCacheOptions cache_options;
+  cache_options.enabled = true;
+  cache_options.directory = project.root() / "cache";
+  const auto cache = std::make_shared<AstCache>(cache_options, nullptr);
+  const auto build = [&] {
+    CompileCommandsAstIndexer indexer;
+    EXPECT_TRUE(indexer.UseTranslationUnitCache(cache));
+    return indexer.BuildIndex(sources);
+  };
+
+  const auto cold = build();
+  const auto warm = build();
+  ASSERT_THAT(cold.facts, Contains(Field(&AstFact::name, "Widget")));
+  EXPECT_EQ(cold.facts.size(), warm.facts.size());
+  EXPECT_FALSE(std::filesystem::is_empty(cache_options.directory /
+                                         "translation_units"));
+  // The cache hit keeps the timing measured by the cold run.
+  const auto timings = cache->LoadParseTimings();
+  ASSERT_EQ(1u, timings.size());
+  EXPECT_EQ(std::filesystem::weakly_canonical(source_path).string(),
+            timings[0].file);
+  EXPECT_EQ(cold.facts.size(), timings[0].fact_count);
+
+  {
+    std::ofstream stream(header_path, std::ios::trunc);
+    stream << "struct Gadget { int value; };\nusing Widget = Gadget;\n";
+  }
+  const auto changed = build();
+  EXPECT_THAT(changed.facts, Contains(Field(&AstFact::name, "Gadget")));
+}
+
+TEST(CompileCommandsAstIndexerTest, ContinuesAnInterruptedRunFromTheCache) {
+  test::TemporaryProject project;
+  const auto first =
+      project.AddFile("src/first.cpp", "int First() { return 1; }\n");
+  const auto second =
+      project.AddFile("src/second.cpp", "int Second() { return 2; }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[\n";
+    for (const auto *source : {&first, &second}) {
+      stream << "  {\"directory\": \"" << build_dir.string()
+             << "\", \"file\": \"" << source->string()
+             << "\", \"command\": \"clang -std=c++17 -c "
+             << source->string() << "\"}"
+             << (source == &first ? ",\n" : "\n");
+    }
+    stream << "]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  AstCacheOptions cache_options;
+  cache_options.enabled = true;
+  cache_options.directory = project.root() / "cache";
+  const auto cache = std::make_shared<AstCache>(cache_options, nullptr);
+
+  // Stands in for a run killed after its first unit was stored.
+  class InterruptingSink : public FactSink {
+  public:
+    void Consume(const FactStore &) override {
+      throw std::runtime_error("interrupted");
+    }
+  };
+  {
+    CompileCommandsAstIndexer indexer;
+    ASSERT_TRUE(indexer.UseTranslationUnitCache(cache));
+    InterruptingSink sink;
+    EXPECT_THROW(indexer.StreamIndex(sources, sink), std::runtime_error);
+  }
+
+  // Starting the run again reuses the unit the interrupted run stored.
+  std::ostringstream log;
+  CompileCommandsAstIndexer indexer(
+      {}, MakeLogger(LoggingConfig{LogLevel::kInfo}, log));
+  ASSERT_TRUE(indexer.UseTranslationUnitCache(cache));
+  const auto continued = indexer.BuildIndex(sources);
+
+  EXPECT_THAT(log.str(), HasSubstr("\"hits\": \"1\""));
+  EXPECT_THAT(log.str(), HasSubstr("\"misses\": \"1\""));
+  EXPECT_THAT(continued.facts, Contains(Field(&AstFact::name, "First")));
+  EXPECT_THAT(continued.facts, Contains(Field(&AstFact::name, "Second")));
+}
+
+TEST(CompileCommandsAstIndexerTest, ChangedFilesSelectUnitsToReparse) {
+  test::TemporaryProject project;
+  const auto header_path =
+      project.AddFile("src/widget.h", "struct Widget { int value; };\n");
+  const auto source_path =
+      project.AddFile("src/use.cpp", "#include \"widget.h\"\n"
+                                     "int Use(Widget w) { return w.value; }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[{\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << source_path.string()
+           << "\", \"command\": \"clang -std=c++17 -c "
+           << source_path.string() << "\"}]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  AstCacheOptions cache_options;
+  cache_options.enabled = true;
+  cache_options.directory = project.root() / "cache";
+  const auto cache = std::make_shared<AstCache>(cache_options, nullptr);
+  const auto build = [&](ChangeSet changes) {
+    IndexerOptions options;
+    options.changes = std::move(changes);
+    CompileCommandsAstIndexer indexer({}, nullptr, options);
+    EXPECT_TRUE(indexer.UseTranslationUnitCache(cache));
+    return indexer.BuildIndex(sources);
+  };
+  const auto header = std::filesystem::weakly_canonical(header_path).string();
+  const auto source = std::filesystem::weakly_canonical(source_path).string();
+
+  const auto cold = build({"base", {}, {header, source}});
+  ASSERT_THAT(cold.facts, Contains(Field(&AstFact::name, "Widget")));
+  {
+    std::ofstream stream(header_path, std::ios::trunc);
+    stream << "struct Gadget { int value; };\nusing Widget = Gadget;\n";
+  }
+  // An edit outside the change set is not looked at.
+  const auto other = project.AddFile("src/other.h").string();
+  const auto unlisted = build({"base", {other}, {header, source}});
+  EXPECT_THAT(unlisted.facts, Not(Contains(Field(&AstFact::name, "Gadget"))));
+
+  // Units recorded at another commit are validated by hashing their files.
+  const auto other_revision = build({"next", {other}, {header, source}});
+  EXPECT_THAT(other_revision.facts, Contains(Field(&AstFact::name, "Gadget")));
+
+  const auto listed = build({"next", {header}, {source}});
+  EXPECT_THAT(listed.facts, Contains(Field(&AstFact::name, "Gadget")));
+}
+
+TEST(CompileCommandsAstIndexerTest, KeptUnitsAreReparsedWhenAHeaderChanges) {
+  test::TemporaryProject project;
+  const auto header_path =
+      project.AddFile("src/widget.h", "struct Widget { int value; };\n");
+  const auto source_path =
+      project.AddFile("src/use.cpp", "#include \"widget.h\"\n"
+                                     "int Use(Widget w) { return w.value; }\n");
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[{\"directory\": \"" << build_dir.string()
+           << "\", \"file\": \"" << source_path.string()
+           << "\", \"command\": \"clang -std=c++17 -c "
+           << source_path.string() << "\"}]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  IndexerOptions options;
+  options.keep_translation_units = true;
+  CompileCommandsAstIndexer indexer({}, nullptr, options);
+  const auto cold = indexer.BuildIndex(sources);
+  const auto warm = indexer.BuildIndex(sources);
+  ASSERT_THAT(cold.facts, Contains(Field(&AstFact::name, "Widget")));
+  EXPECT_EQ(cold.facts.size(), warm.facts.size());
+
+  {
+    std::ofstream stream(header_path, std::ios::trunc);
+    stream << "struct Gadget { int value; };\nusing Widget = Gadget;\n";
+  }
+  const auto changed = indexer.BuildIndex(sources);
+  EXPECT_THAT(changed.facts, Contains(Field(&AstFact::name, "Gadget")));
+}
+
+TEST(CompileCommandsAstIndexerTest, MergedShardsMatchASingleRun) {
+  test::TemporaryProject project;
+  project.AddFile("src/widget.h", "struct Widget { int value; };\n");
+  std::vector<std::filesystem::path> sources_paths;
+  for (const auto *name : {"a", "b", "c", "d"}) {
+    sources_paths.push_back(project.AddFile(
+        std::string("src/") + name + ".cpp",
+        std::string("#include \"widget.h\"\nint ") + name +
+            "(Widget w) { return w.value; }\n"));
+  }
+  const auto build_dir = project.root() / "build";
+  std::filesystem::create_directories(build_dir);
+  {
+    std::ofstream stream(build_dir / "compile_commands.json");
+    stream << "[";
+    for (std::size_t i = 0; i < sources_paths.size(); ++i) {
+      stream << (i == 0 ? "" : ",") << "{\"directory\": \""
+             << build_dir.string() << "\", \"file\": \""
+             << sources_paths[i].string()
+             << "\", \"command\": \"clang -std=c++17 -c "
+             << sources_paths[i].string() << "\"}";
+    }
+    stream << "]\n";
+  }
+
+  SourceAcquisitionResult sources;
+  sources.project_root = project.root().string();
+  sources.build_directory = build_dir.string();
+
+  const auto single = CompileCommandsAstIndexer().BuildIndex(sources);
+  std::vector<std::filesystem::path> shard_paths;
+  for (unsigned index = 1; index <= 2; ++index) {
+    IndexerOptions options;
+    options.shard = IndexShard{index, 2};
+    CompileCommandsAstIndexer indexer({}, nullptr, options);
+    FactShardWriter writer(*options.shard);
+    indexer.StreamIndex(sources, writer);
+    shard_paths.push_back(project.root() /
+                          FactShardFileName(*options.shard));
+    writer.Write(shard_paths.back(), indexer.IndexingNotes());
+  }
+  const auto merged = FactShardMerger(shard_paths).BuildIndex(sources);
+
+  ASSERT_THAT(single.facts, Contains(Field(&AstFact::name, "Widget")));
+  ASSERT_EQ(single.facts.size(), merged.facts.size());
+  for (std::size_t i = 0; i < single.facts.size(); ++i) {
+    EXPECT_EQ(single.facts[i].name(), merged.facts[i].name());
+    EXPECT_EQ(single.facts[i].source_location(),
+              merged.facts[i].source_location());
+  }
+}
+
 TEST(CompileCommandsAstIndexerTest, SkipsBuildDirectoryEntries) {
   test::TemporaryProject project;
   const auto build_dir = project.root() / "build";
@@ -216,13 +908,13 @@ TEST(CompileCommandsAstIndexerTest, SkipsBuildDirectoryEntries) {
   const auto compile_commands_path = build_dir / "compile_commands.json";
   {
     std::ofstream stream(compile_commands_path);
-    stream << "[\\n";
-    stream << "  {\\n";
-    stream << "    \"directory\": \"" << build_dir.string() << "\",\\n";
-    stream << "    \"file\": \"" << build_file.string() << "\",\\n";
+    stream << "[\n";
+    stream << "  {\n";
+    stream << "    \"directory\": \"" << build_dir.string() << "\",\n";
+    stream << "    \"file\": \"" << build_file.string() << "\",\n";
     stream << "    \"command\": \"clang -std=c++17 -c " << build_file.string()
-           << "\"\\n";
-    stream << "  }\\n";
+           << "\"\n";
+    stream << "  }\n";
     stream << "]\n";
   }
 
@@ -0,0 +1,114 @@
+#include <dsl/compile_commands_loader.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace dsl {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::vector<CompileCommand> ReadAll(std::string_view json) {
+  CompileCommandsReader reader(json);
+  std::vector<CompileCommand> commands;
+  CompileCommand command;
+  while (reader.Next(command)) {
+    commands.push_back(command);
+  }
+  return commands;
+}
+
+TEST(CompileCommandsReaderTest, ReadsArgumentsCommandAndOutput) {
+  const auto commands = ReadAll(R"([
+    {"directory": "/work/build", "file": "../src/a.cpp",
+     "arguments": ["clang++", "-DNAME=\"x y\"", "-c", "../src/a.cpp"],
+     "output": "a.o"},
+    {"file": "/work/src/b.cpp", "directory": "/work/build",
+     "command": "clang++ -I'/work/my include' -c /work/src/b.cpp"}
+  ])");
+
+  ASSERT_EQ(2u, commands.size());
+  EXPECT_EQ("/work/build", commands[0].directory);
+  EXPECT_EQ("../src/a.cpp", commands[0].file);
+  EXPECT_THAT(commands[0].arguments,
+              ElementsAre("clang++", "-DNAME=\"x y\"", "-c", "../src/a.cpp"));
+  EXPECT_EQ("a.o", commands[0].output);
+  EXPECT_EQ("/work/src/b.cpp", commands[1].file);
+  EXPECT_THAT(commands[1].arguments,
+              ElementsAre("clang++", "-I/work/my include", "-c",
+                          "/work/src/b.cpp"));
+  EXPECT_THAT(commands[1].output, IsEmpty());
+}
+
+TEST(CompileCommandsReaderTest, HandlesEscapesAndBracesInsideStrings) {
+  const auto commands = ReadAll(
+      R"([{"directory": "C:\\work\\{build}", "file": "a \"}\" b.cpp",
+           "command": "cc -DA=\"{}\" -DU=\u00e9\ud83d\ude00 a.cpp"}])");
+
+  ASSERT_EQ(1u, commands.size());
+  EXPECT_EQ("C:\\work\\{build}", commands[0].directory);
+  EXPECT_EQ("a \"}\" b.cpp", commands[0].file);
+  EXPECT_THAT(commands[0].arguments,
+              ElementsAre("cc", "-DA={}", "-DU=\xc3\xa9\xf0\x9f\x98\x80",
+                          "a.cpp"));
+}
+
+TEST(CompileCommandsReaderTest, SkipsUnknownKeysOfAnyType) {
+  const auto commands = ReadAll(
+      R"([{"extra": {"nested": [1, -2.5e3, true, null, {"x": "}"}]},
+           "file": "a.cpp", "count": 3, "flag": false}])");
+
+  ASSERT_EQ(1u, commands.size());
+  EXPECT_EQ("a.cpp", commands[0].file);
+  EXPECT_THAT(commands[0].arguments, IsEmpty());
+}
+
+TEST(CompileCommandsReaderTest, ReusesTheCommandBetweenEntries) {
+  CompileCommandsReader reader(
+      R"([{"file": "a.cpp", "output": "a.o", "arguments": ["cc"]},
+          {"file": "b.cpp"}])");
+  CompileCommand command;
+
+  ASSERT_TRUE(reader.Next(command));
+  ASSERT_TRUE(reader.Next(command));
+  EXPECT_EQ("b.cpp", command.file);
+  EXPECT_THAT(command.output, IsEmpty());
+  EXPECT_THAT(command.arguments, IsEmpty());
+  EXPECT_FALSE(reader.Next(command));
+  EXPECT_FALSE(reader.Next(command));
+}
+
+TEST(CompileCommandsReaderTest, AcceptsAnEmptyDatabase) {
+  EXPECT_THAT(ReadAll(" [ ] \n"), IsEmpty());
+}
+
+TEST(CompileCommandsReaderTest, RejectsMalformedInput) {
+  for (const std::string json :
+       {"", "{}", "[", "[{\"file\": \"a.cpp\"}", "[{\"file\": a.cpp}]",
+        "[{\"file\": \"a.cpp\"} {\"file\": \"b.cpp\"}]",
+        "[{\"file\": \"a\\q.cpp\"}]", "[{\"file\": \"\\ud800\"}]",
+        "[{\"file\": \"a.cpp\"}] trailing", "[\\n]"}) {
+    EXPECT_THROW(ReadAll(json), std::runtime_error) << json;
+  }
+}
+
+TEST(SplitCommandLineTest, FollowsClangToolingQuoting) {
+  EXPECT_THAT(SplitCommandLine("  clang++\t-c  a.cpp "),
+              ElementsAre("clang++", "-c", "a.cpp"));
+  EXPECT_THAT(SplitCommandLine(R"(cc "-DA=\"b c\"" '-DD=\e' x\ y)"),
+              ElementsAre("cc", "-DA=\"b c\"", "-DD=\\e", "x y"));
+  EXPECT_THAT(SplitCommandLine(R"(cc -I""/usr/include '')"),
+              ElementsAre("cc", "-I/usr/include", ""));
+  EXPECT_THAT(SplitCommandLine(R"(cc 'open \)"), ElementsAre("cc", "open \\"));
+  EXPECT_THAT(SplitCommandLine(R"(cc trailing\)"),
+              ElementsAre("cc", "trailing\\"));
+  EXPECT_THAT(SplitCommandLine(""), IsEmpty());
+}
+
+} // namespace
+} // namespace dsl
@@ -1,4 +1,5 @@
 #include <dsl/analyzer_pipeline_builder.h>
+#include <dsl/compile_commands_ast_indexer.h>
 #include <dsl/component_registry.h>
 #include <dsl/default_analyzer_pipeline.h>
 #include <dsl/heuristic_dsl_extractor.h>
@@ -127,5 +128,43 @@ TEST(ComponentRegistryTest, PipelineBuilderUsesCustomPluginsWhenSelected) {
   EXPECT_EQ(result.report.json, "custom-json");
 }
 
+TEST(ComponentRegistryTest, ProvidesBothIndexingEngines) {
+  const auto registry = MakeComponentRegistryWithDefaults();
+
+  EXPECT_EQ(registry.DefaultIndexerName(), "cursor");
+  EXPECT_EQ(registry.IndexerNames(),
+            (std::vector<std::string>{"cursor", "indexing-api"}));
+  for (const auto &name : registry.IndexerNames()) {
+    auto indexer = registry.CreateIndexer(name);
+    EXPECT_NE(dynamic_cast<CompileCommandsAstIndexer *>(indexer.get()),
+              nullptr)
+        << name;
+  }
+  EXPECT_THROW(registry.CreateIndexer("missing"), std::invalid_argument);
+}
+
+TEST(ComponentRegistryTest, PipelineBuilderPassesOptionsToSelectedIndexer) {
+  auto registry = MakeComponentRegistryWithDefaults();
+  IndexerOptions received;
+  registry.RegisterIndexer(
+      "recording", [&](std::shared_ptr<Logger>, IndexerOptions options) {
+        received = options;
+        return std::make_unique<StubIndexer>();
+      });
+  IndexerOptions options;
+  options.jobs = 6;
+  options.depth = IndexDepth::kDeclarations;
+
+  AnalyzerPipelineBuilder builder(registry);
+  builder.WithLogger(std::make_shared<NullLogger>());
+  builder.WithSourceAcquirer(std::make_unique<StubSourceAcquirer>());
+  builder.WithIndexerName("recording").WithIndexerOptions(options);
+  auto pipeline = builder.Build();
+  pipeline.Run(MinimalConfig());
+
+  EXPECT_EQ(received.jobs, 6u);
+  EXPECT_EQ(received.depth, IndexDepth::kDeclarations);
+}
+
 } // namespace
 } // namespace dsl
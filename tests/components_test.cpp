@@ -8,15 +8,23 @@
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "test_support/allocation_tracking.h"
 #include "test_support/temporary_project.h"
 
 namespace dsl {
 namespace {
 
+std::shared_ptr<const FactStore> ShareFacts(FactStore facts) {
+  return std::make_shared<const FactStore>(std::move(facts));
+}
+
 AnalysisConfig MakeConfig() {
   AnalysisConfig config;
   config.root_path = ".";
@@ -25,8 +33,7 @@ AnalysisConfig MakeConfig() {
 }
 
 TEST(HeuristicDslExtractorTest, BuildsTermsAndRelationships) {
-  AstIndex index;
-  index.facts = {
+  std::vector<AstFact> facts = {
       {"ProcessData", "function", "file.cpp:3", "int ProcessData()",
        "Processes input", "", "3:1-3:10"},
       {"ProcessData", "call", "file.cpp:10", "", "Transforms frame",
@@ -46,7 +53,7 @@ TEST(HeuristicDslExtractorTest, BuildsTermsAndRelationships) {
       {"FrameBuffer", "type", "types.h:30", "class FrameBuffer", "holds pixels",
        "", "30:1-30:20"},
   };
-  for (auto &fact : index.facts) {
+  for (auto &fact : facts) {
     fact.subject_in_project = true;
     if (fact.kind == "call" || fact.kind == "type_usage" ||
         fact.kind == "owns" || fact.kind == "reference" ||
@@ -54,6 +61,10 @@ TEST(HeuristicDslExtractorTest, BuildsTermsAndRelationships) {
       fact.target_scope = AstFact::TargetScope::kInProject;
     }
   }
+  AstIndex index;
+  for (const auto &fact : facts) {
+    index.facts.push_back(fact);
+  }
   HeuristicDslExtractor extractor;
 
   const auto extraction = extractor.Extract(index, MakeConfig());
@@ -158,6 +169,38 @@ TEST(RuleBasedCoherenceAnalyzerTest, DetectsDuplicateTerms) {
   EXPECT_EQ(result.findings.front().term, "shared");
 }
 
+TEST(RuleBasedCoherenceAnalyzerTest, AcceptsOverloadSets) {
+  AstIndex index;
+  for (const auto *parameter : {"int", "double"}) {
+    AstFact add{"Add", "function", "math.h:1"};
+    add.signature = std::string("void Add(") + parameter + ")";
+    add.descriptor = add.signature;
+    add.usr = std::string("c:@F@Add#") + parameter + "#";
+    add.subject_in_project = true;
+    index.facts.push_back(add);
+    AstFact call{"Run", "call", "run.cpp:2"};
+    call.target = "Add";
+    call.target_usr = add.usr;
+    call.target_scope = AstFact::TargetScope::kInProject;
+    call.subject_in_project = true;
+    index.facts.push_back(call);
+  }
+  HeuristicDslExtractor extractor;
+  AnalysisConfig config;
+  config.root_path = "repo";
+  const auto extraction = extractor.Extract(index, config);
+  ASSERT_EQ(2, std::count_if(extraction.terms.begin(), extraction.terms.end(),
+                             [](const DslTerm &term) {
+                               return term.name == "add";
+                             }));
+
+  const auto result = RuleBasedCoherenceAnalyzer().Analyze(extraction);
+
+  EXPECT_THAT(result.findings,
+              ::testing::Not(::testing::Contains(::testing::Field(
+                  &Finding::conflict, ::testing::HasSubstr("Duplicate")))));
+}
+
 TEST(RuleBasedCoherenceAnalyzerTest, DetectsAmbiguousAliases) {
   DslExtractionResult extraction;
   DslTerm first;
@@ -279,10 +322,10 @@ TEST(RuleBasedCoherenceAnalyzerTest,
 
 TEST(RuleBasedCoherenceAnalyzerTest, FlagsMutatingOrVoidGetter) {
   DslExtractionResult extraction;
-  extraction.facts = {
+  extraction.facts = ShareFacts({
       {"GetValue", "function", "file.cpp:3", "void GetValue()", "", "", ""},
       {"GetValue", "mutation", "file.cpp:4", "", "writes cache", "", ""},
-  };
+  });
 
   RuleBasedCoherenceAnalyzer analyzer;
 
@@ -299,8 +342,8 @@ TEST(RuleBasedCoherenceAnalyzerTest, FlagsMutatingOrVoidGetter) {
 
 TEST(RuleBasedCoherenceAnalyzerTest, FlagsSetterWithoutMutations) {
   DslExtractionResult extraction;
-  extraction.facts = {{"SetValue", "function", "file.cpp:8",
-                       "void SetValue(int value)", "", "", ""}};
+  extraction.facts = ShareFacts({{"SetValue", "function", "file.cpp:8",
+                                  "void SetValue(int value)", "", "", ""}});
 
   RuleBasedCoherenceAnalyzer analyzer;
 
@@ -314,10 +357,10 @@ TEST(RuleBasedCoherenceAnalyzerTest, FlagsSetterWithoutMutations) {
 
 TEST(RuleBasedCoherenceAnalyzerTest, FlagsImpureOrNonBoolPredicates) {
   DslExtractionResult extraction;
-  extraction.facts = {
+  extraction.facts = ShareFacts({
       {"IsReady", "function", "file.cpp:12", "int IsReady()", "", "", ""},
       {"IsReady", "mutation", "file.cpp:13", "", "updates cache", "", ""},
-  };
+  });
 
   RuleBasedCoherenceAnalyzer analyzer;
 
@@ -335,10 +378,10 @@ TEST(RuleBasedCoherenceAnalyzerTest, FlagsImpureOrNonBoolPredicates) {
 
 TEST(RuleBasedCoherenceAnalyzerTest, DetectsOpenWithoutCloseInCaller) {
   DslExtractionResult extraction;
-  extraction.facts = {
+  extraction.facts = ShareFacts({
       {"Controller::Run", "call", "runner.cpp:20", "", "", "OpenSession", ""},
       {"Controller::Run", "call", "runner.cpp:21", "", "", "DoWork", ""},
-  };
+  });
 
   RuleBasedCoherenceAnalyzer analyzer;
 
@@ -352,10 +395,10 @@ TEST(RuleBasedCoherenceAnalyzerTest, DetectsOpenWithoutCloseInCaller) {
 
 TEST(RuleBasedCoherenceAnalyzerTest, AcceptsBalancedOpenCloseInCaller) {
   DslExtractionResult extraction;
-  extraction.facts = {
+  extraction.facts = ShareFacts({
       {"Controller::Run", "call", "runner.cpp:20", "", "", "OpenSession", ""},
       {"Controller::Run", "call", "runner.cpp:22", "", "", "CloseSession", ""},
-  };
+  });
 
   RuleBasedCoherenceAnalyzer analyzer;
 
@@ -364,6 +407,137 @@ TEST(RuleBasedCoherenceAnalyzerTest, AcceptsBalancedOpenCloseInCaller) {
   EXPECT_TRUE(result.findings.empty());
 }
 
+class EmptySourceAcquirer : public SourceAcquirer {
+public:
+  SourceAcquisitionResult Acquire(const AnalysisConfig &) override {
+    return {};
+  }
+};
+
+class FixedFactsIndexer : public AstIndexer {
+public:
+  explicit FixedFactsIndexer(const FactStore &facts) : facts_(&facts) {}
+
+  AstIndex BuildIndex(const SourceAcquisitionResult &) override {
+    AstIndex index;
+    index.facts = *facts_;
+    return index;
+  }
+
+  void StreamIndex(const SourceAcquisitionResult &, FactSink &sink) override {
+    sink.Consume(*facts_);
+  }
+
+  std::vector<std::string> IndexingNotes() const override { return notes; }
+
+  std::vector<std::string> notes;
+
+private:
+  const FactStore *facts_;
+};
+
+class EmptyReporter : public Reporter {
+public:
+  Report Render(const DslExtractionResult &, const CoherenceResult &,
+                const AnalysisConfig &) override {
+    return {};
+  }
+};
+
+TEST(DefaultAnalyzerPipelineTest, KeepsOnlyIntentFactsInItsResult) {
+  const auto before_facts = test::AllocatedBytes();
+  FactStore facts;
+  for (int i = 0; i < 2000; ++i) {
+    AstFact fact;
+    fact.name = "external::Symbol" + std::to_string(i);
+    fact.kind = "declaration";
+    fact.source_location = "external.h:" + std::to_string(i);
+    fact.doc_comment = std::string(4096, 'x') + std::to_string(i);
+    facts.push_back(fact);
+  }
+  const auto fact_bytes = test::AllocatedBytes() - before_facts;
+
+  PipelineComponents components;
+  components.source_acquirer = std::make_unique<EmptySourceAcquirer>();
+  components.indexer = std::make_unique<FixedFactsIndexer>(facts);
+  components.extractor = std::make_unique<HeuristicDslExtractor>();
+  components.analyzer = std::make_unique<RuleBasedCoherenceAnalyzer>();
+  components.reporter = std::make_unique<EmptyReporter>();
+  DefaultAnalyzerPipeline pipeline(std::move(components));
+
+  test::ResetPeakAllocatedBytes();
+  const auto before_run = test::AllocatedBytes();
+  auto result = pipeline.Run(MakeConfig());
+  const auto peak_growth = test::PeakAllocatedBytes() - before_run;
+
+  // Declarations feed no intent analysis, so the extraction folds them into
+  // its terms without keeping a copy of the facts.
+  ASSERT_NE(nullptr, result.extraction.facts);
+  EXPECT_TRUE(result.extraction.facts->empty());
+  EXPECT_LT(peak_growth, fact_bytes / 2);
+}
+
+TEST(DefaultAnalyzerPipelineTest, AppendsIndexingNotesToExtractionNotes) {
+  FactStore facts;
+  auto indexer = std::make_unique<FixedFactsIndexer>(facts);
+  indexer->notes = {"Skipped broken.cpp"};
+  PipelineComponents components;
+  components.source_acquirer = std::make_unique<EmptySourceAcquirer>();
+  components.indexer = std::move(indexer);
+  components.extractor = std::make_unique<HeuristicDslExtractor>();
+  components.analyzer = std::make_unique<RuleBasedCoherenceAnalyzer>();
+  components.reporter = std::make_unique<EmptyReporter>();
+  DefaultAnalyzerPipeline pipeline(std::move(components));
+
+  const auto result = pipeline.Run(MakeConfig());
+
+  ASSERT_FALSE(result.extraction.extraction_notes.empty());
+  EXPECT_EQ("Skipped broken.cpp", result.extraction.extraction_notes.back());
+}
+
+class FixedFindingsAnalyzer : public CoherenceAnalyzer {
+public:
+  CoherenceResult Analyze(const DslExtractionResult &) override {
+    CoherenceResult result;
+    for (const auto *term : {"Added", "Kept"}) {
+      Finding finding;
+      finding.term = term;
+      finding.conflict = "Duplicate term";
+      result.findings.push_back(finding);
+    }
+    return result;
+  }
+};
+
+TEST(DefaultAnalyzerPipelineTest, MarksFindingsAgainstTheBaseline) {
+  FactStore facts;
+  PipelineComponents components;
+  components.source_acquirer = std::make_unique<EmptySourceAcquirer>();
+  components.indexer = std::make_unique<FixedFactsIndexer>(facts);
+  components.extractor = std::make_unique<HeuristicDslExtractor>();
+  components.analyzer = std::make_unique<FixedFindingsAnalyzer>();
+  components.reporter = std::make_unique<EmptyReporter>();
+  DefaultAnalyzerPipeline pipeline(std::move(components));
+  auto baseline = std::make_shared<std::vector<Finding>>(2);
+  (*baseline)[0].term = "Kept";
+  (*baseline)[0].conflict = "Duplicate term";
+  (*baseline)[1].term = "Fixed";
+  (*baseline)[1].conflict = "Duplicate term";
+  auto config = MakeConfig();
+  config.baseline_findings = baseline;
+
+  const auto result = pipeline.Run(config);
+
+  const auto &findings = result.coherence.findings;
+  ASSERT_EQ(3u, findings.size());
+  EXPECT_EQ("Added", findings[0].term);
+  EXPECT_EQ(FindingChange::kNew, findings[0].change);
+  EXPECT_EQ("Kept", findings[1].term);
+  EXPECT_EQ(FindingChange::kUnchanged, findings[1].change);
+  EXPECT_EQ("Fixed", findings[2].term);
+  EXPECT_EQ(FindingChange::kResolved, findings[2].change);
+}
+
 TEST(DefaultAnalyzerPipelineTest, RunsComponentsInOrder) {
   test::TemporaryProject project;
   project.AddFile("CMakeLists.txt", "cmake_minimum_required(VERSION 3.20)\n");
@@ -374,17 +548,17 @@ TEST(DefaultAnalyzerPipelineTest, RunsComponentsInOrder) {
   const auto compile_commands_path = build_dir / "compile_commands.json";
   {
     std::ofstream compile_commands(compile_commands_path);
-    compile_commands << "[\\n";
-    compile_commands << "  {\\n";
+    compile_commands << "[\n";
+    compile_commands << "  {\n";
     compile_commands << "    \"directory\": \"" << build_dir.string()
-                     << "\",\\n";
+                     << "\",\n";
     compile_commands << "    \"file\": \""
                      << std::filesystem::weakly_canonical(source_path).string()
-                     << "\",\\n";
+                     << "\",\n";
     compile_commands << "    \"command\": \"clang -std=c++17 -c "
                      << std::filesystem::weakly_canonical(source_path).string()
-                     << "\"\\n";
-    compile_commands << "  }\\n";
+                     << "\"\n";
+    compile_commands << "  }\n";
     compile_commands << "]\n";
   }
 
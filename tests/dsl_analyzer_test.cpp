@@ -36,7 +36,20 @@ TEST(ParseAnalyzeArgumentsTest, ParsesFlagsAndValues) {
                                          "--analyzer",
                                          "custom-analyzer",
                                          "--reporter",
-                                         "custom-reporter"};
+                                         "custom-reporter",
+                                         "--indexer",
+                                         "indexing-api",
+                                         "--jobs",
+                                         "4",
+                                         "--traverse-external",
+                                         "--index-depth=declarations",
+                                         "--no-pch",
+                                         "--retry-failed",
+                                         "--watch",
+                                         "--since",
+                                         "origin/main",
+                                         "--shard",
+                                         "2/3"};
 
   const auto options = ParseAnalyzeArguments(args);
 
@@ -63,6 +76,44 @@ TEST(ParseAnalyzeArgumentsTest, ParsesFlagsAndValues) {
   EXPECT_EQ(options.extractor, std::optional<std::string>("custom-extractor"));
   EXPECT_EQ(options.analyzer, std::optional<std::string>("custom-analyzer"));
   EXPECT_EQ(options.reporter, std::optional<std::string>("custom-reporter"));
+  EXPECT_EQ(options.indexer, std::optional<std::string>("indexing-api"));
+  EXPECT_EQ(options.jobs, std::optional<unsigned>(4));
+  EXPECT_EQ(options.traverse_external, std::optional<bool>(true));
+  EXPECT_EQ(options.index_depth,
+            std::optional<dsl::IndexDepth>(dsl::IndexDepth::kDeclarations));
+  EXPECT_EQ(options.precompiled_headers, std::optional<bool>(false));
+  EXPECT_EQ(options.retry_failed, std::optional<bool>(true));
+  EXPECT_TRUE(options.watch);
+  EXPECT_EQ(options.since, std::optional<std::string>("origin/main"));
+  EXPECT_FALSE(options.changed_files);
+  ASSERT_TRUE(options.shard);
+  EXPECT_EQ(2u, options.shard->index);
+  EXPECT_EQ(3u, options.shard->count);
+}
+
+TEST(ParseAnalyzeArgumentsTest, RejectsInvalidShards) {
+  for (const auto *shard : {"0/2", "3/2", "1", "1/0", "a/2", "1/2/3", "-1/2"}) {
+    EXPECT_THROW(ParseAnalyzeArguments({"--shard", shard}),
+                 std::invalid_argument)
+        << shard;
+  }
+}
+
+TEST(ParseAnalyzeArgumentsTest, RejectsInvalidJobCount) {
+  EXPECT_THROW(ParseAnalyzeArguments({"--jobs", "many"}),
+               std::invalid_argument);
+  EXPECT_THROW(ParseAnalyzeArguments({"--jobs", "-2"}), std::invalid_argument);
+  EXPECT_THROW(ParseAnalyzeArguments({"--jobs"}), std::invalid_argument);
+}
+
+TEST(ParseAnalyzeArgumentsTest, ParsesIndexDepth) {
+  EXPECT_EQ(ParseAnalyzeArguments({"--index-depth", "full"}).index_depth,
+            std::optional<dsl::IndexDepth>(dsl::IndexDepth::kFull));
+  EXPECT_FALSE(ParseAnalyzeArguments({}).index_depth);
+  EXPECT_THROW(ParseAnalyzeArguments({"--index-depth", "bodies"}),
+               std::invalid_argument);
+  EXPECT_THROW(ParseAnalyzeArguments({"--index-depth"}),
+               std::invalid_argument);
 }
 
 TEST(ParseReportArgumentsTest, ParsesFlagsAndFormats) {
@@ -95,9 +146,15 @@ TEST(ParseConfigFileTest, ParsesYamlNestedValuesAndFormatsList) {
   config_stream << "extractor: yaml-extractor\n";
   config_stream << "analyzer: yaml-analyzer\n";
   config_stream << "reporter: yaml-reporter\n";
+  config_stream << "indexer: cursor\n";
   config_stream << "ignored_source_directories:\n";
   config_stream << "  - generated\n";
   config_stream << "  - vendor\n";
+  config_stream << "jobs: 3\n";
+  config_stream << "traverse_external: false\n";
+  config_stream << "index_depth: declarations\n";
+  config_stream << "precompiled_headers: false\n";
+  config_stream << "retry_failed: true\n";
   config_stream.close();
 
   const auto options = ParseConfigFile(temp_config);
@@ -119,8 +176,15 @@ TEST(ParseConfigFileTest, ParsesYamlNestedValuesAndFormatsList) {
   EXPECT_EQ(options.extractor, std::optional<std::string>("yaml-extractor"));
   EXPECT_EQ(options.analyzer, std::optional<std::string>("yaml-analyzer"));
   EXPECT_EQ(options.reporter, std::optional<std::string>("yaml-reporter"));
+  EXPECT_EQ(options.indexer, std::optional<std::string>("cursor"));
   ASSERT_EQ(options.ignored_source_directories,
             (std::vector<std::string>{"generated", "vendor"}));
+  EXPECT_EQ(options.jobs, std::optional<unsigned>(3));
+  EXPECT_EQ(options.traverse_external, std::optional<bool>(false));
+  EXPECT_EQ(options.index_depth,
+            std::optional<dsl::IndexDepth>(dsl::IndexDepth::kDeclarations));
+  EXPECT_EQ(options.precompiled_headers, std::optional<bool>(false));
+  EXPECT_EQ(options.retry_failed, std::optional<bool>(true));
   std::filesystem::remove(temp_config);
 }
 
@@ -166,6 +230,22 @@ TEST(ResolveAnalyzeOptionsTest, CliOverridesConfig) {
   std::filesystem::remove(temp_config);
 }
 
+TEST(ResolveAnalyzeOptionsTest, RejectsChangeSetsWithConflictingOptions) {
+  const auto resolve = [](std::vector<std::string> extra) {
+    extra.insert(extra.begin(), {"--root", "/project/root"});
+    return ResolveAnalyzeOptions(ParseAnalyzeArguments(extra));
+  };
+
+  const auto options = resolve({"--changed-files", "changed.txt"});
+  ASSERT_TRUE(options.changed_files);
+  EXPECT_EQ(options.changed_files->generic_string(), "changed.txt");
+  EXPECT_THROW(resolve({"--since", "main", "--changed-files", "changed.txt"}),
+               std::invalid_argument);
+  EXPECT_THROW(resolve({"--since", "main", "--watch"}), std::invalid_argument);
+  EXPECT_THROW(resolve({"--changed-files", "changed.txt", "--clean-cache"}),
+               std::invalid_argument);
+}
+
 TEST(CacheCleanHelpersTest, ParsesAndResolvesCacheDirectory) {
   const auto options =
       ParseCacheCleanArguments({"--root", "/project", "--cache-dir", "cache"});
@@ -176,6 +256,59 @@ TEST(CacheCleanHelpersTest, ParsesAndResolvesCacheDirectory) {
   EXPECT_EQ(resolved.generic_string(), "cache");
 }
 
+TEST(ServeArgumentsTest, SeparatesTheSocketFromAnalyzeOptions) {
+  const auto options = ParseServeArguments(
+      {"--root", "/project", "--socket", "/tmp/dsl.sock", "--jobs", "4"});
+
+  ASSERT_TRUE(options.socket);
+  EXPECT_EQ(options.socket->generic_string(), "/tmp/dsl.sock");
+  ASSERT_TRUE(options.analyze.root);
+  EXPECT_EQ(options.analyze.root->generic_string(), "/project");
+  EXPECT_EQ(options.analyze.jobs, 4u);
+}
+
+TEST(ServeArgumentsTest, RejectsSingleRunOptions) {
+  for (const auto &extra : std::vector<std::vector<std::string>>{
+           {"--shard", "1/4"},
+           {"--watch"},
+           {"--since", "main"},
+           {"--changed-files", "changed.txt"}}) {
+    auto arguments = extra;
+    arguments.insert(arguments.begin(), {"--root", "/project"});
+    EXPECT_THROW(ParseServeArguments(arguments), std::invalid_argument)
+        << extra.front();
+  }
+}
+
+TEST(MergeArgumentsTest, SeparatesShardsFromAnalyzeOptions) {
+  const auto options = ParseMergeArguments(
+      {"--root", "/project", "shards/a.shard", "--format", "json", "b.shard"});
+
+  EXPECT_EQ(options.shards, (std::vector<std::filesystem::path>{
+                                "shards/a.shard", "b.shard"}));
+  ASSERT_TRUE(options.analyze.root);
+  EXPECT_EQ(options.analyze.root->generic_string(), "/project");
+  EXPECT_EQ(options.analyze.formats, (std::vector<std::string>{"json"}));
+  EXPECT_THROW(ParseMergeArguments({"--bogus", "a.shard"}),
+               std::invalid_argument);
+}
+
+TEST(ClientArgumentsTest, ParsesRequestAndDefaultsToAnalyze) {
+  const auto defaulted = ParseClientArguments({"--root", "/project"});
+  EXPECT_EQ(defaulted.request, "analyze");
+  EXPECT_FALSE(defaulted.socket);
+
+  const auto options =
+      ParseClientArguments({"--socket", "/tmp/dsl.sock", "shutdown"});
+  EXPECT_EQ(options.request, "shutdown");
+  ASSERT_TRUE(options.socket);
+  EXPECT_EQ(DefaultServerSocket("/project/.dsl_cache").generic_string(),
+            "/project/.dsl_cache/serve.sock");
+
+  EXPECT_THROW(ParseClientArguments({"analyze", "report"}),
+               std::invalid_argument);
+}
+
 TEST(CacheCleanHelpersTest, RemovesCacheDirectoryIfPresent) {
   const auto temp_dir =
       std::filesystem::temp_directory_path() / "dsl_cache_clean_test";
@@ -33,4 +33,11 @@ TEST(EscapingTest, RoundTripPreservesContent) {
   EXPECT_EQ(original, dsl::Unescape(dsl::Escape(original)));
 }
 
+TEST(EscapingTest, EscapesJsonStringSpecialCharacters) {
+  const std::string input = "say \"hi\"\\\tthen\r\nstop";
+
+  EXPECT_EQ("say \\\"hi\\\"\\\\\\tthen\\r\\nstop",
+            dsl::EscapeJsonString(input));
+}
+
 } // namespace
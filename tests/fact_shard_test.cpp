@@ -0,0 +1,117 @@
+#include <dsl/fact_shard.h>
+
+#include <dsl/interfaces.h>
+#include <dsl/models.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "test_support/temporary_project.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dsl {
+namespace {
+
+using ::testing::ElementsAre;
+
+FactStore MakeBatch(const std::vector<std::string> &names) {
+  FactStore facts;
+  for (const auto &name : names) {
+    AstFact fact;
+    fact.name = name;
+    fact.kind = "function";
+    fact.source_location = name + ".cpp:1:1-1:10";
+    facts.push_back(fact);
+  }
+  return facts;
+}
+
+std::vector<std::string> Names(const FactStore &facts) {
+  std::vector<std::string> names;
+  for (const auto fact : facts) {
+    names.emplace_back(fact.name());
+  }
+  return names;
+}
+
+// Writes the batches of `units` whose position `owned` selects to a shard.
+std::filesystem::path
+WriteShard(const test::TemporaryProject &project, const IndexShard &shard,
+           const std::vector<FactStore> &units,
+           const std::vector<bool> &owned,
+           const std::vector<std::string> &notes) {
+  FactShardWriter writer(shard);
+  for (std::size_t position = 0; position < units.size(); ++position) {
+    writer.Consume(owned[position] ? units[position] : FactStore{});
+  }
+  const auto path = project.root() / FactShardFileName(shard);
+  writer.Write(path, notes);
+  return path;
+}
+
+TEST(FactShardTest, EveryFileBelongsToExactlyOneShard) {
+  for (const auto *file : {"src/a.cpp", "src/b.cpp", "tools/main.cpp"}) {
+    int owners = 0;
+    for (unsigned index = 1; index <= 3; ++index) {
+      owners += InShard(file, IndexShard{index, 3}) ? 1 : 0;
+    }
+    EXPECT_EQ(1, owners) << file;
+  }
+  EXPECT_EQ("dsl_facts_2_of_3.shard", FactShardFileName(IndexShard{2, 3}));
+}
+
+TEST(FactShardTest, MergeMatchesASingleDeduplicatedRun) {
+  test::TemporaryProject project;
+  const std::vector<FactStore> units = {MakeBatch({"Foo"}), MakeBatch({"Bar"}),
+                                        MakeBatch({"Foo", "Baz"}),
+                                        FactStore{}};
+  FactStore single;
+  CollectingFactSink collect_single(single);
+  DeduplicatingFactSink deduplicate(collect_single);
+  for (const auto &unit : units) {
+    deduplicate.Consume(unit);
+  }
+
+  const auto second =
+      WriteShard(project, IndexShard{2, 2}, units, {false, true, false, false},
+                 {"Could not parse b.cpp"});
+  const auto first =
+      WriteShard(project, IndexShard{1, 2}, units, {true, false, true, true},
+                 {"Could not parse a.cpp"});
+  FactShardMerger merger({second, first});
+
+  const auto merged = merger.BuildIndex({});
+
+  EXPECT_THAT(Names(merged.facts), ElementsAre("Foo", "Bar", "Baz"));
+  EXPECT_EQ(Names(single), Names(merged.facts));
+  EXPECT_THAT(merger.IndexingNotes(),
+              ElementsAre("Could not parse a.cpp", "Could not parse b.cpp"));
+}
+
+TEST(FactShardTest, RejectsIncompleteOrMismatchedShardSets) {
+  test::TemporaryProject project;
+  const std::vector<FactStore> units = {MakeBatch({"Foo"}), MakeBatch({"Bar"})};
+  const auto first =
+      WriteShard(project, IndexShard{1, 2}, units, {true, false}, {});
+  const auto other = project.root() / "other";
+  std::filesystem::create_directories(other);
+  FactShardWriter three_units(IndexShard{2, 2});
+  for (int i = 0; i < 3; ++i) {
+    three_units.Consume(FactStore{});
+  }
+  three_units.Write(other / "shard", {});
+  const auto garbage = project.AddFile("garbage.shard", "not a shard");
+
+  EXPECT_THROW(FactShardMerger({first}).BuildIndex({}), std::runtime_error);
+  EXPECT_THROW(FactShardMerger({first, first}).BuildIndex({}),
+               std::runtime_error);
+  EXPECT_THROW(FactShardMerger({first, other / "shard"}).BuildIndex({}),
+               std::runtime_error);
+  EXPECT_THROW(FactShardMerger({garbage}).BuildIndex({}), std::runtime_error);
+}
+
+} // namespace
+} // namespace dsl
@@ -0,0 +1,145 @@
+#include <dsl/fact_store.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace dsl {
+namespace {
+
+AstFact MakeCall() {
+  AstFact fact{"sample::Use",     "call",        "use.cpp:3:1-3:9",
+               "int Add(int)",    "calls Add",   "sample::Add",
+               "use.cpp:3:1-3:9", "/// Uses it", "sample"};
+  fact.subject_in_project = true;
+  fact.target_scope = AstFact::TargetScope::kInProject;
+  fact.target_location = "add.h:1:1-1:20";
+  fact.usr = "c:@N@sample@F@Use#";
+  fact.target_usr = "c:@N@sample@F@Add#I#";
+  return fact;
+}
+
+TEST(StringPoolTest, InternsEqualStringsOnce) {
+  StringPool pool;
+  const auto first = pool.Intern("Widget");
+  const auto second = pool.Intern(std::string("Wid") + "get");
+
+  EXPECT_EQ(0u, pool.Intern(""));
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, pool.Intern("Gadget"));
+  EXPECT_EQ("Widget", pool.Get(first));
+  EXPECT_EQ(3u, pool.size());
+}
+
+TEST(StringPoolTest, CopiesAndMovedFromPoolsStayUsable) {
+  StringPool pool;
+  const auto id = pool.Intern("Widget");
+  StringPool copy(pool);
+  StringPool moved(std::move(pool));
+
+  EXPECT_EQ("Widget", copy.Get(id));
+  EXPECT_EQ("Widget", moved.Get(id));
+  EXPECT_EQ("", pool.Get(0));
+  EXPECT_EQ(1u, pool.Intern("Gadget"));
+}
+
+TEST(FactStoreTest, RoundTripsEveryField) {
+  const auto fact = MakeCall();
+  FactStore store{fact};
+
+  ASSERT_EQ(1u, store.size());
+  const AstFact loaded = store[0];
+  EXPECT_EQ(fact.name, loaded.name);
+  EXPECT_EQ(fact.kind, loaded.kind);
+  EXPECT_EQ(fact.source_location, loaded.source_location);
+  EXPECT_EQ(fact.signature, loaded.signature);
+  EXPECT_EQ(fact.descriptor, loaded.descriptor);
+  EXPECT_EQ(fact.target, loaded.target);
+  EXPECT_EQ(fact.range, loaded.range);
+  EXPECT_EQ(fact.doc_comment, loaded.doc_comment);
+  EXPECT_EQ(fact.scope_path, loaded.scope_path);
+  EXPECT_TRUE(loaded.subject_in_project);
+  EXPECT_EQ(AstFact::TargetScope::kInProject, loaded.target_scope);
+  EXPECT_EQ(fact.target_location, loaded.target_location);
+  EXPECT_EQ(fact.usr, loaded.usr);
+  EXPECT_EQ(fact.target_usr, loaded.target_usr);
+  EXPECT_EQ(FactKind::kCall, store[0].kind_id());
+}
+
+TEST(FactStoreTest, StoresRangesAsSpansAndKeepsOtherTextVerbatim) {
+  FactStore store;
+  const auto span = store.InternLocation("src/a:b.cpp:12:3-14:1");
+  const auto point = store.InternLocation("widget.h:1");
+  const auto padded = store.InternLocation("widget.h:01:1-1:2");
+
+  ASSERT_TRUE(span.structured);
+  EXPECT_EQ("src/a:b.cpp", store.Text(span.file));
+  EXPECT_EQ(12u, span.begin_line);
+  EXPECT_EQ(3u, span.begin_column);
+  EXPECT_EQ(14u, span.end_line);
+  EXPECT_EQ(1u, span.end_column);
+  EXPECT_EQ("src/a:b.cpp:12:3-14:1", store.Location(span));
+  EXPECT_FALSE(point.structured);
+  EXPECT_EQ("widget.h:1", store.Location(point));
+  EXPECT_FALSE(padded.structured);
+  EXPECT_EQ("widget.h:01:1-1:2", store.Location(padded));
+}
+
+TEST(FactStoreTest, SharesStringsBetweenFacts) {
+  FactStore store;
+  auto other = MakeCall();
+  other.kind = "type_usage";
+  store.push_back(MakeCall());
+  store.push_back(other);
+
+  const auto &facts = store.compact_facts();
+  EXPECT_EQ(facts[0].name, facts[1].name);
+  EXPECT_EQ(facts[0].location.file, facts[1].location.file);
+  EXPECT_NE(facts[0].kind_text, facts[1].kind_text);
+  EXPECT_EQ(FactKind::kTypeUsage, facts[1].kind);
+}
+
+TEST(FactStoreTest, ImportsFactsFromAnotherStore) {
+  FactStore source;
+  source.push_back({"Unrelated", "type", "other.h:1"});
+  source.push_back(MakeCall());
+  FactStore merged;
+  merged.push_back({"sample::Add", "function", "add.h:1"});
+
+  merged.Add(merged.Import(source, source.compact_facts()[1]));
+
+  ASSERT_EQ(2u, merged.size());
+  EXPECT_EQ(merged.compact_facts()[0].name, merged.compact_facts()[1].target);
+  EXPECT_EQ("sample::Use", merged[1].name());
+  EXPECT_EQ("use.cpp:3:1-3:9", merged[1].range());
+  EXPECT_EQ("add.h:1:1-1:20", merged[1].target_location());
+  EXPECT_EQ("c:@N@sample@F@Add#I#", merged[1].target_usr());
+}
+
+TEST(FactStoreTest, IdentifiesSymbolsByUsrAcrossStores) {
+  auto overload = MakeCall();
+  overload.target_usr = "c:@N@sample@F@Add#d#";
+  FactStore first{MakeCall()};
+  FactStore second{overload, MakeCall()};
+
+  EXPECT_EQ(0u, SymbolIdForUsr(""));
+  EXPECT_EQ(SymbolIdForUsr("c:@N@sample@F@Add#I#"), first[0].target_symbol());
+  EXPECT_EQ(first[0].target_symbol(), second[1].target_symbol());
+  EXPECT_NE(second[0].target_symbol(), second[1].target_symbol());
+  EXPECT_EQ("", first.Usr(SymbolIdForUsr("c:@F@Unknown#")));
+  first.push_back({"Unrelated", "type", "other.h:1"});
+  EXPECT_EQ(0u, first[1].symbol());
+}
+
+TEST(FactStoreTest, ClassifiesKnownKinds) {
+  EXPECT_EQ(FactKind::kFunction, ClassifyFactKind("function"));
+  EXPECT_EQ(FactKind::kType, ClassifyFactKind("type"));
+  EXPECT_EQ(FactKind::kVariable, ClassifyFactKind("variable"));
+  EXPECT_EQ(FactKind::kOwns, ClassifyFactKind("owns"));
+  EXPECT_EQ(FactKind::kCall, ClassifyFactKind("call"));
+  EXPECT_EQ(FactKind::kTypeUsage, ClassifyFactKind("type_usage"));
+  EXPECT_EQ(FactKind::kOther, ClassifyFactKind("alias"));
+}
+
+} // namespace
+} // namespace dsl
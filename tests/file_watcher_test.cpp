@@ -0,0 +1,79 @@
+#include <dsl/file_watcher.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "test_support/temporary_project.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#ifdef __linux__
+
+namespace dsl {
+namespace {
+
+using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::Not;
+
+constexpr std::chrono::milliseconds kQuiet{20};
+
+std::filesystem::path Canonical(const std::filesystem::path &path) {
+  return std::filesystem::weakly_canonical(path);
+}
+
+TEST(FileWatcherTest, ReportsABurstOfChangesOnce) {
+  test::TemporaryProject project;
+  const auto source = project.AddFile("src/a.cpp", "int a;\n");
+  FileWatcher watcher;
+  watcher.WatchTree(project.root());
+
+  std::ofstream(source) << "int a = 1;\n";
+  std::ofstream(source) << "int a = 2;\n";
+  const auto header = project.AddFile("src/a.h", "int b;\n");
+
+  EXPECT_THAT(watcher.WaitForChanges(kQuiet),
+              ElementsAre(Canonical(source), Canonical(header)));
+}
+
+TEST(FileWatcherTest, SkipsExcludedDirectoriesAndWatchesNewOnes) {
+  test::TemporaryProject project;
+  project.AddFile("build/keep.txt", "");
+  FileWatcher watcher({project.root() / "build"});
+  watcher.WatchTree(project.root());
+
+  std::filesystem::create_directories(project.root() / "include");
+  const auto lists = project.AddFile("CMakeLists.txt", "");
+  EXPECT_THAT(watcher.WaitForChanges(kQuiet), ElementsAre(Canonical(lists)));
+  const auto generated = project.AddFile("build/generated.cpp", "");
+  const auto header = project.AddFile("include/new.h", "");
+
+  const auto changed = watcher.WaitForChanges(kQuiet);
+  EXPECT_THAT(changed, Contains(Canonical(header)));
+  EXPECT_THAT(changed, Not(Contains(Canonical(generated))));
+}
+
+TEST(FileWatcherTest, SkipsNewHiddenDirectoriesAndVanishedOnes) {
+  test::TemporaryProject project;
+  project.AddFile("src/a.cpp", "");
+  FileWatcher watcher;
+  watcher.WatchTree(project.root());
+
+  std::filesystem::create_directories(project.root() / ".git");
+  std::filesystem::create_directories(project.root() / "tmp" / "nested");
+  std::filesystem::remove_all(project.root() / "tmp");
+  const auto lists = project.AddFile("CMakeLists.txt", "");
+  EXPECT_THAT(watcher.WaitForChanges(kQuiet), ElementsAre(Canonical(lists)));
+  EXPECT_FALSE(watcher.lost_events());
+
+  project.AddFile(".git/HEAD", "");
+  const auto source = project.AddFile("src/a.cpp", "int a;\n");
+  EXPECT_THAT(watcher.WaitForChanges(kQuiet), ElementsAre(Canonical(source)));
+}
+
+} // namespace
+} // namespace dsl
+
+#endif
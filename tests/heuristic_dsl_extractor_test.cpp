@@ -99,6 +99,104 @@ TEST(HeuristicDslExtractorTest, SkipsExternalTargetsAndCollectsDependencies) {
               Contains(Field(&DslTerm::name, "externaltype")));
 }
 
+TEST(HeuristicDslExtractorTest, StreamedBatchesMatchWholeIndexExtraction) {
+  // The call to Bar arrives before Bar's definition, so scope decisions must
+  // wait for the last batch.
+  FactStore first{MakeDefinition("Foo", "function", "int Foo()"),
+                  MakeRelationshipFact("Foo", "call", "Bar",
+                                       AstFact::TargetScope::kUnknown,
+                                       "int Bar()", "calls Bar")};
+  FactStore second{MakeDefinition("Bar", "function", "int Bar()"),
+                   MakeRelationshipFact("Bar", "call", "std::sort",
+                                        AstFact::TargetScope::kExternal,
+                                        "std::sort", "calls std::sort")};
+  AstIndex index;
+  index.facts.Append(first);
+  index.facts.Append(second);
+
+  HeuristicDslExtractor extractor;
+  const auto whole = extractor.Extract(index, MakeConfig());
+  auto session = extractor.StartExtraction(MakeConfig());
+  session->Consume(first);
+  session->Consume(second);
+  const auto streamed = session->Finish();
+
+  ASSERT_EQ(whole.terms.size(), streamed.terms.size());
+  EXPECT_THAT(streamed.relationships,
+              Contains(AllOf(Field(&DslRelationship::subject, "foo"),
+                             Field(&DslRelationship::verb, "calls"),
+                             Field(&DslRelationship::object, "bar"))));
+  EXPECT_EQ(whole.relationships.size(), streamed.relationships.size());
+  EXPECT_THAT(streamed.external_dependencies,
+              Contains(Field(&DslTerm::name, "std..sort")));
+  ASSERT_NE(nullptr, streamed.facts);
+  EXPECT_EQ(index.facts.size(), streamed.facts->size());
+}
+
+TEST(HeuristicDslExtractorTest, DropsCallsToSymbolsNoBatchDefines) {
+  FactStore first{MakeDefinition("Foo", "function", "int Foo()"),
+                  MakeRelationshipFact("Foo", "call", "Bar",
+                                       AstFact::TargetScope::kUnknown,
+                                       "int Bar()", "calls Bar"),
+                  MakeRelationshipFact("Foo", "call", "Baz",
+                                       AstFact::TargetScope::kUnknown,
+                                       "int Baz()", "calls Baz")};
+  FactStore second{MakeDefinition("Bar", "function", "int Bar()")};
+
+  auto session = HeuristicDslExtractor().StartExtraction(MakeConfig());
+  session->Consume(first);
+  session->Consume(second);
+  const auto result = session->Finish();
+
+  EXPECT_THAT(result.relationships,
+              UnorderedElementsAre(
+                  AllOf(Field(&DslRelationship::subject, "foo"),
+                        Field(&DslRelationship::object, "bar"))));
+  EXPECT_THAT(result.terms, Each(Field(&DslTerm::name, Not("baz"))));
+  EXPECT_THAT(result.terms, Contains(AllOf(Field(&DslTerm::name, "bar"),
+                                           Field(&DslTerm::usage_count, 2))));
+}
+
+TEST(HeuristicDslExtractorTest, IdentifiesSymbolsByUsrAcrossBatches) {
+  // Both overloads of Add are called "add", but only the one both units call
+  // collects their usages.
+  auto add_int = MakeDefinition("Add", "function", "int Add(int)");
+  add_int.usr = "c:@F@Add#I#";
+  auto add_double = MakeDefinition("Add", "function", "double Add(double)");
+  add_double.usr = "c:@F@Add#d#";
+  auto use = MakeDefinition("Use", "function", "int Use()");
+  use.usr = "c:@F@Use#";
+  auto run = MakeDefinition("Run", "function", "int Run()");
+  run.usr = "c:@F@Run#";
+  auto use_calls =
+      MakeRelationshipFact("Use", "call", "Add",
+                           AstFact::TargetScope::kInProject, "int Add(int)",
+                           "calls Add");
+  use_calls.usr = use.usr;
+  use_calls.target_usr = add_int.usr;
+  auto run_calls = use_calls;
+  run_calls.name = "Run";
+  run_calls.usr = run.usr;
+
+  HeuristicDslExtractor extractor;
+  auto session = extractor.StartExtraction(MakeConfig());
+  session->Consume(FactStore{add_int, add_double, use, use_calls});
+  session->Consume(FactStore{run, run_calls});
+  const auto result = session->Finish();
+
+  EXPECT_EQ(2, std::count_if(result.terms.begin(), result.terms.end(),
+                             [](const DslTerm &term) {
+                               return term.name == "add";
+                             }));
+  EXPECT_THAT(result.terms,
+              Contains(AllOf(Field(&DslTerm::name, "add"),
+                             Field(&DslTerm::usage_count, 3))));
+  EXPECT_THAT(result.terms,
+              Contains(AllOf(Field(&DslTerm::name, "add"),
+                             Field(&DslTerm::usage_count, 1))));
+  EXPECT_EQ(2u, result.relationships.size());
+}
+
 TEST(HeuristicDslExtractorTest, SkipsDefaultIgnoredNamespaces) {
   AstIndex index;
   index.facts.push_back(
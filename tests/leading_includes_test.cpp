@@ -0,0 +1,57 @@
+#include <dsl/leading_includes.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace dsl {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(LeadingIncludesTest, CollectsIncludesBeforeTheFirstDeclaration) {
+  EXPECT_THAT(LeadingIncludes("\xEF\xBB\xBF"
+                              "// Copyright\n"
+                              "/* License\n   text */\n"
+                              "#include \"pch.h\"\n"
+                              "  #  include <vector> // containers\n"
+                              "\n"
+                              "#include<map>\n"
+                              "int x;\n"
+                              "#include <set>\n"),
+              ElementsAre("\"pch.h\"", "<vector>", "<map>"));
+}
+
+TEST(LeadingIncludesTest, StopsAtOtherDirectivesAndCode) {
+  EXPECT_THAT(LeadingIncludes("#include <a>\n#define X 1\n#include <b>\n"),
+              ElementsAre("<a>"));
+  EXPECT_THAT(LeadingIncludes("#include <a>\n#include_next <b>\n"),
+              ElementsAre("<a>"));
+  EXPECT_THAT(LeadingIncludes("#include HEADER\n"), IsEmpty());
+  EXPECT_THAT(LeadingIncludes("#include <a> int x;\n"), ElementsAre("<a>"));
+  EXPECT_THAT(LeadingIncludes("#include \"open\n\"\n"), IsEmpty());
+  EXPECT_THAT(LeadingIncludes("/* unterminated\n#include <a>\n"), IsEmpty());
+  EXPECT_THAT(LeadingIncludes(""), IsEmpty());
+}
+
+TEST(FirstMacroDirectiveTest, FindsTheFirstDefineOrUndef) {
+  EXPECT_EQ(FirstMacroDirective("#include <a>\n  # define X 1\n#undef X\n"),
+            15U);
+  EXPECT_EQ(FirstMacroDirective("int x;\n#undef Y\n"), 7U);
+  EXPECT_EQ(FirstMacroDirective("#define"), 0U);
+  EXPECT_EQ(FirstMacroDirective("#include <a>\n#defined X\nint define;\n"),
+            std::string_view::npos);
+  EXPECT_EQ(FirstMacroDirective(""), std::string_view::npos);
+}
+
+TEST(CommonIncludePrefixTest, KeepsTheSharedOpeningRun) {
+  EXPECT_THAT(CommonIncludePrefix({{"\"pch.h\"", "<vector>", "<map>"},
+                                   {"\"pch.h\"", "<vector>"},
+                                   {"\"pch.h\"", "<vector>", "<set>"}}),
+              ElementsAre("\"pch.h\"", "<vector>"));
+  EXPECT_THAT(CommonIncludePrefix({{"<a>"}, {"<b>", "<a>"}}), IsEmpty());
+  EXPECT_THAT(CommonIncludePrefix({}), IsEmpty());
+}
+
+} // namespace
+} // namespace dsl
@@ -0,0 +1,32 @@
+#include <dsl/mapped_file.h>
+
+#include <gtest/gtest.h>
+
+#include "test_support/temporary_project.h"
+
+namespace dsl {
+namespace {
+
+TEST(MappedFileTest, ExposesFileContents) {
+  test::TemporaryProject project;
+  const auto path = project.AddFile("data.bin", std::string("a\0b", 3));
+
+  auto file = MappedFile::Open(path);
+  ASSERT_TRUE(file.has_value());
+  const auto moved = std::move(*file);
+
+  EXPECT_EQ(std::string_view("a\0b", 3), moved.contents());
+}
+
+TEST(MappedFileTest, HandlesEmptyAndMissingFiles) {
+  test::TemporaryProject project;
+  const auto path = project.AddFile("empty.bin");
+
+  const auto file = MappedFile::Open(path);
+  ASSERT_TRUE(file.has_value());
+  EXPECT_TRUE(file->contents().empty());
+  EXPECT_FALSE(MappedFile::Open(project.root() / "missing.bin").has_value());
+}
+
+} // namespace
+} // namespace dsl
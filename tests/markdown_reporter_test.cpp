@@ -72,6 +72,21 @@ TEST(MarkdownReporterTest, RendersSections) {
   EXPECT_THAT(report.json, ::testing::HasSubstr("\"extraction_notes\""));
 }
 
+TEST(MarkdownReporterTest, RecordsIndexDepthInHeader) {
+  MarkdownReporter reporter;
+  AnalysisConfig config{.root_path = "repo",
+                        .formats = {"markdown", "json"},
+                        .index_depth = IndexDepth::kDeclarations};
+
+  const auto report = reporter.Render({}, {}, config);
+
+  EXPECT_THAT(report.markdown,
+              ::testing::HasSubstr("| Index Depth | declarations (no call or "
+                                   "type_usage relationships) |"));
+  EXPECT_THAT(report.json,
+              ::testing::HasSubstr("\"index_depth\": \"declarations\""));
+}
+
 TEST(MarkdownReporterTest, JoinsListsWithDelimiters) {
   DslExtractionResult extraction;
   DslTerm term;
@@ -0,0 +1,14 @@
+#include <dsl/naming.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+TEST(NamingTest, CanonicalizesScopeSeparatorsAndCase) {
+  EXPECT_EQ("sample..widget", dsl::CanonicalizeName("Sample::Widget"));
+  EXPECT_EQ(dsl::CanonicalizeName("sample..widget"),
+            dsl::CanonicalizeName("SAMPLE::WIDGET"));
+  EXPECT_EQ("", dsl::CanonicalizeName(""));
+}
+
+} // namespace
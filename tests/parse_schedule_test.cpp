@@ -0,0 +1,129 @@
+#include <dsl/parse_schedule.h>
+
+#include <chrono>
+#include <future>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace dsl {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Records the first fact name of each batch, or "-" for an empty batch.
+class RecordingSink : public FactSink {
+public:
+  void Consume(const FactStore &facts) override {
+    batches.emplace_back(facts.size() == 0 ? std::string_view("-")
+                                           : facts[0].name());
+  }
+
+  std::vector<std::string> batches;
+};
+
+// Holds the first batch until `released` is ready, after announcing through
+// `consuming` that it is being consumed.
+class GatedSink : public RecordingSink {
+public:
+  GatedSink(std::promise<void> &consuming, std::shared_future<void> released)
+      : consuming_(&consuming), released_(std::move(released)) {}
+
+  void Consume(const FactStore &facts) override {
+    if (batches.empty()) {
+      consuming_->set_value();
+      released_in_time = released_.wait_for(std::chrono::seconds(10)) ==
+                         std::future_status::ready;
+    }
+    RecordingSink::Consume(facts);
+  }
+
+  bool released_in_time = false;
+
+private:
+  std::promise<void> *consuming_;
+  std::shared_future<void> released_;
+};
+
+FactStore Batch(const std::string &name) {
+  return FactStore{AstFact{name, "type", name + ".h:1"}};
+}
+
+TEST(ParseScheduleTest, EstimatesUnrecordedJobsFromRecordedRate) {
+  EXPECT_THAT(EstimateParseCosts({std::nullopt, 500, std::nullopt},
+                                 {100, 50, 30}),
+              ElementsAre(1000, 500, 300));
+  EXPECT_THAT(EstimateParseCosts({std::nullopt, std::nullopt}, {7, 3}),
+              ElementsAre(7, 3));
+}
+
+TEST(ParseScheduleTest, OrdersLongestJobsFirstAndKeepsTiesInOrder) {
+  EXPECT_THAT(LongestFirstOrder({2, 9, 2, 5}), ElementsAre(1, 3, 0, 2));
+}
+
+TEST(ParseScheduleTest, LongestFirstShortensTheMakespan) {
+  // A long job scheduled last runs alone after the short ones are done.
+  const std::vector<std::uint64_t> costs{1, 1, 1, 1, 4};
+
+  EXPECT_EQ(6u, PredictMakespan(costs, {0, 1, 2, 3, 4}, 2));
+  EXPECT_EQ(4u, PredictMakespan(costs, LongestFirstOrder(costs), 2));
+  EXPECT_EQ(8u, PredictMakespan(costs, LongestFirstOrder(costs), 1));
+}
+
+TEST(OrderedDeliveryTest, DeliversInJobOrderWithinTheWindow) {
+  // Longest first would run 3, 2, 1 and hold two batches back until 0 is
+  // done; with room for one, the earliest job runs as soon as one waits.
+  RecordingSink sink;
+  OrderedDelivery delivery({3, 2, 1}, 4, 1, sink);
+
+  std::vector<std::size_t> taken;
+  while (const auto job = delivery.Take()) {
+    taken.push_back(*job);
+    delivery.Complete(*job, Batch("job" + std::to_string(*job)));
+  }
+
+  EXPECT_THAT(taken, ElementsAre(3, 1, 2));
+  EXPECT_THAT(sink.batches, ElementsAre("-", "job1", "job2", "job3"));
+  EXPECT_EQ(1u, delivery.peak_waiting());
+}
+
+TEST(OrderedDeliveryTest, CompletesJobsWhileABatchIsConsumed) {
+  // The second job completes while the first batch is being consumed; a
+  // worker completing a job must not wait for the sink.
+  std::promise<void> consuming;
+  std::promise<void> released;
+  GatedSink sink(consuming, released.get_future().share());
+  OrderedDelivery delivery({0, 1}, 2, 4, sink);
+  ASSERT_EQ(std::optional<std::size_t>(0), delivery.Take());
+  ASSERT_EQ(std::optional<std::size_t>(1), delivery.Take());
+
+  std::thread second([&]() {
+    consuming.get_future().wait();
+    delivery.Complete(1, Batch("job1"));
+    released.set_value();
+  });
+  delivery.Complete(0, Batch("job0"));
+  second.join();
+
+  EXPECT_TRUE(sink.released_in_time);
+  EXPECT_THAT(sink.batches, ElementsAre("job0", "job1"));
+  EXPECT_EQ(1u, delivery.peak_waiting());
+}
+
+TEST(OrderedDeliveryTest, StopHandsOutNoMoreJobs) {
+  RecordingSink sink;
+  OrderedDelivery delivery({0, 1}, 2, 4, sink);
+
+  ASSERT_EQ(std::optional<std::size_t>(0), delivery.Take());
+  delivery.Stop();
+
+  EXPECT_FALSE(delivery.Take());
+}
+
+} // namespace
+} // namespace dsl
@@ -0,0 +1,156 @@
+#include <dsl/project_generator.h>
+
+#include "test_support/temporary_project.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace dsl {
+namespace {
+
+std::string ReadFile(const std::filesystem::path &path) {
+  std::ifstream stream(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(stream),
+          std::istreambuf_iterator<char>()};
+}
+
+std::size_t CountOccurrences(const std::string &text,
+                             const std::string &needle) {
+  std::size_t count = 0;
+  for (auto position = text.find(needle); position != std::string::npos;
+       position = text.find(needle, position + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+TEST(ProjectGeneratorTest, WritesEveryUnitHeaderAndCompileCommand) {
+  test::TemporaryProject project;
+  ProjectShape shape;
+  shape.translation_units = 3;
+  shape.headers_per_unit = 2;
+
+  const auto generated = GenerateProject(project.root(), shape);
+
+  ASSERT_EQ(3u, generated.sources.size());
+  ASSERT_EQ(6u, generated.headers.size());
+  EXPECT_TRUE(std::filesystem::exists(generated.root / "CMakeLists.txt"));
+  for (const auto &path : generated.sources) {
+    EXPECT_TRUE(std::filesystem::is_regular_file(path)) << path;
+  }
+  for (const auto &path : generated.headers) {
+    EXPECT_TRUE(std::filesystem::is_regular_file(path)) << path;
+  }
+  const auto commands = ReadFile(generated.compile_commands);
+  EXPECT_EQ(3u, CountOccurrences(commands, "\"file\": \"../src/unit"));
+  EXPECT_EQ(3u, CountOccurrences(commands, "-I../include"));
+  EXPECT_GT(generated.lines, 0u);
+  EXPECT_GT(generated.bytes, generated.lines);
+}
+
+TEST(ProjectGeneratorTest, CallsReachClassesOfOtherUnits) {
+  test::TemporaryProject project;
+  ProjectShape shape;
+  shape.translation_units = 4;
+  shape.call_fan_out = 3;
+  shape.namespace_depth = 1;
+
+  const auto generated = GenerateProject(project.root(), shape);
+
+  const auto source = ReadFile(generated.sources.front());
+  const auto method_count = shape.classes_per_header * shape.methods_per_class;
+  EXPECT_EQ(method_count * shape.call_fan_out,
+            CountOccurrences(source, " peer;"));
+  EXPECT_EQ(0u, CountOccurrences(source, "::gen::area0::Component0 peer"));
+  EXPECT_EQ(0u, CountOccurrences(source, "::gen::area0::Component1 peer"));
+  EXPECT_NE(std::string::npos, source.find("#include \"gen/area0/header0.h\""));
+}
+
+TEST(ProjectGeneratorTest, SameShapeProducesIdenticalFiles) {
+  test::TemporaryProject first;
+  test::TemporaryProject second;
+  test::TemporaryProject reseeded;
+  ProjectShape shape;
+  shape.translation_units = 5;
+  auto other_seed = shape;
+  other_seed.seed = 7;
+
+  const auto a = GenerateProject(first.root() / "project", shape);
+  const auto b = GenerateProject(second.root() / "project", shape);
+  const auto c = GenerateProject(reseeded.root() / "project", other_seed);
+
+  ASSERT_EQ(a.sources.size(), b.sources.size());
+  EXPECT_EQ(a.lines, b.lines);
+  for (std::size_t i = 0; i < a.sources.size(); ++i) {
+    EXPECT_EQ(ReadFile(a.sources[i]), ReadFile(b.sources[i]));
+  }
+  for (std::size_t i = 0; i < a.headers.size(); ++i) {
+    EXPECT_EQ(ReadFile(a.headers[i]), ReadFile(b.headers[i]));
+  }
+  EXPECT_NE(ReadFile(a.sources.front()), ReadFile(c.sources.front()));
+}
+
+TEST(ProjectGeneratorTest, DocCommentDensityControlsDocumentation) {
+  test::TemporaryProject undocumented;
+  test::TemporaryProject documented;
+  ProjectShape shape;
+  shape.translation_units = 2;
+  shape.doc_comment_density = 0.0;
+  const auto none = GenerateProject(undocumented.root(), shape);
+  shape.doc_comment_density = 1.0;
+  const auto all = GenerateProject(documented.root(), shape);
+
+  const auto per_header =
+      shape.classes_per_header * (1 + shape.methods_per_class);
+  EXPECT_EQ(0u, CountOccurrences(ReadFile(none.headers.front()), "///"));
+  EXPECT_EQ(per_header, CountOccurrences(ReadFile(all.headers.front()), "///"));
+}
+
+TEST(ProjectGeneratorTest, ScenarioShapesMatchTheirLineBudget) {
+  test::TemporaryProject project;
+
+  const auto generated =
+      GenerateProject(project.root(), ProjectShapeForScenario("50k-loc"));
+  const auto large = ProjectShapeForScenario("500k-loc");
+
+  EXPECT_GE(generated.lines, 45'000u);
+  EXPECT_LE(generated.lines, 60'000u);
+  EXPECT_EQ(10 * ProjectShapeForScenario("50k-loc").translation_units,
+            large.translation_units);
+  EXPECT_THROW(ProjectShapeForScenario("huge"), std::invalid_argument);
+}
+
+TEST(ProjectGeneratorTest, ParsesScenarioAndOverrides) {
+  const auto options = ParseGenerateProjectArguments(
+      {"--seed", "9", "--scenario", "50k-loc", "--units", "12",
+       "--doc-density", "0.25", "--out", "generated"});
+
+  EXPECT_EQ("generated", options.output_directory);
+  EXPECT_EQ(12u, options.shape.translation_units);
+  EXPECT_EQ(3u, options.shape.classes_per_header);
+  EXPECT_DOUBLE_EQ(0.25, options.shape.doc_comment_density);
+  EXPECT_EQ(9u, options.shape.seed);
+  EXPECT_THROW(ParseGenerateProjectArguments({"--units", "2"}),
+               std::invalid_argument);
+  EXPECT_THROW(ParseGenerateProjectArguments(
+                   {"--out", "x", "--doc-density", "1.5"}),
+               std::invalid_argument);
+  EXPECT_THROW(ParseGenerateProjectArguments({"--out", "x", "--units", "-1"}),
+               std::invalid_argument);
+}
+
+TEST(ProjectGeneratorTest, RejectsEmptyShapes) {
+  test::TemporaryProject project;
+  ProjectShape shape;
+  shape.methods_per_class = 0;
+
+  EXPECT_THROW(GenerateProject(project.root(), shape), std::invalid_argument);
+}
+
+} // namespace
+} // namespace dsl
@@ -0,0 +1,61 @@
+#include "allocation_tracking.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+// Each block is prefixed with its size, padded to keep the payload aligned.
+constexpr std::size_t kHeaderSize = alignof(std::max_align_t);
+
+std::atomic<std::size_t> live_bytes{0};
+std::atomic<std::size_t> peak_bytes{0};
+
+void RecordAllocation(std::size_t size) {
+  const auto live = live_bytes.fetch_add(size) + size;
+  auto peak = peak_bytes.load();
+  while (live > peak && !peak_bytes.compare_exchange_weak(peak, live)) {
+  }
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  auto *block = static_cast<char *>(std::malloc(size + kHeaderSize));
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  std::memcpy(block, &size, sizeof(size));
+  RecordAllocation(size);
+  return block + kHeaderSize;
+}
+
+void operator delete(void *pointer) noexcept {
+  if (pointer == nullptr) {
+    return;
+  }
+  auto *block = static_cast<char *>(pointer) - kHeaderSize;
+  std::size_t size = 0;
+  std::memcpy(&size, block, sizeof(size));
+  live_bytes.fetch_sub(size);
+  std::free(block);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  operator delete(pointer);
+}
+
+namespace dsl {
+namespace test {
+
+std::size_t AllocatedBytes() { return live_bytes.load(); }
+
+std::size_t PeakAllocatedBytes() { return peak_bytes.load(); }
+
+void ResetPeakAllocatedBytes() { peak_bytes.store(live_bytes.load()); }
+
+} // namespace test
+} // namespace dsl
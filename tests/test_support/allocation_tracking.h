@@ -0,0 +1,19 @@
+#ifndef DSL_TEST_SUPPORT_ALLOCATION_TRACKING_H
+#define DSL_TEST_SUPPORT_ALLOCATION_TRACKING_H
+
+#include <cstddef>
+
+namespace dsl {
+namespace test {
+
+// Heap accounting backed by the replacement operator new/delete in
+// allocation_tracking.cpp. Counts bytes requested through operator new.
+std::size_t AllocatedBytes();
+std::size_t PeakAllocatedBytes();
+// Restarts peak tracking from the current number of live bytes.
+void ResetPeakAllocatedBytes();
+
+} // namespace test
+} // namespace dsl
+
+#endif // DSL_TEST_SUPPORT_ALLOCATION_TRACKING_H